@@ -4,6 +4,9 @@ def add_file_downloads(confs : dict) -> list:
         @param confs kconfig vars, dict type
         @return list type, items is dict type
     '''
+    if not confs.get('PLATFORM_MAIXCAM', None) and not confs.get('PLATFORM_MAIXCAM2', None):
+        # linux use FFmpeg installed in system
+        return []
     version = f"{confs['CONFIG_FFMPEG_VERSION_MAJOR']}.{confs['CONFIG_FFMPEG_VERSION_MINOR']}.{confs['CONFIG_FFMPEG_VERSION_PATCH']}.{confs['CONFIG_FFMPEG_COMPILED_VERSION']}"
     if confs.get('PLATFORM_MAIXCAM', None):
         url = f"https://github.com/sipeed/MaixCDK/releases/download/v0.0.0/ffmpeg_libs_n{version}.tar.xz"
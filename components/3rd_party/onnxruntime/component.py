@@ -3,6 +3,9 @@ def add_file_downloads(confs : dict) -> list:
         @param confs kconfig vars, dict type
         @return list type, items is dict type
     '''
+    if not (confs.get('PLATFORM_MAIXCAM', None) or confs.get('PLATFORM_MAIXCAM2', None)):
+        # linux use local onnxruntime, see ONNXRUNTIME_DIR in Kconfig
+        return []
     version = f"{confs['CONFIG_ONNXRUNTIME_VERSION_MAJOR']}.{confs['CONFIG_ONNXRUNTIME_VERSION_MINOR']}.{confs['CONFIG_ONNXRUNTIME_VERSION_PATCH']}"
     if confs.get('PLATFORM_MAIXCAM', None):
         url = f"https://github.com/sipeed/MaixCDK/releases/download/v0.0.0/sg2002_onnxruntime_v{version}.tar.xz"
@@ -92,5 +92,12 @@ namespace maix::comm
          * @maixcdk maix.comm.CommBase.read
          */
         virtual Bytes *read(int len, int timeout) = 0;
+
+        /**
+         * Get device file descriptor, used to wait data with poll/epoll.
+         * @return file descriptor, -1 means not support, then caller should use read with timeout instead.
+         * @maixcdk maix.comm.CommBase.fd
+         */
+        virtual int fd() { return -1; }
     };
 }
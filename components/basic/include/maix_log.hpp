@@ -11,6 +11,7 @@
 #include <stdio.h>
 #include "global_config.h"
 #include <stdarg.h>
+#include <string>
 
 namespace maix::log
 {
@@ -50,6 +51,42 @@ namespace maix::log
      */
     bool get_log_use_color();
 
+    /**
+     * Enable or disable async log mode, default is sync mode.
+     * In async mode, log is formatted in caller thread and pushed to a lock-free queue,
+     * a background thread writes logs to stdout and log file, so slow console will not block caller.
+     * If queue is full, log will be dropped, and the dropped count will be printed later.
+     * @param enable true to enable async mode, false to disable and wait all queued logs written.
+     * @param queue_size max number of logs in queue, only take effect at the first time enable.
+     * @maixpy maix.log.set_async
+     */
+    void set_async(bool enable, int queue_size = 256);
+
+    /**
+     * Get whether log is in async mode
+     * @return true if async mode enabled
+     * @maixpy maix.log.get_async
+     */
+    bool get_async();
+
+    /**
+     * Set log file, logs will be written to stdout and this file.
+     * @param path log file path, empty string to disable log file.
+     * @param max_size max file size in bytes, file will be rotated when exceed, 0 means no limit.
+     * @param max_files max number of rotated files to keep, named path.1, path.2 ... path.max_files, 0 means not keep.
+     * @return true if open log file success
+     * @maixpy maix.log.set_log_file
+     */
+    bool set_log_file(const std::string &path, int max_size = 1048576, int max_files = 3);
+
+    /**
+     * Limit repeated logs, same log repeated in interval_ms will be dropped,
+     * and repeat count will be printed before the next same log.
+     * @param interval_ms interval in ms, 0 means disable rate limit(default).
+     * @maixpy maix.log.set_rate_limit
+     */
+    void set_rate_limit(int interval_ms);
+
     /**
      * print error log
      * @param fmt format string
@@ -229,6 +229,15 @@ namespace maix
                 set_body(body_new->data, body_new->size());
             }
 
+            /**
+             * Set message body reference to external data, no copy.
+             * Body will not be freed by MSG, and only valid while the external data is valid.
+             * @param body_ref body data
+             * @param body_len body data length
+             * @maixcdk maix.protocol.MSG.set_body_view
+            */
+            void set_body_view(uint8_t *body_ref, int body_len);
+
             /**
              * Get message body
              * @return message body, bytes type
@@ -241,6 +250,7 @@ namespace maix
 
         private:
             int _body_buff_len;
+            bool _body_view;
         };
 
         /**
@@ -291,6 +301,17 @@ namespace maix
             */
             protocol::MSG *decode(uint8_t *new_data = nullptr, size_t len = 0);
 
+            /**
+             * Decode data in data queue and return a message without copy body.
+             * @param new_data new data add to data queue, if null, only decode.
+             * @param len new data length, can be 0.
+             * @return decoded message, if nullptr, means no message decoded.
+             *         Message body references the data queue directly, only valid until next push_data, decode or decode_view,
+             *         use decode instead if you need keep the message longer.
+             * @maixcdk maix.protocol.Protocol.decode_view
+            */
+            protocol::MSG *decode_view(uint8_t *new_data = nullptr, size_t len = 0);
+
             /**
              * Decode data in data queue and return a message
              * @param new_data new data add to data queue, if null, only decode.
@@ -386,8 +407,11 @@ namespace maix
         private:
             int _buff_size;
             uint8_t *_buff;
+            int _data_start;
             int _data_len;
             uint32_t _header;
+
+            protocol::MSG *_decode(uint8_t *new_data, size_t len, bool body_view);
         };
 
         /**
@@ -3,17 +3,29 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Thread local format buffer, add async mode, log file and rate limit.
+ * @update 2026.10.18: Format long log to heap buffer instead of truncate.
  */
 
 
 #include "maix_log.hpp"
 #include "maix_err.hpp"
 #include <string>
+#include <string.h>
+#include <stdlib.h>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <unistd.h>
+#include <sys/eventfd.h>
 
 namespace maix::log
 {
+    #define LOG_MSG_MAX   512
+    #define LOG_LINE_MAX  (LOG_MSG_MAX + 16)
+    #define LOG_RATE_SLOTS 16
 
-    static char log_buf[512];
 #if DEBUG
     static volatile LogLevel log_level = LogLevel::LEVEL_DEBUG;
 #else
@@ -21,6 +33,341 @@ namespace maix::log
 #endif
     static volatile bool log_color = false;
 
+    // every thread format log in its own buffer
+    static thread_local char log_buf[LOG_LINE_MAX];
+
+    /**
+     * Bounded lock-free queue(Vyukov), multiple log producers, one writer thread consumer.
+     */
+    class _LogQueue
+    {
+    public:
+        struct Cell
+        {
+            std::atomic<size_t> seq;
+            uint16_t len;
+            char data[LOG_LINE_MAX];
+        };
+
+        _LogQueue(size_t size)
+        {
+            _size = 2;
+            while (_size < size)
+                _size <<= 1;
+            _cells = new Cell[_size];
+            for (size_t i = 0; i < _size; ++i)
+                _cells[i].seq.store(i, std::memory_order_relaxed);
+            _head.store(0, std::memory_order_relaxed);
+            _tail = 0;
+        }
+
+        ~_LogQueue()
+        {
+            delete[] _cells;
+        }
+
+        bool push(const char *data, int len)
+        {
+            size_t pos = _head.load(std::memory_order_relaxed);
+            Cell *cell;
+            while (1)
+            {
+                cell = &_cells[pos & (_size - 1)];
+                size_t seq = cell->seq.load(std::memory_order_acquire);
+                intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+                if (diff == 0)
+                {
+                    if (_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                    return false; // full
+                else
+                    pos = _head.load(std::memory_order_relaxed);
+            }
+            memcpy(cell->data, data, len);
+            cell->len = len;
+            cell->seq.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        // only called by writer thread
+        Cell *front()
+        {
+            Cell *cell = &_cells[_tail & (_size - 1)];
+            if ((intptr_t)cell->seq.load(std::memory_order_acquire) - (intptr_t)(_tail + 1) < 0)
+                return nullptr;
+            return cell;
+        }
+
+        void pop()
+        {
+            Cell *cell = &_cells[_tail & (_size - 1)];
+            cell->seq.store(_tail + _size, std::memory_order_release);
+            ++_tail;
+        }
+
+    private:
+        Cell *_cells;
+        size_t _size;
+        std::atomic<size_t> _head;
+        size_t _tail;
+    };
+
+    // output sinks, sync mode guarded by _out_lock, async mode only used by writer thread
+    static std::mutex _out_lock;
+    static FILE *_log_file = nullptr;
+    static std::string _log_file_path;
+    static long _log_file_size = 0;
+    static long _log_file_max_size = 0;
+    static int _log_file_max_files = 0;
+
+    // repeated message rate limit, guarded by _rate_lock,
+    // _out_lock can not be used as writer thread is joined with it held
+    static std::mutex _rate_lock;
+    static int _rate_interval_ms = 0;
+    struct _RateSlot
+    {
+        uint32_t hash;
+        uint64_t t;
+        uint32_t suppressed;
+    };
+    static _RateSlot _rate_slots[LOG_RATE_SLOTS];
+    static int _rate_next = 0;
+
+    // async writer
+    // queue is created at first time enable async and never freed,
+    // so other threads logging while switching mode will not access freed memory.
+    static _LogQueue *_queue = nullptr;
+    static std::atomic<bool> _async{false};
+    static std::thread *_writer = nullptr;
+    static std::atomic<bool> _writer_exit{false};
+    static std::atomic<bool> _writer_waiting{false};
+    static std::atomic<uint64_t> _dropped{0};
+    static std::atomic<uint64_t> _pushed{0};
+    static std::atomic<uint64_t> _written{0};
+    static int _writer_fd = -1;
+
+    static uint64_t _ms()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static void _file_rotate()
+    {
+        fclose(_log_file);
+        _log_file = nullptr;
+        for (int i = _log_file_max_files - 1; i > 0; --i)
+        {
+            std::string from = _log_file_path + "." + std::to_string(i);
+            std::string to = _log_file_path + "." + std::to_string(i + 1);
+            rename(from.c_str(), to.c_str());
+        }
+        if (_log_file_max_files > 0)
+            rename(_log_file_path.c_str(), (_log_file_path + ".1").c_str());
+        _log_file = fopen(_log_file_path.c_str(), "w");
+        _log_file_size = 0;
+    }
+
+    static void _output(const char *data, int len)
+    {
+        fwrite(data, 1, len, stdout);
+        if (_log_file)
+        {
+            if (_log_file_max_size > 0 && _log_file_size + len > _log_file_max_size)
+                _file_rotate();
+            if (_log_file)
+            {
+                fwrite(data, 1, len, _log_file);
+                _log_file_size += len;
+            }
+        }
+    }
+
+    /**
+     * Check rate limit, return false if this message should be dropped.
+     * If message allowed after some repeat dropped, repeat count will be written to *suppressed.
+     */
+    static bool _rate_check(const char *data, int len, uint32_t *suppressed)
+    {
+        *suppressed = 0;
+        std::lock_guard<std::mutex> lock(_rate_lock);
+        if (_rate_interval_ms <= 0)
+            return true;
+        uint32_t hash = 2166136261u; // FNV-1a
+        for (int i = 0; i < len; ++i)
+            hash = (hash ^ (uint8_t)data[i]) * 16777619u;
+        uint64_t t = _ms();
+        for (int i = 0; i < LOG_RATE_SLOTS; ++i)
+        {
+            _RateSlot &slot = _rate_slots[i];
+            if (slot.t != 0 && slot.hash == hash)
+            {
+                if (t - slot.t < (uint64_t)_rate_interval_ms)
+                {
+                    ++slot.suppressed;
+                    return false;
+                }
+                *suppressed = slot.suppressed;
+                slot.t = t;
+                slot.suppressed = 0;
+                return true;
+            }
+        }
+        _RateSlot &slot = _rate_slots[_rate_next];
+        _rate_next = (_rate_next + 1) % LOG_RATE_SLOTS;
+        slot.hash = hash;
+        slot.t = t;
+        slot.suppressed = 0;
+        return true;
+    }
+
+    static void _write_line(const char *data, int len)
+    {
+        uint32_t suppressed;
+        if (!_rate_check(data, len, &suppressed))
+            return;
+        if (suppressed > 0)
+        {
+            char tmp[64];
+            int n = snprintf(tmp, sizeof(tmp), "-- [W] log below repeated %u times, suppressed by rate limit\n", suppressed);
+            _output(tmp, n);
+        }
+        _output(data, len);
+    }
+
+    static void _writer_loop()
+    {
+        while (1)
+        {
+            _LogQueue::Cell *cell = _queue->front();
+            if (cell)
+            {
+                _write_line(cell->data, cell->len);
+                _queue->pop();
+                _written.fetch_add(1, std::memory_order_release);
+                continue;
+            }
+            uint64_t dropped = _dropped.exchange(0);
+            if (dropped > 0)
+            {
+                char tmp[64];
+                int n = snprintf(tmp, sizeof(tmp), "-- [W] log queue full, %llu logs dropped\n", (unsigned long long)dropped);
+                _output(tmp, n);
+            }
+            fflush(stdout);
+            if (_log_file)
+                fflush(_log_file);
+            if (_writer_exit.load())
+                break;
+            // sleep until new log pushed
+            _writer_waiting.store(true);
+            if (_queue->front() || _writer_exit.load())
+            {
+                _writer_waiting.store(false);
+                continue;
+            }
+            uint64_t v;
+            if (::read(_writer_fd, &v, sizeof(v)) < 0)
+            {
+                _writer_waiting.store(false);
+            }
+        }
+    }
+
+    static void _writer_wakeup()
+    {
+        if (_writer_waiting.exchange(false))
+        {
+            uint64_t v = 1;
+            if (::write(_writer_fd, &v, sizeof(v)) < 0)
+            {
+                // writer will still wake up by next log
+            }
+        }
+    }
+
+    static void _writer_stop()
+    {
+        if (!_writer)
+            return;
+        _writer_exit.store(true);
+        _writer_waiting.store(true); // force wakeup
+        _writer_wakeup();
+        _writer->join();
+        delete _writer;
+        _writer = nullptr;
+        ::close(_writer_fd);
+        _writer_fd = -1;
+    }
+
+    static void _emit(const char *data, int len)
+    {
+        if (_async.load(std::memory_order_acquire))
+        {
+            // long log split to multiple queue cells
+            while (len > 0)
+            {
+                int n = len > LOG_LINE_MAX - 1 ? LOG_LINE_MAX - 1 : len;
+                if (_queue->push(data, n))
+                    _pushed.fetch_add(1, std::memory_order_relaxed);
+                else
+                    _dropped.fetch_add(1, std::memory_order_relaxed);
+                data += n;
+                len -= n;
+            }
+            _writer_wakeup();
+            return;
+        }
+        std::lock_guard<std::mutex> lock(_out_lock);
+        _write_line(data, len);
+    }
+
+    /**
+     * Format log to thread local buffer and output,
+     * message longer than LOG_MSG_MAX will be formatted again to heap buffer.
+     * @param msg if not nullptr, message without prefix and newline will be written to it.
+     */
+    static void _vlog(const char *prefix, const char *fmt, va_list args, bool newline, std::string *msg = nullptr)
+    {
+        int prefix_len = prefix ? strlen(prefix) : 0;
+        if (prefix_len)
+            memcpy(log_buf, prefix, prefix_len);
+        va_list args2;
+        va_copy(args2, args);
+        int n = vsnprintf(log_buf + prefix_len, LOG_MSG_MAX, fmt, args);
+        char *buf = log_buf;
+        if (n < 0)
+            n = 0;
+        else if (n > LOG_MSG_MAX - 1)
+        {
+            buf = (char *)malloc(prefix_len + n + 2);
+            if (buf)
+            {
+                memcpy(buf, log_buf, prefix_len);
+                vsnprintf(buf + prefix_len, n + 1, fmt, args2);
+            }
+            else
+            {
+                buf = log_buf;
+                n = LOG_MSG_MAX - 1;
+            }
+        }
+        va_end(args2);
+        int len = prefix_len + n;
+        buf[len] = '\0';
+        if (msg)
+            msg->assign(buf + prefix_len, n);
+        if (newline)
+        {
+            buf[len++] = '\n';
+            buf[len] = '\0';
+        }
+        _emit(buf, len);
+        if (buf != log_buf)
+            free(buf);
+    }
+
     void set_log_level(LogLevel level, bool color)
     {
         log_level = level;
@@ -37,6 +384,87 @@ namespace maix::log
         return log_color;
     }
 
+    void set_async(bool enable, int queue_size)
+    {
+        std::lock_guard<std::mutex> lock(_out_lock);
+        static bool atexit_registered = false;
+        _async.store(false);
+        _writer_stop();
+        if (!enable)
+            return;
+        _writer_fd = eventfd(0, EFD_CLOEXEC);
+        if (_writer_fd < 0)
+        {
+            printf("-- [E] create log writer eventfd failed\n");
+            return;
+        }
+        _writer_exit.store(false);
+        _writer_waiting.store(false);
+        if (!_queue)
+            _queue = new _LogQueue(queue_size > 0 ? queue_size : 256);
+        _writer = new std::thread(_writer_loop);
+        _async.store(true, std::memory_order_release);
+        if (!atexit_registered)
+        {
+            // flush queued logs at program exit
+            atexit([]() { _writer_stop(); });
+            atexit_registered = true;
+        }
+    }
+
+    bool get_async()
+    {
+        return _async.load();
+    }
+
+    bool set_log_file(const std::string &path, int max_size, int max_files)
+    {
+        // let writer thread finish queued logs first, and pause it while switching file
+        bool async = _async.load();
+        if (async)
+        {
+            flush();
+            set_async(false);
+        }
+        bool ret = true;
+        {
+            std::lock_guard<std::mutex> lock(_out_lock);
+            if (_log_file)
+            {
+                fclose(_log_file);
+                _log_file = nullptr;
+            }
+            _log_file_path = path;
+            _log_file_max_size = max_size;
+            _log_file_max_files = max_files;
+            _log_file_size = 0;
+            if (!path.empty())
+            {
+                _log_file = fopen(path.c_str(), "a");
+                if (!_log_file)
+                {
+                    printf("-- [E] open log file %s failed\n", path.c_str());
+                    ret = false;
+                }
+                else
+                {
+                    fseek(_log_file, 0, SEEK_END);
+                    _log_file_size = ftell(_log_file);
+                }
+            }
+        }
+        if (async)
+            set_async(true);
+        return ret;
+    }
+
+    void set_rate_limit(int interval_ms)
+    {
+        std::lock_guard<std::mutex> lock(_rate_lock);
+        _rate_interval_ms = interval_ms;
+        memset(_rate_slots, 0, sizeof(_rate_slots));
+    }
+
     void error(const char *fmt, ...)
     {
         if(log_level < LogLevel::LEVEL_ERROR)
@@ -45,11 +473,10 @@ namespace maix::log
         // print error and call err::set_error
         va_list args;
         va_start(args, fmt);
-        printf("%s", err_start);
-        vsnprintf(log_buf, sizeof(log_buf), fmt, args);
-        printf("%s\n", log_buf);
+        std::string msg;
+        _vlog(err_start, fmt, args, true, &msg);
         va_end(args);
-        err::set_error(err_start + std::string(log_buf));
+        err::set_error(err_start + msg);
     }
 
     void error0(const char *fmt, ...)
@@ -60,11 +487,10 @@ namespace maix::log
         // print error and call err::set_error
         va_list args;
         va_start(args, fmt);
-        printf("%s", err_start);
-        vsnprintf(log_buf, sizeof(log_buf), fmt, args);
-        printf("%s", log_buf);
+        std::string msg;
+        _vlog(err_start, fmt, args, false, &msg);
         va_end(args);
-        err::set_error(err_start + std::string(log_buf));
+        err::set_error(err_start + msg);
     }
 
     void warn(const char *fmt, ...)
@@ -73,10 +499,8 @@ namespace maix::log
             return;
         va_list args;
         va_start(args, fmt);
-        printf("-- [W] ");
-        vprintf(fmt, args);
+        _vlog("-- [W] ", fmt, args, true);
         va_end(args);
-        printf("\n");
     }
 
     void warn0(const char *fmt, ...)
@@ -85,8 +509,7 @@ namespace maix::log
             return;
         va_list args;
         va_start(args, fmt);
-        printf("-- [W] ");
-        vprintf(fmt, args);
+        _vlog("-- [W] ", fmt, args, false);
         va_end(args);
     }
 
@@ -96,10 +519,8 @@ namespace maix::log
             return;
         va_list args;
         va_start(args, fmt);
-        printf("-- [I] ");
-        vprintf(fmt, args);
+        _vlog("-- [I] ", fmt, args, true);
         va_end(args);
-        printf("\n");
     }
 
     void info0(const char *fmt, ...)
@@ -108,8 +529,7 @@ namespace maix::log
             return;
         va_list args;
         va_start(args, fmt);
-        printf("-- [I] ");
-        vprintf(fmt, args);
+        _vlog("-- [I] ", fmt, args, false);
         va_end(args);
     }
 
@@ -120,10 +540,8 @@ namespace maix::log
             return;
         va_list args;
         va_start(args, fmt);
-        printf("-- [D] ");
-        vprintf(fmt, args);
+        _vlog("-- [D] ", fmt, args, true);
         va_end(args);
-        printf("\n");
 #else
         (void)fmt;
 #endif
@@ -136,8 +554,7 @@ namespace maix::log
             return;
         va_list args;
         va_start(args, fmt);
-        printf("-- [D] ");
-        vprintf(fmt, args);
+        _vlog("-- [D] ", fmt, args, false);
         va_end(args);
 #else
         (void)fmt;
@@ -149,7 +566,7 @@ namespace maix::log
         printf("[WARN] log::print(fmt, ...) function is deprecated, please use log::print(log::LogLevel, fmt, ...) instead\n");
         va_list args;
         va_start(args, fmt);
-        vprintf(fmt, args);
+        _vlog(nullptr, fmt, args, false);
         va_end(args);
     }
 
@@ -159,13 +576,27 @@ namespace maix::log
             return;
         va_list args;
         va_start(args, fmt);
-        vprintf(fmt, args);
+        _vlog(nullptr, fmt, args, false);
         va_end(args);
     }
 
     void flush(log::LogLevel level)
     {
+        (void)level;
+        if (_async.load())
+        {
+            // wait writer thread write all queued logs, max 1s
+            uint64_t target = _pushed.load();
+            uint64_t t = _ms();
+            while (_written.load(std::memory_order_acquire) < target && _ms() - t < 1000)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        std::lock_guard<std::mutex> lock(_out_lock);
         fflush(stdout);
+        if (_log_file)
+            fflush(_log_file);
     }
 
 } // namespace maix::log
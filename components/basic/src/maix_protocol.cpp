@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Use slice-by-8 CRC16 and non-moving decode buffer, add decode_view to reference body in data queue.
  */
 
 
@@ -13,21 +14,49 @@
 namespace maix::protocol
 {
     uint32_t HEADER = 0xBBACCAAA;
+
+    /**
+     * CRC16-IBM(reflected poly 0xA001) lookup tables for slice-by-8,
+     * table[0] is the classic byte table, table[k] is table[0] advanced k bytes.
+     */
+    struct _CRC16_Table
+    {
+        uint16_t t[8][256];
+        constexpr _CRC16_Table() : t()
+        {
+            for (int i = 0; i < 256; ++i)
+            {
+                uint16_t crc = i;
+                for (int j = 0; j < 8; ++j)
+                    crc = (crc & 1) ? ((crc >> 1) ^ 0xA001) : (crc >> 1);
+                t[0][i] = crc;
+            }
+            for (int k = 1; k < 8; ++k)
+            {
+                for (int i = 0; i < 256; ++i)
+                    t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFF];
+            }
+        }
+    };
+    static constexpr _CRC16_Table _crc16_table;
+
     uint16_t crc16_IBM(uint8_t *ptr, size_t len)
     {
-        unsigned int i;
+        const uint16_t (*t)[256] = _crc16_table.t;
         uint16_t crc = 0x0000;
 
+        while (len >= 8)
+        {
+            crc ^= ptr[0] | (ptr[1] << 8);
+            crc = t[7][crc & 0xFF] ^ t[6][crc >> 8] ^
+                  t[5][ptr[2]] ^ t[4][ptr[3]] ^ t[3][ptr[4]] ^
+                  t[2][ptr[5]] ^ t[1][ptr[6]] ^ t[0][ptr[7]];
+            ptr += 8;
+            len -= 8;
+        }
         while (len--)
         {
-            crc ^= *ptr++;
-            for (i = 0; i < 8; ++i)
-            {
-                if (crc & 1)
-                    crc = (crc >> 1) ^ 0xA001;
-                else
-                    crc = (crc >> 1);
-            }
+            crc = (crc >> 8) ^ t[0][(crc ^ *ptr++) & 0xFF];
         }
 
         return crc;
@@ -111,70 +140,111 @@ namespace maix::protocol
         return encode(buff, buff_len, cmd, FLAG_RESP | FLAG_RESP_ERR, (uint8_t *)msg.c_str(), msg.length(), code);
     }
 
-    bool get_msg(uint8_t *data, int len, MSG *frame, int *idx, const uint32_t header=HEADER)
+    /**
+     * Find header in data, compare first byte with memchr then the whole word.
+     * @return header position, -1 if not found.
+     */
+    static int _find_header(const uint8_t *data, int len, uint32_t header)
     {
-        size_t data_len = 0;
+        const uint8_t first = header & 0xFF;
+        const uint8_t *p = data;
+        const uint8_t *end = data + len - 3;
+        while (p < end)
+        {
+            p = (const uint8_t *)memchr(p, first, end - p);
+            if (!p)
+                return -1;
+            uint32_t word;
+            memcpy(&word, p, 4);
+            if (word == header) // header is little endian on wire
+                return p - data;
+            ++p;
+        }
+        return -1;
+    }
 
+    /**
+     * Find a complete frame in data.
+     * @param start frame start position, valid when return true.
+     * @param data_len frame's data length field(body + 4), valid when return true.
+     * @param idx bytes can be dropped from data.
+     * @param max_frame_len max frame length can be received, larger frame will be considered as invalid header, <= 0 means no limit.
+     * @return true if find a valid frame.
+     */
+    static bool _find_frame(const uint8_t *data, int len, uint32_t header, int max_frame_len, int *start, uint32_t *data_len, int *idx)
+    {
         *idx = 0;
-        if (len < 12)
-            return false;
-        // find header
-        uint32_t i = 0;
-        bool found = false;
-        for (; i < (uint32_t)len - 4; i++)
+        while (len - *idx >= 12)
         {
-            if (data[i] == (header & 0xFF) &&
-                data[i + 1] == ((header >> 8) & 0xFF) &&
-                data[i + 2] == ((header >> 16) & 0xFF) &&
-                data[i + 3] == ((header >> 24) & 0xFF))
+            int i = _find_header(data + *idx, len - *idx, header);
+            if (i < 0)
             {
-                found = true;
-                break;
+                // keep last 3 bytes, may be part of header
+                *idx = len - 3;
+                return false;
             }
-        }
-        // len >= 12
-        if (!found)
-        {
+            i += *idx;
             *idx = i;
-            return false;
+            if (len - i < 12)
+                return false;
+            // get data_len, and check data length
+            uint32_t n = data[i + 4] | (data[i + 5] << 8) | (data[i + 6] << 16) | ((uint32_t)data[i + 7] << 24);
+            if (n < 4 || (max_frame_len > 0 && n > (uint32_t)max_frame_len - 8))
+            {
+                // not a real header, search from next byte
+                *idx = i + 1;
+                continue;
+            }
+            if (n > (uint32_t)(len - i - 8))
+                return false;
+            *idx = i + 8 + n;
+            // check crc
+            uint16_t crc16 = crc16_IBM((uint8_t *)data + i, n + 6);
+            if (data[i + 6 + n] != (crc16 & 0xFF) || data[i + 7 + n] != (crc16 >> 8 & 0xFF))
+            {
+                return false;
+            }
+            *start = i;
+            *data_len = n;
+            return true;
         }
-        if (len - i < 12)
-            return false;
+        return false;
+    }
 
-        // get data_len, and check data length
-        data_len = data[i + 4] | (data[i + 5] << 8) | (data[i + 6] << 16) | (data[i + 7] << 24);
-        if (data_len > len - i - 8)
-            return false;
-        *idx = i + 8 + data_len;
-        // check crc
-        uint16_t crc16 = crc16_IBM(data + i, data_len + 6);
-        if (data[i + 6 + data_len] != (crc16 & 0xFF) || data[i + 7 + data_len] != (crc16 >> 8 & 0xFF))
-        {
-            return false;
-        }
-        // parse data
-        frame->version = data[i + 8] & FLAG_VERSION_MASK;
-        frame->is_resp = data[i + 8] & FLAG_IS_RESP_MASK;
+    static void _parse_frame(uint8_t *frame_data, uint32_t data_len, MSG *frame, bool body_view)
+    {
+        frame->version = frame_data[8] & FLAG_VERSION_MASK;
+        frame->is_resp = frame_data[8] & FLAG_IS_RESP_MASK;
         frame->is_req = !frame->is_resp;
-        frame->is_report = data[i + 8] & FLAG_REPORT_MASK;
-        frame->resp_ok = data[i + 8] & FLAG_RESP_OK_MASK;
-        frame->cmd = data[i + 9];
-        frame->set_body(data + i + 10, data_len - 4);
-        frame->body_len = data_len - 4;
+        frame->is_report = frame_data[8] & FLAG_REPORT_MASK;
+        frame->resp_ok = frame_data[8] & FLAG_RESP_OK_MASK;
+        frame->cmd = frame_data[9];
+        if (body_view)
+            frame->set_body_view(frame_data + 10, data_len - 4);
+        else
+            frame->set_body(frame_data + 10, data_len - 4);
+    }
+
+    bool get_msg(uint8_t *data, int len, MSG *frame, int *idx, const uint32_t header=HEADER)
+    {
+        int start = 0;
+        uint32_t data_len = 0;
+        if (!_find_frame(data, len, header, 0, &start, &data_len, idx))
+            return false;
+        _parse_frame(data + start, data_len, frame, false);
         return true;
     }
 
     std::tuple<MSG *, int> get_msg(uint8_t *data, int len)
     {
-        MSG *frame = new MSG();
+        int start = 0;
+        uint32_t data_len = 0;
         int idx = 0;
-        if (get_msg(data, len, frame, &idx))
-            return std::make_tuple(frame, idx);
-        else
-        {
-            delete frame;
+        if (!_find_frame(data, len, HEADER, 0, &start, &data_len, &idx))
             return std::make_tuple(nullptr, idx);
-        }
+        MSG *frame = new MSG();
+        _parse_frame(data + start, data_len, frame, false);
+        return std::make_tuple(frame, idx);
     }
 
     MSG::MSG()
@@ -188,11 +258,12 @@ namespace maix::protocol
         body = nullptr;
         body_len = 0;
         _body_buff_len = 0;
+        _body_view = false;
     }
 
     MSG::~MSG()
     {
-        if (body)
+        if (body && !_body_view)
         {
             delete[] body;
         }
@@ -256,6 +327,12 @@ namespace maix::protocol
 
     void MSG::set_body(uint8_t *body_new, int body_len)
     {
+        if (_body_view)
+        {
+            body = nullptr;
+            _body_buff_len = 0;
+            _body_view = false;
+        }
         if ((body && _body_buff_len < body_len))
         {
             delete[] body;
@@ -271,6 +348,18 @@ namespace maix::protocol
         this->body_len = body_len;
     }
 
+    void MSG::set_body_view(uint8_t *body_ref, int body_len)
+    {
+        if (body && !_body_view)
+        {
+            delete[] body;
+        }
+        body = body_ref;
+        _body_buff_len = 0;
+        _body_view = true;
+        this->body_len = body_len;
+    }
+
     int Protocol::encode_resp_ok(uint8_t *buff, int buff_len, uint8_t cmd, uint8_t *body, int body_len)
     {
         return protocol::encode_resp_ok(buff, buff_len, cmd, body, body_len);
@@ -323,6 +412,7 @@ namespace maix::protocol
     {
         _buff_size = buff_size;
         _buff = new uint8_t[buff_size];
+        _data_start = 0;
         _data_len = 0;
         _header = header;
         HEADER = header;
@@ -337,42 +427,60 @@ namespace maix::protocol
     {
         if (_data_len + len > _buff_size)
             return err::ERR_BUFF_FULL;
-        memcpy(_buff + _data_len, new_data, len);
+        // only move the remaining partial frame to buffer head when tail space not enough,
+        // so every frame is continuous in buffer and can be referenced by MSG directly.
+        if (_data_start + _data_len + len > _buff_size)
+        {
+            memmove(_buff, _buff + _data_start, _data_len);
+            _data_start = 0;
+        }
+        memcpy(_buff + _data_start + _data_len, new_data, len);
         _data_len += len;
         return err::ERR_NONE;
     }
 
     err::Err Protocol::push_data(const Bytes *new_data)
     {
-        return push_data((uint8_t *)&new_data[0], new_data->size());
+        return push_data(new_data->data, new_data->size());
     }
 
     MSG *Protocol::decode(uint8_t *new_data, size_t len)
+    {
+        return _decode(new_data, len, false);
+    }
+
+    MSG *Protocol::decode_view(uint8_t *new_data, size_t len)
+    {
+        return _decode(new_data, len, true);
+    }
+
+    MSG *Protocol::_decode(uint8_t *new_data, size_t len, bool body_view)
     {
         if (len > 0)
         {
             push_data(new_data, len);
         }
-        MSG *frame = new MSG();
+        int start = 0;
+        uint32_t data_len = 0;
         int idx = 0;
-        if (get_msg(_buff, _data_len, frame, &idx, _header))
-        {
-            memmove(_buff, _buff + idx, _data_len - idx);
-            _data_len -= idx;
-            return frame;
-        }
-        if (idx > 0)
-        {
-            memmove(_buff, _buff + idx, _data_len - idx);
-            _data_len -= idx;
-        }
-        delete frame;
-        return nullptr;
+        uint8_t *data = _buff + _data_start;
+        bool found = _find_frame(data, _data_len, _header, _buff_size, &start, &data_len, &idx);
+        _data_start += idx;
+        _data_len -= idx;
+        if (_data_len == 0)
+            _data_start = 0;
+        if (!found)
+            return nullptr;
+        MSG *frame = new MSG();
+        _parse_frame(data + start, data_len, frame, body_view);
+        return frame;
     }
 
     MSG *Protocol::decode(const Bytes *new_data)
     {
-        return decode((uint8_t *)&new_data[0], new_data->size());
+        if (!new_data)
+            return decode(nullptr, 0);
+        return decode(new_data->data, new_data->size());
     }
 
 } // namespace maix::protocol
@@ -15,6 +15,8 @@
 #include "maix_err.hpp"
 #include "maix_protocol.hpp"
 #include "maix_comm_base.hpp"
+#include <functional>
+#include <mutex>
 
 namespace maix
 {
@@ -44,6 +46,22 @@ namespace maix
          */
         bool rm_default_comm_listener();
 
+        class CommProtocol;
+
+        /**
+         * @brief Set app custom CMD handler for default CommProtocol listener.
+         *
+         * Handlers run in default listener's worker thread one by one in message received order,
+         * so slow handler will not block receiving, handler should reply by p.resp_ok() or p.resp_err() itself.
+         * CMD without handler will be replied with error "Unsupport CMD".
+         *
+         * @param cmd CMD value, should < maix.protocol.CMD_APP_MAX.
+         * @param handler handler function, msg is deleted after handler return, set to nullptr to remove handler.
+         * @return err::ERR_NONE if success, err::ERR_ARGS if cmd not valid.
+         * @maixcdk maix.comm.set_default_comm_handler
+         */
+        err::Err set_default_comm_handler(uint8_t cmd, std::function<void(CommProtocol &p, protocol::MSG &msg)> handler);
+
         /**
          * Class for communication protocol
          * @maixpy maix.comm.CommProtocol
@@ -73,6 +91,13 @@ namespace maix
              */
             protocol::MSG *get_msg(int timeout = 0);
 
+            /**
+             * Wake up get_msg which is blocking wait data, get_msg will return nullptr immediately if no msg.
+             * Can be called from other thread, e.g. to exit receive thread.
+             * @maixcdk maix.comm.CommProtocol.wakeup
+             */
+            void wakeup();
+
             /**
              * Send response ok(success) message
              * @param buff output buffer
@@ -201,6 +226,9 @@ namespace maix
 
         private:
             void execute_cmd(protocol::MSG* msg);
+            int _write(const uint8_t *buff, int len);
+            void _read_available();
+            bool _wait_readable(int timeout);
 
         private:
             protocol::Protocol *_p;
@@ -210,6 +238,9 @@ namespace maix
             uint8_t  *_tmp_buff;
             int       _tmp_buff_len;
             bool      _valid;
+            int       _epoll_fd;
+            int       _wakeup_fd;
+            std::mutex _write_mutex;
         };
     } // namespace comm
 } // namespace maix
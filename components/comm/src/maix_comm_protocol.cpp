@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Wait data with epoll, default listener dispatch app CMD to handlers in worker thread.
  */
 
 #include <string.h>
@@ -31,6 +32,12 @@ using namespace maix::peripheral;
 #include <thread>
 #include <unordered_set>
 #include <climits>
+#include <deque>
+#include <map>
+#include <condition_variable>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
 #include "maix_fs.hpp"
 
 namespace maix::comm
@@ -40,6 +47,16 @@ namespace maix::comm
     static volatile bool _comm_loop_need_exit = false;
     static volatile bool _comm_loop_exit = true;
 
+    // default listener app CMD handlers and worker thread,
+    // only one worker so handlers run in message received order.
+    static std::mutex _comm_handlers_lock;
+    static std::map<uint8_t, std::function<void(CommProtocol &p, protocol::MSG &msg)>> _comm_handlers;
+    static std::mutex _comm_jobs_lock;
+    static std::condition_variable _comm_jobs_cond;
+    static std::deque<protocol::MSG *> _comm_jobs;
+    static std::thread *_comm_worker_th = nullptr;
+    static bool _comm_worker_exit = false;
+
     static void _cancel_comm_uart(uart::UART *obj)
     {
         if(_comm_protocol && obj)
@@ -193,6 +210,8 @@ namespace maix::comm
         _p = new protocol::Protocol(buff_size, header);
         _comm_method = CommProtocol::get_method();
         _valid = false;
+        _epoll_fd = -1;
+        _wakeup_fd = -1;
         err::Err e;
         _comm = _get_comm_obj(_comm_method, e);
         if (!_comm)
@@ -216,6 +235,31 @@ namespace maix::comm
             throw err::Exception(err::ERR_RUNTIME, msg);
         }
         _valid = true;
+
+        // wait data with epoll, and eventfd to wake up waiting.
+        // if comm obj not provide fd, fallback to read with timeout.
+        int fd = _comm->fd();
+        if (fd >= 0)
+        {
+            _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+            _wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            struct epoll_event ev = {};
+            ev.events = EPOLLIN;
+            ev.data.fd = fd;
+            bool ok = _epoll_fd >= 0 && _wakeup_fd >= 0 && epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &ev) == 0;
+            ev.data.fd = _wakeup_fd;
+            ok = ok && epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _wakeup_fd, &ev) == 0;
+            if (!ok)
+            {
+                log::warn("[Maix Comm Protocol] init epoll failed: %s, use polling", strerror(errno));
+                if (_epoll_fd >= 0)
+                    ::close(_epoll_fd);
+                if (_wakeup_fd >= 0)
+                    ::close(_wakeup_fd);
+                _epoll_fd = -1;
+                _wakeup_fd = -1;
+            }
+        }
     }
 
     CommProtocol::~CommProtocol()
@@ -231,6 +275,21 @@ namespace maix::comm
             delete _tmp_buff;
             _tmp_buff = nullptr;
         }
+        if (_epoll_fd >= 0)
+        {
+            ::close(_epoll_fd);
+            _epoll_fd = -1;
+        }
+        if (_wakeup_fd >= 0)
+        {
+            ::close(_wakeup_fd);
+            _wakeup_fd = -1;
+        }
+        if (_p)
+        {
+            delete _p;
+            _p = nullptr;
+        }
     }
 
     err::Err CommProtocol::set_method(const std::string &method)
@@ -604,35 +663,137 @@ namespace maix::comm
         // log::info("[%s:%d] Finish...", __PRETTY_FUNCTION__, __LINE__);
     }
 
-    protocol::MSG *CommProtocol::get_msg(int timeout)
+    int CommProtocol::_write(const uint8_t *buff, int len)
     {
-        protocol::MSG *msg = nullptr;
-        if(!_valid)
-            return msg;
-        uint64_t t = time::ticks_ms();
+        // handlers may reply in different threads, keep frames not interleaved
+        std::lock_guard<std::mutex> lock(_write_mutex);
+        return _comm->write(buff, len);
+    }
+
+    void CommProtocol::_read_available()
+    {
+        int fd = _epoll_fd >= 0 ? _comm->fd() : -1;
         while (1)
         {
-            int rx_len = 0;
-            while (1)
+            int rx_len;
+            if (fd >= 0)
             {
-                rx_len = _comm->read(_tmp_buff, _tmp_buff_len, -1, timeout);
-                if (rx_len == 0)
-                {
+                // only take bytes already received, comm read may still wait an idle gap even if timeout is 0
+                int available = 0;
+                if (ioctl(fd, FIONREAD, &available) < 0 || available <= 0)
                     break;
-                }
-                else if (rx_len < 0)
+                rx_len = ::read(fd, _tmp_buff, available < _tmp_buff_len ? available : _tmp_buff_len);
+                if (rx_len < 0)
                 {
-                    log::error("read error: %d, %s\n", -rx_len, err::to_str((err::Err)-rx_len).c_str());
-                    time::sleep_ms(10);
-                    break;
+                    if (errno == EAGAIN || errno == EINTR)
+                        break;
+                    rx_len = -err::ERR_IO;
                 }
+            }
+            else
+            {
+                rx_len = _comm->read(_tmp_buff, _tmp_buff_len, -1, 0);
+            }
+            if (rx_len == 0)
+            {
+                break;
+            }
+            else if (rx_len < 0)
+            {
+                log::error("read error: %d, %s\n", -rx_len, err::to_str((err::Err)-rx_len).c_str());
+                time::sleep_ms(10);
+                break;
+            }
+            if (_p->push_data(_tmp_buff, rx_len) != err::ERR_NONE)
+            {
+                log::warn("[Maix Comm Protocol] buffer full, drop %d bytes", rx_len);
+                break;
+            }
+            if (rx_len < _tmp_buff_len)
+                break;
+        }
+    }
+
+    bool CommProtocol::_wait_readable(int timeout)
+    {
+        if (_epoll_fd < 0)
+        {
+            // no fd, read with timeout directly
+            int rx_len = _comm->read(_tmp_buff, _tmp_buff_len, -1, timeout);
+            if (rx_len < 0)
+            {
+                log::error("read error: %d, %s\n", -rx_len, err::to_str((err::Err)-rx_len).c_str());
+                time::sleep_ms(10);
+                return false;
+            }
+            if (rx_len > 0)
                 _p->push_data(_tmp_buff, rx_len);
+            return rx_len > 0;
+        }
+        struct epoll_event events[2];
+        int n = epoll_wait(_epoll_fd, events, 2, timeout);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                return true;
+            log::error("[Maix Comm Protocol] epoll wait failed: %s", strerror(errno));
+            time::sleep_ms(10);
+            return false;
+        }
+        bool readable = false;
+        for (int i = 0; i < n; ++i)
+        {
+            if (events[i].data.fd == _wakeup_fd)
+            {
+                uint64_t v;
+                if (::read(_wakeup_fd, &v, sizeof(v)) < 0)
+                {
+                    // already cleared by other waiter
+                }
+                return false;
             }
+            readable = true;
+        }
+        return readable;
+    }
+
+    void CommProtocol::wakeup()
+    {
+        if (_wakeup_fd < 0)
+            return;
+        uint64_t v = 1;
+        if (::write(_wakeup_fd, &v, sizeof(v)) < 0)
+        {
+            log::warn("[Maix Comm Protocol] wakeup failed: %s", strerror(errno));
+        }
+    }
+
+    protocol::MSG *CommProtocol::get_msg(int timeout)
+    {
+        protocol::MSG *msg = nullptr;
+        if(!_valid)
+            return msg;
+        uint64_t t = time::ticks_ms();
+        while (1)
+        {
+            // decode data already received first, then wait new data, decode as soon as data arrive.
+            _read_available();
             msg = _p->decode(nullptr, 0);
             if (msg || timeout == 0)
                 break;
-            if (timeout > 0 && (time::ticks_ms() - t > (uint64_t)timeout))
+            int wait_ms = -1;
+            if (timeout > 0)
+            {
+                uint64_t elapsed = time::ticks_ms() - t;
+                if (elapsed >= (uint64_t)timeout)
+                    break;
+                wait_ms = timeout - (int)elapsed;
+            }
+            if (!_wait_readable(wait_ms))
+            {
+                msg = _p->decode(nullptr, 0);
                 break;
+            }
         }
         if (msg)
             this->execute_cmd(msg);
@@ -648,7 +809,7 @@ namespace maix::comm
         {
             return (err::Err)-len;
         }
-        len = _comm->write(buff, len);
+        len = _write(buff, len);
         if (len < 0)
         {
             return (err::Err)-len;
@@ -665,7 +826,7 @@ namespace maix::comm
         {
             return err::ERR_RUNTIME;
         }
-        int len = _comm->write(buff->data, buff->size());
+        int len = _write(buff->data, buff->size());
         delete buff;
         if (len < 0)
         {
@@ -683,7 +844,7 @@ namespace maix::comm
         {
             return err::ERR_RUNTIME;
         }
-        int len = _comm->write(buff->data, buff->size());
+        int len = _write(buff->data, buff->size());
         delete buff;
         if (len < 0)
         {
@@ -701,7 +862,7 @@ namespace maix::comm
         {
             return (err::Err)-len;
         }
-        len = _comm->write(buff, len);
+        len = _write(buff, len);
         if (len < 0)
         {
             return (err::Err)-len;
@@ -718,7 +879,7 @@ namespace maix::comm
         {
             return err::ERR_RUNTIME;
         }
-        int len = _comm->write(buff->data, buff->size());
+        int len = _write(buff->data, buff->size());
         delete buff;
         if (len < 0)
         {
@@ -736,7 +897,7 @@ namespace maix::comm
         {
             return err::ERR_RUNTIME;
         }
-        int len = _comm->write(buff->data, buff->size());
+        int len = _write(buff->data, buff->size());
         delete buff;
         if (len < 0)
         {
@@ -754,7 +915,7 @@ namespace maix::comm
         {
             return (err::Err)-len;
         }
-        len = _comm->write(buff, len);
+        len = _write(buff, len);
         if (len < 0)
         {
             return (err::Err)-len;
@@ -771,7 +932,7 @@ namespace maix::comm
         {
             return err::ERR_RUNTIME;
         }
-        int len = _comm->write(buff->data, buff->size());
+        int len = _write(buff->data, buff->size());
         delete buff;
         if (len < 0)
         {
@@ -780,20 +941,75 @@ namespace maix::comm
         return err::ERR_NONE;
     }
 
+    static void _comm_worker()
+    {
+        while (1)
+        {
+            protocol::MSG *msg = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(_comm_jobs_lock);
+                _comm_jobs_cond.wait(lock, []() { return _comm_worker_exit || !_comm_jobs.empty(); });
+                if (_comm_worker_exit)
+                    break;
+                msg = _comm_jobs.front();
+                _comm_jobs.pop_front();
+            }
+            std::function<void(CommProtocol &p, protocol::MSG &msg)> handler;
+            {
+                std::lock_guard<std::mutex> lock(_comm_handlers_lock);
+                auto it = _comm_handlers.find(msg->cmd);
+                if (it != _comm_handlers.end())
+                    handler = it->second;
+            }
+            try
+            {
+                if (handler)
+                    handler(*_comm_protocol, *msg);
+                else
+                    _comm_protocol->resp_err(msg->cmd, err::Err::ERR_ARGS, "Unsupport CMD");
+            }
+            catch (const std::exception &e)
+            {
+                maix::log::error("[Default CommListener] handler of cmd %d error: %s", msg->cmd, e.what());
+            }
+            delete msg;
+        }
+    }
+
+    static void _comm_worker_start()
+    {
+        _comm_worker_exit = false;
+        _comm_worker_th = new std::thread(_comm_worker);
+    }
+
+    static void _comm_worker_stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_comm_jobs_lock);
+            _comm_worker_exit = true;
+        }
+        _comm_jobs_cond.notify_all();
+        if (_comm_worker_th)
+        {
+            _comm_worker_th->join();
+            delete _comm_worker_th;
+            _comm_worker_th = nullptr;
+        }
+        for (auto msg : _comm_jobs)
+        {
+            delete msg;
+        }
+        _comm_jobs.clear();
+    }
+
     void _comm_loop()
     {
-        int timeout = 50; // 50 ms for fast exit at program start if user want comm to exit. after 3s, timeout will be 500ms to reduce cpu usage.
-        uint64_t _t0 = time::ticks_ms();
-        bool flag = false;
+        // get_msg return as soon as frame received, timeout only for checking app exit.
+        int timeout = 500;
         while (!maix::app::need_exit() && !_comm_loop_need_exit)
         {
             try
             {
-                if(!flag && (time::ticks_ms() - _t0) > 3000)
-                {
-                    flag = true;
-                    timeout = 500;
-                }
                 auto msg = _comm_protocol->get_msg(timeout);
                 if (!msg)
                     continue;
@@ -802,8 +1018,22 @@ namespace maix::comm
                     delete msg;
                     continue;
                 }
-                _comm_protocol->resp_err(msg->cmd, err::Err::ERR_ARGS, "Unsupport CMD");
-                delete msg;
+                bool has_handler;
+                {
+                    std::lock_guard<std::mutex> lock(_comm_handlers_lock);
+                    has_handler = _comm_handlers.find(msg->cmd) != _comm_handlers.end();
+                }
+                if (!has_handler)
+                {
+                    _comm_protocol->resp_err(msg->cmd, err::Err::ERR_ARGS, "Unsupport CMD");
+                    delete msg;
+                    continue;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(_comm_jobs_lock);
+                    _comm_jobs.push_back(msg);
+                }
+                _comm_jobs_cond.notify_one();
             }
             catch (const std::exception &e)
             {
@@ -815,6 +1045,21 @@ namespace maix::comm
         _comm_loop_exit = true;
     }
 
+    err::Err set_default_comm_handler(uint8_t cmd, std::function<void(CommProtocol &p, protocol::MSG &msg)> handler)
+    {
+        if (cmd >= protocol::CMD_APP_MAX)
+        {
+            log::error("[Maix Comm Protocol] cmd %d not app custom cmd", cmd);
+            return err::ERR_ARGS;
+        }
+        std::lock_guard<std::mutex> lock(_comm_handlers_lock);
+        if (handler)
+            _comm_handlers[cmd] = handler;
+        else
+            _comm_handlers.erase(cmd);
+        return err::ERR_NONE;
+    }
+
     void add_default_comm_listener()
     {
         if(!_comm_protocol)
@@ -824,6 +1069,7 @@ namespace maix::comm
             _comm_loop_need_exit = false;
             if(_comm_protocol->valid())
             {
+                _comm_worker_start();
                 _comm_th = new std::thread([]()
                 {
                     _comm_loop();
@@ -842,6 +1088,7 @@ namespace maix::comm
         {
             log::info("[Maix Comm Protocol] exit...");
             _comm_loop_need_exit = true;
+            _comm_protocol->wakeup();
             while(!_comm_loop_exit)
             {
                 time::sleep_ms(10);
@@ -852,6 +1099,7 @@ namespace maix::comm
                 delete _comm_th;
                 _comm_th = nullptr;
             }
+            _comm_worker_stop();
             delete _comm_protocol;
             _comm_protocol = nullptr;
         }
@@ -3,10 +3,12 @@
  * @copyright Sipeed Ltd 2024-
  * @license Apache 2.0
  * @update 2024.8.6: Add framework, create this file.
+ * @update 2026.10.18: Add FIFO batched acquisition, binary log and batched AHRS update.
  */
 
 #pragma once
 #include "maix_basic.hpp"
+#include "maix_ahrs_mahony.hpp"
 
 #include <atomic>
 #include <future>
@@ -134,6 +136,12 @@ public:
       * @maixpy maix.ext_dev.imu.IMUData.temp
      */
     float temp;
+
+    /**
+      * sample timestamp, unit is us, the same clock as time::ticks_us, only valid for samples read by IMU.read_fifo, else 0.
+      * @maixpy maix.ext_dev.imu.IMUData.timestamp
+     */
+    uint64_t timestamp = 0;
 };
 
 /**
@@ -296,16 +304,74 @@ public:
     */
     std::vector<double> get_calibration();
 
+    /**
+      * Start FIFO batched acquisition, a background thread drains the hardware FIFO by one I2C burst every interval_ms,
+      * samples are timestamped and pushed to a ring buffer, read them by read_fifo.
+      * Timestamps are fitted from drain time and sample count by least squares, no scheduling jitter and follow the real output data rate.
+      * Only support qmi8658 and lsm6dsowtr, read() and read_all() still work when FIFO started.
+      * @param buffer_size ring buffer size, unit is sample, the oldest samples are dropped when full.
+      * @param interval_ms drain interval, hardware FIFO must not be full in this time, 10ms is enough for 1kHz output data rate.
+      * @return err::ERR_NONE if success, else error code.
+      * @maixpy maix.ext_dev.imu.IMU.fifo_start
+     */
+    err::Err fifo_start(int buffer_size = 4096, int interval_ms = 10);
+
+    /**
+      * Stop FIFO batched acquisition, samples not read are discarded.
+      * @return err::ERR_NONE if success, else error code.
+      * @maixpy maix.ext_dev.imu.IMU.fifo_stop
+     */
+    err::Err fifo_stop();
+
+    /**
+      * FIFO batched acquisition started or not
+      * @maixpy maix.ext_dev.imu.IMU.fifo_running
+     */
+    bool fifo_running();
+
+    /**
+      * Read samples of FIFO batched acquisition in order, every sample has timestamp.
+      * @param max_num max samples number to read, -1 means all samples in buffer.
+      * @param timeout_ms wait time when no sample, 0 means not wait, -1 means wait forever.
+      * @param calib_gryo calibrate gyro data based on calib_gyro_data, the same as read_all.
+      * @param radian gyro unit use rad/s instead of degree/s, default false(use degree/s).
+      * @return samples list, empty if no sample or FIFO not started.
+      * @maixpy maix.ext_dev.imu.IMU.read_fifo
+     */
+    std::vector<ext_dev::imu::IMUData> read_fifo(int max_num = -1, int timeout_ms = 0, bool calib_gryo = true, bool radian = false);
+
+    /**
+      * Samples dropped since fifo_start, by hardware FIFO overflow(estimated from timestamps) or ring buffer full.
+      * @maixpy maix.ext_dev.imu.IMU.fifo_dropped
+     */
+    uint64_t fifo_dropped();
+
 public:
     tensor::Vector3f calib_gyro_data;
 
 private:
     void* _param;
+    void* _fifo = nullptr;
     std::string _driver;
     imu::Mode _mode;
     bool _calib_gyro_loaded;
+
+    void _fifo_run(void *fifo);
 };
 
+/**
+ * Update MahonyAHRS by samples in order, dt of every sample is calculated from sample timestamps,
+ * for samples read by IMU.read_fifo.
+ * @param ahrs MahonyAHRS object.
+ * @param samples samples with timestamp, gyro unit is degree/s, or rad/s if radian is true.
+ * @param last_timestamp timestamp of the last sample of previous batch, unit is us,
+ *                       0 means no previous batch, the first sample only initializes or uses interval of the first two samples.
+ * @param radian gyro unit of samples and returned angle use radian instead of degree.
+ * @return angle after the last sample, maix.vector.Vector3f type, all 0 if samples is empty.
+ * @maixpy maix.ext_dev.imu.ahrs_update
+ */
+tensor::Vector3f ahrs_update(ahrs::MahonyAHRS &ahrs, const std::vector<ext_dev::imu::IMUData> &samples, uint64_t last_timestamp = 0, bool radian = false);
+
 typedef struct {
     char version[16];
     char id[256];
@@ -488,10 +554,107 @@ public:
         _gcsv_write(&_handle, &info);
         return err::ERR_NONE;
     }
+
+    /**
+     * @brief Write samples read by IMU.read_fifo to gcsv file, all lines are formatted to one buffer and written once.
+     * @param samples samples with timestamp, timestamp unit is us and converted by tscale, gyro and acc are divided by gscale and ascale.
+     * @return error code
+     * @maixpy maix.ext_dev.imu.Gcsv.write_batch
+     */
+    err::Err write_batch(const std::vector<ext_dev::imu::IMUData> &samples) {
+        if (!_is_opened || !_handle.f) {
+            return err::ERR_NOT_OPEN;
+        }
+        std::string buf;
+        buf.reserve(samples.size() * 64);
+        char line[128];
+        for (const auto &s : samples) {
+            int n = snprintf(line, sizeof(line), "%lu,%d,%d,%d,%d,%d,%d\n",
+                (unsigned long)(s.timestamp * 1e-6 / _header.tscale),
+                (int)(s.gyro.x / _header.gscale), (int)(s.gyro.y / _header.gscale), (int)(s.gyro.z / _header.gscale),
+                (int)(s.acc.x / _header.ascale), (int)(s.acc.y / _header.ascale), (int)(s.acc.z / _header.ascale));
+            buf.append(line, n);
+        }
+        if (fwrite(buf.data(), 1, buf.size(), _handle.f) != buf.size()) {
+            return err::ERR_IO;
+        }
+        return err::ERR_NONE;
+    }
 private:
     gcsv_handle_t _handle;
     gcsv_header_t _header;
     bool _is_opened;
 };
 
-}
\ No newline at end of file
+/**
+ * IMU binary log, samples read by IMU.read_fifo are written as fixed size little endian records by one fwrite every batch,
+ * much cheaper than formatting text when record at high output data rate, convert to gcsv later by to_gcsv.
+ * File format: 32 bytes header("MAIXIMU" and version, record size), records of
+ * [uint64 timestamp(us), float acc_x, acc_y, acc_z, float gyro_x, gyro_y, gyro_z], values are stored as read.
+ * @maixpy maix.ext_dev.imu.IMUBinLog
+ */
+class IMUBinLog {
+public:
+    /**
+     * @brief Construct a new IMUBinLog object
+     * @maixpy maix.ext_dev.imu.IMUBinLog.__init__
+     */
+    IMUBinLog();
+    ~IMUBinLog();
+
+    /**
+     * @brief Open a file for write, file is truncated.
+     * @param path the path where data will be saved
+     * @return error code
+     * @maixpy maix.ext_dev.imu.IMUBinLog.open
+     */
+    err::Err open(const std::string &path);
+
+    /**
+     * @brief Close file
+     * @return error code
+     * @maixpy maix.ext_dev.imu.IMUBinLog.close
+     */
+    err::Err close();
+
+    /**
+     * @brief Check if the object is already open
+     * @maixpy maix.ext_dev.imu.IMUBinLog.is_opened
+     */
+    bool is_opened();
+
+    /**
+     * @brief Write samples
+     * @param samples samples read by IMU.read_fifo.
+     * @return error code
+     * @maixpy maix.ext_dev.imu.IMUBinLog.write
+     */
+    err::Err write(const std::vector<ext_dev::imu::IMUData> &samples);
+
+    /**
+     * @brief Read samples from binary log file, for C++ and convert.
+     * @param path binary log file path.
+     * @param samples read samples are appended.
+     * @return error code
+     * @maixcdk maix.ext_dev.imu.IMUBinLog.read
+     */
+    static err::Err read(const std::string &path, std::vector<ext_dev::imu::IMUData> &samples);
+
+    /**
+     * @brief Convert binary log to gcsv file for gyroflow
+     * @param path binary log file path.
+     * @param gcsv_path gcsv file path.
+     * @param tscale time scale, the same as Gcsv.open.
+     * @param gscale gyroscope scale factor, the same as Gcsv.open.
+     * @param ascale accelerometer scale factor, the same as Gcsv.open.
+     * @param orientation sensor orientation, default is "YxZ"
+     * @return error code
+     * @maixpy maix.ext_dev.imu.IMUBinLog.to_gcsv
+     */
+    static err::Err to_gcsv(const std::string &path, const std::string &gcsv_path, double tscale = 0.001, double gscale = 1, double ascale = 1, const std::string &orientation = "YxZ");
+
+private:
+    FILE *_f;
+};
+
+}
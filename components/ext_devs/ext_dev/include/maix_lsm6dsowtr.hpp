@@ -22,9 +22,34 @@ public:
 
     std::vector<float> read();
 
+    /**
+     * Enable or disable FIFO, acc and gyro samples are batched in FIFO by their output data rate.
+     * @return err::ERR_NONE if success, else error code.
+     * @maixcdk maix.ext_dev.lsm6dsowtr.LSM6DSOWTR.fifo_enable
+     */
+    err::Err fifo_enable(bool enable);
+
+    /**
+     * Read all samples in FIFO by one I2C burst.
+     * @param out samples are appended, 6 floats per sample, [acc_x, acc_y, acc_z, gyro_x, gyro_y, gyro_z], unit is the same as read().
+     * @param overflow set to true if FIFO overflowed and samples lost, can be nullptr.
+     * @return samples number read, < 0 means error.
+     * @maixcdk maix.ext_dev.lsm6dsowtr.LSM6DSOWTR.read_fifo
+     */
+    int read_fifo(std::vector<float> &out, bool *overflow = nullptr);
+
+    /**
+     * FIFO sample rate, gyro output data rate, or acc output data rate in ACC_ONLY mode, unit is Hz.
+     * @maixcdk maix.ext_dev.lsm6dsowtr.LSM6DSOWTR.odr
+     */
+    float odr();
+
 private:
     void* _data = nullptr;  // points to priv::Lsm6dsowI2C
     imu::Mode _mode;
+    float _fifo_acc[3] = {0};   // latest FIFO values, kept between reads
+    float _fifo_gyro[3] = {0};
+    bool _fifo_acc_valid = false;
     std::future<std::pair<int, std::string>> open_future;
     bool open_fut_need_get = false;
 };
@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2024-
  * @license Apache 2.0
  * @update 2024.8.6: Add framework, create this file.
+ * @update 2026.10.18: Add FIFO burst read.
  */
 
 #pragma once
@@ -57,9 +58,41 @@ public:
      * @maixpy maix.ext_dev.qmi8658.QMI8658.read
      */
     std::vector<float> read();
+
+    /**
+     * @brief Enable or disable FIFO, acc and gyro samples are batched in FIFO by output data rate.
+     *
+     * @param enable true to enable stream mode FIFO, false to bypass FIFO.
+     * @return err::ERR_NONE if success, else error code.
+     *
+     * @maixcdk maix.ext_dev.qmi8658.QMI8658.fifo_enable
+     */
+    err::Err fifo_enable(bool enable);
+
+    /**
+     * @brief Read all samples in FIFO by one I2C burst.
+     *
+     * @param out samples are appended, 6 floats per sample, [acc_x, acc_y, acc_z, gyro_x, gyro_y, gyro_z], unit is the same as read(),
+     *            values of sensor not enabled by mode are 0.
+     * @param overflow set to true if FIFO overflowed and samples lost, can be nullptr.
+     * @return samples number read, < 0 means error.
+     *
+     * @maixcdk maix.ext_dev.qmi8658.QMI8658.read_fifo
+     */
+    int read_fifo(std::vector<float> &out, bool *overflow = nullptr);
+
+    /**
+     * @brief FIFO sample rate, the nominal value of gyro output data rate in 6DOF mode.
+     *
+     * @return sample rate, unit is Hz.
+     *
+     * @maixcdk maix.ext_dev.qmi8658.QMI8658.odr
+     */
+    float odr();
 private:
     void* _data;
     imu::Mode _mode;
+    float _odr{0};
     std::atomic_bool reset_finished{false};
     std::future<std::pair<int, std::string>> open_future;
     bool open_fut_need_get{false};
@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2024-
  * @license Apache 2.0
  * @update 2024.10.28: Add framework, create this file.
+ * @update 2026.10.18: Read registers to buffer by one ioctl, merge multi registers access to one transaction.
  */
 
 #include "maix_i2c.hpp"
@@ -26,37 +27,32 @@ static uint8_t dev_addr{0};
 
 static err::Err maix_i2c_read(uint8_t address, uint8_t reg, uint8_t *buffer, uint16_t size)
 {
-    ::maix::Bytes* res = nullptr;
-
+    int res;
     {
         std::lock_guard<std::recursive_mutex> lock(mtx);
-        i2cdev->writeto((int)address, &reg, 1);
-        res = i2cdev->readfrom((int)address, (int)size);
+        res = i2cdev->readfrom_mem((int)address, reg, buffer, (int)size);
     }
-
-    if (res == nullptr) return err::Err::ERR_READ;
-
-    std::copy(res->data, res->data+res->data_len, buffer);
-
-    delete res;
+    if (res < 0) return err::Err::ERR_READ;
     return err::Err::ERR_NONE;
 }
 
 static err::Err maix_i2c_write(uint8_t address, uint8_t reg, const uint8_t *buffer, uint16_t size)
 {
-    auto buff = new uint8_t[size+1];
-    buff[0] = reg;
-    std::copy(buffer, buffer+size, buff+1);
-
+    int res;
     {
         std::lock_guard<std::recursive_mutex> lock(mtx);
-        i2cdev->writeto((int)address, buff, size+1);
+        res = i2cdev->writeto_mem((int)address, reg, buffer, (int)size);
     }
-
-    delete[] buff;
+    if (res < 0) return err::Err::ERR_WRITE;
     return err::Err::ERR_NONE;
 }
 
+static err::Err maix_i2c_transfer(::maix::peripheral::i2c::Transaction &t)
+{
+    std::lock_guard<std::recursive_mutex> lock(mtx);
+    return i2cdev->transfer(t);
+}
+
 static void maix_i2c_init(int bus, uint8_t addr)
 {
     if (i2cdev) {
@@ -266,19 +262,14 @@ ext_dev::axp2101::ChargerStatus AXP2101::get_charger_status()
 uint16_t AXP2101::get_bat_vol()
 {
     uint8_t val_h, val_l;
-    err::Err ret;
-    ret = priv::maix_i2c_read(priv::dev_addr, AXP2101_ADC_DATA_RELUST0, &val_h, 1);
-    if (ret != err::Err::ERR_NONE) {
-        log::error("[%s]: maix_i2c_read failed. Error code:%d", priv::TAG, ret);
-        return false;
-    }
-    ret = priv::maix_i2c_read(priv::dev_addr, AXP2101_ADC_DATA_RELUST1, &val_l, 1);
+    ::maix::peripheral::i2c::Transaction t(4);
+    t.read_mem(priv::dev_addr, AXP2101_ADC_DATA_RELUST0, &val_h, 1);
+    t.read_mem(priv::dev_addr, AXP2101_ADC_DATA_RELUST1, &val_l, 1);
+    err::Err ret = priv::maix_i2c_transfer(t);
     if (ret != err::Err::ERR_NONE) {
-        log::error("[%s]: maix_i2c_read failed. Error code:%d", priv::TAG, ret);
+        log::error("[%s]: maix_i2c_transfer failed. Error code:%d", priv::TAG, ret);
         return false;
     }
-    if (val_h == -1 || val_l == -1)
-        return 0;
     return ((val_h & 0x1F) << 8) | val_l;
 }
 
@@ -286,6 +277,7 @@ err::Err AXP2101::clean_irq()
 {
     const uint8_t buffer = 0xFF;
     err::Err ret;
+    // write-1-to-clear registers, each write is a separate transfer with stop
     for (int i = 0; i < 3; i++) {
         ret = priv::maix_i2c_write(priv::dev_addr, AXP2101_INT_STATUS1+i, &buffer, 1);
         if (ret != err::Err::ERR_NONE) {
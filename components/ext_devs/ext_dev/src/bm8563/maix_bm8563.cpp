@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2024-
  * @license Apache 2.0
  * @update 2024.8.6: Add framework, create this file.
+ * @update 2026.10.18: Read and write registers by one ioctl without memory allocation.
  */
 
 #include "bm8563.h"
@@ -39,37 +40,27 @@ static const std::vector<int> empty_time_tuple;
 
 static int32_t maix_i2c_read(void *handle, uint8_t address, uint8_t reg, uint8_t *buffer, uint16_t size)
 {
-    ::maix::Bytes* res = nullptr;
+    int res;
 
     {
         std::lock_guard<std::recursive_mutex> lock(mtx);
-        /* i2cdev->readfrom_mem() */
-        i2cdev->writeto((int)address, &reg, 1);
-        res = i2cdev->readfrom((int)address, (int)size);
+        res = i2cdev->readfrom_mem((int)address, reg, buffer, (int)size);
     }
 
-    if (res == nullptr) return BM8563_ERROR_NOTTY;
-
-    std::copy(res->data, res->data+res->data_len, buffer);
+    if (res < 0) return BM8563_ERROR_NOTTY;
 
 #ifdef BM8563_DEBUG
-    int32_t len = res->data_len;
-    log::info0("read %d: ", len);
-    for (size_t i = 0; i < res->data_len; ++i) {
-        printf("0x%x ", res->at(i));
+    log::info0("read %d: ", res);
+    for (int i = 0; i < res; ++i) {
+        printf("0x%x ", buffer[i]);
     } printf("\n");
 #endif // BM8563_DEBUG
 
-    delete res;
     return BM8563_OK;
 }
 
 static int32_t maix_i2c_write(void *handle, uint8_t address, uint8_t reg, const uint8_t *buffer, uint16_t size)
 {
-    auto buff = new uint8_t[size+1];
-    buff[0] = reg;
-    std::copy(buffer, buffer+size, buff+1);
-
 #ifdef BM8563_DEBUG
     log::info0("write %d: ", size);
     for (int i = 0; i < size; ++i) {
@@ -77,12 +68,13 @@ static int32_t maix_i2c_write(void *handle, uint8_t address, uint8_t reg, const
     } printf("\n");
 #endif // BM8563_DEBUG
 
+    int res;
     {
         std::lock_guard<std::recursive_mutex> lock(mtx);
-        i2cdev->writeto((int)address, buff, size+1);
+        res = i2cdev->writeto_mem((int)address, reg, buffer, (int)size);
     }
 
-    delete[] buff;
+    if (res < 0) return BM8563_ERROR_NOTTY;
     return BM8563_OK;
 }
 
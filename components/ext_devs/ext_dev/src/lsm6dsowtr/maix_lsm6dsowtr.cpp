@@ -64,6 +64,15 @@ static constexpr uint8_t OUTX_L_A       = 0x28;
 static constexpr uint8_t OUTX_L_G       = 0x22;
 static constexpr uint8_t CTRL1_XL       = 0x10;
 static constexpr uint8_t CTRL2_G        = 0x11;
+static constexpr uint8_t FIFO_CTRL3     = 0x09;
+static constexpr uint8_t FIFO_CTRL4     = 0x0A;
+static constexpr uint8_t FIFO_STATUS1   = 0x3A;
+static constexpr uint8_t FIFO_DATA_OUT_TAG = 0x78;
+static constexpr uint8_t FIFO_MODE_CONTINUOUS = 0x06;
+static constexpr uint8_t FIFO_TAG_GYRO  = 0x01;
+static constexpr uint8_t FIFO_TAG_ACC   = 0x02;
+static constexpr int FIFO_WORD_BYTES    = 7;     // tag and 3 axes int16
+static constexpr int FIFO_MAX_WORDS     = 512;
 
 static constexpr float ACC_SENS_TABLE[4] = {0.061f, 0.122f, 0.244f, 0.488f};  // mg/LSB
 static constexpr float GYRO_SENS_TABLE[4] = {8.75f, 17.5f, 35.0f, 70.0f};     // mdps/LSB
@@ -84,6 +93,9 @@ public:
     uint8_t addr = 0x6B;
     bool is_open = false;
     uint8_t device_id = 0;
+    int acc_odr_idx = 0;    // index of ODR_TABLE, also batch data rate code of FIFO
+    int gyro_odr_idx = 0;
+    std::mutex reg_mtx;
 
     Lsm6dsowI2C(int bus, uint8_t _addr, uint32_t freq_khz)
         : addr(_addr) {
@@ -96,24 +108,22 @@ public:
     }
 
     uint8_t read_reg(uint8_t reg) {
-        return this->read_reg_block(reg, 1)[0];
+        auto data = this->read_reg_block(reg, 1);
+        return data.empty() ? 0 : data[0];
     }
 
     std::vector<uint8_t> read_reg_block(uint8_t reg, size_t len) {
-        // 发送寄存器地址
-        i2c->writeto(addr, std::vector<uint8_t>{reg});
-
-        // 读取 len 字节
-        maix::Bytes* bytes = i2c->readfrom(addr, (int)len);
-        std::vector<uint8_t> result;
-        if (bytes && bytes->size() >= len) {
-            result.assign(bytes->begin(), bytes->begin() + len);
+        // register address and read data in one I2C_RDWR transfer
+        std::lock_guard<std::mutex> lock(reg_mtx);
+        std::vector<uint8_t> result(len);
+        if (i2c->readfrom_mem(addr, reg, result.data(), (int)len) != (int)len) {
+            result.clear();
         }
-        delete bytes;
         return result;
     }
 
     void write_reg(uint8_t reg, uint8_t val) {
+        std::lock_guard<std::mutex> lock(reg_mtx);
         std::vector<uint8_t> data = {reg, val};  // [寄存器地址, 值]
         i2c->writeto(addr, data);
     }
@@ -136,6 +146,7 @@ public:
         uint8_t val = read_reg(CTRL1_XL);
         val = (val & 0x0F) | (best_idx << 4);
         write_reg(CTRL1_XL, val);
+        acc_odr_idx = best_idx;
     }
 
     void set_acc_scale(int g_val) {
@@ -162,6 +173,7 @@ public:
         uint8_t val = read_reg(CTRL2_G);
         val = (val & 0x0F) | (best_idx << 4);
         write_reg(CTRL2_G, val);
+        gyro_odr_idx = best_idx;
     }
 
     void set_gyro_scale(int dps_val) {
@@ -175,6 +187,42 @@ public:
         write_reg(CTRL2_G, val);
     }
 
+    // continuous mode, batch data rate the same as ODR, the oldest word is dropped when full
+    bool fifo_enable(bool enable) {
+        uint8_t bdr = enable ? (uint8_t)((gyro_odr_idx << 4) | acc_odr_idx) : 0;
+        uint8_t mode = enable ? FIFO_MODE_CONTINUOUS : 0;
+        write_reg(FIFO_CTRL4, 0);    // bypass mode clears FIFO
+        write_reg(FIFO_CTRL3, bdr);
+        write_reg(FIFO_CTRL4, mode);
+        return read_reg(FIFO_CTRL3) == bdr && (read_reg(FIFO_CTRL4) & 0x07) == mode;
+    }
+
+    // read FIFO status and all words by one burst, address rolls back to FIFO_DATA_OUT_TAG automatically
+    int fifo_read(uint8_t* buf, int max_words, bool* overflow) {
+        auto status = read_reg_block(FIFO_STATUS1, 2);
+        if (status.size() != 2)
+            return -1;
+        int words = ((status[1] & 0x03) << 8) | status[0];
+        if (overflow)
+            *overflow = status[1] & 0x40;
+        words = words > max_words ? max_words : words;
+        if (words == 0)
+            return 0;
+        auto data = read_reg_block(FIFO_DATA_OUT_TAG, words * FIFO_WORD_BYTES);
+        if ((int)data.size() != words * FIFO_WORD_BYTES)
+            return -1;
+        memcpy(buf, data.data(), data.size());
+        return words;
+    }
+
+    float acc_scale() {
+        return ACC_SENS_TABLE[(read_reg(CTRL1_XL) >> 2) & 0x03] * 1e-3f * GRAVITY;
+    }
+
+    float gyro_scale() {
+        return GYRO_SENS_TABLE[(read_reg(CTRL2_G) >> 2) & 0x03] * 1e-3f;
+    }
+
     bool read_data(lsm6dsow_data_t& out) {
         uint8_t status = read_reg(STATUS_REG);
         if ((status & 0x01) == 0 || (status & 0x02) == 0) {
@@ -337,4 +385,65 @@ std::vector<float> LSM6DSOWTR::read() {
     }
     return {};
 }
-}
\ No newline at end of file
+err::Err LSM6DSOWTR::fifo_enable(bool enable) {
+    auto dev = static_cast<Lsm6dsowI2C*>(this->_data);
+    if (!dev->is_open) {
+        maix::log::error("[%s] IMU is not open", TAG);
+        return err::ERR_NOT_READY;
+    }
+    if (!dev->fifo_enable(enable)) {
+        maix::log::error("[%s] set FIFO failed", TAG);
+        return err::ERR_IO;
+    }
+    _fifo_acc_valid = false;
+    return err::ERR_NONE;
+}
+
+int LSM6DSOWTR::read_fifo(std::vector<float> &out, bool *overflow) {
+    auto dev = static_cast<Lsm6dsowI2C*>(this->_data);
+    if (!dev->is_open)
+        return -1;
+    uint8_t buf[FIFO_WORD_BYTES * FIFO_MAX_WORDS];
+    int words = dev->fifo_read(buf, FIFO_MAX_WORDS, overflow);
+    if (words <= 0)
+        return words;
+    float acc_scale = dev->acc_scale();
+    float gyro_scale = dev->gyro_scale();
+    // acc and gyro are separated words, one sample is output when the word of leading sensor arrived,
+    // gyro leads in DUAL mode, the other sensor uses its latest value
+    bool acc_lead = _mode == imu::Mode::ACC_ONLY;
+    int num = 0;
+    for (int i = 0; i < words; ++i) {
+        const uint8_t *d = buf + i * FIFO_WORD_BYTES;
+        uint8_t tag = d[0] >> 3;
+        float *v = nullptr;
+        float scale = 0;
+        if (tag == FIFO_TAG_GYRO) {
+            v = _fifo_gyro;
+            scale = gyro_scale;
+        } else if (tag == FIFO_TAG_ACC) {
+            v = _fifo_acc;
+            scale = acc_scale;
+            _fifo_acc_valid = true;
+        } else {
+            continue;
+        }
+        for (int j = 0; j < 3; ++j)
+            v[j] = static_cast<int16_t>(d[1 + j * 2] | (d[2 + j * 2] << 8)) * scale;
+        if ((tag == FIFO_TAG_ACC) != acc_lead)
+            continue;
+        if (_mode == imu::Mode::DUAL && !_fifo_acc_valid)
+            continue;
+        out.insert(out.end(), _fifo_acc, _fifo_acc + 3);
+        out.insert(out.end(), _fifo_gyro, _fifo_gyro + 3);
+        ++num;
+    }
+    return num;
+}
+
+float LSM6DSOWTR::odr() {
+    auto dev = static_cast<Lsm6dsowI2C*>(this->_data);
+    int idx = _mode == imu::Mode::ACC_ONLY ? dev->acc_odr_idx : dev->gyro_odr_idx;
+    return ODR_TABLE[idx];
+}
+}
@@ -6,6 +6,10 @@
 #include "maix_ahrs_type.hpp"
 #include <nlohmann/json.hpp>
 #include <fstream>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "maix_i2c.hpp"
 
 using json = nlohmann::json;
@@ -13,6 +17,8 @@ using json = nlohmann::json;
 
 #define CALIBRATION_DATA_PATH "/maixapp/share/misc/imu_calibration"
 #define CALIBRATION_DATA_PATH2 "/maixapp/share/misc/imu_calibration.json"
+#define BIN_LOG_MAGIC "MAIXIMU"
+#define BIN_LOG_VERSION 1
 namespace maix::ext_dev::imu {
 
 enum class driver_type
@@ -31,6 +37,118 @@ typedef struct {
 } imu_param_t;
 
 
+// Timestamps of FIFO samples.
+// Host time of every drain is jittered by scheduling and the sensor clock differs from nominal ODR,
+// so fit drain time = a + b * sample_index by least squares over recent drains,
+// b is the real sample period and timestamps of samples are a + b * index.
+class _SampleClock
+{
+public:
+    void reset(double period_us)
+    {
+        _nominal = period_us;
+        _period = period_us;
+        _index = 0;
+        _last = 0;
+        _points.clear();
+    }
+
+    // n samples drained at host time t_us, the last one is the newest, return samples lost before them
+    uint64_t stamp(uint64_t t_us, int n, uint64_t *out)
+    {
+        uint64_t lost = 0;
+        if (!_points.empty())
+        {
+            // samples lost by FIFO overflow, drain time is much later than expected
+            double expect = _a + _period * (_index + n - 1);
+            double gap = (t_us - expect) / _period;
+            if (gap > 2 + _nominal_gap())
+            {
+                lost = (uint64_t)(gap - _nominal_gap());
+                _index += lost;
+                _points.clear();
+            }
+        }
+        _index += n;
+        _points.push_back({(double)(_index - 1), (double)t_us});
+        if (_points.size() > max_points)
+            _points.erase(_points.begin());
+        _fit();
+        for (int i = 0; i < n; ++i)
+        {
+            double t = _a + _period * (_index - n + i);
+            uint64_t ts = t < 0 ? 0 : (uint64_t)t;
+            // monotonic, a new fit never moves samples before the previous batch
+            if (_last && ts <= _last)
+                ts = _last + 1;
+            out[i] = ts;
+            _last = ts;
+        }
+        return lost;
+    }
+
+private:
+    static const size_t max_points = 64;
+    double _nominal = 1000;
+    double _period = 1000;
+    double _a = 0;
+    uint64_t _index = 0;        // samples number since reset
+    uint64_t _last = 0;
+    std::vector<std::pair<double, double>> _points;
+
+    // drain time jitter tolerance in samples
+    double _nominal_gap()
+    {
+        return 2000 / _period;  // 2ms
+    }
+
+    void _fit()
+    {
+        size_t n = _points.size();
+        double x0 = _points[0].first, y0 = _points[0].second;
+        double sx = 0, sy = 0;
+        for (auto &p : _points)
+        {
+            sx += p.first - x0;
+            sy += p.second - y0;
+        }
+        double mx = sx / n, my = sy / n;
+        if (n >= 8)
+        {
+            double sxx = 0, sxy = 0;
+            for (auto &p : _points)
+            {
+                double dx = p.first - x0 - mx;
+                sxx += dx * dx;
+                sxy += dx * (p.second - y0 - my);
+            }
+            // sensor clock error is within several percent, limit it against bursty scheduling
+            if (sxx > 0)
+                _period = std::min(std::max(sxy / sxx, _nominal * 0.8), _nominal * 1.2);
+        }
+        _a = y0 + my - _period * (x0 + mx);
+    }
+};
+
+class _IMUFifo
+{
+public:
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool exit = false;
+    int interval_ms = 10;
+    std::vector<IMUData> ring;
+    size_t head = 0;            // index of the oldest sample
+    size_t count = 0;
+    uint64_t dropped = 0;
+    int readers = 0;            // threads using this object in read_fifo, fifo_stop wait them exit before free
+    _SampleClock clock;
+};
+
+// guard IMU::_fifo pointer, fifo_stop may be called while other threads read FIFO
+static std::mutex _fifo_ptr_lock;
+
 std::vector<ext_dev::imu::IMUInfo> get_imu_info()
 {
     std::vector<ext_dev::imu::IMUInfo> info;
@@ -134,6 +252,7 @@ IMU::IMU(std::string driver, int i2c_bus, int addr, int freq, imu::Mode mode, im
 
 IMU::~IMU()
 {
+    fifo_stop();
     if (_param) {
         imu_param_t *param = (imu_param_t *)_param;
         if (_driver == "qmi8658") {
@@ -206,6 +325,353 @@ ext_dev::imu::IMUData IMU::read_all(bool calib_gryo, bool radian)
     return res;
 }
 
+err::Err IMU::fifo_start(int buffer_size, int interval_ms)
+{
+    if (_fifo)
+        return err::ERR_NONE;
+    if (buffer_size <= 0 || interval_ms <= 0)
+        return err::ERR_ARGS;
+    imu_param_t *param = (imu_param_t *)_param;
+    err::Err e;
+    float odr;
+    if (param->type == driver_type::qmi8658) {
+        e = param->driver.qmi8658->fifo_enable(true);
+        odr = param->driver.qmi8658->odr();
+    } else if (param->type == driver_type::lsm6dsowtr) {
+        e = param->driver.lsm6dsowtr->fifo_enable(true);
+        odr = param->driver.lsm6dsowtr->odr();
+    } else {
+        return err::ERR_NOT_IMPL;
+    }
+    if (e != err::ERR_NONE)
+        return e;
+    if (odr <= 0)
+        return err::ERR_ARGS;
+
+    _IMUFifo *fifo = new _IMUFifo();
+    fifo->interval_ms = interval_ms;
+    fifo->ring.resize(buffer_size);
+    fifo->clock.reset(1000000.0 / odr);
+    fifo->thread = std::thread([this, fifo]() { this->_fifo_run(fifo); });
+    std::lock_guard<std::mutex> guard(_fifo_ptr_lock);
+    _fifo = fifo;
+    return err::ERR_NONE;
+}
+
+err::Err IMU::fifo_stop()
+{
+    _IMUFifo *fifo;
+    {
+        // new read_fifo calls will not get this object
+        std::lock_guard<std::mutex> guard(_fifo_ptr_lock);
+        fifo = (_IMUFifo *)_fifo;
+        _fifo = nullptr;
+    }
+    if (!fifo)
+        return err::ERR_NONE;
+    {
+        std::lock_guard<std::mutex> lock(fifo->mutex);
+        fifo->exit = true;
+    }
+    fifo->cond.notify_all();
+    if (fifo->thread.joinable())
+        fifo->thread.join();
+    {
+        // wake up blocked readers and wait them leave before free
+        std::unique_lock<std::mutex> lock(fifo->mutex);
+        fifo->cond.wait(lock, [fifo]() { return fifo->readers == 0; });
+    }
+    delete fifo;
+
+    imu_param_t *param = (imu_param_t *)_param;
+    if (param->type == driver_type::qmi8658)
+        return param->driver.qmi8658->fifo_enable(false);
+    if (param->type == driver_type::lsm6dsowtr)
+        return param->driver.lsm6dsowtr->fifo_enable(false);
+    return err::ERR_NONE;
+}
+
+bool IMU::fifo_running()
+{
+    return _fifo != nullptr;
+}
+
+void IMU::_fifo_run(void *arg)
+{
+    _IMUFifo *fifo = (_IMUFifo *)arg;
+    imu_param_t *param = (imu_param_t *)_param;
+    std::vector<float> values;
+    std::vector<uint64_t> timestamps;
+    while (true)
+    {
+        values.clear();
+        bool overflow = false;
+        int num = -1;
+        if (param->type == driver_type::qmi8658)
+            num = param->driver.qmi8658->read_fifo(values, &overflow);
+        else if (param->type == driver_type::lsm6dsowtr)
+            num = param->driver.lsm6dsowtr->read_fifo(values, &overflow);
+        uint64_t t = time::ticks_us();
+        if (num < 0)
+            log::warn("read IMU FIFO failed");
+        if (overflow)
+            log::warn("IMU FIFO overflow, increase drain frequency");
+
+        std::unique_lock<std::mutex> lock(fifo->mutex);
+        if (num > 0)
+        {
+            timestamps.resize(num);
+            fifo->dropped += fifo->clock.stamp(t, num, timestamps.data());
+            size_t size = fifo->ring.size();
+            for (int i = 0; i < num; ++i)
+            {
+                const float *v = values.data() + i * 6;
+                IMUData data;
+                data.acc.x = v[0];
+                data.acc.y = v[1];
+                data.acc.z = v[2];
+                data.gyro.x = v[3];
+                data.gyro.y = v[4];
+                data.gyro.z = v[5];
+                data.temp = 0;
+                data.timestamp = timestamps[i];
+                if (fifo->count == size)
+                {
+                    fifo->head = (fifo->head + 1) % size;
+                    --fifo->count;
+                    ++fifo->dropped;
+                }
+                fifo->ring[(fifo->head + fifo->count) % size] = data;
+                ++fifo->count;
+            }
+            fifo->cond.notify_all();
+        }
+        fifo->cond.wait_for(lock, std::chrono::milliseconds(fifo->interval_ms), [fifo]() { return fifo->exit; });
+        if (fifo->exit)
+            break;
+    }
+}
+
+std::vector<ext_dev::imu::IMUData> IMU::read_fifo(int max_num, int timeout_ms, bool calib_gryo, bool radian)
+{
+    std::vector<IMUData> res;
+    _IMUFifo *fifo;
+    std::unique_lock<std::mutex> ptr_lock(_fifo_ptr_lock);
+    fifo = (_IMUFifo *)_fifo;
+    if (!fifo)
+        return res;
+    {
+        std::unique_lock<std::mutex> lock(fifo->mutex);
+        ptr_lock.unlock();
+        ++fifo->readers;
+        auto ready = [fifo]() { return fifo->count > 0 || fifo->exit; };
+        if (timeout_ms < 0)
+            fifo->cond.wait(lock, ready);
+        else if (timeout_ms > 0)
+            fifo->cond.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready);
+        size_t num = (max_num < 0 || (size_t)max_num > fifo->count) ? fifo->count : max_num;
+        res.reserve(num);
+        size_t size = fifo->ring.size();
+        for (size_t i = 0; i < num; ++i)
+            res.push_back(fifo->ring[(fifo->head + i) % size]);
+        fifo->head = (fifo->head + num) % size;
+        fifo->count -= num;
+        if (--fifo->readers == 0 && fifo->exit)
+            fifo->cond.notify_all();
+    }
+    for (auto &d : res)
+    {
+        if (calib_gryo)
+        {
+            d.gyro.x -= calib_gyro_data.x;
+            d.gyro.y -= calib_gyro_data.y;
+            d.gyro.z -= calib_gyro_data.z;
+        }
+        if (radian)
+        {
+            d.gyro.x *= ahrs::DEG2RAD;
+            d.gyro.y *= ahrs::DEG2RAD;
+            d.gyro.z *= ahrs::DEG2RAD;
+        }
+    }
+    return res;
+}
+
+uint64_t IMU::fifo_dropped()
+{
+    std::lock_guard<std::mutex> guard(_fifo_ptr_lock);
+    _IMUFifo *fifo = (_IMUFifo *)_fifo;
+    if (!fifo)
+        return 0;
+    std::lock_guard<std::mutex> lock(fifo->mutex);
+    return fifo->dropped;
+}
+
+tensor::Vector3f ahrs_update(ahrs::MahonyAHRS &ahrs, const std::vector<ext_dev::imu::IMUData> &samples, uint64_t last_timestamp, bool radian)
+{
+    tensor::Vector3f angle;
+    size_t n = samples.size();
+    for (size_t i = 0; i < n; ++i)
+    {
+        const IMUData &d = samples[i];
+        uint64_t last = i > 0 ? samples[i - 1].timestamp : last_timestamp;
+        float dt;
+        if (last)
+            dt = (float)(d.timestamp - last) * 1e-6f;
+        else
+            dt = n > 1 ? (float)(samples[1].timestamp - samples[0].timestamp) * 1e-6f : 0;
+        tensor::Vector3f gyro = d.gyro;
+        if (!radian)
+        {
+            gyro.x *= ahrs::DEG2RAD;
+            gyro.y *= ahrs::DEG2RAD;
+            gyro.z *= ahrs::DEG2RAD;
+        }
+        if (i + 1 < n)
+            ahrs.update(d.acc.x, d.acc.y, d.acc.z, gyro.x, gyro.y, gyro.z, d.mag.x, d.mag.y, d.mag.z, dt);
+        else
+            angle = ahrs.get_angle(d.acc, gyro, d.mag, dt, radian);
+    }
+    return angle;
+}
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint8_t reserved[16];
+} bin_log_header_t;
+
+typedef struct {
+    uint64_t t;
+    float acc[3];
+    float gyro[3];
+} bin_log_record_t;
+
+IMUBinLog::IMUBinLog()
+{
+    _f = nullptr;
+}
+
+IMUBinLog::~IMUBinLog()
+{
+    close();
+}
+
+err::Err IMUBinLog::open(const std::string &path)
+{
+    close();
+    _f = fopen(path.c_str(), "wb");
+    if (!_f)
+    {
+        log::error("open %s failed", path.c_str());
+        return err::ERR_IO;
+    }
+    // write by batch, a large buffer makes fwrite calls rarely touch the file
+    setvbuf(_f, nullptr, _IOFBF, 64 * 1024);
+    bin_log_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BIN_LOG_MAGIC, sizeof(BIN_LOG_MAGIC));
+    header.version = BIN_LOG_VERSION;
+    header.record_size = sizeof(bin_log_record_t);
+    if (fwrite(&header, sizeof(header), 1, _f) != 1)
+    {
+        close();
+        return err::ERR_IO;
+    }
+    return err::ERR_NONE;
+}
+
+err::Err IMUBinLog::close()
+{
+    if (_f)
+    {
+        fclose(_f);
+        _f = nullptr;
+    }
+    return err::ERR_NONE;
+}
+
+bool IMUBinLog::is_opened()
+{
+    return _f != nullptr;
+}
+
+err::Err IMUBinLog::write(const std::vector<ext_dev::imu::IMUData> &samples)
+{
+    if (!_f)
+        return err::ERR_NOT_OPEN;
+    std::vector<bin_log_record_t> records(samples.size());
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        const IMUData &d = samples[i];
+        bin_log_record_t &r = records[i];
+        r.t = d.timestamp;
+        r.acc[0] = d.acc.x;
+        r.acc[1] = d.acc.y;
+        r.acc[2] = d.acc.z;
+        r.gyro[0] = d.gyro.x;
+        r.gyro[1] = d.gyro.y;
+        r.gyro[2] = d.gyro.z;
+    }
+    if (fwrite(records.data(), sizeof(bin_log_record_t), records.size(), _f) != records.size())
+        return err::ERR_IO;
+    return err::ERR_NONE;
+}
+
+err::Err IMUBinLog::read(const std::string &path, std::vector<ext_dev::imu::IMUData> &samples)
+{
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f)
+    {
+        log::error("open %s failed", path.c_str());
+        return err::ERR_ARGS;
+    }
+    bin_log_header_t header;
+    if (fread(&header, sizeof(header), 1, f) != 1 || memcmp(header.magic, BIN_LOG_MAGIC, sizeof(BIN_LOG_MAGIC)) != 0
+        || header.version != BIN_LOG_VERSION || header.record_size != sizeof(bin_log_record_t))
+    {
+        log::error("%s is not IMU binary log", path.c_str());
+        fclose(f);
+        return err::ERR_ARGS;
+    }
+    bin_log_record_t records[256];
+    size_t n;
+    while ((n = fread(records, sizeof(bin_log_record_t), 256, f)) > 0)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            IMUData d;
+            d.acc.x = records[i].acc[0];
+            d.acc.y = records[i].acc[1];
+            d.acc.z = records[i].acc[2];
+            d.gyro.x = records[i].gyro[0];
+            d.gyro.y = records[i].gyro[1];
+            d.gyro.z = records[i].gyro[2];
+            d.temp = 0;
+            d.timestamp = records[i].t;
+            samples.push_back(d);
+        }
+    }
+    fclose(f);
+    return err::ERR_NONE;
+}
+
+err::Err IMUBinLog::to_gcsv(const std::string &path, const std::string &gcsv_path, double tscale, double gscale, double ascale, const std::string &orientation)
+{
+    std::vector<IMUData> samples;
+    err::Err e = read(path, samples);
+    if (e != err::ERR_NONE)
+        return e;
+    Gcsv gcsv;
+    e = gcsv.open(gcsv_path, tscale, gscale, ascale, 1, "1.3", "imu", orientation);
+    if (e != err::ERR_NONE)
+        return e;
+    e = gcsv.write_batch(samples);
+    gcsv.close();
+    return e;
+}
+
 tensor::Vector3f IMU::calib_gyro(uint64_t time_ms, int interval_ms, const std::string &save_id)
 {
     uint64_t start_ms = time::ticks_ms();
@@ -72,13 +72,9 @@ void Qmi8658c::qmi8658_write(uint8_t reg, uint8_t value)
 
 uint8_t Qmi8658c::qmi8658_read(uint8_t reg)
 {
-    maix::Bytes* res = nullptr;
-    {
-        res = i2cbus->readfrom_mem(this->deviceAdress, reg, 1);
-    }
-    uint8_t value = res->at(0);
+    uint8_t value = 0;
+    i2cbus->readfrom_mem(this->deviceAdress, reg, &value, 1);
     // maix::log::info0("%u ", value);
-    delete res;
     return value;
 }
 
@@ -227,27 +223,25 @@ qmi8658_result_t Qmi8658c::open(qmi8658_cfg_t* qmi8658_cfg) {
 // Read data from the QMI8658 sensor and stores it in the provided data structure.
 
 void Qmi8658c::read(qmi_data_t* data) {
-    maix::Bytes* res = nullptr;
+    uint8_t buf[14];
     static qmi_data_t last_data = {0};
-    res = i2cbus->readfrom_mem(this->deviceAdress, QMI8658_TEMP_L, 14);
-    if (res || res->data_len != 14) {
-        int16_t temp = (((int16_t)res->data[1] << 8) | res->data[0]);
+    if (i2cbus->readfrom_mem(this->deviceAdress, QMI8658_TEMP_L, buf, 14) == 14) {
+        int16_t temp = (((int16_t)buf[1] << 8) | buf[0]);
         data->temperature = (float)temp/TEMPERATURE_SENSOR_RESOLUTION;
 
-        int16_t acc_x = (((int16_t)res->data[3] << 8) | res->data[2]);
-        int16_t acc_y = (((int16_t)res->data[5] << 8) | res->data[4]);
-        int16_t acc_z = (((int16_t)res->data[7] << 8) | res->data[6]);
+        int16_t acc_x = (((int16_t)buf[3] << 8) | buf[2]);
+        int16_t acc_y = (((int16_t)buf[5] << 8) | buf[4]);
+        int16_t acc_z = (((int16_t)buf[7] << 8) | buf[6]);
         data->acc_xyz.x = (float)acc_x/qmi_ctx.acc_sensitivity;
         data->acc_xyz.y = (float)acc_y/qmi_ctx.acc_sensitivity;
         data->acc_xyz.z = (float)acc_z/qmi_ctx.acc_sensitivity;
 
-        int16_t rot_x = (int16_t)(((uint16_t)res->data[9] << 8) | res->data[8]);
-        int16_t rot_y = (int16_t)(((uint16_t)res->data[11] << 8) | res->data[10]);
-        int16_t rot_z = (int16_t)(((uint16_t)res->data[13] << 8) | res->data[12]);
+        int16_t rot_x = (int16_t)(((uint16_t)buf[9] << 8) | buf[8]);
+        int16_t rot_y = (int16_t)(((uint16_t)buf[11] << 8) | buf[10]);
+        int16_t rot_z = (int16_t)(((uint16_t)buf[13] << 8) | buf[12]);
         data->gyro_xyz.x = (float)rot_x/qmi_ctx.gyro_sensitivity;
         data->gyro_xyz.y = (float)rot_y/qmi_ctx.gyro_sensitivity;
         data->gyro_xyz.z = (float)rot_z/qmi_ctx.gyro_sensitivity;
-        delete res;
 
         memcpy(&last_data, data, sizeof(last_data));
     } else {
@@ -255,6 +249,64 @@ void Qmi8658c::read(qmi_data_t* data) {
     }
 }
 
+// Send a CTRL9 command, wait CmdDone and acknowledge it.
+
+bool Qmi8658c::ctrl9_cmd(uint8_t cmd) {
+    this->qmi8658_write(QMI8658_CTRL9, cmd);
+    bool done = false;
+    for (int i = 0; i < 100; ++i) {
+        if (this->qmi8658_read(QMI8658_STATUSINT) & 0x80) {
+            done = true;
+            break;
+        }
+        maix::time::sleep_us(100);
+    }
+    this->qmi8658_write(QMI8658_CTRL9, QMI8658_CTRL_CMD_ACK);
+    return done;
+}
+
+// Enable FIFO in stream mode with 128 samples size, the oldest sample is dropped when full.
+
+bool Qmi8658c::fifo_enable(bool enable) {
+    uint8_t fifo_ctrl = enable ? (QMI8658_FIFO_MODE_STREAM | QMI8658_FIFO_SIZE_128) : QMI8658_FIFO_MODE_BYPASS;
+    this->qmi8658_write(QMI8658_FIFO_CTRL, fifo_ctrl);
+    if (!this->ctrl9_cmd(QMI8658_CTRL_CMD_RST_FIFO))
+        return false;
+    return (this->qmi8658_read(QMI8658_FIFO_CTRL) & 0x0F) == fifo_ctrl;
+}
+
+// Read FIFO count and FIFO_CTRL by one transaction, request FIFO read mode,
+// then read all data by one burst and exit read mode in one transaction.
+
+int Qmi8658c::fifo_read(uint8_t* buf, int max_bytes, bool* overflow) {
+    uint8_t cnt[2];
+    uint8_t fifo_ctrl;
+    fifo_trans.clear();
+    fifo_trans.read_mem(this->deviceAdress, QMI8658_FIFO_SMPL_CNT, cnt, 2);
+    fifo_trans.read_mem(this->deviceAdress, QMI8658_FIFO_CTRL, &fifo_ctrl, 1);
+    if (i2cbus->transfer(fifo_trans) != maix::err::ERR_NONE)
+        return -1;
+    int bytes = (((cnt[1] & 0x03) << 8) | cnt[0]) * 2;
+    if (overflow)
+        *overflow = cnt[1] & QMI8658_FIFO_STATUS_OVFLOW;
+    if (bytes == 0)
+        return 0;
+    bytes = bytes > max_bytes ? max_bytes : bytes;
+
+    fifo_ctrl &= ~QMI8658_FIFO_RD_MODE;
+    if (!this->ctrl9_cmd(QMI8658_CTRL_CMD_REQ_FIFO))
+        return -1;
+    fifo_trans.clear();
+    fifo_trans.read_mem(this->deviceAdress, QMI8658_FIFO_DATA, buf, bytes);
+    fifo_trans.write_mem(this->deviceAdress, QMI8658_FIFO_CTRL, &fifo_ctrl, 1);
+    if (i2cbus->transfer(fifo_trans) != maix::err::ERR_NONE) {
+        // make sure FIFO read mode exited
+        this->qmi8658_write(QMI8658_FIFO_CTRL, fifo_ctrl);
+        return -1;
+    }
+    return bytes;
+}
+
 // Close communication with the QMI8658 sensor.
 // Return a status code indicating success or failure of the operation.
 
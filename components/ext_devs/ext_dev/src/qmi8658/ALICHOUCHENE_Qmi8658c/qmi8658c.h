@@ -52,6 +52,25 @@ namespace maix::ext_dev::qmi8658::priv {
 #define QMI8658_TEMP_L      0x33  // Temperature sensor low byte.
 #define QMI8658_TEMP_H      0x34  // Temperature sensor high byte.
 
+/* FIFO registers */
+#define QMI8658_FIFO_WTM_TH     0x13  // FIFO watermark level, in unit of ODR samples.
+#define QMI8658_FIFO_CTRL       0x14  // FIFO control register.
+#define QMI8658_FIFO_SMPL_CNT   0x15  // FIFO sample count LSB, in unit of 2 bytes.
+#define QMI8658_FIFO_STATUS     0x16  // FIFO status and sample count MSB.
+#define QMI8658_FIFO_DATA       0x17  // FIFO data, address not increased when burst read.
+
+#define QMI8658_FIFO_MODE_BYPASS    0x00
+#define QMI8658_FIFO_MODE_STREAM    0x02
+#define QMI8658_FIFO_SIZE_128       0x0C
+#define QMI8658_FIFO_RD_MODE        0x80
+#define QMI8658_FIFO_STATUS_OVFLOW  0x20
+
+/* Status and CTRL9 command */
+#define QMI8658_STATUSINT       0x2D  // bit7 CmdDone of CTRL9 protocol.
+#define QMI8658_CTRL_CMD_ACK        0x00
+#define QMI8658_CTRL_CMD_RST_FIFO   0x04
+#define QMI8658_CTRL_CMD_REQ_FIFO   0x05
+
 /* Soft reset register */
 #define QMI8658_RESET       0x60  // Soft reset register address.
 
@@ -194,6 +213,7 @@ private:
     uint16_t deviceFrequency;
     qmi_ctx_t qmi_ctx;
     ::maix::peripheral::i2c::I2C* i2cbus;
+    ::maix::peripheral::i2c::Transaction fifo_trans;          // reused by fifo_read, no allocation when polling
     int maix_i2c_bus;
 
 public:
@@ -203,6 +223,10 @@ public:
     qmi8658_result_t close(void);                             // Close communication with the Qmi8658c.
     char* resultToString(qmi8658_result_t result);            // Convert a qmi8658_result_t enum value into a corresponding string representation.
     void reset(void);
+    bool fifo_enable(bool enable);                            // Enable FIFO stream mode of acc and gyro, or bypass FIFO.
+    int fifo_read(uint8_t* buf, int max_bytes, bool* overflow); // Read all bytes in FIFO by one burst, return bytes number, < 0 if error.
+    float acc_sensitivity(void) { return qmi_ctx.acc_sensitivity; }
+    float gyro_sensitivity(void) { return qmi_ctx.gyro_sensitivity; }
     ~Qmi8658c();
 
 private:
@@ -214,6 +238,7 @@ private:
     void acc_set_scale(acc_scale_t acc_scale);                // Set the scale for the accelerometer.
     void gyro_set_odr(gyro_odr_t odr);                        // Set the output data rate (ODR) for the gyroscope.
     void gyro_set_scale(gyro_scale_t gyro_scale);             // Set the scale for the gyroscope.
+    bool ctrl9_cmd(uint8_t cmd);                              // Send CTRL9 command and wait done.
     static ::maix::peripheral::i2c::I2C* maix_qmi_init_i2c_bus(int bus, uint32_t deviceFrequency, bool& is_exist);
     static void maix_qmi_deinit_i2c_bus(int bus);
 };
@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2024-
  * @license Apache 2.0
  * @update 2024.8.6: Add framework, create this file.
+ * @update 2026.10.18: Add FIFO burst read.
  */
 
 #include "qmi8658c.h"
@@ -21,6 +22,12 @@ static const int DEFALUT_I2C_BUS = 4;
 // static const int QMI8658C_I2C_ADDRESS = 0x6B;
 static const uint64_t RESET_WAIT_TIME_MS = 2000;
 static const char* TAG = "MAIX QMI8658";
+static const int FIFO_AXIS_BYTES = 6;      // one sensor, 3 axes int16
+static const int FIFO_MAX_SAMPLES = 128;
+// gyro ODR of gyro_odr_t in 6DOF and gyro only mode, accelerometer runs at the same rate in 6DOF mode
+static const float GYRO_ODR_6DOF[] = {7174.4f, 3587.2f, 1793.6f, 896.8f, 448.4f, 224.2f, 112.1f, 56.05f, 28.025f};
+// accelerometer ODR of acc_odr_t in accelerometer only mode
+static const float ACC_ODR[] = {8000.0f, 4000.0f, 2000.0f, 1000.0f, 500.0f, 250.0f, 125.0f, 62.5f, 31.25f};
 
 /********************************************
  *
@@ -102,12 +109,27 @@ QMI8658::QMI8658(int i2c_bus, int addr, int freq, imu::Mode mode, imu::AccScale
     qmi8658c->deviceID = 0x0;
     this->_mode = mode;
     priv::qmi8658_cfg_t cfg;
-    cfg.qmi8658_mode = priv::qmi8658_mode_dual;
+    // only enable sensors of mode, FIFO sample layout depends on it
+    if (mode == imu::Mode::ACC_ONLY)
+        cfg.qmi8658_mode = priv::qmi8658_mode_acc_only;
+    else if (mode == imu::Mode::GYRO_ONLY)
+        cfg.qmi8658_mode = priv::qmi8658_mode_gyro_only;
+    else
+        cfg.qmi8658_mode = priv::qmi8658_mode_dual;
     maix::log::info("cfg.qmi8658_mode: 0x%x", cfg.qmi8658_mode);
     cfg.acc_scale = static_cast<priv::acc_scale_t>(acc_scale);
     cfg.acc_odr = static_cast<priv::acc_odr_t>(acc_odr);
     cfg.gyro_scale = static_cast<priv::gyro_scale_t>(gyro_scale);
     cfg.gyro_odr = static_cast<priv::gyro_odr_t>(gyro_odr);
+    if (mode == imu::Mode::ACC_ONLY) {
+        int odr_idx = static_cast<int>(cfg.acc_odr);
+        int odr_num = sizeof(priv::ACC_ODR) / sizeof(priv::ACC_ODR[0]);
+        this->_odr = priv::ACC_ODR[odr_idx < odr_num ? odr_idx : odr_num - 1];
+    } else {
+        int odr_idx = static_cast<int>(cfg.gyro_odr);
+        int odr_num = sizeof(priv::GYRO_ODR_6DOF) / sizeof(priv::GYRO_ODR_6DOF[0]);
+        this->_odr = priv::GYRO_ODR_6DOF[odr_idx < odr_num ? odr_idx : odr_num - 1];
+    }
 
     if (!qmi8658c->need_reset) {
         log::warn("qmi8658c in this bus is already init! All config args will be ignore!");
@@ -198,4 +220,53 @@ std::vector<float> QMI8658::read()
     return make_read_result(this->_mode, data);
 }
 
-}
\ No newline at end of file
+err::Err QMI8658::fifo_enable(bool enable)
+{
+    auto qmi8658c = (priv::Qmi8658c*)this->_data;
+    if (qmi8658c->deviceID != 0x5) {
+        log::error("[%s] IMU is not open", priv::TAG);
+        return err::ERR_NOT_READY;
+    }
+    if (!qmi8658c->fifo_enable(enable)) {
+        log::error("[%s] set FIFO failed", priv::TAG);
+        return err::ERR_IO;
+    }
+    return err::ERR_NONE;
+}
+
+int QMI8658::read_fifo(std::vector<float> &out, bool *overflow)
+{
+    auto qmi8658c = (priv::Qmi8658c*)this->_data;
+    if (qmi8658c->deviceID != 0x5)
+        return -1;
+    // FIFO only contains enabled sensors, acc first
+    bool has_acc = this->_mode != imu::Mode::GYRO_ONLY;
+    bool has_gyro = this->_mode != imu::Mode::ACC_ONLY;
+    int sample_bytes = priv::FIFO_AXIS_BYTES * ((has_acc ? 1 : 0) + (has_gyro ? 1 : 0));
+    uint8_t buf[priv::FIFO_AXIS_BYTES * 2 * priv::FIFO_MAX_SAMPLES];
+    int bytes = qmi8658c->fifo_read(buf, sample_bytes * priv::FIFO_MAX_SAMPLES, overflow);
+    if (bytes < 0)
+        return -1;
+    int num = bytes / sample_bytes;
+    float acc_sens = qmi8658c->acc_sensitivity();
+    float gyro_sens = qmi8658c->gyro_sensitivity();
+    size_t offset = out.size();
+    out.resize(offset + num * 6, 0);
+    float *p = out.data() + offset;
+    for (int i = 0; i < num; ++i) {
+        const uint8_t *d = buf + i * sample_bytes;
+        for (int j = has_acc ? 0 : 3; j < (has_gyro ? 6 : 3); ++j) {
+            int16_t v = (int16_t)(((uint16_t)d[1] << 8) | d[0]);
+            p[i * 6 + j] = (float)v / (j < 3 ? acc_sens : gyro_sens);
+            d += 2;
+        }
+    }
+    return num;
+}
+
+float QMI8658::odr()
+{
+    return this->_odr;
+}
+
+}
@@ -13,6 +13,8 @@ struct paramsMLX90640;
 
 namespace maix::ext_dev::mlx90640 {
 
+class MLX90640Acquisition;
+
 /**
  * @brief MLX90640 FPS
  * @maixpy maix.ext_dev.mlx90640.FPS
@@ -117,6 +119,10 @@ public:
      * The matrix structure is represented as list[MLX_H][MLX_W],
      * where MLX_H is the number of rows (24) and MLX_W is the number of columns (32).
      *
+     * Sensor is read by a background thread once constructed, every sub page updates half of the pixels,
+     * this function returns the latest frame immediately without waiting for I2C,
+     * only the first call waits until both sub pages arrived.
+     *
      * @return CMatrix containing the temperature data, or an empty matrix ([]) if the operation fails.
      *
      * @maixpy maix.ext_dev.mlx90640.MLX90640Celsius.matrix
@@ -246,10 +252,10 @@ private:
     float _max;
     float _emissivity;
     uint16_t _eeMLX90640[832];
-    uint16_t _frame[834];
     float _mlx90640To[768];
     // paramsMLX90640 _mlx90640;
     std::unique_ptr<paramsMLX90640> _mlx90640;
+    std::unique_ptr<MLX90640Acquisition> _acq;
     Point _temp_min;
     Point _temp_max;
     Point _center;
@@ -1,7 +1,11 @@
 #include "maix_mlx90640.hpp"
 #include "MLX90640_I2C_Driver.h"
 #include "MLX90640_API.h"
+#include "mlx90640_calc.hpp"
 #include "maix_basic.hpp"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 namespace maix::ext_dev::mlx90640 {
 
@@ -110,6 +114,107 @@ void make_maix_image_pixel(float min, float max, float value, uint8_t* buffer, c
 }
 
 
+// read sub pages in background thread, calculate To of each sub page into working frame,
+// publish a copy once both sub pages arrived, readers never wait for I2C
+class MLX90640Acquisition final {
+public:
+    MLX90640Acquisition(const paramsMLX90640 *params, float emissivity, FPS fps)
+        : _params(params), _calc(params, emissivity)
+    {
+        // refresh rate is sub page rate, 0b001: 1Hz, ..., 0b111: 64Hz
+        _period_us = 2000000 >> static_cast<uint8_t>(fps);
+        ::memset(_frame, 0x00, sizeof(_frame));
+        ::memset(_to, 0x00, sizeof(_to));
+        ::memset(_latest, 0x00, sizeof(_latest));
+        _thread = std::thread([this]() { this->_run(); });
+    }
+
+    ~MLX90640Acquisition()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _exit = true;
+        }
+        _cond.notify_all();
+        if (_thread.joinable())
+            _thread.join();
+    }
+
+    /**
+     * Copy latest complete frame
+     * @param to 768 floats.
+     * @param timeout_ms wait time if no complete frame yet.
+     * @return false if no complete frame.
+     */
+    bool latest(float *to, int timeout_ms)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (!_cond.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this]() { return _ready || _exit; }) || !_ready)
+            return false;
+        ::memcpy(to, _latest, sizeof(_latest));
+        return true;
+    }
+
+    int period_ms()
+    {
+        return _period_us / 1000;
+    }
+
+private:
+    const paramsMLX90640 *_params;
+    ToCalculator _calc;
+    int _period_us;
+    std::thread _thread;
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    bool _exit = false;
+    bool _ready = false;
+    uint8_t _sub_pages = 0;     // bit 0 and bit 1 set when sub page 0 and 1 calculated
+    uint16_t _frame[834];
+    float _to[768];             // working frame, only accessed by acquisition thread
+    float _latest[768];         // latest complete frame, protected by _mutex
+
+    void _run()
+    {
+        uint64_t t_read = time::ticks_us();
+        uint32_t failed = 0;    // continuous failed reads, only log first failure and recovery
+        while (true) {
+            {
+                // next sub page is ready at least one period after last read started,
+                // sleep most of it instead of polling status register, I2C bus and CPU are free for others
+                std::unique_lock<std::mutex> lock(_mutex);
+                int64_t wait_us = static_cast<int64_t>(_period_us) * 3 / 4 - static_cast<int64_t>(time::ticks_us() - t_read);
+                if (wait_us > 0)
+                    _cond.wait_for(lock, std::chrono::microseconds(wait_us), [this]() { return _exit; });
+                if (_exit)
+                    break;
+            }
+            t_read = time::ticks_us();
+            int sub_page = MLX90640_GetFrameData(MLX_ADDR, _frame);
+            if (sub_page < 0) {
+                if (failed++ == 0)
+                    log::warn("%s get frame data failed: %d", TAG(), sub_page);
+                continue;
+            }
+            if (failed > 0) {
+                log::info("%s get frame data recovered after %u failed reads", TAG(), failed);
+                failed = 0;
+            }
+            float tr = MLX90640_GetTa(_frame, _params) - 8.0;
+            _calc.calculate(_frame, tr, _to);
+            _sub_pages |= 1 << sub_page;
+            if (_sub_pages != 0x03)
+                continue;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                ::memcpy(_latest, _to, sizeof(_latest));
+                _ready = true;
+            }
+            _cond.notify_all();
+        }
+    }
+};
+
 MLX90640Kelvin::MLX90640Kelvin(int i2c_bus_num, FPS fps, Cmap cmap, float temp_min, float temp_max, float emissivity)
 {
     float ctemp_min = temp_min - KC;
@@ -174,7 +279,6 @@ MLX90640Celsius::MLX90640Celsius(int i2c_bus_num, FPS fps, Cmap cmap, float temp
     this->_mlx90640 = std::make_unique<paramsMLX90640>();
 
     ::memset(this->_eeMLX90640, 0x00, std::size(this->_eeMLX90640)*sizeof(uint16_t));
-    ::memset(this->_frame, 0x00, std::size(this->_frame)*sizeof(uint16_t));
     ::memset(this->_mlx90640To, 0x00, std::size(this->_mlx90640To)*sizeof(float));
 
     MLX90640_I2CInit(i2c_bus_num);
@@ -185,19 +289,22 @@ MLX90640Celsius::MLX90640Celsius(int i2c_bus_num, FPS fps, Cmap cmap, float temp
     MLX90640_DumpEE(MLX_ADDR, this->_eeMLX90640);
     MLX90640_ExtractParameters(this->_eeMLX90640, this->_mlx90640.get());
 
+    this->_acq = std::make_unique<MLX90640Acquisition>(this->_mlx90640.get(), this->_emissivity, fps);
 }
 
-MLX90640Celsius::~MLX90640Celsius() {}
+MLX90640Celsius::~MLX90640Celsius()
+{
+    /* stop acquisition thread before params released */
+    this->_acq.reset();
+}
 
 CMatrix MLX90640Celsius::matrix()
 {
-
-    MLX90640_GetFrameData(MLX_ADDR, this->_frame);
-
-    auto eTa = MLX90640_GetTa(this->_frame, this->_mlx90640.get());
-    auto eTr = eTa-8.0;
-
-    MLX90640_CalculateTo(this->_frame, this->_mlx90640.get(), this->_emissivity, eTr, this->_mlx90640To);
+    /* two sub pages and I2C read time at most */
+    if (!this->_acq->latest(this->_mlx90640To, this->_acq->period_ms() * 4 + 1000)) {
+        log::error("%s wait frame timeout!", TAG());
+        return {};
+    }
 
     CMatrix m(MLX_H, std::vector<float>(MLX_W));
 
@@ -205,7 +312,7 @@ CMatrix MLX90640Celsius::matrix()
     int temp_min_x{};
     int temp_min_y{};
 
-    float temp_max = std::numeric_limits<float>::min();
+    float temp_max = std::numeric_limits<float>::lowest();
     int temp_max_x{};
     int temp_max_y{};
 
@@ -236,6 +343,8 @@ CMatrix MLX90640Celsius::matrix()
 maix::image::Image* MLX90640Celsius::image()
 {
     CMatrix m = this->matrix();
+    if (m.empty())
+        return nullptr;
     return image_from(m);
 }
 
@@ -0,0 +1,214 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Create this file, add table based SIMD To calculation.
+ */
+
+#include "mlx90640_calc.hpp"
+#include "MLX90640_API.h"
+#include <math.h>
+
+// vsqrtq_f32 and vdivq_f32 are only available on aarch64
+#if defined(__aarch64__) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+    #include <arm_neon.h>
+    #define MLX90640_USE_NEON 1
+    #define MLX90640_USE_SSE 0
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+    #define MLX90640_USE_NEON 0
+    #define MLX90640_USE_SSE 1
+#else
+    #define MLX90640_USE_NEON 0
+    #define MLX90640_USE_SSE 0
+#endif
+
+namespace maix::ext_dev::mlx90640 {
+
+// values constant in one sub page
+class _FrameConst {
+public:
+    float gain;
+    float dta;        // ta - 25
+    float dvdd;       // vdd - 3.3
+    float cp;         // tgc * irDataCP[subPage]
+    float inv_e;      // 1 / emissivity
+    float ks_ta;      // 1 + KsTa * (ta - 25)
+    float ta_tr;
+    float k0;         // 1 - ksTo[1] * 273.15
+    float ks_to1;
+    float ct[4];
+    float ks_to[4];
+    float corr[4];    // alphaCorrR
+};
+
+static inline float _sext(uint16_t v)
+{
+    return (float)(int16_t)v;
+}
+
+static inline float _to_scalar(const _FrameConst &c, float ir, float offset, float kta, float kv, float ilc, float alpha)
+{
+    ir = ir * c.gain - offset * (1 + kta * c.dta) * (1 + kv * c.dvdd) + ilc - c.cp;
+    ir = ir * c.inv_e;
+    float a = alpha * c.ks_ta;
+    float sx = a * a * a * (ir + a * c.ta_tr);
+    sx = sqrtf(sqrtf(sx)) * c.ks_to1;
+    float to = sqrtf(sqrtf(ir / (a * c.k0 + sx) + c.ta_tr)) - 273.15f;
+    int range = to < c.ct[1] ? 0 : (to < c.ct[2] ? 1 : (to < c.ct[3] ? 2 : 3));
+    return sqrtf(sqrtf(ir / (a * c.corr[range] * (1 + c.ks_to[range] * (to - c.ct[range]))) + c.ta_tr)) - 273.15f;
+}
+
+ToCalculator::ToCalculator(const paramsMLX90640 *params, float emissivity)
+    : _params(params), _emissivity(emissivity)
+{
+    float kta_scale = pow(2, (double)params->ktaScale);
+    float kv_scale = pow(2, (double)params->kvScale);
+    float alpha_scale = pow(2, (double)params->alphaScale);
+    for (int m = 0; m < 2; ++m)
+    {
+        uint8_t mode = m ? 0x80 : 0;    // the same as (frameData[832] & 0x1000) >> 5
+        for (int i = 0; i < MLX90640_PIXEL_NUM; ++i)
+        {
+            int il_pattern = i / 32 - (i / 64) * 2;
+            int chess_pattern = il_pattern ^ (i - (i / 2) * 2);
+            int conversion_pattern = ((i + 2) / 4 - (i + 3) / 4 + (i + 1) / 4 - i / 4) * (1 - 2 * il_pattern);
+            int pattern = mode == 0 ? il_pattern : chess_pattern;
+            Table &t = _tables[m][pattern];
+            t.index.push_back(i);
+            t.offset.push_back(params->offset[i]);
+            t.kta.push_back(params->kta[i] / kta_scale);
+            t.kv.push_back(params->kv[i] / kv_scale);
+            float ilc = 0;
+            if (mode != params->calibrationModeEE)
+                ilc = params->ilChessC[2] * (2 * il_pattern - 1) - params->ilChessC[1] * conversion_pattern;
+            t.ilc.push_back(ilc);
+            t.alpha.push_back(SCALEALPHA * alpha_scale / params->alpha[i]);
+        }
+    }
+    _ir.resize(MLX90640_PIXEL_NUM);
+    _to.resize(MLX90640_PIXEL_NUM);
+}
+
+void ToCalculator::calculate(const uint16_t *frame, float tr, float *result)
+{
+    const paramsMLX90640 *p = _params;
+    uint16_t *frame_data = const_cast<uint16_t *>(frame);
+    int sub_page = frame[833] & 0x01;
+    uint8_t mode = (frame[832] & 0x1000) >> 5;
+    float vdd = MLX90640_GetVdd(frame_data, p);
+    float ta = MLX90640_GetTa(frame_data, p);
+
+    _FrameConst c;
+    float ta4 = ta + 273.15;
+    ta4 = ta4 * ta4;
+    ta4 = ta4 * ta4;
+    float tr4 = tr + 273.15;
+    tr4 = tr4 * tr4;
+    tr4 = tr4 * tr4;
+    c.ta_tr = tr4 - (tr4 - ta4) / _emissivity;
+    c.gain = p->gainEE / _sext(frame[778]);
+    c.dta = ta - 25;
+    c.dvdd = vdd - 3.3;
+    c.inv_e = 1 / _emissivity;
+    c.ks_ta = 1 + p->KsTa * (ta - 25);
+    c.ks_to1 = p->ksTo[1];
+    c.k0 = 1 - p->ksTo[1] * 273.15;
+    float cp_scale = (1 + p->cpKta * (ta - 25)) * (1 + p->cpKv * (vdd - 3.3));
+    float cp_offset = p->cpOffset[sub_page];
+    if (sub_page == 1 && mode != p->calibrationModeEE)
+        cp_offset += p->ilChessC[0];
+    c.cp = p->tgc * (_sext(frame[sub_page ? 808 : 776]) * c.gain - cp_offset * cp_scale);
+    c.corr[0] = 1 / (1 + p->ksTo[0] * 40);
+    c.corr[1] = 1;
+    c.corr[2] = 1 + p->ksTo[1] * p->ct[2];
+    c.corr[3] = c.corr[2] * (1 + p->ksTo[2] * (p->ct[3] - p->ct[2]));
+    for (int i = 0; i < 4; ++i)
+    {
+        c.ct[i] = p->ct[i];
+        c.ks_to[i] = p->ksTo[i];
+    }
+
+    const Table &t = _tables[mode ? 1 : 0][sub_page];
+    int n = t.index.size();
+    const int *index = t.index.data();
+    float *ir = _ir.data();
+    float *to = _to.data();
+    for (int i = 0; i < n; ++i)
+        ir[i] = _sext(frame[index[i]]);
+
+    const float *offset = t.offset.data();
+    const float *kta = t.kta.data();
+    const float *kv = t.kv.data();
+    const float *ilc = t.ilc.data();
+    const float *alpha = t.alpha.data();
+    int i = 0;
+#if MLX90640_USE_NEON
+    const float32x4_t one = vdupq_n_f32(1), k273 = vdupq_n_f32(273.15f);
+    const float32x4_t gain = vdupq_n_f32(c.gain), dta = vdupq_n_f32(c.dta), dvdd = vdupq_n_f32(c.dvdd);
+    const float32x4_t cp = vdupq_n_f32(c.cp), inv_e = vdupq_n_f32(c.inv_e), ks_ta = vdupq_n_f32(c.ks_ta);
+    const float32x4_t ta_tr = vdupq_n_f32(c.ta_tr), k0 = vdupq_n_f32(c.k0), ks_to1 = vdupq_n_f32(c.ks_to1);
+    for (; i + 4 <= n; i += 4)
+    {
+        float32x4_t v = vmulq_f32(vld1q_f32(ir + i), gain);
+        float32x4_t o = vmulq_f32(vld1q_f32(offset + i), vmlaq_f32(one, vld1q_f32(kta + i), dta));
+        o = vmulq_f32(o, vmlaq_f32(one, vld1q_f32(kv + i), dvdd));
+        v = vsubq_f32(vaddq_f32(vsubq_f32(v, o), vld1q_f32(ilc + i)), cp);
+        v = vmulq_f32(v, inv_e);
+        float32x4_t a = vmulq_f32(vld1q_f32(alpha + i), ks_ta);
+        float32x4_t sx = vmulq_f32(vmulq_f32(vmulq_f32(a, a), a), vmlaq_f32(v, a, ta_tr));
+        sx = vmulq_f32(vsqrtq_f32(vsqrtq_f32(sx)), ks_to1);
+        float32x4_t t0 = vaddq_f32(vdivq_f32(v, vmlaq_f32(sx, a, k0)), ta_tr);
+        t0 = vsubq_f32(vsqrtq_f32(vsqrtq_f32(t0)), k273);
+        // select range by ct, range 0 if To < ct[1]
+        float32x4_t corr = vdupq_n_f32(c.corr[0]), ks = vdupq_n_f32(c.ks_to[0]), ct = vdupq_n_f32(c.ct[0]);
+        for (int r = 1; r < 4; ++r)
+        {
+            uint32x4_t m = vcgeq_f32(t0, vdupq_n_f32(c.ct[r]));
+            corr = vbslq_f32(m, vdupq_n_f32(c.corr[r]), corr);
+            ks = vbslq_f32(m, vdupq_n_f32(c.ks_to[r]), ks);
+            ct = vbslq_f32(m, vdupq_n_f32(c.ct[r]), ct);
+        }
+        float32x4_t d = vmulq_f32(vmulq_f32(a, corr), vmlaq_f32(one, ks, vsubq_f32(t0, ct)));
+        float32x4_t t1 = vaddq_f32(vdivq_f32(v, d), ta_tr);
+        vst1q_f32(to + i, vsubq_f32(vsqrtq_f32(vsqrtq_f32(t1)), k273));
+    }
+#elif MLX90640_USE_SSE
+    const __m128 one = _mm_set1_ps(1), k273 = _mm_set1_ps(273.15f);
+    const __m128 gain = _mm_set1_ps(c.gain), dta = _mm_set1_ps(c.dta), dvdd = _mm_set1_ps(c.dvdd);
+    const __m128 cp = _mm_set1_ps(c.cp), inv_e = _mm_set1_ps(c.inv_e), ks_ta = _mm_set1_ps(c.ks_ta);
+    const __m128 ta_tr = _mm_set1_ps(c.ta_tr), k0 = _mm_set1_ps(c.k0), ks_to1 = _mm_set1_ps(c.ks_to1);
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 v = _mm_mul_ps(_mm_loadu_ps(ir + i), gain);
+        __m128 o = _mm_mul_ps(_mm_loadu_ps(offset + i), _mm_add_ps(one, _mm_mul_ps(_mm_loadu_ps(kta + i), dta)));
+        o = _mm_mul_ps(o, _mm_add_ps(one, _mm_mul_ps(_mm_loadu_ps(kv + i), dvdd)));
+        v = _mm_sub_ps(_mm_add_ps(_mm_sub_ps(v, o), _mm_loadu_ps(ilc + i)), cp);
+        v = _mm_mul_ps(v, inv_e);
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(alpha + i), ks_ta);
+        __m128 sx = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(a, a), a), _mm_add_ps(v, _mm_mul_ps(a, ta_tr)));
+        sx = _mm_mul_ps(_mm_sqrt_ps(_mm_sqrt_ps(sx)), ks_to1);
+        __m128 t0 = _mm_add_ps(_mm_div_ps(v, _mm_add_ps(_mm_mul_ps(a, k0), sx)), ta_tr);
+        t0 = _mm_sub_ps(_mm_sqrt_ps(_mm_sqrt_ps(t0)), k273);
+        // select range by ct, range 0 if To < ct[1]
+        __m128 corr = _mm_set1_ps(c.corr[0]), ks = _mm_set1_ps(c.ks_to[0]), ct = _mm_set1_ps(c.ct[0]);
+        for (int r = 1; r < 4; ++r)
+        {
+            __m128 m = _mm_cmpge_ps(t0, _mm_set1_ps(c.ct[r]));
+            corr = _mm_or_ps(_mm_and_ps(m, _mm_set1_ps(c.corr[r])), _mm_andnot_ps(m, corr));
+            ks = _mm_or_ps(_mm_and_ps(m, _mm_set1_ps(c.ks_to[r])), _mm_andnot_ps(m, ks));
+            ct = _mm_or_ps(_mm_and_ps(m, _mm_set1_ps(c.ct[r])), _mm_andnot_ps(m, ct));
+        }
+        __m128 d = _mm_mul_ps(_mm_mul_ps(a, corr), _mm_add_ps(one, _mm_mul_ps(ks, _mm_sub_ps(t0, ct))));
+        __m128 t1 = _mm_add_ps(_mm_div_ps(v, d), ta_tr);
+        _mm_storeu_ps(to + i, _mm_sub_ps(_mm_sqrt_ps(_mm_sqrt_ps(t1)), k273));
+    }
+#endif
+    for (; i < n; ++i)
+        to[i] = _to_scalar(c, ir[i], offset[i], kta[i], kv[i], ilc[i], alpha[i]);
+
+    for (i = 0; i < n; ++i)
+        result[index[i]] = to[i];
+}
+
+}   // namespace maix::ext_dev::mlx90640
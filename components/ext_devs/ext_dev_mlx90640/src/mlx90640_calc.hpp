@@ -0,0 +1,53 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Create this file, add table based SIMD To calculation.
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+struct paramsMLX90640;
+
+namespace maix::ext_dev::mlx90640 {
+
+/**
+ * Object temperature calculator, the same result as MLX90640_CalculateTo.
+ * Per pixel coefficients are derived from EEPROM params once in constructor,
+ * every sub page only calculates per frame values and runs a vectorised loop over the pixels of this sub page.
+ */
+class ToCalculator final {
+public:
+    ToCalculator(const paramsMLX90640 *params, float emissivity);
+
+    /**
+     * Calculate To of pixels in the sub page of frame, pixels of the other sub page in result are not changed.
+     * @param frame 834 words read by MLX90640_GetFrameData.
+     * @param tr reflected temperature.
+     * @param result 768 floats.
+     */
+    void calculate(const uint16_t *frame, float tr, float *result);
+
+private:
+    // pixels of one sub page in one mode, all arrays have the same size
+    class Table {
+    public:
+        std::vector<int> index;
+        std::vector<float> offset;
+        std::vector<float> kta;   // kta / ktaScale
+        std::vector<float> kv;    // kv / kvScale
+        std::vector<float> ilc;   // interleaved / chess pattern correction, 0 in calibration mode
+        std::vector<float> alpha; // SCALEALPHA * alphaScale / alpha
+    };
+
+    const paramsMLX90640 *_params;
+    float _emissivity;
+    Table _tables[2][2];          // [mode][sub page]
+    std::vector<float> _ir;       // raw data of one sub page
+    std::vector<float> _to;
+};
+
+}   // namespace maix::ext_dev::mlx90640
@@ -142,31 +142,20 @@ int MLX90640_GetFrameData(uint8_t slaveAddr, uint16_t *frameData)
     }
     // maix::log::info("_w_0x8000_0x0030 used: %llu", maix::time::ticks_ms()-_w_0x8000_0x0030_ltime);
 
-    // uint64_t _r_768_ltime = maix::time::ticks_ms();
-    error = MLX90640_I2CRead(slaveAddr, 0x0400, 768, frameData);
-    if(error != 0)
+    // frame, aux data and control register in one I2C transaction
     {
-        return error;
+        const uint16_t startAddress[3] = {0x0400, 0x0700, 0x800D};
+        const uint16_t nMemAddressRead[3] = {768, 64, 1};
+        uint16_t *blocks[3] = {frameData, data, &controlRegister1};
+        error = MLX90640_I2CReadBatch(slaveAddr, 3, startAddress, nMemAddressRead, blocks);
     }
-    // maix::log::info("_r_768 used: %llu", maix::time::ticks_ms()-_r_768_ltime);
-
-    // auto _r_64_ltime = maix::time::ticks_ms();
-    error = MLX90640_I2CRead(slaveAddr, 0x0700, 64, data);
     if(error != 0)
     {
         return error;
     }
-    // maix::log::info("_r_64 used: %llu", maix::time::ticks_ms()-_r_64_ltime);
-
-    error = MLX90640_I2CRead(slaveAddr, 0x800D, 1, &controlRegister1);
     frameData[832] = controlRegister1;
     frameData[833] = statusRegister & 0x0001;
 
-    if(error != 0)
-    {
-        return error;
-    }
-
     // auto _vaildate_ltime = maix::time::ticks_ms();
     error = ValidateAuxData(data);
     if(error == 0)
@@ -27,6 +27,8 @@ extern "C" {
 void MLX90640_I2CInit(int i2c_bus_num);
 int MLX90640_I2CGeneralReset(void);
 int MLX90640_I2CRead(uint8_t slaveAddr,uint16_t startAddress, uint16_t nMemAddressRead, uint16_t *data);
+/* read several blocks in one I2C transaction, data[i] receives nMemAddressRead[i] words from startAddress[i] */
+int MLX90640_I2CReadBatch(uint8_t slaveAddr, int num, const uint16_t *startAddress, const uint16_t *nMemAddressRead, uint16_t **data);
 int MLX90640_I2CWrite(uint8_t slaveAddr,uint16_t writeAddress, uint16_t data);
 void MLX90640_I2CFreqSet(int freq);
 
@@ -4,7 +4,7 @@
 #define MLX90640_MAIX_I2C           1
 #define MLX90640_SOFT_I2C           2
 
-#define MLX_90640_I2C_MODE MLX90640_LINUX_SYSCALL_I2C
+#define MLX_90640_I2C_MODE MLX90640_MAIX_I2C
 
 #if MLX_90640_I2C_MODE == MLX90640_LINUX_SYSCALL_I2C
 
@@ -71,6 +71,15 @@ int MLX90640_I2CRead(uint8_t slaveAddr, uint16_t startAddress, uint16_t nMemAddr
     return 0;
 }
 
+int MLX90640_I2CReadBatch(uint8_t slaveAddr, int num, const uint16_t *startAddress, const uint16_t *nMemAddressRead, uint16_t **data)
+{
+    for (int i = 0; i < num; ++i) {
+        if (MLX90640_I2CRead(slaveAddr, startAddress[i], nMemAddressRead[i], data[i]) != 0)
+            return -1;
+    }
+    return 0;
+}
+
 void MLX90640_I2CFreqSet([[maybe_unused]]int freq)
 {
 #if 1 // PLATFORM_MAIXCAM
@@ -125,4 +134,127 @@ void MLX90640_I2CInit(int bus_num)
 }
 
 
-#endif
\ No newline at end of file
+#endif
+
+#if MLX_90640_I2C_MODE == MLX90640_MAIX_I2C
+
+#include "MLX90640_I2C_Driver.h"
+#include "maix_i2c.hpp"
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+
+#define MLX90640_I2C_BATCH_MAX 8
+
+// driver functions have no device handle, bus state and batch buffers are shared by all sensor instances,
+// lock them, or reads of different instances in different threads will corrupt each other.
+static std::mutex i2c_lock;
+static std::unique_ptr<maix::peripheral::i2c::I2C> i2c_dev;
+static int i2c_bus_num = -1;
+static maix::peripheral::i2c::Transaction i2c_trans(MLX90640_I2C_BATCH_MAX * 2);
+static uint8_t i2c_buf[1664 + 128 + 2];   // the biggest batch, frame + aux + control register
+
+// call with i2c_lock locked
+static bool MLX90640_I2COpen()
+{
+    if (i2c_dev)
+        return true;
+    try {
+        i2c_dev = std::make_unique<maix::peripheral::i2c::I2C>(i2c_bus_num, maix::peripheral::i2c::Mode::MASTER);
+    } catch (const std::exception &e) {
+        maix::log::error("mlx90640 open i2c %d failed: %s", i2c_bus_num, e.what());
+        return false;
+    }
+    return true;
+}
+
+int MLX90640_I2CReadBatch(uint8_t slaveAddr, int num, const uint16_t *startAddress, const uint16_t *nMemAddressRead, uint16_t **data)
+{
+    std::lock_guard<std::mutex> lock(i2c_lock);
+    if (!MLX90640_I2COpen())
+        return -1;
+
+    size_t total = 0;
+    for (int i = 0; i < num; ++i)
+        total += nMemAddressRead[i] * 2;
+    if (num > MLX90640_I2C_BATCH_MAX || total > sizeof(i2c_buf)) {
+        maix::log::error("mlx90640 i2c batch too large");
+        return -1;
+    }
+
+    // all reads in one I2C_RDWR ioctl, device sends words big endian
+    i2c_trans.clear();
+    uint8_t *p = i2c_buf;
+    for (int i = 0; i < num; ++i) {
+        i2c_trans.read_mem(slaveAddr, startAddress[i], p, nMemAddressRead[i] * 2, 16);
+        p += nMemAddressRead[i] * 2;
+    }
+    if (i2c_dev->transfer(i2c_trans) != maix::err::ERR_NONE) {
+        printf("I2C Read Error!\n");
+        return -1;
+    }
+
+    p = i2c_buf;
+    for (int i = 0; i < num; ++i) {
+        for (int count = 0; count < nMemAddressRead[i]; count++) {
+            data[i][count] = ((uint16_t)p[0] << 8) | p[1];
+            p += 2;
+        }
+    }
+    return 0;
+}
+
+int MLX90640_I2CRead(uint8_t slaveAddr, uint16_t startAddress, uint16_t nMemAddressRead, uint16_t *data)
+{
+    return MLX90640_I2CReadBatch(slaveAddr, 1, &startAddress, &nMemAddressRead, &data);
+}
+
+void MLX90640_I2CFreqSet([[maybe_unused]]int freq)
+{
+#if 1 // PLATFORM_MAIXCAM
+    if (i2c_bus_num == 5) {
+        const char* priv_freq_path = "/sys/devices/platform/i2c5@gpio/udelay_value/udelay_v";
+        const char* wd = "0";
+
+        int _fd = ::open(priv_freq_path, O_WRONLY);
+        if (_fd < 0) return;
+
+        int ret = ::write(_fd, wd, 1);
+        ::close(_fd);
+        if (ret < 0) return;
+    }
+#endif
+}
+
+int MLX90640_I2CWrite(uint8_t slaveAddr, uint16_t writeAddress, uint16_t data)
+{
+    std::lock_guard<std::mutex> lock(i2c_lock);
+    if (!MLX90640_I2COpen())
+        return -1;
+
+    uint8_t cmd[2] = {(uint8_t)(data >> 8), (uint8_t)(data & 0x00FF)};
+    if (i2c_dev->writeto_mem(slaveAddr, writeAddress, cmd, 2, 16) < 0) {
+        printf("I2C Write Error!\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+int MLX90640_I2CGeneralReset(void)
+{
+	MLX90640_I2CWrite(0x33,0x06,0x00);
+	return 0;
+}
+
+void MLX90640_I2CInit(int bus_num)
+{
+    std::lock_guard<std::mutex> lock(i2c_lock);
+    i2c_bus_num = bus_num;
+    i2c_dev.reset();
+    MLX90640_I2CFreqSet(0);
+}
+
+#endif
@@ -23,7 +23,9 @@ def add_requirements(platform : str, find_dirs : list):
             "uchardet"
         ])
     elif platform == "linux":
-        pass
+        reqs.extend([
+            "onnxruntime"
+        ])
     else:
         raise Exception("nn component.py not add this platform support yet")
     return reqs
@@ -144,6 +144,19 @@ namespace maix::nn
          */
          nn::Layout layout = nn::Layout::UNKNOWN;
 
+        /**
+         * Quantization scale of int8/uint8 layer, real value = (quantized value - zero_point) * scale.
+         * Set by MUD extra key `output_scale`, 1.0 if not quantized.
+         * @maixpy maix.nn.LayerInfo.scale
+         */
+        float scale = 1.0;
+
+        /**
+         * Quantization zero point of int8/uint8 layer, set by MUD extra key `output_zero_point`, 0 if not quantized.
+         * @maixpy maix.nn.LayerInfo.zero_point
+         */
+        int zero_point = 0;
+
         /**
          * Shape as one int type, multiply all dims of shape
          * @maixpy maix.nn.LayerInfo.shape_int
@@ -178,7 +191,12 @@ namespace maix::nn
                     str += ", ";
                 }
             }
-            str += "])";
+            str += "]";
+            if (dtype == tensor::DType::INT8 || dtype == tensor::DType::UINT8)
+            {
+                str += ", scale=" + std::to_string(scale) + ", zero_point=" + std::to_string(zero_point);
+            }
+            str += ")";
             return str;
         }
 
@@ -231,7 +249,8 @@ namespace maix::nn
 
         /**
          * Get model output layer info
-         * @return output layer info
+         * @return output layer info, quantization params of int8/uint8 outputs are set from MUD extra keys
+         *         `output_scale` and `output_zero_point`, comma separated values in outputs order.
          */
         virtual std::vector<LayerInfo> outputs_info() = 0;
 
@@ -394,6 +413,7 @@ namespace maix::nn
          * @param dual_buff_wait bool type, only for dual_buff mode, if true, will inference this image and wait for result, default false.
          * @param chw !!depracated!! This arg will be ignored!!! Please set extra.input_layout in mud file instead.
          *            chw channel format, forward model with hwc format image input if set to false, default true(chw).
+         *            On linux, set to false for a nchw model will raise err.Exception(ERR_NOT_IMPL).
          * @return output tensor. In C++, you should manually delete tensors in return value and return value.
          *         If dual_buff mode, it can be NULL(None in MaixPy) means not ready.
          * @throw If error occurs, like arg error or alloc memory failed, will raise err.Exception.
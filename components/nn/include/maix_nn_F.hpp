@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Add dequantize and quantized sigmoid threshold.
  */
 
 #pragma once
@@ -23,5 +24,28 @@ namespace maix::nn::F
     */
     tensor::Tensor *softmax(tensor::Tensor *tensor, bool replace);
 
+    /**
+     * Dequantize int8/uint8 tensor to float32, real value = (quantized value - zero_point) * scale
+     * @param tensor input tensor, dtype must be int8 or uint8
+     * @param scale quantization scale, see nn::LayerInfo.scale
+     * @param zero_point quantization zero point, see nn::LayerInfo.zero_point
+     * @throw If dtype not int8 or uint8, will raise err.Exception error
+     * @return new float32 tensor, In C++, you should delete it manually!
+     * @maixcdk maix.nn.F.dequantize
+    */
+    tensor::Tensor *dequantize(tensor::Tensor *tensor, float scale, int zero_point);
+
+    /**
+     * Minimum quantized value whose sigmoid is greater than threshold, i.e.
+     * sigmoid((q - zero_point) * scale) > th equals to q >= quant_sigmoid_threshold(th, scale, zero_point),
+     * so scores can be compared in quantized domain without dequantize and sigmoid.
+     * @param th sigmoid threshold, (0, 1)
+     * @param scale quantization scale, must > 0
+     * @param zero_point quantization zero point
+     * @return minimum quantized value, may out of data type range, e.g. > 127 means no value pass for int8.
+     * @maixcdk maix.nn.F.quant_sigmoid_threshold
+    */
+    int quant_sigmoid_threshold(float th, float scale, int zero_point);
+
 } // namespace maix::nn::F
 
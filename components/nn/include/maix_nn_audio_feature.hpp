@@ -0,0 +1,179 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Create this file, add real FFT and streaming mel spectrogram.
+ */
+
+#pragma once
+
+#include "maix_basic.hpp"
+#include <complex>
+#include <vector>
+
+namespace maix::nn
+{
+    /**
+     * Real FFT plan, mixed radix(4, 2, 3, 5 and others), factors and twiddles are calculated once in constructor,
+     * reuse one object for all frames of the same size.
+     * @maixcdk maix.nn.RFFT
+     */
+    class RFFT
+    {
+    public:
+        /**
+         * Create real FFT plan
+         * @param n FFT size, must be even and >= 2.
+         * @throw err::Exception if n invalid.
+         * @maixcdk maix.nn.RFFT.RFFT
+         */
+        RFFT(int n);
+
+        /**
+         * FFT size
+         * @maixcdk maix.nn.RFFT.size
+         */
+        int size() { return _n; }
+
+        /**
+         * Forward FFT
+         * @param in n real samples.
+         * @param out n / 2 + 1 complex bins.
+         * @maixcdk maix.nn.RFFT.forward
+         */
+        void forward(const float *in, std::complex<float> *out);
+
+        /**
+         * Power spectrum, |X|^power
+         * @param in n real samples.
+         * @param out n / 2 + 1 floats.
+         * @param power 2 for power spectrum, 1 for magnitude.
+         * @maixcdk maix.nn.RFFT.power
+         */
+        void power(const float *in, float *out, float power = 2.0f);
+
+    private:
+        int _n;
+        int _m; // complex FFT size, n / 2
+        std::vector<int> _factors;
+        std::vector<std::complex<float>> _twiddles;
+        std::vector<std::complex<float>> _super_twiddles;
+        std::vector<std::complex<float>> _in;
+        std::vector<std::complex<float>> _out;
+        std::vector<std::complex<float>> _scratch;
+        std::vector<std::complex<float>> _bins;
+
+        void _work(std::complex<float> *out, const std::complex<float> *in, int fstride, const int *factors);
+    };
+
+    /**
+     * Log mel spectrogram feature extractor.
+     * The same as librosa.feature.melspectrogram(center=True, pad_mode="reflect", window="hann", htk=False, norm="slaney") and then log10.
+     * Window, mel filter bank and FFT plan are created once, PCM can be pushed by chunks,
+     * every frame is calculated once when enough samples arrived, features are stored row major [frames, n_mels] continuously.
+     * @maixcdk maix.nn.MelSpectrogram
+     */
+    class MelSpectrogram
+    {
+    public:
+        /**
+         * Create mel spectrogram extractor
+         * @param sample_rate PCM sample rate.
+         * @param n_fft FFT size, also window size.
+         * @param hop hop length.
+         * @param n_mels mel bands number.
+         * @param fmin lowest frequency of mel filter.
+         * @param fmax highest frequency of mel filter, <= 0 means sample_rate / 2.
+         * @param power exponent of magnitude, 2 for power, 1 for energy.
+         * @maixcdk maix.nn.MelSpectrogram.MelSpectrogram
+         */
+        MelSpectrogram(int sample_rate = 16000, int n_fft = 400, int hop = 160, int n_mels = 80, float fmin = 0, float fmax = -1, float power = 2.0f);
+
+        /**
+         * Clear pushed PCM and features, start a new stream.
+         * @maixcdk maix.nn.MelSpectrogram.reset
+         */
+        void reset();
+
+        /**
+         * Push PCM samples
+         * @param pcm float samples, range [-1, 1].
+         * @param num samples number.
+         * @return new frames number calculated by this push.
+         * @maixcdk maix.nn.MelSpectrogram.push
+         */
+        int push(const float *pcm, int num);
+
+        /**
+         * Push 16 bits signed PCM samples
+         * @maixcdk maix.nn.MelSpectrogram.push
+         */
+        int push(const int16_t *pcm, int num);
+
+        /**
+         * Stream end, pad tail by reflect and calculate the remaining frames, push after finish will start a new stream.
+         * @return new frames number calculated.
+         * @maixcdk maix.nn.MelSpectrogram.finish
+         */
+        int finish();
+
+        /**
+         * Frames number calculated
+         * @maixcdk maix.nn.MelSpectrogram.frames
+         */
+        int frames() { return _frames; }
+
+        /**
+         * Mel bands number
+         * @maixcdk maix.nn.MelSpectrogram.n_mels
+         */
+        int n_mels() { return _n_mels; }
+
+        /**
+         * Features, log10(max(mel, 1e-10)), row major [frames, n_mels], valid until next push, finish or reset.
+         * @maixcdk maix.nn.MelSpectrogram.data
+         */
+        const float *data() { return _log_mel.data(); }
+
+        /**
+         * Max value of features
+         * @maixcdk maix.nn.MelSpectrogram.max
+         */
+        float max() { return _max; }
+
+        /**
+         * Whisper encoder input, (max(x, max - 8) + 4) / 4, shape [n_mels, n_frames], frames less than n_frames are filled with 0.
+         * @param out output buffer, n_mels * n_frames floats.
+         * @param start first frame index.
+         * @param n_frames frames number of output, 3000 for 30s of Whisper.
+         * @maixcdk maix.nn.MelSpectrogram.whisper_input
+         */
+        void whisper_input(float *out, int start = 0, int n_frames = 3000);
+
+    private:
+        int _sample_rate;
+        int _n_fft;
+        int _hop;
+        int _n_mels;
+        float _power;
+        RFFT _fft;
+        std::vector<float> _window;
+        std::vector<float> _filters;     // non-zero weights of all mel bands
+        std::vector<int> _filter_start;  // first FFT bin of each mel band
+        std::vector<int> _filter_offset; // offset in _filters of each mel band, n_mels + 1
+        std::vector<float> _buf;         // padded samples not consumed, first sample is padded index _buf_start
+        int64_t _buf_start;
+        int64_t _raw_num;                // raw samples pushed
+        bool _started;                   // left pad added
+        bool _finished;
+        int _frames;
+        float _max;
+        std::vector<float> _log_mel;
+        std::vector<float> _frame;
+        std::vector<float> _spec;
+
+        void _mel_filters(float fmin, float fmax);
+        int _compute();
+        void _start();
+    };
+} // namespace maix::nn
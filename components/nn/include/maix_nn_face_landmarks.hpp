@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2024-
  * @license Apache 2.0, model used YOLOv8 and mediepipe's.
  * @update 2025.01.07: Add face landmarks support.
+ * @update 2026.10.18: Add detect_faces, run landmarks model of all faces by ROIPipeline.
  */
 
 #pragma once
@@ -12,6 +13,7 @@
 #include "maix_image_cv.hpp"
 #include "maix_nn_F.hpp"
 #include "maix_nn_object.hpp"
+#include "maix_nn_roi_pipeline.hpp"
 #include <math.h>
 
 
@@ -76,6 +78,7 @@ namespace maix::nn
         FaceLandmarks(const string &model = "")
         {
             _model = nullptr;
+            _pipeline = nullptr;
             if (!model.empty())
             {
                 err::Err e = load(model);
@@ -88,6 +91,11 @@ namespace maix::nn
 
         ~FaceLandmarks()
         {
+            if (_pipeline)
+            {
+                delete _pipeline;
+                _pipeline = nullptr;
+            }
             if (_model)
             {
                 delete _model;
@@ -103,6 +111,11 @@ namespace maix::nn
          */
         err::Err load(const string &model)
         {
+            if (_pipeline)
+            {
+                delete _pipeline;
+                _pipeline = nullptr;
+            }
             if (_model)
             {
                 delete _model;
@@ -218,6 +231,7 @@ namespace maix::nn
                 }
             }
             log::info("landmarks num: %d", landmarks_num);
+            _pipeline = new nn::ROIPipeline(_model, _input_img_fmt, this->mean, this->scale);
             return err::ERR_NONE;
         }
 
@@ -265,11 +279,60 @@ namespace maix::nn
             {
                 return obj;
             }
-            _decode_landmarks(*obj, outputs, this->_conf_th, _input_size.width(), _input_size.height(), img.width(), img.height(), landmarks_abs, landmarks_rel);
+            _decode_landmarks(*obj, outputs, _M_inverse, this->_conf_th, _input_size.width(), _input_size.height(), img.width(), img.height(), landmarks_abs, landmarks_rel);
             delete outputs;
             return obj;
         }
 
+        /**
+         * Detect landmarks of all faces in image, faces are cropped by crop_image's method and forwarded by ROIPipeline,
+         * cropping the next face is overlapped with forwarding current face, and batch > 1 model forwards multiple faces together.
+         * @param img source image, format must be the same as model input format.
+         * @param faces face detect results, points of object must start with 2 eyes points, e.g. results of Retinaface or YOLOv8 face model.
+         * @param conf_th landmarks confidence threshold, default 0.5.
+         * @param landmarks_abs output absolute coordinates of points in img, default true.
+         * @param landmarks_rel output relative coordinates of points in model input image, default false.
+         * @param scale crop size scale relative to face rectangle's max side length, default 1.2.
+         * @return landmarks object list, the same order as faces, invalid object's valid is false, you should delete them after use.
+         * @throw If image format not match model input format, will throw err::Exception.
+         * @maixcdk maix.nn.FaceLandmarks.detect_faces
+         */
+        std::vector<nn::FaceLandmarksObject *> detect_faces(image::Image &img, nn::Objects &faces, float conf_th = 0.5, bool landmarks_abs = true, bool landmarks_rel = false, float scale = 1.2)
+        {
+            if (img.format() != _input_img_fmt)
+            {
+                throw err::Exception("image format not match, input_type: " + image::fmt_names[_input_img_fmt] + ", image format: " + image::fmt_names[img.format()]);
+            }
+            if(!landmarks_abs && !landmarks_rel)
+            {
+                throw err::Exception(err::ERR_ARGS);
+            }
+            this->_conf_th = conf_th;
+            std::vector<nn::FaceLandmarksObject *> res;
+            std::vector<cv::Mat> M, M_inverse(faces.size());
+            for (size_t i = 0; i < faces.size(); ++i)
+            {
+                nn::Object &face = faces.at(i);
+                nn::FaceLandmarksObject *obj = new nn::FaceLandmarksObject();
+                obj->points.resize((landmarks_abs && landmarks_rel)? landmarks_num * 4 : landmarks_num * 2, 0);
+                obj->points_z.resize(landmarks_num, 0);
+                res.push_back(obj);
+                M.push_back(_crop_affine(face.x, face.y, face.w, face.h, face.points, _input_size.width(), _input_size.height(), scale));
+                cv::invertAffineTransform(M.back(), M_inverse[i]);
+            }
+            auto prepare = [&](int idx, image::Image &dst) -> err::Err {
+                ROIPipeline::warp_affine(img, dst, (const double *)M[idx].data, image::ResizeMethod::NEAREST);
+                return err::ERR_NONE;
+            };
+            auto collect = [&](int idx, tensor::Tensors &outputs) {
+                _decode_landmarks(*res[idx], &outputs, M_inverse[idx], conf_th, _input_size.width(), _input_size.height(), img.width(), img.height(), landmarks_abs, landmarks_rel);
+            };
+            err::Err e = _pipeline->run(faces.size(), prepare, collect);
+            if (e != err::ERR_NONE)
+                log::warn("face landmarks forward failed: %s", err::to_str(e).c_str());
+            return res;
+        }
+
         /**
          * Crop image from source image by 2 points(2 eyes)
          * @param x,y,w,h face rectangle, x,y is left-top point.
@@ -284,23 +347,7 @@ namespace maix::nn
                 new_width = _input_size.width();
             if(new_height == -1)
                 new_height = _input_size.height();
-            int cx = x + w * 0.5;
-            int cy = y + h * 0.5;
-            int new_size = w > h ? w : h;
-            new_size *= scale;
-            float theta = atan2(points[3] - points[1], points[2] - points[0]);
-            cv::Mat A = (cv::Mat_<float>(4, 2) << -1, -1, -1, 1, 1, 1, 1, -1);
-            cv::Mat R = (cv::Mat_<float>(2, 2) << cos(theta), sin(theta), -sin(theta), cos(theta));
-            cv::Mat C;
-            float half_w = new_size * 0.5;
-            cv::gemm(A, R, half_w, cv::Mat(), 0.0, C);
-            for (int i = 0; i < C.rows; ++i) {
-                C.at<float>(i, 0) += cx;
-                C.at<float>(i, 1) += cy;
-            }
-            cv::Mat element = C(cv::Range(0, 3), cv::Range(0, 2));
-            cv::Mat dst = (cv::Mat_<float>(3, 2) << 0, 0, 0, new_height, new_width, new_height);
-            auto M = cv::getAffineTransform(element, dst);
+            auto M = _crop_affine(x, y, w, h, points, new_width, new_height, scale);
             image::Image *img_dst = new image::Image(new_width, new_height, image::FMT_RGB888);
             if(!img_dst)
             {
@@ -440,12 +487,35 @@ namespace maix::nn
         image::Size _input_size;
         image::Format _input_img_fmt;
         nn::NN *_model;
+        nn::ROIPipeline *_pipeline;
         std::map<string, string> _extra_info;
         float _conf_th = 0.5;
         cv::Mat _M_inverse;
 
     private:
-        void _decode_landmarks(nn::FaceLandmarksObject &obj, tensor::Tensors *outputs, float conf_th, int input_w, int input_h, int img_w, int img_h, bool landmarks_abs, bool landmarks_rel)
+        // affine matrix maps face area rotated by 2 eyes to new_width x new_height image
+        cv::Mat _crop_affine(int x, int y, int w, int h, const std::vector<int> &points, int new_width, int new_height, float scale)
+        {
+            int cx = x + w * 0.5;
+            int cy = y + h * 0.5;
+            int new_size = w > h ? w : h;
+            new_size *= scale;
+            float theta = atan2(points[3] - points[1], points[2] - points[0]);
+            cv::Mat A = (cv::Mat_<float>(4, 2) << -1, -1, -1, 1, 1, 1, 1, -1);
+            cv::Mat R = (cv::Mat_<float>(2, 2) << cos(theta), sin(theta), -sin(theta), cos(theta));
+            cv::Mat C;
+            float half_w = new_size * 0.5;
+            cv::gemm(A, R, half_w, cv::Mat(), 0.0, C);
+            for (int i = 0; i < C.rows; ++i) {
+                C.at<float>(i, 0) += cx;
+                C.at<float>(i, 1) += cy;
+            }
+            cv::Mat element = C(cv::Range(0, 3), cv::Range(0, 2));
+            cv::Mat dst = (cv::Mat_<float>(3, 2) << 0, 0, 0, new_height, new_width, new_height);
+            return cv::getAffineTransform(element, dst);
+        }
+
+        void _decode_landmarks(nn::FaceLandmarksObject &obj, tensor::Tensors *outputs, cv::Mat &M_inverse, float conf_th, int input_w, int input_h, int img_w, int img_h, bool landmarks_abs, bool landmarks_rel)
         {
             bool z_filled = false;
             tensor::Tensor *score_out = NULL; // shape 1, 1, 1, 1
@@ -472,7 +542,7 @@ namespace maix::nn
                 return;
             }
             obj.valid = true;
-            if(_M_inverse.empty() || !landmarks_abs)
+            if(M_inverse.empty() || !landmarks_abs)
             {
                 landmarks_abs = false;
                 landmarks_rel = true;
@@ -480,7 +550,7 @@ namespace maix::nn
             else
             {
                 cv::Mat iM;
-                cv::transpose(_M_inverse, iM);
+                cv::transpose(M_inverse, iM);
                 cv::Mat A = cv::Mat_<double>(landmarks_num, 3);
                 for (int i = 0; i < A.rows; ++i) {
                     A.at<double>(i, 0) = points[i*3];
@@ -495,7 +565,7 @@ namespace maix::nn
                     obj.points[2*i] = C.at<double>(i, 0);
                     obj.points[2*i + 1] = C.at<double>(i, 1);
                 }
-                _M_inverse.release();
+                M_inverse.release();
             }
             if(landmarks_rel)
             {
@@ -3,6 +3,8 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2024.5.17: Create this file.
+ * @update 2026.10.18: Run feature model of all faces by ROIPipeline.
+ * @update 2026.10.18: Store faces in FeatureIndex gallery.
  */
 
 #pragma once
@@ -15,6 +17,8 @@
 #include "maix_nn_face_detector.hpp"
 #include "maix_nn_retinaface.hpp"
 #include "maix_nn_yolov8.hpp"
+#include "maix_nn_roi_pipeline.hpp"
+#include "maix_nn_feature_index.hpp"
 
 #include <fstream>
 #include <sstream>
@@ -275,6 +279,7 @@ namespace maix::nn
         FaceRecognizer(const string &detect_model = "", const string &feature_model = "", bool dual_buff = true)
         {
             _model_feature = nullptr;
+            _pipeline = nullptr;
             labels.push_back("unknown");
             _facedetector = nullptr;
             _facedetector_retina = nullptr;
@@ -307,6 +312,11 @@ namespace maix::nn
                 delete _facedetector_yolov8;
                 _facedetector_yolov8 = nullptr;
             }
+            if (_pipeline)
+            {
+                delete _pipeline;
+                _pipeline = nullptr;
+            }
             if (_model_feature)
             {
                 delete _model_feature;
@@ -375,6 +385,11 @@ namespace maix::nn
             }
 
             // feature extract model
+            if (_pipeline)
+            {
+                delete _pipeline;
+                _pipeline = nullptr;
+            }
             if (_model_feature)
             {
                 delete _model_feature;
@@ -503,6 +518,7 @@ namespace maix::nn
                 (int)(70.7299f * _feature_input_size / 112),
                 (int)(92.2041f * _feature_input_size / 112),
             };
+            _pipeline = new nn::ROIPipeline(_model_feature, _input_img_fmt, this->mean_feature, this->scale_feature);
             return err::ERR_NONE;
         }
 
@@ -523,7 +539,11 @@ namespace maix::nn
         {
             this->_conf_th = conf_th;
             this->_iou_th = iou_th;
-            std::vector<nn::Object> *objs;
+            if (img.format() != _input_img_fmt)
+            {
+                throw err::Exception("image format not match, input_type: " + image::fmt_names[_input_img_fmt] + ", image format: " + image::fmt_names[img.format()]);
+            }
+            std::vector<nn::Object> *objs = nullptr;
             nn::Objects *objs2 = nullptr;
             if(_facedetector)
                 objs = _facedetector->detect(img, _conf_th, _iou_th, fit);
@@ -533,34 +553,31 @@ namespace maix::nn
                 objs2 = _facedetector_yolov8->detect(img, _conf_th, _iou_th, fit);
             FaceObjects *faces = new nn::FaceObjects();
             size_t size = objs2 ? objs2->size() : objs->size();
-            for (size_t i = 0; i < size; ++i)
-            {
-                nn::Object *obj = objs2 ? &objs2->at(i) : &objs->at(i);
-                // get std face
-                image::Image *std_img = img.affine(obj->points, _std_points, _feature_input_size, _feature_input_size);
-                // img.save("/root/test0.jpg");
-                // std_img->save("/root/test.jpg");
-                tensor::Tensors *outputs = _model_feature->forward_image(*std_img, this->mean_feature, this->scale_feature, fit, false, true);
-                if (!outputs) // not ready for dual_buff mode
-                {
-                    delete std_img;
-                    return new FaceObjects();
-                }
-                tensor::Tensor *out = outputs->tensors[outputs->keys()[0]];
+            std::vector<image::Image *> face_imgs(get_face ? size : 0, nullptr);
+            auto get_obj = [&](int idx) -> nn::Object * {
+                return objs2 ? &objs2->at(idx) : &objs->at(idx);
+            };
+            // get std face, run in pipeline worker while the previous face is forwarding
+            auto prepare = [&](int idx, image::Image &dst) -> err::Err {
+                ROIPipeline::warp_points(img, dst, get_obj(idx)->points, _std_points);
+                if (get_face)
+                    face_imgs[idx] = dst.copy();
+                return err::ERR_NONE;
+            };
+            auto collect = [&](int idx, tensor::Tensors &outputs) {
+                nn::Object *obj = get_obj(idx);
+                tensor::Tensor *out = outputs.tensors[outputs.keys()[0]];
                 int fea_len = out->size_int();
                 float *feature = (float *)out->data();
                 // compare feature from DB
                 float max_score = 0;
                 int max_i = -1;
-                for (size_t i = 0; i < features.size(); ++i)
+                if (_gallery.size() > 0 && fea_len == _gallery.dim())
                 {
-                    float score = _feature_compare(feature, features[i].data(), fea_len);
-                    if (score > max_score)
-                    {
-                        max_score = score;
-                        if(score > compare_th)
-                            max_i = i;
-                    }
+                    auto top = _gallery.search(feature, 1);
+                    max_score = top[0].second;
+                    if(max_score > compare_th)
+                        max_i = top[0].first;
                 }
                 {
                     faces->add(obj->x, obj->y, obj->w, obj->h, max_i + 1, max_score);
@@ -573,11 +590,16 @@ namespace maix::nn
                 }
                 if(get_face)
                 {
-                    face1.face = *std_img;
+                    face1.face = *face_imgs[idx];
                 }
-                delete std_img;
-                delete outputs;
-            }
+            };
+            err::Err e = _pipeline->run(size, prepare, collect);
+            if (e != err::ERR_NONE)
+                log::warn("face feature forward failed: %s", err::to_str(e).c_str());
+            for (auto face_img : face_imgs)
+                delete face_img;
+            delete objs;
+            delete objs2;
             return faces;
         }
 
@@ -594,6 +616,10 @@ namespace maix::nn
                 log::error("face no feature");
                 return err::ERR_ARGS;
             }
+            if (_gallery.add(face->feature.data(), face->feature.size()) < 0)
+            {
+                return err::ERR_ARGS;
+            }
             labels.push_back(label);
             features.push_back(face->feature);
             return err::ERR_NONE;
@@ -625,10 +651,12 @@ namespace maix::nn
                     }
                 }
             }
-            if (idx >= 0 && (size_t)idx < features.size())
+            if (idx >= 0 && idx < _gallery.size())
             {
-                features.erase(features.begin() + idx);
+                _gallery.remove(idx);
                 labels.erase(labels.begin() + idx + 1);
+                if (idx < (int)features.size())
+                    features.erase(features.begin() + idx);
                 return err::ERR_NONE;
             }
             log::error("idx value error: %d", idx);
@@ -649,35 +677,36 @@ namespace maix::nn
             {
                 return e;
             }
-            fs::File *f = fs::open(path, "w");
-            if (!f)
-            {
-                return err::ERR_IO;
-            }
-            for (size_t i = 0; i < features.size(); ++i)
-            {
-                // name + \0 + fea_len(2B) + feature
-                f->write(labels[i + 1].c_str(), (int)labels[i + 1].size());
-                f->write("\0", 1);
-                uint16_t len = (uint16_t)features[i].size();
-                f->write(&len, 2);
-                f->write(features[i].data(), features[i].size() * sizeof(float));
-            }
-            f->flush();
-            f->close();
-            delete f;
-            return err::ERR_NONE;
+            return _gallery.save(path, std::vector<std::string>(labels.begin() + 1, labels.end()));
         }
 
         /**
-         * Load faces info from a file
+         * Load faces info from a file, file saved by old version is also supported.
          * @param path from where to load, string type.
          * @return err::Err type
          * @maixpy maix.nn.FaceRecognizer.load_faces
          */
         err::Err load_faces(const std::string &path)
         {
-            // Open the file
+            if (FeatureIndex::is_index_file(path))
+            {
+                std::vector<std::string> names;
+                err::Err e = _gallery.load(path, &names);
+                labels.clear();
+                labels.push_back("unknown");
+                if (e != err::ERR_NONE)
+                {
+                    _gallery.clear();
+                    _sync_features();
+                    return e;
+                }
+                names.resize(_gallery.size());
+                labels.insert(labels.end(), names.begin(), names.end());
+                _sync_features();
+                return err::ERR_NONE;
+            }
+
+            // old format: name + \0 + fea_len(2B) + feature
             fs::File *f = fs::open(path, "r");
             if (!f)
             {
@@ -685,6 +714,7 @@ namespace maix::nn
             }
 
             // Clear current data
+            _gallery.clear();
             features.clear();
             labels.clear();
             labels.push_back("unknown");
@@ -695,10 +725,17 @@ namespace maix::nn
                 std::string label;
                 char ch;
                 // Read label until '\0'
-                while (f->read(&ch, 1) && ch != '\0')
+                int read_num = 0;
+                while (f->read(&ch, 1) == 1)
                 {
+                    ++read_num;
+                    if (ch == '\0')
+                        break;
                     label += ch;
                 }
+                // eof flag is only set after read past the last record
+                if (read_num == 0)
+                    break;
 
                 // Read the length of the feature vector
                 uint16_t len;
@@ -721,6 +758,12 @@ namespace maix::nn
                 }
 
                 // Add the data to the vectors
+                if (_gallery.add(feature.data(), len) < 0)
+                {
+                    f->close();
+                    delete f;
+                    return err::ERR_ARGS;
+                }
                 labels.push_back(label);
                 features.push_back(feature);
             }
@@ -803,15 +846,51 @@ namespace maix::nn
         std::vector<std::string> labels;
 
         /**
-         * features
+         * features of faces in lib, list type, kept for compatibility, read only,
+         * raw features of faces added by add_face or loaded from old version file,
+         * normalized features of faces loaded from file saved by this version, because faces file only keeps normalized features.
+         * use add_face and remove_face to modify faces, use faces_num and get_feature instead is recommended.
          * @maixpy maix.nn.FaceRecognizer.features
          */
         std::vector<std::vector<float>> features;
 
+        /**
+         * Get faces number in lib
+         * @return faces number
+         * @maixpy maix.nn.FaceRecognizer.faces_num
+         */
+        int faces_num()
+        {
+            return _gallery.size();
+        }
+
+        /**
+         * Get feature of face in lib
+         * @param idx index of face in lib, value [0,face_num).
+         * @return feature, normalized, empty if idx out of range.
+         * @maixpy maix.nn.FaceRecognizer.get_feature
+         */
+        std::vector<float> get_feature(int idx)
+        {
+            return _gallery.get(idx);
+        }
+
+        /**
+         * Get faces lib, e.g. call gallery().reset(0, nn::IndexMetric::COSINE, nn::IndexDType::INT8) before add faces to reduce memory,
+         *         features attribute is not updated if faces are modified by gallery() directly.
+         * @return faces feature index
+         * @maixcdk maix.nn.FaceRecognizer.gallery
+         */
+        nn::FeatureIndex &gallery()
+        {
+            return _gallery;
+        }
+
     private:
         image::Size _input_size;
         image::Format _input_img_fmt;
         nn::NN *_model_feature;
+        nn::ROIPipeline *_pipeline;
         std::map<string, string> _extra_info;
         std::map<string, string> _extra_info2;
         float _conf_th = 0.5;
@@ -824,21 +903,15 @@ namespace maix::nn
         int _feature_input_size;
         bool _dual_buff;
         std::vector<int> _std_points;
+        nn::FeatureIndex _gallery;
 
     private:
-        float _feature_compare(float *ftr0, float *ftr1, int len)
+        // materialize features from gallery after loaded from index file, raw features are not saved in it
+        void _sync_features()
         {
-            double sumcorr = 0;
-            double sumftr0 = 0;
-            double sumftr1 = 0;
-
-            for (int i = 0; i < len; i++)
-            {
-                sumftr0 += ftr0[i] * ftr0[i];
-                sumftr1 += ftr1[i] * ftr1[i];
-                sumcorr += ftr0[i] * ftr1[i];
-            }
-            return (0.5 + 0.5 * sumcorr / sqrt(sumftr0 * sumftr1));
+            features.resize(_gallery.size());
+            for (int i = 0; i < _gallery.size(); ++i)
+                features[i] = _gallery.get(i);
         }
 
         static void split0(std::vector<std::string> &items, const std::string &s, const std::string &delimiter)
@@ -0,0 +1,182 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Create this file, add feature vector index for face and self learn galleries.
+ */
+
+#pragma once
+
+#include "maix_basic.hpp"
+#include <vector>
+#include <string>
+#include <utility>
+
+namespace maix::nn
+{
+    /**
+     * Feature index metric
+     * @maixcdk maix.nn.IndexMetric
+     */
+    enum class IndexMetric
+    {
+        COSINE = 0, // score = 0.5 + 0.5 * cos(a, b), value [0, 1], bigger is more similar
+        L2,         // score = |a - b|, smaller is more similar
+    };
+
+    /**
+     * Feature index storage data type
+     * @maixcdk maix.nn.IndexDType
+     */
+    enum class IndexDType
+    {
+        FLOAT32 = 0,
+        FLOAT16,    // half memory, about 3 decimal digits precision
+        INT8,       // quarter memory, symmetric quantized with one scale every row
+    };
+
+    /**
+     * Feature vectors index, e.g. face recognize gallery and self learn classifier classes.
+     * Vectors are stored row major in one contiguous buffer, optionally quantized to float16 or int8,
+     * search calculates dot product of query and every row by NEON or SSE if available, and keeps top k by a heap instead of sort all.
+     * Saved file can be memory mapped when load, rows are only copied to memory when index is modified.
+     * @maixcdk maix.nn.FeatureIndex
+     */
+    class FeatureIndex
+    {
+    public:
+        /**
+         * Construct feature index
+         * @param dim feature dimension, 0 means set by the first added feature.
+         * @param metric search metric, COSINE vectors are normalized when add.
+         * @param dtype storage data type.
+         * @maixcdk maix.nn.FeatureIndex.FeatureIndex
+         */
+        FeatureIndex(int dim = 0, IndexMetric metric = IndexMetric::COSINE, IndexDType dtype = IndexDType::FLOAT32);
+        ~FeatureIndex();
+        FeatureIndex(const FeatureIndex &) = delete;
+        FeatureIndex &operator=(const FeatureIndex &) = delete;
+
+        /**
+         * Remove all features and set new dimension, metric and data type
+         * @maixcdk maix.nn.FeatureIndex.reset
+         */
+        void reset(int dim = 0, IndexMetric metric = IndexMetric::COSINE, IndexDType dtype = IndexDType::FLOAT32);
+
+        /**
+         * Add feature to the end
+         * @param feature feature data, length is dim().
+         * @param len feature length, must equal to dim() if dim() is not 0.
+         * @return index of added feature, -1 if len not match.
+         * @maixcdk maix.nn.FeatureIndex.add
+         */
+        int add(const float *feature, int len);
+
+        /**
+         * Replace feature
+         * @param idx index of feature, [0, size()).
+         * @maixcdk maix.nn.FeatureIndex.set
+         */
+        err::Err set(int idx, const float *feature);
+
+        /**
+         * Remove feature, features after it move forward, so indexes keep the add order.
+         * @param idx index of feature, [0, size()).
+         * @maixcdk maix.nn.FeatureIndex.remove
+         */
+        err::Err remove(int idx);
+
+        /**
+         * Remove all features, dimension, metric and data type are kept.
+         * @maixcdk maix.nn.FeatureIndex.clear
+         */
+        void clear();
+
+        /**
+         * Get feature, quantized data is converted to float, COSINE metric feature is normalized.
+         * @maixcdk maix.nn.FeatureIndex.get
+         */
+        std::vector<float> get(int idx);
+
+        /**
+         * Search top k similar features
+         * @param query query feature, length is dim().
+         * @param k result number, <= 0 means all.
+         * @return list of (index, score), sorted from most similar, score see IndexMetric.
+         * @maixcdk maix.nn.FeatureIndex.search
+         */
+        std::vector<std::pair<int, float>> search(const float *query, int k = 1);
+
+        /**
+         * Save to file, the file can be memory mapped by load.
+         * @param path file path.
+         * @param labels labels of features, empty or size() items.
+         * @maixcdk maix.nn.FeatureIndex.save
+         */
+        err::Err save(const std::string &path, const std::vector<std::string> &labels = std::vector<std::string>());
+
+        /**
+         * Load from file saved by save, dimension, metric and data type are set by file.
+         * @param path file path.
+         * @param labels if not nullptr, labels in file will be stored to it.
+         * @param mmap true to memory map file, rows are copied only when index modified, false to read all to memory.
+         * @return err::ERR_ARGS if file is not index file, err::ERR_IO if read failed.
+         * @maixcdk maix.nn.FeatureIndex.load
+         */
+        err::Err load(const std::string &path, std::vector<std::string> *labels = nullptr, bool mmap = true);
+
+        /**
+         * Check if file is saved by FeatureIndex
+         * @maixcdk maix.nn.FeatureIndex.is_index_file
+         */
+        static bool is_index_file(const std::string &path);
+
+        /**
+         * Features number
+         * @maixcdk maix.nn.FeatureIndex.size
+         */
+        int size() { return _num; }
+
+        /**
+         * Feature dimension
+         * @maixcdk maix.nn.FeatureIndex.dim
+         */
+        int dim() { return _dim; }
+
+        /**
+         * Search metric
+         * @maixcdk maix.nn.FeatureIndex.metric
+         */
+        IndexMetric metric() { return _metric; }
+
+        /**
+         * Storage data type
+         * @maixcdk maix.nn.FeatureIndex.dtype
+         */
+        IndexDType dtype() { return _dtype; }
+
+    private:
+        int _dim;
+        IndexMetric _metric;
+        IndexDType _dtype;
+        int _num;
+        size_t _row_bytes;
+        // rows, row scales(INT8) and squared norms, point to mapped file or own buffers
+        const uint8_t *_rows;
+        const float *_scales;
+        const float *_norms;
+        std::vector<uint8_t> _rows_buf;
+        std::vector<float> _scales_buf;
+        std::vector<float> _norms_buf;
+        void *_map;
+        size_t _map_size;
+        std::vector<float> _tmp;    // normalized query or feature
+        std::vector<int8_t> _tmp_i8;
+
+        void _unmap();
+        void _own();
+        void _encode(const float *feature, uint8_t *row, float &scale, float &norm);
+        float _prepare_query(const float *query, float &scale);
+        float _dot(int idx, float query_scale);
+    };
+} // namespace maix::nn
@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2024-
  * @license Apache 2.0
  * @update 2024.12.27: Add hand keypoints support.
+ * @update 2026.10.18: Run landmarks model of all hands by ROIPipeline.
  */
 
 #pragma once
@@ -12,6 +13,7 @@
 #include "maix_image_cv.hpp"
 #include "maix_nn_F.hpp"
 #include "maix_nn_object.hpp"
+#include "maix_nn_roi_pipeline.hpp"
 #include <math.h>
 
 #define DRAW_STD_IMG 0
@@ -36,6 +38,7 @@ namespace maix::nn
         {
             _model = nullptr;
             _model_detect = nullptr;
+            _pipeline = nullptr;
             if (!model.empty())
             {
                 err::Err e = load(model);
@@ -48,6 +51,11 @@ namespace maix::nn
 
         ~HandLandmarks()
         {
+            if (_pipeline)
+            {
+                delete _pipeline;
+                _pipeline = nullptr;
+            }
             if (_model_detect)
             {
                 delete _model_detect;
@@ -68,6 +76,11 @@ namespace maix::nn
          */
         err::Err load(const string &model)
         {
+            if (_pipeline)
+            {
+                delete _pipeline;
+                _pipeline = nullptr;
+            }
             if (_model)
             {
                 delete _model;
@@ -233,6 +246,7 @@ namespace maix::nn
                 log::error("detect_model key not found");
                 return err::ERR_ARGS;
             }
+            _pipeline = new nn::ROIPipeline(_model, _input_img_fmt, this->mean, this->scale);
 
             return err::ERR_NONE;
         }
@@ -288,26 +302,23 @@ namespace maix::nn
                 objs = _nms(*objs);
                 delete objects_total;
             }
-            std::vector<cv::Mat> M_inverse;
-            std::vector<image::Image *> landmarks_input = _crop_reize_hand(*objs, img, _input_size.width(), _input_size.height(), M_inverse, landmarks_rel);
-            #if DRAW_STD_IMG
-                int y=0;
-            #endif
+            std::vector<cv::Mat> M, M_inverse;
+            _hand_affine(*objs, _input_size.width(), _input_size.height(), M, M_inverse, landmarks_rel);
             bool have_invalid = false;
-            for(size_t i=0; i<landmarks_input.size(); ++i)
-            {
+            auto prepare = [&](int idx, image::Image &dst) -> err::Err {
+                ROIPipeline::warp_affine(img, dst, (const double *)M[idx].data, image::ResizeMethod::NEAREST);
                 #if DRAW_STD_IMG
-                    img.draw_image(0, y, *landmarks_input[i]);
-                    y += landmarks_input[i]->height();
+                    img.draw_image(0, idx * dst.height(), dst);
                 #endif
-                outputs = _model->forward_image(*landmarks_input[i], this->mean, this->scale, fit, false, true, false);
-                delete landmarks_input[i];
-                if (!outputs) // not ready, return empty result.
-                {
-                    return objs;
-                }
-                have_invalid |= _decode_landmarks(*objs, i, outputs, conf_th2, M_inverse, _input_size.width(), _input_size.height(), img.width(), img.height(), landmarks_rel);
-                delete outputs;
+                return err::ERR_NONE;
+            };
+            auto collect = [&](int idx, tensor::Tensors &outputs) {
+                have_invalid |= _decode_landmarks(*objs, idx, &outputs, conf_th2, M_inverse, _input_size.width(), _input_size.height(), img.width(), img.height(), landmarks_rel);
+            };
+            if (_pipeline->run(objs->size(), prepare, collect) != err::ERR_NONE) // not ready, return empty result.
+            {
+                delete objs;
+                return new nn::Objects();
             }
             if(have_invalid)
             {
@@ -490,6 +501,7 @@ namespace maix::nn
         image::Format _input_img_fmt;
         nn::NN *_model;
         nn::NN *_model_detect;
+        nn::ROIPipeline *_pipeline;
         std::map<string, string> _extra_info;
         float _conf_th = 0.7;
         float _iou_th = 0.45;
@@ -558,9 +570,9 @@ namespace maix::nn
             }
         }
 
-        std::vector<image::Image *> _crop_reize_hand(nn::Objects &objs, image::Image &img, int input_w, int input_h, std::vector<cv::Mat> &M_inverse, bool landmarks_rel)
+        // calculate hand box and affine matrix of every hand, M maps image to landmarks model input
+        void _hand_affine(nn::Objects &objs, int input_w, int input_h, std::vector<cv::Mat> &M, std::vector<cv::Mat> &M_inverse, bool landmarks_rel)
         {
-            std::vector<image::Image *> res;
             float dscale = 2.6;
             for (size_t i = 0; i < objs.size(); ++i)
             {
@@ -590,24 +602,11 @@ namespace maix::nn
                 obj.h = hand_size;
                 cv::Mat element = C(cv::Range(0, 3), cv::Range(0, 2));
                 cv::Mat dst = (cv::Mat_<float>(3, 2) << 0, 0, 0, input_h, input_w, input_h);
-                auto M = cv::getAffineTransform(element, dst);
-                image::Image *img_dst = new image::Image(input_w, input_h, image::FMT_RGB888);
-                if(!img_dst)
-                {
-                    log::error("no memory");
-                    break;
-                }
-                cv::Mat img_dst2(input_h, input_w, CV_8UC3, img_dst->data());
-                cv::Mat img_src;
-                image::image2cv(img, img_src, false, false);
-                cv::warpAffine(img_src, img_dst2, M, cv::Size(input_w, input_h), cv::INTER_NEAREST);
-                assert(img_dst2.data() == img_dst->data());
-                res.push_back(img_dst);
+                M.push_back(cv::getAffineTransform(element, dst));
                 cv::Mat iM;
-                cv::invertAffineTransform(M, iM);
+                cv::invertAffineTransform(M.back(), iM);
                 M_inverse.push_back(iM);
             }
-            return res;
         }
 
         bool _decode_landmarks(nn::Objects &objs, int idx, tensor::Tensors *outputs, float conf_th2, std::vector<cv::Mat> &M_inverse, int input_w, int input_h, int img_w, int img_h, bool landmarks_rel)
@@ -0,0 +1,113 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Create this file, add compiled lexicon for TTS G2P.
+ */
+
+#pragma once
+
+#include "maix_basic.hpp"
+#include <vector>
+
+namespace maix::nn
+{
+    /**
+     * Compiled lexicon, word to phones and tones, used by TTS G2P.
+     * Text lexicon and tokens files are compiled to one binary file of double array tries(darts-clone) and a flat phones/tones table,
+     * binary file is memory mapped when load, no parse and no heap allocation for entries, pages are loaded by kernel when used.
+     * Text lexicon format: one word per line, `word phone1 phone2 ... tone1 tone2 ...`, phones and tones have the same number.
+     * Text tokens format: one token per line, `token id`.
+     * @maixcdk maix.nn.Lexicon
+     */
+    class Lexicon
+    {
+    public:
+        /**
+         * Lexicon entry, points to mapped memory, valid until lexicon unload.
+         * @maixcdk maix.nn.Lexicon.Entry
+         */
+        class Entry
+        {
+        public:
+            const int32_t *phones = nullptr;
+            const int32_t *tones = nullptr;
+            int num = 0;
+        };
+
+        Lexicon();
+        ~Lexicon();
+
+        /**
+         * Compile text lexicon and tokens to binary lexicon file, can be run offline on PC.
+         * @param lexicon_file text lexicon file path.
+         * @param tokens_file text tokens file path.
+         * @param out_file binary lexicon file path.
+         * @return err::ERR_NONE if success, else error code.
+         * @maixcdk maix.nn.Lexicon.compile
+         */
+        static err::Err compile(const std::string &lexicon_file, const std::string &tokens_file, const std::string &out_file);
+
+        /**
+         * Load binary lexicon by mmap
+         * @param file binary lexicon file path, created by compile.
+         * @return err::ERR_NONE if success, else error code.
+         * @maixcdk maix.nn.Lexicon.load
+         */
+        err::Err load(const std::string &file);
+
+        /**
+         * Load text lexicon, compiled binary lexicon cache_file is used if it's newer than text files,
+         * else compile and save to cache_file then load it, if save failed, compiled lexicon is kept in memory.
+         * @param lexicon_file text lexicon file path.
+         * @param tokens_file text tokens file path.
+         * @param cache_file binary lexicon file path, empty means lexicon_file + ".bin".
+         * @return err::ERR_NONE if success, else error code.
+         * @maixcdk maix.nn.Lexicon.load
+         */
+        err::Err load(const std::string &lexicon_file, const std::string &tokens_file, const std::string &cache_file = "");
+
+        /**
+         * Unload lexicon
+         * @maixcdk maix.nn.Lexicon.unload
+         */
+        void unload();
+
+        /**
+         * Words number
+         * @maixcdk maix.nn.Lexicon.size
+         */
+        int size();
+
+        /**
+         * Find word
+         * @param word word string.
+         * @param len word bytes, -1 means strlen(word).
+         * @param entry found entry.
+         * @return true if found.
+         * @maixcdk maix.nn.Lexicon.find
+         */
+        bool find(const char *word, int len, Lexicon::Entry &entry);
+
+        /**
+         * Longest word matches the beginning of text
+         * @param text text string.
+         * @param len text bytes.
+         * @param entry matched entry.
+         * @return matched bytes, 0 if no word matched.
+         * @maixcdk maix.nn.Lexicon.match
+         */
+        int match(const char *text, int len, Lexicon::Entry &entry);
+
+        /**
+         * Get token id
+         * @param token token string.
+         * @return token id, -1 if not found.
+         * @maixcdk maix.nn.Lexicon.token
+         */
+        int token(const std::string &token);
+
+    private:
+        void *_data;
+    };
+} // namespace maix::nn
@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2024-
  * @license Apache 2.0
  * @update 2025.5.20: Add melotts support.
+ * @update 2026.10.18: Add sentence streaming synthesis.
  */
 
 #pragma once
@@ -60,6 +61,21 @@ namespace maix::nn
         */
         Bytes *infer(std::string text, std::string path = "", bool output_pcm = false);
 
+        /**
+         * Text to speech by streaming.
+         * Text is split into sentences at punctuation and synthesized in a background thread,
+         * PCM is passed to callback as soon as every part of sentence decoded, so playback can start before the whole text synthesized,
+         * adjacent sentences are joined with cross-fade. Block until all PCM passed to callback.
+         * @param text input text
+         * @param callback called in the calling thread with 16 bits mono PCM chunk, sample rate is samplerate(),
+         * can be passed to audio.Player.play directly, pcm is released after callback returns.
+         * @param queue_num max chunks synthesized ahead of callback, limit memory when callback is slower than synthesis. default is 4.
+         * @param fade_ms cross-fade length at sentence joins, unit ms, 0 to disable. default is 20.
+         * @return err::ERR_NONE if success, else error code.
+         * @maixpy maix.nn.MeloTTS.infer_stream
+        */
+        err::Err infer_stream(std::string text, std::function<void(Bytes *)> callback, int queue_num = 4, int fade_ms = 20);
+
         /**
          * Get pcm samplerate
          * @return pcm samplerate
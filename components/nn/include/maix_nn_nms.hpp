@@ -0,0 +1,180 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Create this file, add NMS engine shared by detectors.
+ */
+
+#pragma once
+
+#include "maix_basic.hpp"
+#include "maix_nn_object.hpp"
+#include <vector>
+
+namespace maix::nn
+{
+    /**
+     * NMS method
+     */
+    enum class NMSMethod
+    {
+        HARD = 0,      // remove boxes IoU > iou_th with higher score box
+        SOFT_LINEAR,   // score *= (1 - IoU) if IoU > iou_th
+        SOFT_GAUSSIAN, // score *= exp(-IoU^2 / sigma)
+    };
+
+    /**
+     * NMS(Non-Maximum Suppression) engine.
+     * Boxes are stored in structure-of-arrays, candidates sorted by score and compared only with kept boxes of the same class,
+     * IoU of one candidate with kept boxes are calculated 4 boxes a time by NEON or SSE if available, and stop at the first overlap.
+     * Reuse one object to avoid memory allocation every frame.
+     */
+    class NMS
+    {
+    public:
+        /**
+         * Construct NMS engine
+         * @param iou_th IoU threshold.
+         * @param class_agnostic true to suppress boxes of different classes, false only suppress boxes of the same class.
+         * @param max_det max number of kept boxes, <= 0 means no limit.
+         * @param method NMS method, @see NMSMethod.
+         */
+        NMS(float iou_th = 0.45, bool class_agnostic = false, int max_det = -1, NMSMethod method = NMSMethod::HARD);
+
+        /**
+         * Set IoU threshold
+         */
+        void set_iou_th(float iou_th) { _iou_th = iou_th; }
+
+        /**
+         * Set suppress boxes of different classes or not
+         */
+        void set_class_agnostic(bool class_agnostic) { _class_agnostic = class_agnostic; }
+
+        /**
+         * Set max number of kept boxes, <= 0 means no limit
+         */
+        void set_max_det(int max_det) { _max_det = max_det; }
+
+        /**
+         * Set NMS method
+         * @param method NMS method, @see NMSMethod.
+         * @param sigma sigma of SOFT_GAUSSIAN.
+         * @param score_th boxes decayed below this score will be removed, only for soft NMS.
+         */
+        void set_method(NMSMethod method, float sigma = 0.5, float score_th = 0.001);
+
+        /**
+         * Use rotated IoU for boxes with angle, for OBB(oriented bounding box) models.
+         * Angle unit is the same as nn::Object::angle, that is radian / PI, rotate around box center.
+         */
+        void set_rotated(bool rotated) { _rotated = rotated; }
+
+        /**
+         * Remove all boxes, memory is kept for next use.
+         */
+        void clear();
+
+        /**
+         * Reserve memory for boxes
+         */
+        void reserve(int num);
+
+        /**
+         * Add one box
+         * @param x left top x
+         * @param y left top y
+         * @param w width
+         * @param h height
+         * @param score box score
+         * @param class_id class id
+         * @param angle rotate angle, radian / PI, only used when set_rotated(true).
+         * @return box index
+         */
+        int add(float x, float y, float w, float h, float score, int class_id = 0, float angle = 0);
+
+        /**
+         * Add one object box
+         * @return box index, same as index of objects if add all objects in order.
+         */
+        int add(const nn::Object &obj)
+        {
+            return add(obj.x, obj.y, obj.w, obj.h, obj.score, obj.class_id, obj.angle);
+        }
+
+        /**
+         * Add all objects in order
+         */
+        void add(nn::Objects &objs);
+
+        /**
+         * Boxes number
+         */
+        int size() { return (int)_score.size(); }
+
+        /**
+         * Run NMS
+         * @return kept boxes index, sorted by score from high to low, valid until next run or clear.
+         */
+        const std::vector<int> &run();
+
+        /**
+         * Score of box after run, only changed by soft NMS
+         */
+        float score(int idx) { return _cur_score[idx]; }
+
+        /**
+         * Run NMS and keep objects in place, suppressed objects are deleted, kept objects sorted by score from high to low.
+         * Soft NMS will update object score.
+         * @param objs objects to process.
+         * @return kept objects number.
+         */
+        int run(nn::Objects &objs);
+
+        /**
+         * Rotated boxes IoU
+         * @param a box a, [x, y, w, h, angle], angle unit is radian / PI.
+         * @param b box b, [x, y, w, h, angle].
+         * @return IoU of a and b.
+         */
+        static float rotated_iou(const float a[5], const float b[5]);
+
+    private:
+        float _iou_th;
+        bool _class_agnostic;
+        int _max_det;
+        NMSMethod _method;
+        float _sigma;
+        float _soft_score_th;
+        bool _rotated;
+
+        // boxes
+        std::vector<float> _x1;
+        std::vector<float> _y1;
+        std::vector<float> _x2;
+        std::vector<float> _y2;
+        std::vector<float> _area;
+        std::vector<float> _score;
+        std::vector<float> _cur_score;
+        std::vector<float> _angle;
+        std::vector<int> _class;
+
+        // temp
+        std::vector<int> _order;
+        std::vector<int> _keep;
+        std::vector<int> _cand;
+        std::vector<float> _corners; // 8 floats for each box, only for rotated
+        std::vector<float> _kx1;     // kept boxes of current class, continuous for SIMD
+        std::vector<float> _ky1;
+        std::vector<float> _kx2;
+        std::vector<float> _ky2;
+        std::vector<float> _karea;
+        std::vector<int> _kidx;
+
+        void _hard(const int *idx, int num);
+        void _soft(const int *idx, int num);
+        bool _overlap_kept(int i);
+        float _iou(int i, int j);
+    };
+
+} // namespace maix::nn
@@ -327,6 +327,31 @@ namespace maix::nn
             return err::ERR_NONE;
         }
 
+        /**
+         * Keep objects at idxes in the given order, delete others.
+         * @param idxes index of objects to keep, should not repeat.
+         * @maixcdk maix.nn.Objects.keep
+         */
+        void keep(const std::vector<int> &idxes)
+        {
+            std::vector<Object *> kept;
+            kept.reserve(idxes.size());
+            for (int idx : idxes)
+            {
+                kept.push_back(objs.at(idx));
+                objs[idx] = NULL;
+            }
+            for (Object *obj : objs)
+            {
+                if (!obj)
+                    continue;
+                if (obj->seg_mask)
+                    delete obj->seg_mask;
+                delete obj;
+            }
+            objs.swap(kept);
+        }
+
         /**
          * Get object item
          * @maixpy maix.nn.Objects.at
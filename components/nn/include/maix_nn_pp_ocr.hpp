@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2024.9.19: Add PP OCR support
+ * @update 2026.10.18: Run recognize model of all text lines by ROIPipeline.
  */
 
 #pragma once
@@ -12,6 +13,7 @@
 #include "maix_nn_F.hpp"
 #include "maix_nn_object.hpp"
 #include "maix_nn_ocr_object.hpp"
+#include "maix_nn_roi_pipeline.hpp"
 
 namespace maix::nn
 {
@@ -33,6 +35,7 @@ namespace maix::nn
         {
             _model = nullptr;
             _rec_model = nullptr;
+            _rec_pipeline = nullptr;
             this->det = false;
             this->rec = false;
             if (!model.empty())
@@ -47,6 +50,11 @@ namespace maix::nn
 
         ~PP_OCR()
         {
+            if (_rec_pipeline)
+            {
+                delete _rec_pipeline;
+                _rec_pipeline = nullptr;
+            }
             if (_model)
             {
                 delete _model;
@@ -67,6 +75,11 @@ namespace maix::nn
         */
         err::Err load(const string &model)
         {
+            if (_rec_pipeline)
+            {
+                delete _rec_pipeline;
+                _rec_pipeline = nullptr;
+            }
             if (_model)
             {
                 delete _model;
@@ -314,6 +327,7 @@ namespace maix::nn
                     log::error("input width not match, model need: %lld, actual: %lld", _max_ch_num * 8, _rec_input_size.width());
                     return err::ERR_ARGS;
                 }
+                _rec_pipeline = new nn::ROIPipeline(_rec_model, _input_img_fmt, this->rec_mean, this->rec_scale);
             }
             return err::ERR_NONE;
         }
@@ -391,8 +405,8 @@ namespace maix::nn
             {
                 throw err::Exception(err::ERR_NO_MEM);
             }
-            _recognize(img, box, obj->idx_list, char_list, obj->char_pos, crop);
-            obj->update_chars(char_list);
+            std::vector<nn::OCR_Object *> objs = {obj};
+            _recognize(img, objs, crop);
             return obj;
         }
 
@@ -523,6 +537,7 @@ namespace maix::nn
         image::Format _input_img_fmt;
         nn::NN *_model;
         nn::NN *_rec_model;
+        nn::ROIPipeline *_rec_pipeline;
         std::map<string, string> _extra_info;
         float _thresh = 0.3;
         float _box_thresh = 0.6;
@@ -561,7 +576,7 @@ namespace maix::nn
 
         nn::OCR_Objects *_post_process(image::Image &img, tensor::Tensors *outputs, int img_w, int img_h, maix::image::Fit fit);
 
-        void _recognize(image::Image &img, const nn::OCR_Box &box, std::vector<int> &idx_list, std::vector<std::string> &char_list, std::vector<int> &char_pos, bool crop);
+        void _recognize(image::Image &img, std::vector<nn::OCR_Object *> &objs, bool crop);
 
         // void _get_layer_objs(std::vector<nn::Object> &objs, tensor::Tensor &output, int layer_i, int layer_num)
         // {
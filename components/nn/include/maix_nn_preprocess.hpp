@@ -0,0 +1,108 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Create this file, add fused image preprocess for model input.
+ */
+
+#pragma once
+
+#include "maix_basic.hpp"
+#include "maix_image.hpp"
+
+namespace maix::nn
+{
+    /**
+     * Image preprocess engine for model input.
+     * Resize(with fit), convert color format, normalize and reorder layout in one pass,
+     * read from image::Image and write to model input buffer directly, no temporary image is created.
+     * Output rows are split to OpenMP threads, vertical resample, color convert and normalize use NEON or SSE if available.
+     */
+    class ImagePreprocess
+    {
+    public:
+        /**
+         * Construct preprocess engine
+         * @param width model input width
+         * @param height model input height
+         * @param format model input color format, only support image::FMT_RGB888, image::FMT_BGR888, image::FMT_GRAYSCALE.
+         * @param dtype model input data type, support tensor::FLOAT32, tensor::UINT8, tensor::INT8.
+         * @param chw true for NCHW layout, false for NHWC layout.
+         * @param mean mean value, empty means 0, output = (pixel - mean) * scale, UINT8 dtype will ignore mean and scale.
+         * @param scale scale value, empty means 1.
+         * @param method resize method, only support image::ResizeMethod::NEAREST and image::ResizeMethod::BILINEAR, others will use BILINEAR,
+         *               default BILINEAR, the same as image::Image::resize.
+         * @throw If args error, will throw err::Exception.
+         */
+        ImagePreprocess(int width, int height, image::Format format, tensor::DType dtype, bool chw,
+                        const std::vector<float> &mean = std::vector<float>(), const std::vector<float> &scale = std::vector<float>(),
+                        image::ResizeMethod method = image::ResizeMethod::BILINEAR);
+
+        /**
+         * Update mean and scale
+         * @param mean mean value, empty means 0.
+         * @param scale scale value, empty means 1.
+         */
+        void set_norm(const std::vector<float> &mean, const std::vector<float> &scale);
+
+        /**
+         * Preprocess image and write to dst
+         * @param img input image, support image::FMT_YVU420SP, image::FMT_RGB888, image::FMT_BGR888,
+         *            image::FMT_RGBA8888, image::FMT_BGRA8888, image::FMT_GRAYSCALE.
+         * @param dst model input buffer, size must >= width * height * channels * dtype size.
+         * @param fit resize fit mode, FIT_CONTAIN will fill black border.
+         * @return err::ERR_NONE if success, err::ERR_ARGS if image format not support.
+         */
+        err::Err run(image::Image &img, void *dst, image::Fit fit = image::Fit::FIT_CONTAIN);
+
+        /**
+         * Model input width
+         */
+        int width() { return _width; }
+
+        /**
+         * Model input height
+         */
+        int height() { return _height; }
+
+        /**
+         * Model input channels
+         */
+        int channels() { return _channels; }
+
+    private:
+        class AxisMap
+        {
+        public:
+            int start = 0;           // first pixel index of content in dst
+            int len = 0;             // content pixels number in dst
+            int first = 0;           // first used source index
+            int count = 0;           // used source pixels number
+            std::vector<int> i0;     // source index, relative to first
+            std::vector<int> i1;     // next source index for bilinear
+            std::vector<uint16_t> w; // weight of i1, 0~256
+        };
+
+        int _width;
+        int _height;
+        int _channels;
+        image::Format _format;
+        tensor::DType _dtype;
+        bool _chw;
+        bool _bilinear;
+        float _a[3]; // out = pixel * a + b
+        float _b[3];
+
+        // cached map for last source size and fit
+        int _src_w;
+        int _src_h;
+        image::Fit _fit;
+        AxisMap _xmap;
+        AxisMap _ymap;
+
+        void _update_map(int src_w, int src_h, image::Fit fit);
+        void _map_axis(AxisMap &m, int start, int len, float src_start, float src_len, int src_size);
+        void _write_row(uint8_t **planes, void *dst, int y);
+    };
+
+} // namespace maix::nn
@@ -0,0 +1,142 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Create this file, add two stage ROI pipeline.
+ */
+
+#pragma once
+
+#include "maix_basic.hpp"
+#include "maix_image.hpp"
+#include "maix_nn.hpp"
+#include "maix_nn_preprocess.hpp"
+#include <functional>
+
+namespace maix::nn
+{
+    /**
+     * Second stage engine of detect -> crop -> forward models, e.g. face feature, face/hand landmarks, OCR recognize.
+     * All ROIs of one frame are warped into pooled model input buffers, no image is allocated per ROI,
+     * when there are more ROIs than one batch, a worker thread prepares ROIs of the next batch while current batch is forwarding.
+     * If model input batch > 1(static batch in model, or dynamic batch model with `batch` key in MUD extra section),
+     * ROIs are preprocessed into one input tensor and forwarded together, else every ROI is forwarded by forward_image.
+     * @maixcdk maix.nn.ROIPipeline
+     */
+    class ROIPipeline
+    {
+    public:
+        /**
+         * Write ROI idx to dst, dst is a pooled image of model input size and format.
+         * Called in worker thread in index order, only touch ROI idx's own data.
+         * Return err::ERR_NONE if success, else this ROI is skipped and collect will not be called for it.
+         */
+        typedef std::function<err::Err(int idx, image::Image &dst)> PrepareFunc;
+
+        /**
+         * Receive model outputs of ROI idx, called in caller's thread in index order,
+         * outputs only valid in this function, batch outputs are split to shape [1, ...] for every ROI.
+         */
+        typedef std::function<void(int idx, tensor::Tensors &outputs)> CollectFunc;
+
+        /**
+         * Construct ROI pipeline
+         * @param model second stage model, not owned, must be valid during pipeline alive.
+         * @param format model input image format, image::FMT_RGB888, image::FMT_BGR888 or image::FMT_GRAYSCALE.
+         * @param mean mean value of model input.
+         * @param scale scale value of model input.
+         * @throw err::Exception if model input is not image or format not support.
+         * @maixcdk maix.nn.ROIPipeline.ROIPipeline
+         */
+        ROIPipeline(nn::NN *model, image::Format format, const std::vector<float> &mean, const std::vector<float> &scale);
+        ~ROIPipeline();
+
+        /**
+         * Run all ROIs, prepare and forward are overlapped.
+         * @param num ROIs number.
+         * @param prepare write ROI to model input image.
+         * @param collect receive outputs of ROI.
+         * @return err::ERR_NONE if success, else error code of forward, exceptions of prepare and collect are rethrown.
+         * @maixcdk maix.nn.ROIPipeline.run
+         */
+        err::Err run(int num, const PrepareFunc &prepare, const CollectFunc &collect);
+
+        /**
+         * Update mean and scale
+         * @maixcdk maix.nn.ROIPipeline.set_norm
+         */
+        void set_norm(const std::vector<float> &mean, const std::vector<float> &scale);
+
+        /**
+         * ROIs number forwarded together
+         * @maixcdk maix.nn.ROIPipeline.batch
+         */
+        int batch() { return _batch; }
+
+        /**
+         * Model input width
+         * @maixcdk maix.nn.ROIPipeline.width
+         */
+        int width() { return _width; }
+
+        /**
+         * Model input height
+         * @maixcdk maix.nn.ROIPipeline.height
+         */
+        int height() { return _height; }
+
+        /**
+         * Model input image format
+         * @maixcdk maix.nn.ROIPipeline.format
+         */
+        image::Format format() { return _format; }
+
+        /**
+         * Affine warp src to dst, point [x, y] of src is moved to M * [x, y, 1] of dst, the same as cv::warpAffine, out of src area is filled with 0.
+         * @param src source image, must be the same format as dst.
+         * @param dst destination image.
+         * @param M 2x3 affine matrix, row major, maps src to dst.
+         * @param method image::ResizeMethod::NEAREST or image::ResizeMethod::BILINEAR.
+         * @throw err::Exception if format not match or not support.
+         * @maixcdk maix.nn.ROIPipeline.warp_affine
+         */
+        static void warp_affine(image::Image &src, image::Image &dst, const double M[6], image::ResizeMethod method = image::ResizeMethod::BILINEAR);
+
+        /**
+         * Affine warp src to dst by 3 point pairs, the same as image::Image::affine but write to dst.
+         * @param src_points source points, [x1, y1, x2, y2, x3, y3, ...], only first 3 points used.
+         * @param dst_points destination points, the same format as src_points.
+         * @maixcdk maix.nn.ROIPipeline.warp_points
+         */
+        static void warp_points(image::Image &src, image::Image &dst, const std::vector<int> &src_points, const std::vector<int> &dst_points,
+                                image::ResizeMethod method = image::ResizeMethod::BILINEAR);
+
+    private:
+        class Stage
+        {
+        public:
+            image::Image *img = nullptr; // batch 1 model input
+            std::vector<uint8_t> buf;    // batch > 1 model input tensor
+            std::vector<int> idx;        // ROIs in this stage
+        };
+
+        nn::NN *_model;
+        image::Format _format;
+        std::vector<float> _mean;
+        std::vector<float> _scale;
+        int _width;
+        int _height;
+        int _batch;
+        bool _static_batch;          // model input batch is fixed, always forward _batch slots
+        std::string _input_name;
+        std::vector<int> _input_shape;
+        tensor::DType _input_dtype;
+        size_t _slot_bytes;          // one ROI bytes in input tensor
+        Stage _stages[2];
+        image::Image *_scratch;      // batch > 1, ROI image before preprocess
+        ImagePreprocess *_preprocess;
+
+        void _fill(Stage &stage, int start, int num, const PrepareFunc &prepare);
+        err::Err _forward(Stage &stage, const CollectFunc &collect);
+    };
+} // namespace maix::nn
@@ -3,11 +3,13 @@
  * @author neucrack@sipeed
  * @license Apache 2.0
  * @date 2024.6.14 Add support.
+ * @update 2026.10.18: Search classes by FeatureIndex.
  */
 #pragma once
 
 #include "maix_basic.hpp"
 #include "maix_nn.hpp"
+#include "maix_nn_feature_index.hpp"
 
 namespace maix::nn
 {
@@ -34,6 +36,7 @@ namespace maix::nn
             _model = nullptr;
             _feature_num = 0;
             _dual_buff = dual_buff;
+            _index_dirty = true;
             if (!model.empty())
             {
                 err::Err e = load_model(model);
@@ -179,24 +182,25 @@ namespace maix::nn
          * Classify image
          * @param img image, format should match model input_type， or will raise err.Exception
          * @param fit image resize fit mode, default Fit.FIT_COVER, see image.Fit.
+         * @param topk only return the most similar topk classes, default -1 means all classes.
          * @throw If error occurred, will raise err::Exception, you can find reason in log, mostly caused by args error or hardware error.
          * @return result, a list of (idx, distance), smaller distance means more similar. In C++, you need to delete it after use.
          * @maixpy maix.nn.SelfLearnClassifier.classify
          */
-        std::vector<std::pair<int, float>> *classify(image::Image &img, image::Fit fit = image::FIT_COVER)
+        std::vector<std::pair<int, float>> *classify(image::Image &img, image::Fit fit = image::FIT_COVER, int topk = -1)
         {
             float *feature = NULL;
             tensor::Tensors *outs = _get_feature(img, &feature, fit);
-            std::vector<std::pair<int, float>> *distances = new std::vector<std::pair<int, float>>();
-            for (size_t i = 0; i < _features.size(); ++i)
+            // learn() updates class features in place, rebuild index after that
+            if (_index_dirty)
             {
-                float distance = _get_distance(feature, _features[i]);
-                distances->push_back(std::make_pair(i, distance));
+                _index.reset(_feature_num, IndexMetric::L2, IndexDType::FLOAT32);
+                for (auto f : _features)
+                    _index.add(f, _feature_num);
+                _index_dirty = false;
             }
+            std::vector<std::pair<int, float>> *distances = new std::vector<std::pair<int, float>>(_index.search(feature, topk));
             delete outs;
-            // sort
-            std::sort(distances->begin(), distances->end(), [](const std::pair<int, float> &a, const std::pair<int, float> &b)
-                      { return a.second < b.second; });
             return distances;
         }
 
@@ -211,6 +215,8 @@ namespace maix::nn
             float *feature = NULL;
             tensor::Tensors *outs = _get_feature(img, &feature, fit);
             _add_feature(feature);
+            if (!_index_dirty)
+                _index.add(feature, _feature_num);
             delete outs;
         }
 
@@ -234,6 +240,8 @@ namespace maix::nn
                 return err::ERR_ARGS;
             delete[] _features[idx];
             _features.erase(_features.begin() + idx);
+            if (!_index_dirty)
+                _index.remove(idx);
             return err::ERR_NONE;
         }
 
@@ -280,7 +288,11 @@ namespace maix::nn
          * @return learn epoch(times), 0 means learn nothing.
          * @maixpy maix.nn.SelfLearnClassifier.learn
          */
-        int learn();
+        int learn()
+        {
+            _index_dirty = true;
+            return _learn();
+        }
 
         /**
          * Clear all class and samples
@@ -298,6 +310,7 @@ namespace maix::nn
                 delete[] i;
             }
             _features_sample.clear();
+            _index_dirty = true;
         }
 
         /**
@@ -480,6 +493,7 @@ namespace maix::nn
                 _features.push_back(feature);
                 f->read(reinterpret_cast<char *>(feature), feature_length * sizeof(float));
             }
+            _index_dirty = true;
             for (auto i : _features_sample)
             {
                 delete[] i;
@@ -534,6 +548,8 @@ namespace maix::nn
         std::vector<nn::LayerInfo> _inputs;
         std::vector<float *> _features;
         std::vector<float *> _features_sample;
+        nn::FeatureIndex _index;    // search index of _features
+        bool _index_dirty;
 
         static void split0(std::vector<std::string> &items, const std::string &s, const std::string &delimiter)
         {
@@ -595,16 +611,7 @@ namespace maix::nn
             _features_sample.push_back(feature);
         }
 
-        float _get_distance(float *a, float *b)
-        {
-            float sum = 0.;
-            for (int i = 0; i < _feature_num; i++)
-            {
-                sum += (a[i] - b[i]) * (a[i] - b[i]);
-            }
-            sum = sqrtf(sum);
-            return sum;
-        }
+        int _learn();
     }; // class SelfLearnClassifier
 
 } // namespace maix::nn
@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2024-
  * @license Apache 2.0
  * @update 2024.6.7: Add yolov8 support.
+ * @update 2026.10.18: Add streaming transcription API.
  */
 
 #pragma once
@@ -22,6 +23,8 @@ namespace maix::nn
         int _input_pcm_channels;
         int _input_pcm_bits_per_frame;
         void *_extra_param;
+        void *_stream = nullptr;
+        void _stream_deliver();
     protected:
         std::string type_str = "whisper";
     public:
@@ -69,6 +72,49 @@ namespace maix::nn
         */
         std::string transcribe_raw(Bytes *pcm, int sample_rate = 16000, int channels = 1, int bits_per_frame = 16);
 
+        /**
+         * Start a streaming transcription session.
+         * PCM pushed by stream_push is split into utterances by energy VAD,
+         * recognition runs in a background thread so capture and inference overlap,
+         * models and mel frontend are kept across utterances.
+         * @note Don't call transcribe or transcribe_raw while streaming.
+         * @param callback called with (text, is_final) in the thread calling stream_push or stream_stop,
+         * is_final false means partial result of the utterance being spoken, true means the utterance ended.
+         * @param silence_ms utterance ends after silence longer than this value, unit ms.
+         * @param vad_threshold RMS threshold of speech, PCM range [-1, 1], 10ms per VAD frame.
+         * @param partial_ms emit partial result every partial_ms of speech, 0 to disable partial results.
+         * @param max_segment_ms force end utterance after this length, max 30000 as whisper input window is 30s.
+         * @return err::ERR_NONE if success, err::ERR_BUSY if already started, else error code.
+         * @maixpy maix.nn.Whisper.stream_start
+         */
+        err::Err stream_start(std::function<void(std::string, bool)> callback = nullptr, int silence_ms = 600, float vad_threshold = 0.02, int partial_ms = 800, int max_segment_ms = 28000);
+
+        /**
+         * Push PCM to streaming session, return quickly, can be called in the audio capture loop(e.g. with audio.Recorder.record).
+         * Results ready are delivered to callback before return.
+         * @param pcm RAW data, same sample rate as input_pcm_samplerate.
+         * @param channels channels of pcm, only the first channel is used.
+         * @param bits_per_frame bits of one sample, 8, 16, 24 or 32.
+         * @return err::ERR_NONE if success, err::ERR_NOT_READY if stream not started, else error code.
+         * @maixpy maix.nn.Whisper.stream_push
+         */
+        err::Err stream_push(Bytes *pcm, int channels = 1, int bits_per_frame = 16);
+
+        /**
+         * Stop streaming session, the utterance being spoken is ended and recognized, block until all results delivered.
+         * @return all final results of this session joined.
+         * @maixpy maix.nn.Whisper.stream_stop
+         */
+        std::string stream_stop();
+
+        /**
+         * Is streaming session started
+         * @maixpy maix.nn.Whisper.stream_running
+         */
+        bool stream_running() {
+            return _stream != nullptr;
+        }
+
         /**
          * Get input pcm samplerate
          * @return input pcm samplerate
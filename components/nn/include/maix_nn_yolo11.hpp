@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2024-
  * @license Apache 2.0
  * @update 2024.10.10: Add yolo11 support.
+ * @update 2026.10.18: Decode int8/uint8 det outputs in quantized domain.
  */
 
 #pragma once
@@ -11,6 +12,7 @@
 #include "maix_image.hpp"
 #include "maix_nn_F.hpp"
 #include "maix_nn_object.hpp"
+#include "maix_nn_nms.hpp"
 #include <math.h>
 #include <omp.h>
 
@@ -280,6 +282,7 @@ namespace maix::nn
                 _anchor_num += _input_size.width()/_stride[i] * _input_size.height() / _stride[i];
             }
             std::vector<nn::LayerInfo> outputs = _model->outputs_info();
+            _outputs_info = outputs;
             auto print_outputs = [outputs](){
                 log::info("Outputs:");
                 for(auto item : outputs)
@@ -725,6 +728,7 @@ namespace maix::nn
         float _conf_th = 0.5;
         float _iou_th = 0.45;
         float _keypoint_th = 0.5;
+        nn::NMS _nms_engine;
         YOLO11_Type _type;
         bool _dual_buff;
         _OutIdxes _out_idxes;
@@ -734,6 +738,7 @@ namespace maix::nn
         std::vector<float> _stride = {8, 16, 32};
         int _anchor_num = 0;
         bool _obb_need_sigmoid;
+        std::vector<nn::LayerInfo> _outputs_info;
 
     private:
         err::Err _load_labels_from_file(std::vector<std::string> &labels, const std::string &label_path)
@@ -768,16 +773,18 @@ namespace maix::nn
             float scale_w = 1;
             float scale_h = 1;
 
+            tensor::Tensors *outputs_raw = outputs;
+            outputs = _dequantize_outputs(outputs_raw);
             if(!_decode_objs(*objects, outputs, _conf_th, _input_size.width(), _input_size.height(), &kp_out, &mask_out))
             {
+                if (outputs != outputs_raw)
+                    delete outputs;
                 delete objects;
                 return NULL;
             }
             if (objects->size() > 0)
             {
-                nn::Objects *objects_total = objects;
-                objects = _nms(*objects);
-                delete objects_total;
+                _nms(*objects);
                 if(sort != 0)
                 {
                     _sort_objects(*objects, sort);
@@ -792,6 +799,8 @@ namespace maix::nn
             {
                 _decode_seg_points(*objects, kp_out, mask_out);
             }
+            if (outputs != outputs_raw)
+                delete outputs;
             if (objects->size() > 0)
             {
                 _correct_bbox(*objects, img_w, img_h, fit, &scale_w, &scale_h);
@@ -968,6 +977,14 @@ namespace maix::nn
                         // }
                     }
                 }
+                else if (dets[0]->dtype() == tensor::DType::INT8)
+                {
+                    _decode_dets_quant<int8_t>(objs, dets, idx_start, conf_thresh);
+                }
+                else if (dets[0]->dtype() == tensor::DType::UINT8)
+                {
+                    _decode_dets_quant<uint8_t>(objs, dets, idx_start, conf_thresh);
+                }
                 else
                 {
                     if(_out_chw)
@@ -1233,59 +1250,48 @@ namespace maix::nn
             return true;
         }
 
-        nn::Objects *_nms(nn::Objects &objs)
+        void _nms(nn::Objects &objs)
         {
-            nn::Objects *result = new nn::Objects();
-            std::sort(objs.begin(), objs.end(), [](const nn::Object *a, const nn::Object *b)
-                      { return a->score > b->score; });
+            _nms_engine.set_iou_th(_iou_th);
+            _nms_engine.set_rotated(_type == YOLO11_Type::OBB);
+            _nms_engine.clear();
+            _nms_engine.add(objs);
+            const std::vector<int> &keep = _nms_engine.run();
+            // free keypoint info of suppressed objects
+            std::vector<uint8_t> kept(objs.size(), 0);
+            for (int i : keep)
+                kept[i] = 1;
             for (size_t i = 0; i < objs.size(); ++i)
             {
-                nn::Object &a = objs.at(i);
-                if (a.score == 0)
-                    continue;
-                for (size_t j = i + 1; j < objs.size(); ++j)
+                if (!kept[i])
                 {
-                    nn::Object &b = objs.at(j);
-                    {
-                        if (b.score != 0 && a.class_id == b.class_id && _calc_iou(a, b) > this->_iou_th)
-                        {
-                            b.score = 0;
-                        }
-                    }
+                    delete (_KpInfoYolo11 *)objs.at(i).temp;
+                    objs.at(i).temp = NULL;
                 }
             }
-            for (nn::Object *a : objs)
+            objs.keep(keep);
+            // clip to input size
+            for (nn::Object *obj : objs)
             {
-                if (a->score != 0)
+                if (obj->x < 0)
                 {
-                    Object &obj = result->add(a->x, a->y, a->w, a->h, a->class_id, a->score, a->points, a->angle);
-                    if (obj.x < 0)
-                    {
-                        obj.w += obj.x;
-                        obj.x = 0;
-                    }
-                    if (obj.y < 0)
-                    {
-                        obj.h += obj.y;
-                        obj.y = 0;
-                    }
-                    if (obj.x + obj.w > _input_size.width())
-                    {
-                        obj.w = _input_size.width() - obj.x;
-                    }
-                    if (obj.y + obj.h > _input_size.height())
-                    {
-                        obj.h = _input_size.height() - obj.y;
-                    }
-                    obj.temp = a->temp;
+                    obj->w += obj->x;
+                    obj->x = 0;
                 }
-                else
+                if (obj->y < 0)
                 {
-                    delete (_KpInfoYolo11 *)a->temp;
-                    a->temp = NULL;
+                    obj->h += obj->y;
+                    obj->y = 0;
+                }
+                if (obj->x + obj->w > _input_size.width())
+                {
+                    obj->w = _input_size.width() - obj->x;
+                }
+                if (obj->y + obj->h > _input_size.height())
+                {
+                    obj->h = _input_size.height() - obj->y;
                 }
             }
-            return result;
         }
 
         void _sort_objects(nn::Objects &objects, int sort)
@@ -1298,6 +1304,127 @@ namespace maix::nn
                       { return (a->w * a->h) < (b->w * b->h); });
         }
 
+        bool _is_quant(tensor::DType dtype)
+        {
+            return dtype == tensor::DType::INT8 || dtype == tensor::DType::UINT8;
+        }
+
+        /**
+         * Quantized det outputs of mode 1 detect, pose and seg are decoded by _decode_dets_quant directly,
+         * other int8/uint8 outputs are dequantized to float32 here.
+         * @return outputs itself if no output need dequantize, else new tensors, delete it after use.
+         */
+        tensor::Tensors *_dequantize_outputs(tensor::Tensors *outputs)
+        {
+            std::vector<std::string> keys = outputs->keys();
+            bool quant_dets = _out_node_mode == 1 && _type != YOLO11_Type::OBB && _is_quant((*outputs)[_out_idxes.det0].dtype());
+            std::vector<bool> need(keys.size(), false);
+            bool need_any = false;
+            for (size_t i = 0; i < keys.size(); ++i)
+            {
+                int idx = (int)i;
+                if (quant_dets && (idx == _out_idxes.det0 || idx == _out_idxes.det1 || idx == _out_idxes.det2))
+                    continue;
+                need[i] = _is_quant((*outputs)[keys[i]].dtype());
+                need_any = need_any || need[i];
+            }
+            if (!need_any)
+                return outputs;
+            tensor::Tensors *res = new tensor::Tensors();
+            for (size_t i = 0; i < keys.size(); ++i)
+            {
+                tensor::Tensor &t = (*outputs)[keys[i]];
+                if (!need[i])
+                {
+                    res->add_tensor(keys[i], &t, false, false);
+                    continue;
+                }
+                float scale = i < _outputs_info.size() ? _outputs_info[i].scale : 1.0f;
+                int zero_point = i < _outputs_info.size() ? _outputs_info[i].zero_point : 0;
+                res->add_tensor(keys[i], F::dequantize(&t, scale, zero_point), false, true);
+            }
+            return res;
+        }
+
+        /**
+         * Decode int8/uint8 det outputs of detect, pose and seg.
+         * Class scores are compared with threshold in quantized domain, only anchors pass it are dequantized and DFL decoded,
+         * DFL softmax use exp table of quantized differences, so no expf for DFL.
+         */
+        template <typename T>
+        void _decode_dets_quant(nn::Objects &objs, tensor::Tensor *dets[3], const int idx_start[3], float conf_thresh)
+        {
+            int class_num = (int)labels.size();
+            int prob_offset = _reg_max * 4;
+            int out_idx[3] = {_out_idxes.det0, _out_idxes.det1, _out_idxes.det2};
+            struct QuantLayer {
+                int nh;
+                int nw;
+                const T *feature;
+                float scale;
+                int zero_point;
+                int q_min;
+                float exp_lut[256]; // exp(-d * scale), d is max - value of one DFL bin
+            };
+            QuantLayer layers[3];
+            for (int i = 0; i < 3; ++i)
+            {
+                QuantLayer &l = layers[i];
+                l.nh = dets[i]->shape()[_out_chw ? 2 : 1];
+                l.nw = dets[i]->shape()[_out_chw ? 3 : 2];
+                l.feature = (const T *)dets[i]->data();
+                l.scale = out_idx[i] < (int)_outputs_info.size() ? _outputs_info[out_idx[i]].scale : 1.0f;
+                l.zero_point = out_idx[i] < (int)_outputs_info.size() ? _outputs_info[out_idx[i]].zero_point : 0;
+                l.q_min = F::quant_sigmoid_threshold(conf_thresh, l.scale, l.zero_point);
+                for (int d = 0; d < 256; ++d)
+                    l.exp_lut[d] = expf(-d * l.scale);
+            }
+
+            #pragma omp parallel for
+            for(int index = 0; index < _anchor_num; ++index)
+            {
+                int i = 1;
+                int anchor_idx;
+                if (index >= idx_start[2]) {
+                    i = 2;
+                    anchor_idx = index - idx_start[2];
+                } else if (index < idx_start[1]) {
+                    i = 0;
+                    anchor_idx = index;
+                } else {
+                    anchor_idx = index - idx_start[1];
+                }
+                const QuantLayer &l = layers[i];
+                int ax = anchor_idx % l.nw;
+                int ay = anchor_idx / l.nw;
+                int s = _out_chw ? l.nh * l.nw : 1;
+                const T *p = _out_chw ? l.feature + anchor_idx : l.feature + (prob_offset + class_num) * anchor_idx;
+
+                int class_id = _argmax(p + prob_offset * s, class_num, s);
+                int q = p[(prob_offset + class_id) * s];
+                if (q < l.q_min)
+                    continue;
+                float score = _sigmoid((q - l.zero_point) * l.scale);
+
+                float dis[4];
+                for(int k = 0; k < 4; ++k)
+                {
+                    dis[k] = _softmax_expectation_quant(p + k * _reg_max * s, _reg_max, s, l.exp_lut);
+                }
+                float bbox_x = (ax + 0.5 - dis[0]) * _stride[i];
+                float bbox_y = (ay + 0.5 - dis[1]) * _stride[i];
+                float bbox_w = (ax + 0.5 + dis[2]) * _stride[i] - bbox_x;
+                float bbox_h = (ay + 0.5 + dis[3]) * _stride[i] - bbox_y;
+
+                _KpInfoYolo11 *kp_info = new _KpInfoYolo11(idx_start[i] + anchor_idx, ax, ay, _stride[i]);
+                #pragma omp critical
+                {
+                    Object &obj = objs.add(bbox_x, bbox_y, bbox_w, bbox_h, class_id, score);
+                    obj.temp = (void *)kp_info;
+                }
+            }
+        }
+
         void _decode_keypoints(nn::Objects &objs, tensor::Tensor *kp_out)
         {
             float *data = (float *)kp_out->data();
@@ -1640,18 +1767,6 @@ namespace maix::nn
 
         inline static float _sigmoid(float x) { return 1.0 / (1 + expf(-x)); }
 
-        inline static float _calc_iou(Object &a, Object &b)
-        {
-            float area1 = a.w * a.h;
-            float area2 = b.w * b.h;
-            float wi = std::min((a.x + a.w), (b.x + b.w)) -
-                       std::max(a.x, b.x);
-            float hi = std::min((a.y + a.h), (b.y + b.h)) -
-                       std::max(a.y, b.y);
-            float area_i = std::max(wi, 0.0f) * std::max(hi, 0.0f);
-            return area_i / (area1 + area2 - area_i);
-        }
-
         template <typename T>
         static int _argmax(const T *data, size_t len, size_t stride = 1)
         {
@@ -1776,6 +1891,31 @@ namespace maix::nn
             return numerator / denominator;
         }
 
+        template <typename T>
+        static float _softmax_expectation_quant(const T* src, int length, int step, const float *exp_lut)
+        {
+            int alpha = src[0];
+            for (int i = 1; i < length; ++i)
+            {
+                int val = src[i * step];
+                if (val > alpha)
+                    alpha = val;
+            }
+
+            float denominator = 0.f;
+            float numerator = 0.f;
+
+            // zero point is canceled by subtract max, exp((q - max) * scale) is looked up
+            for (int i = 0; i < length; ++i)
+            {
+                float e = exp_lut[alpha - src[i * step]];
+                denominator += e;
+                numerator += i * e;
+            }
+
+            return numerator / denominator;
+        }
+
     };
 
 } // namespace maix::nn
@@ -4,6 +4,7 @@
  * @license Apache 2.0
  * @update 2026: YOLO26 with platform-specific SIMD optimization.
  *                MaixCAM2: NEON, MaixCAM: RVV, Others: Serial
+ * @update 2026.10.18: Decode int8/uint8 cls outputs in quantized domain.
  */
 
 #pragma once
@@ -244,6 +245,7 @@ namespace maix::nn
         float _conf_th = 0.5;
         bool _dual_buff;
         bool _is_nchw = false;
+        std::vector<nn::LayerInfo> _outputs_info;
         
         static constexpr float LOGIT_THRESHOLD = -0.2f;
         
@@ -261,6 +263,7 @@ namespace maix::nn
         {
             std::vector<nn::LayerInfo> outputs = _model->outputs_info();
             err::check_bool_raise(outputs.size() >= 6, "need at least 6 outputs");
+            _outputs_info = outputs;
             
             struct OutputInfo { std::string name; int h, w, c; int idx; };
             std::vector<OutputInfo> parsed_outputs, bbox_outputs, cls_outputs;
@@ -437,13 +440,33 @@ namespace maix::nn
             // Process each scale
             for (int i = 0; i < 3; i++)
             {
-                float *bbox = (float *)(*outputs)[_output_nodes.bbox[i]].data();
-                float *cls = (float *)(*outputs)[_output_nodes.cls[i]].data();
+                tensor::Tensor &bbox_t = (*outputs)[_output_nodes.bbox[i]];
+                tensor::Tensor &cls_t = (*outputs)[_output_nodes.cls[i]];
                 int stride = _input_size.width() / _output_nodes.grid_sizes[i][0];
                 int fw = _output_nodes.grid_sizes[i][0];
                 int fh = _output_nodes.grid_sizes[i][1];
                 
+                // quantized cls is thresholded in quantized domain, only bbox of passed anchors are dequantized
+                if (cls_t.dtype() == tensor::DType::INT8)
+                {
+                    _generate_proposals_quant<int8_t>(stride, fw, fh, bbox_t, cls_t, i, labels.size(), *objects);
+                    continue;
+                }
+                if (cls_t.dtype() == tensor::DType::UINT8)
+                {
+                    _generate_proposals_quant<uint8_t>(stride, fw, fh, bbox_t, cls_t, i, labels.size(), *objects);
+                    continue;
+                }
+                tensor::Tensor *bbox_f = NULL;
+                if (bbox_t.dtype() == tensor::DType::INT8 || bbox_t.dtype() == tensor::DType::UINT8)
+                {
+                    nn::LayerInfo info = _output_info(_output_nodes.bbox[i]);
+                    bbox_f = F::dequantize(&bbox_t, info.scale, info.zero_point);
+                }
+                float *bbox = (float *)(bbox_f ? bbox_f->data() : bbox_t.data());
+                float *cls = (float *)cls_t.data();
                 _generate_proposals(stride, fw, fh, bbox, cls, labels.size(), *objects);
+                delete bbox_f;
             }
             
             // Correct bbox to original image size
@@ -453,6 +476,86 @@ namespace maix::nn
             return objects;
         }
 
+        nn::LayerInfo _output_info(const std::string &name)
+        {
+            for (auto &info : _outputs_info)
+            {
+                if (info.name == name)
+                    return info;
+            }
+            return nn::LayerInfo(name);
+        }
+
+        /**
+         * Generate proposals from int8/uint8 cls output, max logit is compared in quantized domain,
+         * bbox(float or quantized) is only read for anchors pass threshold.
+         */
+        template <typename T>
+        void _generate_proposals_quant(int stride, int fw, int fh,
+                                       tensor::Tensor &bbox_t, tensor::Tensor &cls_t, int node_idx,
+                                       int num_class, std::vector<nn::Object> &objs)
+        {
+            const int total = fw * fh;
+            const float stride_f = (float)stride;
+            const T *cls = (const T *)cls_t.data();
+            const uint8_t *bbox = (const uint8_t *)bbox_t.data();
+            tensor::DType bbox_dtype = bbox_t.dtype();
+            nn::LayerInfo cls_info = _output_info(_output_nodes.cls[node_idx]);
+            nn::LayerInfo bbox_info = _output_info(_output_nodes.bbox[node_idx]);
+            const int q_min = F::quant_sigmoid_threshold(_conf_th, cls_info.scale, cls_info.zero_point);
+            const int step = _is_nchw ? total : 1;
+
+            auto bbox_at = [&](int idx) -> float {
+                if (bbox_dtype == tensor::DType::INT8)
+                    return ((int)((const int8_t *)bbox)[idx] - bbox_info.zero_point) * bbox_info.scale;
+                if (bbox_dtype == tensor::DType::UINT8)
+                    return ((int)bbox[idx] - bbox_info.zero_point) * bbox_info.scale;
+                return ((const float *)bbox)[idx];
+            };
+
+            for (int i = 0; i < total; i++)
+            {
+                const T *c = _is_nchw ? cls + i : cls + i * num_class;
+                int class_id = 0;
+                int max_q = c[0];
+                for (int j = 1; j < num_class; j++)
+                {
+                    int v = c[j * step];
+                    if (v > max_q)
+                    {
+                        max_q = v;
+                        class_id = j;
+                    }
+                }
+                if (max_q < q_min)
+                    continue;
+                float score = _sigmoid((max_q - cls_info.zero_point) * cls_info.scale);
+
+                int ax = i % fw;
+                int ay = i / fw;
+                int b_base = _is_nchw ? i : i * 4;
+                float b[4];
+                for (int k = 0; k < 4; k++)
+                    b[k] = bbox_at(b_base + k * step);
+
+                float cx = (ax + 0.5f) * stride_f;
+                float cy = (ay + 0.5f) * stride_f;
+                float x = cx - b[0] * stride_f;
+                float y = cy - b[1] * stride_f;
+                float w = (b[0] + b[2]) * stride_f;
+                float h = (b[1] + b[3]) * stride_f;
+
+                // Clamp to input size
+                x = std::max(0.0f, x);
+                y = std::max(0.0f, y);
+                w = std::min(w, (float)_input_size.width() - x);
+                h = std::min(h, (float)_input_size.height() - y);
+
+                if (w > 0 && h > 0)
+                    objs.push_back(Object(x, y, w, h, class_id, score));
+            }
+        }
+
         /**
          * Generate proposals with platform-optimized implementation
          */
@@ -11,6 +11,7 @@
 #include "maix_image.hpp"
 #include "maix_nn_F.hpp"
 #include "maix_nn_object.hpp"
+#include "maix_nn_nms.hpp"
 #include <math.h>
 #include "maix_nn_yolo11.hpp"
 
@@ -621,9 +622,7 @@ namespace maix::nn
             }
             if (objects->size() > 0)
             {
-                nn::Objects *objects_total = objects;
-                objects = _nms(*objects);
-                delete objects_total;
+                _nms(*objects);
                 if(sort != 0)
                 {
                     _sort_objects(*objects, sort);
@@ -712,59 +711,32 @@ namespace maix::nn
             return true;
         }
 
-        nn::Objects *_nms(nn::Objects &objs)
+        void _nms(nn::Objects &objs)
         {
-            nn::Objects *result = new nn::Objects();
-            std::sort(objs.begin(), objs.end(), [](const nn::Object *a, const nn::Object *b)
-                      { return a->score > b->score; });
-            for (size_t i = 0; i < objs.size(); ++i)
-            {
-                nn::Object &a = objs.at(i);
-                if (a.score == 0)
-                    continue;
-                for (size_t j = i + 1; j < objs.size(); ++j)
+            _nms_engine.set_iou_th(_iou_th);
+            _nms_engine.run(objs);
+            // clip to input size
+            for (nn::Object *obj : objs)
+            {
+                if (obj->x < 0)
                 {
-                    nn::Object &b = objs.at(j);
-                    {
-                        if (b.score != 0 && a.class_id == b.class_id && _calc_iou(a, b) > this->_iou_th)
-                        {
-                            b.score = 0;
-                        }
-                    }
+                    obj->w += obj->x;
+                    obj->x = 0;
                 }
-            }
-            for (nn::Object *a : objs)
-            {
-                if (a->score != 0)
+                if (obj->y < 0)
                 {
-                    Object &obj = result->add(a->x, a->y, a->w, a->h, a->class_id, a->score, a->points, a->angle);
-                    if (obj.x < 0)
-                    {
-                        obj.w += obj.x;
-                        obj.x = 0;
-                    }
-                    if (obj.y < 0)
-                    {
-                        obj.h += obj.y;
-                        obj.y = 0;
-                    }
-                    if (obj.x + obj.w > _input_size.width())
-                    {
-                        obj.w = _input_size.width() - obj.x;
-                    }
-                    if (obj.y + obj.h > _input_size.height())
-                    {
-                        obj.h = _input_size.height() - obj.y;
-                    }
-                    obj.temp = a->temp;
+                    obj->h += obj->y;
+                    obj->y = 0;
                 }
-                else
+                if (obj->x + obj->w > _input_size.width())
                 {
-                    // delete (_KpInfoYolo11 *)a->temp;
-                    a->temp = NULL;
+                    obj->w = _input_size.width() - obj->x;
+                }
+                if (obj->y + obj->h > _input_size.height())
+                {
+                    obj->h = _input_size.height() - obj->y;
                 }
             }
-            return result;
         }
 
         void _sort_objects(nn::Objects &objects, int sort)
@@ -915,18 +887,6 @@ namespace maix::nn
 
         inline static float _sigmoid(float x) { return 1.0 / (1 + expf(-x)); }
 
-        inline static float _calc_iou(Object &a, Object &b)
-        {
-            float area1 = a.w * a.h;
-            float area2 = b.w * b.h;
-            float wi = std::min((a.x + a.w), (b.x + b.w)) -
-                       std::max(a.x, b.x);
-            float hi = std::min((a.y + a.h), (b.y + b.h)) -
-                       std::max(a.y, b.y);
-            float area_i = std::max(wi, 0.0f) * std::max(hi, 0.0f);
-            return area_i / (area1 + area2 - area_i);
-        }
-
         template <typename T>
         static int _argmax(const T *data, size_t len, size_t stride = 1)
         {
@@ -1012,6 +972,7 @@ namespace maix::nn
         std::map<string, string> _extra_info;
         float _conf_th = 0.5;
         float _iou_th = 0.45;
+        nn::NMS _nms_engine;
     };
 
 } // namespace maix::nn
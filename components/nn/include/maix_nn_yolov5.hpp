@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Decode int8/uint8 outputs in quantized domain.
  */
 
 #pragma once
@@ -11,6 +12,7 @@
 #include "maix_image.hpp"
 #include "maix_nn_F.hpp"
 #include "maix_nn_object.hpp"
+#include "maix_nn_nms.hpp"
 
 namespace maix::nn
 {
@@ -210,6 +212,7 @@ namespace maix::nn
             else
                 _input_size = image::Size(inputs[0].shape[3], inputs[0].shape[2]);
             log::print(log::LogLevel::LEVEL_INFO, "\tinput size: %dx%d\n\n", _input_size.width(), _input_size.height());
+            _outputs_info = _model->outputs_info();
             return err::ERR_NONE;
         }
 
@@ -325,7 +328,9 @@ namespace maix::nn
         std::map<string, string> _extra_info;
         float _conf_th = 0.5;
         float _iou_th = 0.45;
+        nn::NMS _nms_engine;
         bool _dual_buff;
+        std::vector<nn::LayerInfo> _outputs_info;
 
     private:
         err::Err _load_labels_from_file(std::vector<std::string> &labels, const std::string &label_path)
@@ -370,13 +375,16 @@ namespace maix::nn
                     }
                 }
                 // log::info("output: %s, tensor: %s", it->first.c_str(), it->second->to_str().c_str());
-                _get_layer_objs(*objects, *it->second, i++, layer_num);
+                if (it->second->dtype() == tensor::DType::INT8)
+                    _get_layer_objs_quant<int8_t>(*objects, *it->second, _output_info(it->first), i++, layer_num);
+                else if (it->second->dtype() == tensor::DType::UINT8)
+                    _get_layer_objs_quant<uint8_t>(*objects, *it->second, _output_info(it->first), i++, layer_num);
+                else
+                    _get_layer_objs(*objects, *it->second, i++, layer_num);
             }
             if(objects->size() > 0)
             {
-                std::vector<nn::Object> *objects_total = objects;
-                objects = _nms(*objects);
-                delete objects_total;
+                _nms(*objects);
                 if(sort != 0)
                 {
                     _sort_objects(*objects, sort);
@@ -431,52 +439,103 @@ namespace maix::nn
             }
         }
 
-        std::vector<nn::Object> *_nms(std::vector<nn::Object> &objs)
+        nn::LayerInfo _output_info(const std::string &name)
+        {
+            for (auto &info : _outputs_info)
+            {
+                if (info.name == name)
+                    return info;
+            }
+            return nn::LayerInfo(name);
+        }
+
+        /**
+         * The same as _get_layer_objs but for int8/uint8 output, object score is compared in quantized domain,
+         * only anchors pass it are dequantized.
+         */
+        template <typename T>
+        void _get_layer_objs_quant(std::vector<nn::Object> &objs, tensor::Tensor &output, const nn::LayerInfo &info, int layer_i, int layer_num)
         {
-            std::vector<nn::Object> *result = new std::vector<nn::Object>();
-            std::sort(objs.begin(), objs.end(), [](const nn::Object &a, const nn::Object &b) {
-                return a.score > b.score;
-            });
-            for(size_t i=0; i < objs.size(); ++i)
-            {
-                nn::Object &a = objs.at(i);
-                if(a.score == 0)
-                    continue;
-                for(size_t j = i + 1; j < objs.size(); ++j)
+            int h = output.shape()[2];
+            int w = output.shape()[3];
+            int class_num = this->labels.size();
+            int box_len = class_num + 5;
+            int s = w * h;
+            int anchor_stride = box_len * s;
+            int s4 = 4 * s;
+            int s3 = 3 * s;
+            int s2 = 2 * s;
+            const T *data = (const T *)output.data();
+            int anchor_num = this->anchors.size() / 2 / layer_num;
+            int anchor_start = anchor_num * layer_i * 2;
+            float scale_x = _input_size.width() / w;
+            float scale_y = _input_size.height() / h;
+            float q_scale = info.scale;
+            int zp = info.zero_point;
+            // object score * class score <= object score, so object score must pass threshold first
+            int q_min = F::quant_sigmoid_threshold(_conf_th, q_scale, zp);
+            for (int a = 0; a < anchor_num; ++a)
+            {
+                for (int y = 0; y < h; ++y)
                 {
-                    nn::Object &b = objs.at(j);
-                    if(b.score != 0 && a.class_id == b.class_id && _calc_iou(a, b) > this->_iou_th)
+                    for (int x = 0; x < w; ++x)
                     {
-                        b.score = 0;
+                        const T *p = data + a * anchor_stride + y * w + x + s4;
+                        if ((int)*p < q_min)
+                            continue;
+                        float obj_score = _sigmoid(((int)*p - zp) * q_scale);
+                        const T *cls_scores = p + s;
+                        int class_id = _argmax(cls_scores, class_num, s);
+                        obj_score *= _sigmoid(((int)cls_scores[class_id * s] - zp) * q_scale);
+                        if (obj_score <= _conf_th)
+                            continue;
+                        float bbox_x = (_sigmoid(((int)*(p - s4) - zp) * q_scale) * 2 + x - 0.5) * scale_x;
+                        float bbox_y = (_sigmoid(((int)*(p - s3) - zp) * q_scale) * 2 + y - 0.5) * scale_y;
+                        float bbox_w = pow(_sigmoid(((int)*(p - s2) - zp) * q_scale) * 2, 2) * this->anchors[anchor_start + a * 2];
+                        float bbox_h = pow(_sigmoid(((int)*(p - s) - zp) * q_scale) * 2, 2) * this->anchors[anchor_start + a * 2 + 1];
+                        bbox_x -= bbox_w * 0.5; // center x to left top x
+                        bbox_y -= bbox_h * 0.5; // center y to left top y
+                        Object obj(bbox_x, bbox_y, bbox_w, bbox_h, class_id, obj_score);
+                        objs.push_back(obj);
                     }
                 }
             }
-            for(nn::Object &a :objs)
-            {
-                if(a.score != 0)
+        }
+
+        void _nms(std::vector<nn::Object> &objs)
+        {
+            _nms_engine.set_iou_th(_iou_th);
+            _nms_engine.clear();
+            _nms_engine.reserve(objs.size());
+            for (nn::Object &a : objs)
+                _nms_engine.add(a);
+            const std::vector<int> &keep = _nms_engine.run();
+            std::vector<nn::Object> result;
+            result.reserve(keep.size());
+            for (int i : keep)
+            {
+                nn::Object &a = objs[i];
+                if (a.x < 0)
                 {
-                    if (a.x < 0)
-                    {
-                        a.w += a.x;
-                        a.x = 0;
-                    }
-                    if (a.y < 0)
-                    {
-                        a.h += a.y;
-                        a.y = 0;
-                    }
-                    if (a.x + a.w > _input_size.width())
-                    {
-                        a.w = _input_size.width() - a.x;
-                    }
-                    if (a.y + a.h > _input_size.height())
-                    {
-                        a.h = _input_size.height() - a.y;
-                    }
-                    result->push_back(a);
+                    a.w += a.x;
+                    a.x = 0;
                 }
+                if (a.y < 0)
+                {
+                    a.h += a.y;
+                    a.y = 0;
+                }
+                if (a.x + a.w > _input_size.width())
+                {
+                    a.w = _input_size.width() - a.x;
+                }
+                if (a.y + a.h > _input_size.height())
+                {
+                    a.h = _input_size.height() - a.y;
+                }
+                result.push_back(std::move(a));
             }
-            return result;
+            objs.swap(result);
         }
 
         void _sort_objects(std::vector<nn::Object> &objects, int sort)
@@ -571,18 +630,6 @@ namespace maix::nn
 
         inline static float _sigmoid(float x) { return 1.0 / (1 + expf(-x)); }
 
-        inline static float _calc_iou(Object &a, Object &b)
-        {
-            float area1 = a.w * a.h;
-            float area2 = b.w * b.h;
-            float wi = std::min((a.x + a.w), (b.x + b.w)) -
-                       std::max(a.x, b.x);
-            float hi = std::min((a.y + a.h), (b.y + b.h)) -
-                       std::max(a.y, b.y);
-            float area_i = std::max(wi, 0.0f) * std::max(hi, 0.0f);
-            return area_i / (area1 + area2 - area_i);
-        }
-
         template <typename T>
         static int _argmax(const T *data, size_t len, size_t stride = 1)
         {
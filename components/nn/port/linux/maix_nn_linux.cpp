@@ -1,13 +1,752 @@
-
 #include "maix_nn.hpp"
+#include "maix_basic.hpp"
+#include "maix_nn_linux.hpp"
+#include "maix_nn_preprocess.hpp"
+
+#if ONNXRUNTIME_FOUND
+#include "onnxruntime_cxx_api.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
 
 namespace maix::nn
 {
     err::Err mud_load_raw_model(const std::string &model_path, MUD *mud_obj)
     {
+#if ONNXRUNTIME_FOUND
+        std::vector<std::string> ext = fs::splitext(model_path);
+        if (ext.size() == 2 && ext[1] == ".onnx")
+        {
+            mud_obj->type = "onnx";
+            mud_obj->items["basic"]["type"] = "onnx";
+            mud_obj->items["basic"]["model"] = fs::basename(model_path);
+            return err::ERR_NONE;
+        }
+        log::error("only support load raw .onnx model on linux");
+        return err::ERR_ARGS;
+#else
+        (void)model_path;
+        (void)mud_obj;
         log::error("mud_load_raw_model not impl yet");
         return err::ERR_NOT_IMPL;
+#endif
+    }
+
+#if ONNXRUNTIME_FOUND
+
+    class _NN_Linux_Slot
+    {
+    public:
+        std::vector<std::vector<uint8_t>> in_bufs;
+        std::vector<Ort::Value> in_values;
+        std::vector<std::vector<uint8_t>> out_bufs; // only for static shape outputs
+        std::vector<Ort::Value> out_values;
+        bool submitted = false;
+        err::Err err = err::ERR_NONE;
+    };
+
+    class _NN_Linux_Data
+    {
+    public:
+        Ort::Env env{nullptr};
+        Ort::Session *session = nullptr;
+        Ort::MemoryInfo mem_info{nullptr};
+        std::vector<std::string> in_names;
+        std::vector<std::string> out_names;
+        std::vector<const char *> in_names_c;
+        std::vector<const char *> out_names_c;
+        std::vector<ONNXTensorElementDataType> in_types;
+        std::vector<ONNXTensorElementDataType> out_types;
+        std::vector<bool> out_static;
+
+        // input image preprocess
+        image::Format input_fmt = image::FMT_INVALID;
+        image::Format preprocess_fmt = image::FMT_INVALID;
+        ImagePreprocess *preprocess = nullptr;
+
+        // dual buff, forward slot curr while slot 1 - curr is running
+        _NN_Linux_Slot slots[2];
+        int curr = 0;
+
+        // worker thread for dual buff mode
+        std::thread *worker = nullptr;
+        std::mutex mutex;
+        std::condition_variable cond;
+        int job = -1;
+        bool busy = false;
+        bool exit = false;
+    };
+
+    static err::Err _onnx_to_dtype(ONNXTensorElementDataType type, tensor::DType &dtype)
+    {
+        switch (type)
+        {
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8:
+            dtype = tensor::DType::UINT8;
+            break;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8:
+            dtype = tensor::DType::INT8;
+            break;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT16:
+            dtype = tensor::DType::UINT16;
+            break;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT16:
+            dtype = tensor::DType::INT16;
+            break;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT32:
+            dtype = tensor::DType::UINT32;
+            break;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32:
+            dtype = tensor::DType::INT32;
+            break;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16:
+            dtype = tensor::DType::FLOAT16;
+            break;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT:
+            dtype = tensor::DType::FLOAT32;
+            break;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_DOUBLE:
+            dtype = tensor::DType::FLOAT64;
+            break;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_BOOL:
+            dtype = tensor::DType::BOOL;
+            break;
+        default:
+            return err::ERR_NOT_IMPL;
+        }
+        return err::ERR_NONE;
+    }
+
+    static size_t _shape_bytes(const std::vector<int> &shape, tensor::DType dtype)
+    {
+        size_t n = 1;
+        for (auto i : shape)
+        {
+            n *= i;
+        }
+        return n * tensor::dtype_size[dtype];
+    }
+
+    static bool _shape_static(const std::vector<int> &shape)
+    {
+        for (auto i : shape)
+        {
+            if (i <= 0)
+                return false;
+        }
+        return true;
+    }
+
+    static void _worker_loop(_NN_Linux_Data *data)
+    {
+        while (1)
+        {
+            int job;
+            {
+                std::unique_lock<std::mutex> lock(data->mutex);
+                data->cond.wait(lock, [data] { return data->job >= 0 || data->exit; });
+                if (data->exit)
+                    break;
+                job = data->job;
+                data->job = -1;
+            }
+            _NN_Linux_Slot &slot = data->slots[job];
+            try
+            {
+                data->session->Run(Ort::RunOptions{nullptr}, data->in_names_c.data(), slot.in_values.data(), slot.in_values.size(),
+                                   data->out_names_c.data(), slot.out_values.data(), slot.out_values.size());
+                slot.err = err::ERR_NONE;
+            }
+            catch (const Ort::Exception &e)
+            {
+                log::error("onnxruntime run failed: %s", e.what());
+                slot.err = err::ERR_RUNTIME;
+            }
+            {
+                std::unique_lock<std::mutex> lock(data->mutex);
+                data->busy = false;
+            }
+            data->cond.notify_all();
+        }
+    }
+
+    static void _worker_submit(_NN_Linux_Data *data, int slot_idx)
+    {
+        {
+            std::unique_lock<std::mutex> lock(data->mutex);
+            data->job = slot_idx;
+            data->busy = true;
+        }
+        data->cond.notify_all();
+    }
+
+    static void _worker_wait(_NN_Linux_Data *data)
+    {
+        std::unique_lock<std::mutex> lock(data->mutex);
+        data->cond.wait(lock, [data] { return !data->busy; });
+    }
+
+    static void _worker_start(_NN_Linux_Data *data)
+    {
+        if (data->worker)
+            return;
+        data->exit = false;
+        data->job = -1;
+        data->busy = false;
+        data->worker = new std::thread(_worker_loop, data);
+    }
+
+    static void _worker_stop(_NN_Linux_Data *data)
+    {
+        if (!data->worker)
+            return;
+        _worker_wait(data);
+        {
+            std::unique_lock<std::mutex> lock(data->mutex);
+            data->exit = true;
+        }
+        data->cond.notify_all();
+        data->worker->join();
+        delete data->worker;
+        data->worker = nullptr;
+        for (int i = 0; i < 2; ++i)
+            data->slots[i].submitted = false;
+    }
+
+    // dynamic shape outputs are allocated by onnxruntime, reset to let it alloc again
+    static void _reset_dynamic_outputs(_NN_Linux_Data *data, _NN_Linux_Slot &slot)
+    {
+        for (size_t i = 0; i < slot.out_values.size(); ++i)
+        {
+            if (!data->out_static[i])
+                slot.out_values[i] = Ort::Value(nullptr);
+        }
+    }
+
+    static err::Err _run_sync(_NN_Linux_Data *data, _NN_Linux_Slot &slot)
+    {
+        _reset_dynamic_outputs(data, slot);
+        try
+        {
+            data->session->Run(Ort::RunOptions{nullptr}, data->in_names_c.data(), slot.in_values.data(), slot.in_values.size(),
+                               data->out_names_c.data(), slot.out_values.data(), slot.out_values.size());
+        }
+        catch (const Ort::Exception &e)
+        {
+            log::error("onnxruntime run failed: %s", e.what());
+            return err::ERR_RUNTIME;
+        }
+        return err::ERR_NONE;
+    }
+
+    static err::Err _collect_outputs(_NN_Linux_Data *data, _NN_Linux_Slot &slot, const std::vector<LayerInfo> &outputs_info, tensor::Tensors &outputs, bool copy_result)
+    {
+        bool alloc = outputs.size() == 0;
+        for (size_t i = 0; i < slot.out_values.size(); ++i)
+        {
+            Ort::Value &v = slot.out_values[i];
+            std::vector<int64_t> dims = v.GetTensorTypeAndShapeInfo().GetShape();
+            std::vector<int> shape(dims.begin(), dims.end());
+            tensor::DType dtype = outputs_info[i].dtype;
+            void *ptr = v.GetTensorMutableData<uint8_t>();
+            const std::string &name = data->out_names[i];
+            if (alloc)
+            {
+                tensor::Tensor *t = new tensor::Tensor(shape, dtype, ptr, copy_result);
+                outputs.add_tensor(name, t, false, true);
+                continue;
+            }
+            auto it = outputs.tensors.find(name);
+            if (it == outputs.tensors.end())
+                continue;
+            if (it->second->size_int() * tensor::dtype_size[it->second->dtype()] < (int)_shape_bytes(shape, dtype))
+            {
+                log::error("output tensor %s size not match", name.c_str());
+                return err::ERR_ARGS;
+            }
+            memcpy(it->second->data(), ptr, _shape_bytes(shape, dtype));
+        }
+        return err::ERR_NONE;
+    }
+
+    static void _release(_NN_Linux_Data *data)
+    {
+        _worker_stop(data);
+        for (int i = 0; i < 2; ++i)
+        {
+            _NN_Linux_Slot &slot = data->slots[i];
+            slot.in_values.clear();
+            slot.out_values.clear();
+            slot.in_bufs.clear();
+            slot.out_bufs.clear();
+            slot.submitted = false;
+        }
+        if (data->session)
+        {
+            delete data->session;
+            data->session = nullptr;
+        }
+        data->in_names.clear();
+        data->out_names.clear();
+        data->in_names_c.clear();
+        data->out_names_c.clear();
+        data->in_types.clear();
+        data->out_types.clear();
+        data->out_static.clear();
+        data->curr = 0;
+        if (data->preprocess)
+        {
+            delete data->preprocess;
+            data->preprocess = nullptr;
+        }
+        data->input_fmt = image::FMT_INVALID;
+    }
+
+    NN_Linux::NN_Linux(bool dual_buff)
+    {
+        _init(dual_buff);
+    }
+
+    NN_Linux::NN_Linux()
+    {
+        _init(false);
+    }
+
+    void NN_Linux::_init(bool dual_buff)
+    {
+        _loaded = false;
+        _enable_dual_buff = dual_buff;
+        _data = new _NN_Linux_Data();
+    }
+
+    NN_Linux::~NN_Linux()
+    {
+        unload();
+        delete (_NN_Linux_Data *)_data;
+        _data = nullptr;
+    }
+
+    err::Err NN_Linux::load(const MUD &mud, const std::string &dir)
+    {
+        _NN_Linux_Data *data = (_NN_Linux_Data *)_data;
+        if (_loaded)
+        {
+            log::error("model already loaded");
+            return err::ERR_NOT_PERMIT;
+        }
+        if (mud.type != "onnx")
+        {
+            log::error("model type %s not support on linux, only support onnx", mud.type.c_str());
+            return err::ERR_ARGS;
+        }
+        auto basic = mud.items.find("basic");
+        if (basic == mud.items.end() || basic->second.find("model") == basic->second.end())
+        {
+            log::error("basic.model not found in MUD file");
+            return err::ERR_ARGS;
+        }
+        std::string model_path = dir + "/" + basic->second.at("model");
+        if (!fs::exists(model_path))
+        {
+            log::error("model file %s not exists", model_path.c_str());
+            return err::ERR_NOT_FOUND;
+        }
+        std::map<std::string, std::string> extra;
+        auto extra_it = mud.items.find("extra");
+        if (extra_it != mud.items.end())
+            extra = extra_it->second;
+        int threads = 0;
+        if (extra.find("threads") != extra.end())
+            threads = std::atoi(extra["threads"].c_str());
+        nn::Layout input_layout = nn::Layout::UNKNOWN;
+        if (extra.find("input_layout") != extra.end())
+        {
+            if (extra["input_layout"] == "nchw")
+                input_layout = nn::Layout::NCHW;
+            else if (extra["input_layout"] == "nhwc")
+                input_layout = nn::Layout::NHWC;
+            else
+            {
+                log::error("input_layout %s not support, only support nchw, nhwc", extra["input_layout"].c_str());
+                return err::ERR_ARGS;
+            }
+        }
+
+        int input_w = 0, input_h = 0;
+        if (extra.find("input_width") != extra.end())
+            input_w = std::atoi(extra["input_width"].c_str());
+        if (extra.find("input_height") != extra.end())
+            input_h = std::atoi(extra["input_height"].c_str());
+
+        if (extra.find("input_type") != extra.end())
+        {
+            if (extra["input_type"] == "rgb")
+                data->input_fmt = image::FMT_RGB888;
+            else if (extra["input_type"] == "bgr")
+                data->input_fmt = image::FMT_BGR888;
+            else if (extra["input_type"] == "gray" || extra["input_type"] == "grayscale")
+                data->input_fmt = image::FMT_GRAYSCALE;
+        }
+
+        _inputs_info.clear();
+        _outputs_info.clear();
+        try
+        {
+            data->env = Ort::Env(ORT_LOGGING_LEVEL_ERROR, "maix_nn");
+            Ort::SessionOptions session_options;
+            session_options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+            if (threads > 0)
+                session_options.SetIntraOpNumThreads(threads);
+            data->session = new Ort::Session(data->env, model_path.c_str(), session_options);
+            data->mem_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+
+            Ort::AllocatorWithDefaultOptions allocator;
+            for (size_t i = 0; i < data->session->GetInputCount(); ++i)
+            {
+                Ort::AllocatedStringPtr name = data->session->GetInputNameAllocated(i, allocator);
+                Ort::TypeInfo type_info = data->session->GetInputTypeInfo(i);
+                auto tensor_info = type_info.GetTensorTypeAndShapeInfo();
+                std::vector<int64_t> dims = tensor_info.GetShape();
+                LayerInfo info;
+                info.name = name.get();
+                if (_onnx_to_dtype(tensor_info.GetElementType(), info.dtype) != err::ERR_NONE)
+                {
+                    log::error("input %s data type %d not support", info.name.c_str(), tensor_info.GetElementType());
+                    _release(data);
+                    return err::ERR_NOT_IMPL;
+                }
+                for (size_t j = 0; j < dims.size(); ++j)
+                {
+                    // dynamic batch is fixed to 1
+                    info.shape.push_back((j == 0 && dims[j] <= 0) ? 1 : (int)dims[j]);
+                }
+                if (info.shape.size() == 4)
+                {
+                    if (input_layout != nn::Layout::UNKNOWN)
+                        info.layout = input_layout;
+                    else if (info.shape[1] > 0 && info.shape[1] <= 4)
+                        info.layout = nn::Layout::NCHW;
+                    else if (info.shape[3] > 0 && info.shape[3] <= 4)
+                        info.layout = nn::Layout::NHWC;
+                    else
+                        info.layout = nn::Layout::NCHW;
+                    // dynamic height and width are set by MUD extra or the same as the first input
+                    int h_idx = info.layout == nn::Layout::NCHW ? 2 : 1;
+                    if (info.shape[h_idx] <= 0)
+                        info.shape[h_idx] = input_h;
+                    if (info.shape[h_idx + 1] <= 0)
+                        info.shape[h_idx + 1] = input_w;
+                    if (input_h <= 0)
+                        input_h = info.shape[h_idx];
+                    if (input_w <= 0)
+                        input_w = info.shape[h_idx + 1];
+                }
+                for (auto v : info.shape)
+                {
+                    if (v <= 0)
+                    {
+                        log::error("input %s has dynamic shape, set input_width and input_height in MUD extra, or export model with static shape", info.name.c_str());
+                        _release(data);
+                        return err::ERR_ARGS;
+                    }
+                }
+                data->in_names.push_back(info.name);
+                data->in_types.push_back(tensor_info.GetElementType());
+                _inputs_info.push_back(info);
+            }
+            for (size_t i = 0; i < data->session->GetOutputCount(); ++i)
+            {
+                Ort::AllocatedStringPtr name = data->session->GetOutputNameAllocated(i, allocator);
+                Ort::TypeInfo type_info = data->session->GetOutputTypeInfo(i);
+                auto tensor_info = type_info.GetTensorTypeAndShapeInfo();
+                std::vector<int64_t> dims = tensor_info.GetShape();
+                LayerInfo info;
+                info.name = name.get();
+                if (_onnx_to_dtype(tensor_info.GetElementType(), info.dtype) != err::ERR_NONE)
+                {
+                    log::error("output %s data type %d not support", info.name.c_str(), tensor_info.GetElementType());
+                    _release(data);
+                    return err::ERR_NOT_IMPL;
+                }
+                for (size_t j = 0; j < dims.size(); ++j)
+                {
+                    info.shape.push_back((j == 0 && dims[j] <= 0) ? 1 : (int)dims[j]);
+                }
+                if (info.shape.size() == 4)
+                    info.layout = nn::Layout::NCHW;
+                data->out_names.push_back(info.name);
+                data->out_types.push_back(tensor_info.GetElementType());
+                data->out_static.push_back(_shape_static(std::vector<int>(dims.begin(), dims.end())));
+                _outputs_info.push_back(info);
+            }
+            for (auto &name : data->in_names)
+                data->in_names_c.push_back(name.c_str());
+            for (auto &name : data->out_names)
+                data->out_names_c.push_back(name.c_str());
+
+            // static shape outputs write to our own buffers directly, so copy_result=false is zero copy
+            for (int s = 0; s < 2; ++s)
+            {
+                _NN_Linux_Slot &slot = data->slots[s];
+                slot.in_bufs.resize(_inputs_info.size());
+                for (size_t i = 0; i < _inputs_info.size(); ++i)
+                    slot.in_values.emplace_back(nullptr);
+                slot.out_bufs.resize(_outputs_info.size());
+                for (size_t i = 0; i < _outputs_info.size(); ++i)
+                {
+                    if (!data->out_static[i])
+                    {
+                        slot.out_values.emplace_back(nullptr);
+                        continue;
+                    }
+                    std::vector<int64_t> dims(_outputs_info[i].shape.begin(), _outputs_info[i].shape.end());
+                    slot.out_bufs[i].resize(_shape_bytes(_outputs_info[i].shape, _outputs_info[i].dtype));
+                    slot.out_values.emplace_back(Ort::Value::CreateTensor(data->mem_info, slot.out_bufs[i].data(), slot.out_bufs[i].size(),
+                                                                          dims.data(), dims.size(), data->out_types[i]));
+                }
+            }
+        }
+        catch (const Ort::Exception &e)
+        {
+            log::error("load onnx model %s failed: %s", model_path.c_str(), e.what());
+            _release(data);
+            return err::ERR_RUNTIME;
+        }
+        if (_enable_dual_buff)
+            _worker_start(data);
+        _loaded = true;
+        return err::ERR_NONE;
+    }
+
+    err::Err NN_Linux::unload()
+    {
+        if (!_loaded)
+            return err::ERR_NONE;
+        _release((_NN_Linux_Data *)_data);
+        _inputs_info.clear();
+        _outputs_info.clear();
+        _loaded = false;
+        return err::ERR_NONE;
+    }
+
+    bool NN_Linux::loaded()
+    {
+        return _loaded;
     }
 
+    void NN_Linux::set_dual_buff(bool enable)
+    {
+        _NN_Linux_Data *data = (_NN_Linux_Data *)_data;
+        if (enable == _enable_dual_buff)
+            return;
+        _enable_dual_buff = enable;
+        if (!_loaded)
+            return;
+        if (enable)
+            _worker_start(data);
+        else
+            _worker_stop(data);
+        data->curr = 0;
+    }
+
+    std::vector<LayerInfo> NN_Linux::inputs_info()
+    {
+        return _inputs_info;
+    }
+
+    std::vector<LayerInfo> NN_Linux::outputs_info()
+    {
+        return _outputs_info;
+    }
+
+    err::Err NN_Linux::_run(tensor::Tensors &outputs, bool copy_result, bool dual_buff_wait)
+    {
+        _NN_Linux_Data *data = (_NN_Linux_Data *)_data;
+        if (!_enable_dual_buff)
+        {
+            _NN_Linux_Slot &slot = data->slots[0];
+            err::Err e = _run_sync(data, slot);
+            if (e != err::ERR_NONE)
+                return e;
+            return _collect_outputs(data, slot, _outputs_info, outputs, copy_result);
+        }
+
+        // dual buff: inputs already prepared in slot curr, another slot may be running or hold the last result.
+        int curr = data->curr;
+        int prev = 1 - curr;
+        _NN_Linux_Slot &slot = data->slots[curr];
+        _NN_Linux_Slot &last = data->slots[prev];
+        _worker_wait(data);
+        if (dual_buff_wait)
+        {
+            last.submitted = false;
+            err::Err e = _run_sync(data, slot);
+            if (e != err::ERR_NONE)
+                return e;
+            return _collect_outputs(data, slot, _outputs_info, outputs, copy_result);
+        }
+        _reset_dynamic_outputs(data, slot);
+        slot.submitted = true;
+        _worker_submit(data, curr);
+        data->curr = prev;
+        if (!last.submitted)
+            return err::ERR_NOT_READY;
+        last.submitted = false;
+        if (last.err != err::ERR_NONE)
+            return last.err;
+        return _collect_outputs(data, last, _outputs_info, outputs, copy_result);
+    }
+
+    err::Err NN_Linux::forward(tensor::Tensors &inputs, tensor::Tensors &outputs, bool copy_result, bool dual_buff_wait)
+    {
+        _NN_Linux_Data *data = (_NN_Linux_Data *)_data;
+        if (!_loaded)
+        {
+            log::error("model not loaded");
+            return err::ERR_NOT_READY;
+        }
+        if (inputs.size() != _inputs_info.size())
+        {
+            log::error("model need %d inputs, but got %d", (int)_inputs_info.size(), (int)inputs.size());
+            return err::ERR_ARGS;
+        }
+        _NN_Linux_Slot &slot = data->slots[_enable_dual_buff ? data->curr : 0];
+        std::vector<std::string> keys = inputs.keys();
+        for (size_t i = 0; i < _inputs_info.size(); ++i)
+        {
+            // find by name first, or by order
+            tensor::Tensor *t = nullptr;
+            auto it = inputs.tensors.find(_inputs_info[i].name);
+            if (it != inputs.tensors.end())
+                t = it->second;
+            else
+                t = &inputs[keys[i]];
+            if (t->dtype() != _inputs_info[i].dtype)
+            {
+                log::error("input %s need dtype %s, but got %s", _inputs_info[i].name.c_str(),
+                           tensor::dtype_name[_inputs_info[i].dtype].c_str(), tensor::dtype_name[t->dtype()].c_str());
+                return err::ERR_ARGS;
+            }
+            std::vector<int> shape = t->shape();
+            std::vector<int64_t> dims(shape.begin(), shape.end());
+            size_t bytes = _shape_bytes(shape, t->dtype());
+            void *ptr = t->data();
+            // dual buff mode caller may change input data when model running, so copy it.
+            if (_enable_dual_buff)
+            {
+                slot.in_bufs[i].resize(bytes);
+                memcpy(slot.in_bufs[i].data(), ptr, bytes);
+                ptr = slot.in_bufs[i].data();
+            }
+            try
+            {
+                slot.in_values[i] = Ort::Value::CreateTensor(data->mem_info, ptr, bytes, dims.data(), dims.size(), data->in_types[i]);
+            }
+            catch (const Ort::Exception &e)
+            {
+                log::error("create input tensor %s failed: %s", _inputs_info[i].name.c_str(), e.what());
+                return err::ERR_ARGS;
+            }
+        }
+        return _run(outputs, copy_result, dual_buff_wait);
+    }
+
+    tensor::Tensors *NN_Linux::forward(tensor::Tensors &inputs, bool copy_result, bool dual_buff_wait)
+    {
+        tensor::Tensors *outputs = new tensor::Tensors();
+        err::Err e = forward(inputs, *outputs, copy_result, dual_buff_wait);
+        if (e != err::ERR_NONE)
+        {
+            delete outputs;
+            if (e == err::ERR_NOT_READY)
+                return nullptr;
+            throw err::Exception(e, "forward failed");
+        }
+        return outputs;
+    }
+
+    tensor::Tensors *NN_Linux::forward_image(image::Image &img, std::vector<float> mean, std::vector<float> scale, image::Fit fit, bool copy_result, bool dual_buff_wait, bool chw)
+    {
+        _NN_Linux_Data *data = (_NN_Linux_Data *)_data;
+        if (!_loaded)
+        {
+            throw err::Exception(err::ERR_NOT_READY, "model not loaded");
+        }
+        LayerInfo &info = _inputs_info[0];
+        if (info.shape.size() != 4)
+        {
+            throw err::Exception(err::ERR_ARGS, "model input is not image");
+        }
+        bool input_chw = info.layout != nn::Layout::NHWC;
+        // input memory layout is decided by model, only accept chw=false for nhwc models
+        if (!chw && input_chw)
+        {
+            log::error("forward_image with chw=false need model input layout nhwc, set extra.input_layout in mud file");
+            throw err::Exception(err::ERR_NOT_IMPL, "hwc input for nchw model not support");
+        }
+        int input_w = input_chw ? info.shape[3] : info.shape[2];
+        int input_h = input_chw ? info.shape[2] : info.shape[1];
+        int input_c = input_chw ? info.shape[1] : info.shape[3];
+        if (input_c != 1 && input_c != 3)
+        {
+            log::error("model input channel %d not support for forward_image", input_c);
+            throw err::Exception(err::ERR_ARGS, "model input channel not support");
+        }
+        // model input color format, from MUD extra.input_type, or same as image
+        image::Format input_fmt = data->input_fmt;
+        if (input_fmt == image::FMT_INVALID)
+        {
+            if (input_c == 1)
+                input_fmt = image::FMT_GRAYSCALE;
+            else if (img.format() == image::FMT_BGR888 || img.format() == image::FMT_BGRA8888)
+                input_fmt = image::FMT_BGR888;
+            else
+                input_fmt = image::FMT_RGB888;
+        }
+        ImagePreprocess *pre = data->preprocess;
+        if (!pre || pre->width() != input_w || pre->height() != input_h || data->preprocess_fmt != input_fmt)
+        {
+            delete pre;
+            pre = new ImagePreprocess(input_w, input_h, input_fmt, info.dtype, input_chw, mean, scale);
+            data->preprocess = pre;
+            data->preprocess_fmt = input_fmt;
+        }
+        else
+        {
+            pre->set_norm(mean, scale);
+        }
+
+        _NN_Linux_Slot &slot = data->slots[_enable_dual_buff ? data->curr : 0];
+        std::vector<uint8_t> &buf = slot.in_bufs[0];
+        buf.resize(_shape_bytes(info.shape, info.dtype));
+        err::Err e = pre->run(img, buf.data(), fit);
+        if (e != err::ERR_NONE)
+        {
+            throw err::Exception(e, "preprocess image failed");
+        }
+        std::vector<int64_t> dims(info.shape.begin(), info.shape.end());
+        try
+        {
+            slot.in_values[0] = Ort::Value::CreateTensor(data->mem_info, buf.data(), buf.size(), dims.data(), dims.size(), data->in_types[0]);
+        }
+        catch (const Ort::Exception &e)
+        {
+            throw err::Exception(err::ERR_RUNTIME, std::string("create input tensor failed: ") + e.what());
+        }
+        tensor::Tensors *outputs = new tensor::Tensors();
+        e = _run(*outputs, copy_result, dual_buff_wait);
+        if (e != err::ERR_NONE)
+        {
+            delete outputs;
+            if (e == err::ERR_NOT_READY)
+                return nullptr;
+            throw err::Exception(e, "forward failed");
+        }
+        return outputs;
+    }
+
+#endif // ONNXRUNTIME_FOUND
+
 } // namespace maix::nn
 
@@ -6,4 +6,91 @@ namespace maix::nn
 {
     err::Err mud_load_raw_model(const std::string &model_path, MUD *mud_obj);
 
+    /**
+     * CPU NN backend for linux platform, run onnx model with onnxruntime.
+     * MUD file's basic.type should be `onnx`, basic.model is the onnx model file path relative to MUD file.
+     * Optional extra.input_layout(`nchw` or `nhwc`) set input layout, if not set, will guess from input shape.
+     * Optional extra.threads set onnxruntime intra op threads number, default 0 means decided by onnxruntime.
+     * Optional extra.input_type(`rgb`, `bgr` or `gray`) set model input color format for forward_image, if not set, will follow input image.
+     */
+    class NN_Linux : public NNBase
+    {
+    public:
+        NN_Linux(bool dual_buff);
+        NN_Linux();
+        ~NN_Linux();
+
+        /**
+         * Load model from file
+         * @param[in] mud simply parsed model describe object
+         * @return error code, if load success, return err::ERR_NONE
+         */
+        virtual err::Err load(const MUD &mud, const std::string &dir) final;
+
+        /**
+         * Unload model
+         * @return error code, if unload success, return err::ERR_NONE
+         */
+        virtual err::Err unload() final;
+
+        /**
+         * Is model loaded
+         * @return true if model loaded, else false
+         */
+        virtual bool loaded() final;
+
+        /**
+         * Enable dual buff or disable dual buff
+         * @param enable true to enable, false to disable
+         */
+        virtual void set_dual_buff(bool enable);
+
+        /**
+         * Get model input layer info
+         * @return input layer info
+         */
+        std::vector<LayerInfo> inputs_info();
+
+        /**
+         * Get model output layer info
+         * @return output layer info
+         */
+        std::vector<LayerInfo> outputs_info();
+
+        /**
+         * forward run model, get output of model
+         * @param[in] input input tensor
+         * @param[out] output output tensor
+         * @return error code, if forward success, return err::ERR_NONE
+         */
+        virtual err::Err forward(tensor::Tensors &inputs, tensor::Tensors &outputs, bool copy_result = true, bool dual_buff_wait = false) final;
+
+        /**
+         * forward run model, get output of model,
+         * this is specially for MaixPy, not efficient, but easy to use in MaixPy
+         * @param[in] input input tensor
+         * @return output tensor
+         */
+        virtual tensor::Tensors *forward(tensor::Tensors &inputs, bool copy_result = true, bool dual_buff_wait = false) final;
+
+        /**
+         * forward model, param is image
+         * @param[in] img input image
+         * @param[in] chw deprecated and ignored, the same as NN::forward_image,
+         *                input layout is decided by model input shape or MUD extra.input_layout.
+         * @return output tensor
+         */
+        virtual tensor::Tensors *forward_image(image::Image &img, std::vector<float> mean = std::vector<float>(), std::vector<float> scale = std::vector<float>(), image::Fit fit = image::Fit::FIT_CONTAIN, bool copy_result = true, bool dual_buff_wait = false, bool chw = true) final;
+
+    private:
+        bool _loaded;
+        void *_data;
+        bool _enable_dual_buff;
+        std::vector<LayerInfo> _inputs_info;
+        std::vector<LayerInfo> _outputs_info;
+        void _init(bool dual_buff = true);
+        err::Err _run(tensor::Tensors &outputs, bool copy_result, bool dual_buff_wait);
+    };
+
 } // namespace maix::nn
+
@@ -33,4 +33,8 @@ namespace maix::nn
     Bytes *MeloTTS::infer(std::string text, std::string path, bool output_pcm) {
         return nullptr;
     }
+
+    err::Err MeloTTS::infer_stream(std::string text, std::function<void(Bytes *)> callback, int queue_num, int fade_ms) {
+        return err::ERR_NOT_IMPL;
+    }
 } // namespace maix::nn
\ No newline at end of file
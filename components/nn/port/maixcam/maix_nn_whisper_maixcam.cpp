@@ -39,4 +39,19 @@ namespace maix::nn
     std::string Whisper::transcribe_raw(Bytes *pcm, int sample_rate, int channels, int bits_per_frame) {
         return "";
     }
+
+    err::Err Whisper::stream_start(std::function<void(std::string, bool)> callback, int silence_ms, float vad_threshold, int partial_ms, int max_segment_ms) {
+        return err::ERR_NOT_IMPL;
+    }
+
+    err::Err Whisper::stream_push(Bytes *pcm, int channels, int bits_per_frame) {
+        return err::ERR_NOT_IMPL;
+    }
+
+    std::string Whisper::stream_stop() {
+        return "";
+    }
+
+    void Whisper::_stream_deliver() {
+    }
 } // namespace maix::nn
\ No newline at end of file
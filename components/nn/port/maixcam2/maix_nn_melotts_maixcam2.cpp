@@ -3,6 +3,8 @@
  * @copyright Sipeed Ltd 2024-
  * @license Apache 2.0
  * @update 2025.5.20: Add melotts support.
+ * @update 2026.10.18: Use compiled and memory mapped lexicon.
+ * @update 2026.10.18: Add sentence streaming synthesis.
  */
 
 #include "maix_basic.hpp"
@@ -19,152 +21,108 @@
 #include <fstream>
 #include "onnxruntime/onnxruntime_cxx_api.h"
 #include "maix_nn_melotts.hpp"
+#include "maix_nn_lexicon.hpp"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
 
 namespace maix::nn
 {
     namespace {
-        class Lexicon {
+        // text to phones and tones, words are matched by longest prefix in compiled lexicon
+        class G2P {
         private:
-            std::unordered_map<std::string, std::pair<std::vector<int>, std::vector<int>>> lexicon;
+            nn::Lexicon _lexicon;
+            int _blank;                                     // token of " "
+            std::unordered_map<std::string, int> _punctuation;  // punctuation to token
+            std::unordered_map<std::string, std::string> _alias;
+
+            static int utf8_len(unsigned char c) {
+                if ((c & 0xE0) == 0xC0) return 2;
+                if ((c & 0xF0) == 0xE0) return 3;
+                if ((c & 0xF8) == 0xF0) return 4;
+                return 1;
+            }
 
-        public:
-            Lexicon(const std::string& lexicon_filename, const std::string& tokens_filename) {
-                std::unordered_map<std::string, int> tokens;
-                std::ifstream ifs(tokens_filename);
-                assert(ifs.is_open());
-
-                std::string line;
-                while ( std::getline(ifs, line) ) {
-                    auto splitted_line = split(line, ' ');
-                    tokens.insert({splitted_line[0], std::stoi(splitted_line[1])});
-                }
-                ifs.close();
-
-                ifs.open(lexicon_filename);
-                assert(ifs.is_open());
-                while ( std::getline(ifs, line) ) {
-                    auto splitted_line = split(line, ' ');
-                    std::string word_or_phrase = splitted_line[0];
-                    size_t phone_tone_len = splitted_line.size() - 1;
-                    size_t half_len = phone_tone_len / 2;
-                    std::vector<int> phones, tones;
-                    for (size_t i = 0; i < phone_tone_len; i++) {
-                        auto phone_or_tone = splitted_line[i + 1];
-                        if (i < half_len) {
-                            phones.push_back(tokens[phone_or_tone]);
-                        } else {
-                            tones.push_back(std::stoi(phone_or_tone));
-                        }
-                    }
+            static bool is_english(char c) {
+                return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+            }
 
-                    lexicon.insert({word_or_phrase, std::make_pair(phones, tones)});
-                }
+            void push_token(int token, std::vector<int>& phones, std::vector<int>& tones, std::vector<int>& word2ph) {
+                phones.push_back(token);
+                tones.push_back(0);
+                word2ph.push_back(1);
+            }
 
-                lexicon["呣"] = lexicon["母"];
-                lexicon["嗯"] = lexicon["恩"];
+            void push_entry(const nn::Lexicon::Entry &e, std::vector<int>& phones, std::vector<int>& tones, std::vector<int>& word2ph) {
+                phones.insert(phones.end(), e.phones, e.phones + e.num);
+                tones.insert(tones.end(), e.tones, e.tones + e.num);
+                word2ph.push_back(e.num);
+            }
 
+        public:
+            err::Err load(const std::string& lexicon_filename, const std::string& tokens_filename) {
+                err::Err e = _lexicon.load(lexicon_filename, tokens_filename);
+                if (e != err::ERR_NONE) {
+                    return e;
+                }
+                _blank = std::max(_lexicon.token("_"), 0);
                 const std::vector<std::string> punctuation{"!", "?", "…", ",", ".", "'", "-"};
                 for (auto p : punctuation) {
-                    int i = tokens[p];
-                    int tone = 0;
-                    lexicon[p] = std::make_pair(std::vector<int>{i}, std::vector<int>{tone});
+                    _punctuation[p] = std::max(_lexicon.token(p), 0);
                 }
-                lexicon[" "] = std::make_pair(std::vector<int>{tokens["_"]}, std::vector<int>{0});
+                _punctuation["，"] = _punctuation[","];
+                _punctuation["。"] = _punctuation["."];
+                _punctuation["！"] = _punctuation["!"];
+                _punctuation["？"] = _punctuation["?"];
+                _alias["呣"] = "母";
+                _alias["嗯"] = "恩";
+                return err::ERR_NONE;
             }
 
-            std::vector<std::string> split (const std::string &s, char delim) {
-                std::vector<std::string> result;
-                std::stringstream ss (s);
-                std::string item;
-                while (getline (ss, item, delim)) {
-                    result.push_back (item);
-                }
-                return result;
-            }
-
-            std::vector<std::string> splitEachChar(const std::string& text)
-            {
-                std::vector<std::string> words;
-                std::string input(text);
-                int len = input.length();
+            void convert(const std::string& text, std::vector<int>& phones, std::vector<int>& tones, std::vector<int>& word2ph) {
+                const char *str = text.c_str();
+                int len = text.size();
                 int i = 0;
-
+                nn::Lexicon::Entry entry;
                 while (i < len) {
-                int next = 1;
-                if ((input[i] & 0x80) == 0x00) {
-                    // std::cout << "one character: " << input[i] << std::endl;
-                } else if ((input[i] & 0xE0) == 0xC0) {
-                    next = 2;
-                    // std::cout << "two character: " << input.substr(i, next) << std::endl;
-                } else if ((input[i] & 0xF0) == 0xE0) {
-                    next = 3;
-                    // std::cout << "three character: " << input.substr(i, next) << std::endl;
-                } else if ((input[i] & 0xF8) == 0xF0) {
-                    next = 4;
-                    // std::cout << "four character: " << input.substr(i, next) << std::endl;
-                }
-                words.push_back(input.substr(i, next));
-                i += next;
-                }
-                return words;
-            }
-
-            bool is_english(std::string s) {
-                if (s.size() == 1)
-                    return (s[0] >= 'A' && s[0] <= 'Z') || (s[0] >= 'a' && s[0] <= 'z');
-                else
-                    return false;
-            }
-
-            std::vector<std::string> merge_english(const std::vector<std::string>& splitted_text) {
-                std::vector<std::string> words;
-                size_t i = 0;
-                while (i < splitted_text.size()) {
-                    std::string s;
-                    if (is_english(splitted_text[i])) {
-                        while (i < splitted_text.size()) {
-                            if (!is_english(splitted_text[i])) {
-                                break;
-                            }
-                            s += splitted_text[i];
+                    // english word, lower case
+                    if (is_english(str[i])) {
+                        std::string word;
+                        while (i < len && is_english(str[i])) {
+                            word += std::tolower((unsigned char)str[i]);
                             i++;
                         }
-                        // to lowercase
-                        std::transform(s.begin(), s.end(), s.begin(),
-                            [](unsigned char c){ return std::tolower(c); });
-                        words.push_back(s);
-                        if (i >= splitted_text.size())
-                            break;
+                        if (_lexicon.find(word.c_str(), word.size(), entry)) {
+                            push_entry(entry, phones, tones, word2ph);
+                        } else {
+                            push_token(_blank, phones, tones, word2ph);
+                        }
+                        continue;
                     }
-                    else {
-                        words.push_back(splitted_text[i]);
-                        i++;
+                    int next = std::min(utf8_len(str[i]), len - i);
+                    std::string c(str + i, next);
+                    auto punc = _punctuation.find(c);
+                    if (punc != _punctuation.end()) {
+                        push_token(punc->second, phones, tones, word2ph);
+                        i += next;
+                        continue;
                     }
-                }
-                return words;
-            }
-
-            void convert(const std::string& text, std::vector<int>& phones, std::vector<int>& tones, std::vector<int>& word2ph) {
-                auto splitted_text = splitEachChar(text);
-                auto zh_mix_en = merge_english(splitted_text);
-                for (auto c : zh_mix_en) {
-                    std::string s{c};
-                    if (s == "，")
-                        s = ",";
-                    else if (s == "。")
-                        s = ".";
-                    else if (s == "！")
-                        s = "!";
-                    else if (s == "？")
-                        s = "?";
-
-                    auto phones_and_tones = lexicon[" "];
-                    if (lexicon.find(s) != lexicon.end()) {
-                        phones_and_tones = lexicon[s];
+                    auto alias = _alias.find(c);
+                    if (alias != _alias.end() && _lexicon.find(alias->second.c_str(), alias->second.size(), entry)) {
+                        push_entry(entry, phones, tones, word2ph);
+                        i += next;
+                        continue;
+                    }
+                    int matched = c == " " ? 0 : _lexicon.match(str + i, len - i, entry);
+                    if (matched > 0) {
+                        push_entry(entry, phones, tones, word2ph);
+                        i += matched;
+                    } else {
+                        push_token(_blank, phones, tones, word2ph);
+                        i += next;
                     }
-                    phones.insert(phones.end(), phones_and_tones.first.begin(), phones_and_tones.first.end());
-                    tones.insert(tones.end(), phones_and_tones.second.begin(), phones_and_tones.second.end());
-                    word2ph.push_back(phones_and_tones.first.size());
                 }
             }
         };
@@ -287,7 +245,7 @@ namespace maix::nn
             std::string language;
             bool dual_buff;
             std::map<string, string> extra_info;
-            std::unique_ptr<Lexicon> lexicon;
+            std::unique_ptr<G2P> lexicon;
             OnnxWrapper encoder;
             std::vector<float> g;
         };
@@ -692,7 +650,14 @@ namespace maix::nn
             return res;
         }
         std::string lexicon_file = fs::dirname(model) + "/" + value_string;
-        param->lexicon = std::make_unique<Lexicon>(lexicon_file, token_file);
+        // compiled lexicon is cached as lexicon_file + ".bin" and memory mapped
+        param->lexicon = std::make_unique<G2P>();
+        res = param->lexicon->load(lexicon_file, token_file);
+        if (res != err::ERR_NONE) {
+            log::error("load lexicon %s failed", lexicon_file.c_str());
+            this->unload();
+            return res;
+        }
         log::info("load token and lexicon cost %ld ms", time::ticks_ms() - start);
 
         start = time::ticks_ms();
@@ -777,6 +742,106 @@ namespace maix::nn
     //     }printf("\r\n");
     // }
 
+    /**
+     * Synthesize one sentence, audio of every decoder slice is output once decoded
+    */
+    static err::Err _synth_sentence(MelottsParam *param, const string &se, float length_scale, const std::function<void(const float *, int)> &on_audio) {
+        err::Err err = err::ERR_NONE;
+        float noise_scale   = param->noise_scale;
+        float noise_scale_w = param->noise_scale_w;
+        float sdp_ratio     = param->sdp_ratio;
+
+        // Convert sentence to phones and tones
+        std::vector<int> phones_bef, tones_bef, word2ph;
+        param->lexicon->convert(se, phones_bef, tones_bef, word2ph);
+
+        // Add blank between words
+        auto phones = intersperse(phones_bef, 0);
+        auto tones = intersperse(tones_bef, 0);
+        for (int& i : word2ph) {
+            i *= 2;
+        }
+        if (!word2ph.empty())
+            word2ph[0] += 1;
+
+        int phone_len = phones.size();
+
+        std::vector<int> langids(phone_len, 3);
+
+        // Run encoder
+        auto encoder_output = param->encoder.Run(phones, tones, langids, param->g, noise_scale, noise_scale_w, length_scale, sdp_ratio);
+        float* zp_data = encoder_output.at(0).GetTensorMutableData<float>();
+        int* pronoun_lens_data = encoder_output.at(1).GetTensorMutableData<int>();
+        // int audio_len = encoder_output.at(2).GetTensorMutableData<int>()[0];
+        auto zp_info = encoder_output.at(0).GetTensorTypeAndShapeInfo();
+        auto zp_shape = zp_info.GetShape();
+        std::vector<int> pronoun_lens(pronoun_lens_data, pronoun_lens_data + phone_len);
+
+        auto inputs_info = param->decoder_model->inputs_info();
+        auto outputs_info = param->decoder_model->outputs_info();
+        int zp_size = inputs_info[0].shape_int();
+        int dec_len = zp_size / zp_shape[1];
+        int audio_slice_len = outputs_info[0].shape_int();
+
+        // Generate pronoun slices for better effect
+        auto word2pronoun = calc_word2pronoun(word2ph, pronoun_lens);
+        auto dec_slices = generate_slices(word2pronoun, dec_len);
+
+        // int dec_slice_num = int(std::ceil(zp_shape[2] * 1.0 / dec_len));
+        size_t dec_slice_num = dec_slices.first.size();
+
+        // Iteratively run decoder
+        for (size_t i = 0; i < dec_slice_num; i++) {
+            const Slice& ps = dec_slices.first[i];
+            const Slice& zs = dec_slices.second[i];
+
+            std::vector<float> zp_slice(zp_size, 0);
+            int actual_size = std::min(zs.end - zs.start, dec_len);
+            for (int n = 0; n < zp_shape[1]; n++) {
+                memcpy(zp_slice.data() + n * dec_len, zp_data + n * zp_shape[2] + zs.start, sizeof(float) * actual_size);
+            }
+
+            // 输出音频的长度
+            int sub_audio_len = 512 * actual_size;
+            tensor::Tensors input_tensors, output_tensors;
+            tensor::Tensor *input_tensor0 = new tensor::Tensor(inputs_info[0].shape, inputs_info[0].dtype, zp_slice.data(), false);
+            tensor::Tensor *input_tensor1 = new tensor::Tensor(inputs_info[1].shape, inputs_info[1].dtype, param->g.data(), false);
+            input_tensors.add_tensor(inputs_info[0].name, input_tensor0, false, true);
+            input_tensors.add_tensor(inputs_info[1].name, input_tensor1, false, true);
+            if (err::ERR_NONE != (err = param->decoder_model->forward(input_tensors, output_tensors, false, true))) {
+                log::error("decoder forward failed! err:%d", err);
+                return err;
+            }
+            auto output_tensor = output_tensors.get_tensor(outputs_info[0].name);
+            if (output_tensor.size_int() != audio_slice_len) {
+                log::error("decoder output size error! %d != %d", output_tensor.size_int(), audio_slice_len);
+                return err::ERR_RUNTIME;
+            }
+
+            // 处理overlap
+            int audio_start = 0;
+            if (i > 0) {
+                if (dec_slices.first[i - 1].end > ps.start) {
+                    // 去掉第一个字
+                    audio_start = 512 * word2pronoun[ps.start];
+                }
+            }
+
+            int audio_end = sub_audio_len;
+            if (i < dec_slices.first.size() - 1) {
+                if (ps.end > dec_slices.first[i + 1].start) {
+                    // 去掉最后一个字
+                    audio_end = sub_audio_len - 512 * word2pronoun[ps.end - 1];
+                }
+            }
+
+            if (audio_end > audio_start) {
+                on_audio((float *)output_tensor.data() + audio_start, audio_end - audio_start);
+            }
+        }
+        return err::ERR_NONE;
+    }
+
     /**
      * Text to speech
      * @param text input text
@@ -788,102 +853,17 @@ namespace maix::nn
      * @maixpy maix.nn.MeloTTS.infer
     */
     Bytes *MeloTTS::infer(std::string text, std::string path, bool output_pcm) {
-        err::Err err = err::ERR_NONE;
         MelottsParam *param = (MelottsParam *)_extra_param;
-        float noise_scale   = param->noise_scale;
         float length_scale  = 1.0 / _speed;
-        float noise_scale_w = param->noise_scale_w;
-        float sdp_ratio     = param->sdp_ratio;
 
         auto sens = split_sentence(text, 10, param->language);
         std::vector<float> wavlist;
         for (auto& se : sens) {
-
-            // Convert sentence to phones and tones
-            std::vector<int> phones_bef, tones_bef, word2ph;
-            param->lexicon->convert(se, phones_bef, tones_bef, word2ph);
-
-            // Add blank between words
-            auto phones = intersperse(phones_bef, 0);
-            auto tones = intersperse(tones_bef, 0);
-            for (int& i : word2ph) {
-                i *= 2;
-            }
-            if (!word2ph.empty())
-                word2ph[0] += 1;
-
-            int phone_len = phones.size();
-
-            std::vector<int> langids(phone_len, 3);
-
-            // Run encoder
-            auto encoder_output = param->encoder.Run(phones, tones, langids, param->g, noise_scale, noise_scale_w, length_scale, sdp_ratio);
-            float* zp_data = encoder_output.at(0).GetTensorMutableData<float>();
-            int* pronoun_lens_data = encoder_output.at(1).GetTensorMutableData<int>();
-            // int audio_len = encoder_output.at(2).GetTensorMutableData<int>()[0];
-            auto zp_info = encoder_output.at(0).GetTensorTypeAndShapeInfo();
-            auto zp_shape = zp_info.GetShape();
-            std::vector<int> pronoun_lens(pronoun_lens_data, pronoun_lens_data + phone_len);
-
-            auto inputs_info = param->decoder_model->inputs_info();
-            auto outputs_info = param->decoder_model->outputs_info();
-            int zp_size = inputs_info[0].shape_int();
-            int dec_len = zp_size / zp_shape[1];
-            int audio_slice_len = outputs_info[0].shape_int();
-
-            // Generate pronoun slices for better effect
-            auto word2pronoun = calc_word2pronoun(word2ph, pronoun_lens);
-            auto dec_slices = generate_slices(word2pronoun, dec_len);
-
-            // int dec_slice_num = int(std::ceil(zp_shape[2] * 1.0 / dec_len));
-            size_t dec_slice_num = dec_slices.first.size();
-
-            // Iteratively run decoder
-            for (size_t i = 0; i < dec_slice_num; i++) {
-                const Slice& ps = dec_slices.first[i];
-                const Slice& zs = dec_slices.second[i];
-
-                std::vector<float> zp_slice(zp_size, 0);
-                int actual_size = std::min(zs.end - zs.start, dec_len);
-                for (int n = 0; n < zp_shape[1]; n++) {
-                    memcpy(zp_slice.data() + n * dec_len, zp_data + n * zp_shape[2] + zs.start, sizeof(float) * actual_size);
-                }
-
-                // 输出音频的长度
-                int sub_audio_len = 512 * actual_size;
-                tensor::Tensors input_tensors, output_tensors;
-                tensor::Tensor *input_tensor0 = new tensor::Tensor(inputs_info[0].shape, inputs_info[0].dtype, zp_slice.data(), false);
-                tensor::Tensor *input_tensor1 = new tensor::Tensor(inputs_info[1].shape, inputs_info[1].dtype, param->g.data(), false);
-                input_tensors.add_tensor(inputs_info[0].name, input_tensor0, false, true);
-                input_tensors.add_tensor(inputs_info[1].name, input_tensor1, false, true);
-                if (err::ERR_NONE != (err = param->decoder_model->forward(input_tensors, output_tensors, false, true))) {
-                    log::error("decoder forward failed! err:%d", err);
-                    return nullptr;
-                }
-                auto output_tensor = output_tensors.get_tensor(outputs_info[0].name);
-                if (output_tensor.size_int() != audio_slice_len) {
-                    log::error("decoder output size error! %d != %d", output_tensor.size_int(), audio_slice_len);
-                    return nullptr;
-                }
-
-                // 处理overlap
-                int audio_start = 0;
-                if (!wavlist.empty()) {
-                    if (dec_slices.first[i - 1].end > ps.start) {
-                        // 去掉第一个字
-                        audio_start = 512 * word2pronoun[ps.start];
-                    }
-                }
-
-                int audio_end = sub_audio_len;
-                if (i < dec_slices.first.size() - 1) {
-                    if (ps.end > dec_slices.first[i + 1].start) {
-                        // 去掉最后一个字
-                        audio_end = sub_audio_len - 512 * word2pronoun[ps.end - 1];
-                    }
-                }
-
-                wavlist.insert(wavlist.end(), (float *)output_tensor.data() + audio_start, (float *)output_tensor.data() + audio_end);
+            err::Err err = _synth_sentence(param, se, length_scale, [&wavlist](const float *data, int len) {
+                wavlist.insert(wavlist.end(), data, data + len);
+            });
+            if (err != err::ERR_NONE) {
+                return nullptr;
             }
         }
 
@@ -908,4 +888,131 @@ namespace maix::nn
         }
         return pcm;
     }
+    namespace {
+        class MelottsStreamChunk {
+        public:
+            std::vector<float> pcm;
+            bool sentence_start;
+        };
+
+        class MelottsStream {
+        public:
+            std::mutex lock;
+            std::condition_variable cond;
+            std::deque<MelottsStreamChunk> chunks;
+            size_t queue_num;
+            bool done = false;      // worker finished
+            bool exit = false;      // consumer stopped
+            err::Err err = err::ERR_NONE;
+        };
+    }
+
+    static void _stream_worker(MelottsParam *param, MelottsStream *st, std::vector<string> sens, float length_scale) {
+        err::Err err = err::ERR_NONE;
+        for (auto &se : sens) {
+            bool start = true;
+            err = _synth_sentence(param, se, length_scale, [st, &start](const float *data, int len) {
+                std::unique_lock<std::mutex> guard(st->lock);
+                st->cond.wait(guard, [st] { return st->exit || st->chunks.size() < st->queue_num; });
+                if (st->exit) {
+                    return;
+                }
+                st->chunks.push_back(MelottsStreamChunk{std::vector<float>(data, data + len), start});
+                start = false;
+                st->cond.notify_all();
+            });
+            std::lock_guard<std::mutex> guard(st->lock);
+            if (err != err::ERR_NONE || st->exit) {
+                break;
+            }
+        }
+        std::lock_guard<std::mutex> guard(st->lock);
+        st->err = err;
+        st->done = true;
+        st->cond.notify_all();
+    }
+
+    static void _stream_output(std::vector<float> &pcm, const std::function<void(Bytes *)> &callback) {
+        if (pcm.empty()) {
+            return;
+        }
+        Bytes *bytes = nullptr;
+        audio::File file;
+        file.float_to_pcm_bytes(pcm.data(), pcm.size(), 16, &bytes);
+        callback(bytes);
+        delete bytes;
+    }
+
+    /**
+     * Text to speech by streaming.
+     * @maixpy maix.nn.MeloTTS.infer_stream
+    */
+    err::Err MeloTTS::infer_stream(std::string text, std::function<void(Bytes *)> callback, int queue_num, int fade_ms) {
+        MelottsParam *param = (MelottsParam *)_extra_param;
+        if (!param->decoder_model) {
+            log::error("model not loaded");
+            return err::ERR_NOT_READY;
+        }
+        if (!callback) {
+            return err::ERR_ARGS;
+        }
+        MelottsStream st;
+        st.queue_num = queue_num < 1 ? 1 : queue_num;
+        auto sens = split_sentence(text, 10, param->language);
+        std::thread worker(_stream_worker, param, &st, sens, (float)(1.0 / _speed));
+
+        // the last fade samples are held back, mixed with the head of next sentence or output with next chunk
+        int fade = fade_ms > 0 ? (int64_t)fade_ms * _sample_rate / 1000 : 0;
+        std::vector<float> tail;
+        auto stop_worker = [&st, &worker]() {
+            {
+                std::lock_guard<std::mutex> guard(st.lock);
+                st.exit = true;
+                st.cond.notify_all();
+            }
+            worker.join();
+        };
+        try {
+            while (true) {
+                MelottsStreamChunk chunk;
+                {
+                    std::unique_lock<std::mutex> guard(st.lock);
+                    st.cond.wait(guard, [&st] { return st.done || !st.chunks.empty(); });
+                    if (st.chunks.empty()) {
+                        break;
+                    }
+                    chunk = std::move(st.chunks.front());
+                    st.chunks.pop_front();
+                    st.cond.notify_all();
+                }
+                if (app::need_exit()) {
+                    break;
+                }
+                std::vector<float> &pcm = chunk.pcm;
+                if (chunk.sentence_start) {
+                    // mix the end of tail with the head of new sentence, earlier part of tail is output first
+                    int n = std::min(tail.size(), pcm.size());
+                    int keep = (int)tail.size() - n;
+                    for (int i = 0; i < n; ++i) {
+                        float w = (float)(i + 1) / (n + 1);
+                        pcm[i] = tail[keep + i] * (1 - w) + pcm[i] * w;
+                    }
+                    pcm.insert(pcm.begin(), tail.begin(), tail.begin() + keep);
+                } else {
+                    pcm.insert(pcm.begin(), tail.begin(), tail.end());
+                }
+                int n = std::min((int)pcm.size(), fade);
+                tail.assign(pcm.end() - n, pcm.end());
+                pcm.resize(pcm.size() - n);
+                _stream_output(pcm, callback);
+            }
+            _stream_output(tail, callback);
+        } catch (...) {
+            // callback raise error, stop worker before rethrow, or joinable thread destruct will terminate
+            stop_worker();
+            throw;
+        }
+        stop_worker();
+        return st.err;
+    }
 } // namespace maix::nn
\ No newline at end of file
@@ -12,13 +12,17 @@
 #include "maix_nn_object.hpp"
 #include <math.h>
 #include "maix_nn_yolo11.hpp"
-#include "librosa_simple.hpp"
+#include "maix_nn_audio_feature.hpp"
 #include "maix_audio.hpp"
 #include <fstream>
 #include "opencc.h"
 #include "maix_nn_whisper.hpp"
 #include "uchardet.h"
 #include <iconv.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
 
 namespace maix::nn
 {
@@ -160,6 +164,7 @@ namespace maix::nn
             int n_text_state;
             std::map<string, string> extra_info;
             std::unique_ptr<opencc::SimpleConverter> simple_converter;
+            std::unique_ptr<nn::MelSpectrogram> mel;    // window, mel filters and FFT plan are created once when load
         };
     }
 
@@ -220,6 +225,9 @@ namespace maix::nn
     */
     err::Err Whisper::unload() {
         WhisperParam *param = (WhisperParam *) _extra_param;
+        if (_stream) {
+            stream_stop();
+        }
         if (param->encoder_model) {
             delete param->encoder_model;
             param->encoder_model = NULL;
@@ -321,6 +329,7 @@ namespace maix::nn
             return res;
         }
         param->n_mels = value_int;
+        param->mel.reset(new nn::MelSpectrogram(_input_pcm_samplerate, param->n_fft, param->n_hop, param->n_mels));
 
         res = __load_value_from_map(param->extra_info, "whisper_type", value_string);
         if (res != err::ERR_NONE) {
@@ -616,27 +625,16 @@ namespace maix::nn
 
 
     /**
-     * Transcribe pcm data to text
-     * @param pcm RAW data
-     * @return The output result after automatic speech recognition.
-     * @maixpy maix.nn.Whisper.transcribe_raw
+     * Convert pcm to float, only the first channel is used
     */
-    std::string Whisper::transcribe_raw(Bytes *pcm, int sample_rate, int channels, int bits_per_frame) {
-        err::Err err = err::ERR_NONE;
-        if (!pcm || pcm->data_len == 0) {
-            log::info("pcm data is empty");
-            return "";
-        }
-
-        WhisperParam *param = (WhisperParam *) _extra_param;
-        if (sample_rate != _input_pcm_samplerate) {
-            log::error("wav sample rate not match, must be %d!", _input_pcm_samplerate);
-            return "";
-        }
-
+    static err::Err _pcm_to_float(Bytes *pcm, int channels, int bits_per_frame, std::vector<float> &pcm_data) {
         int bytes_per_frame = bits_per_frame * channels / 8;
+        if (bytes_per_frame <= 0) {
+            log::error("unsupported sample bit %d", bits_per_frame);
+            return err::ERR_ARGS;
+        }
         int num_of_samples = pcm->data_len / bytes_per_frame;
-        std::vector<float> pcm_data(num_of_samples);
+        pcm_data.resize(num_of_samples);
         for (int i = 0; i < num_of_samples; i ++) {
             uint8_t *data = pcm->data + i * bytes_per_frame;
             switch (bits_per_frame) {
@@ -668,67 +666,28 @@ namespace maix::nn
             }
             default:
                 log::error("unsupported sample bit %d", bits_per_frame);
-                return "";
-            }
-        }
-        // print_test("pcm_data_F", (float *)pcm_data.data(), pcm_data.size(), 100);
-        // print_test("pcm_data", (uint8_t *)pcm->data, pcm->data_len, 100);
-        auto mel = librosa_simple::Feature::melspectrogram(pcm_data, _input_pcm_samplerate, param->n_fft, param->n_hop, "hann", true, "reflect", 2.0f, param->n_mels, 0.0f, _input_pcm_samplerate / 2);
-        int n_mel = mel.size();
-        int n_len = mel[0].size();
-
-        // clamping and normalization
-        double mmax = -1e20;
-        for (int i = 0; i < WHISPER_N_MELS; i++) {
-            for (int n = 0; n < n_len; n++) {
-                mel[i][n] = std::log10(std::max(mel[i][n], 1e-10f));
-
-                if (mel[i][n] > mmax) {
-                    mmax = mel[i][n] ;
-                }
+                return err::ERR_ARGS;
             }
         }
+        return err::ERR_NONE;
+    }
 
-        for (int i = 0; i < WHISPER_N_MELS; i++) {
-            for (int n = 0; n < n_len; n++) {
-                mel[i][n] = (std::max(mel[i][n], (float)(mmax - 8.0)) + 4.0)/4.0;
-                mel[i].resize(3000);
-            }
-        }
-
-        n_len = mel[0].size();
-
+    /**
+     * Run encoder and decoder on one 30s window
+     * @param mel_input whisper encoder input, [n_mels, 3000]
+     * @param max_tokens max tokens to decode, partial results use less tokens.
+    */
+    static std::string _whisper_decode(WhisperParam *param, float *mel_input, int max_tokens = WHISPER_N_TEXT_CTX) {
+        err::Err err = err::ERR_NONE;
         int offset = 0;
         std::vector<float> logits(WHISPER_VOCAB_SIZE);
         int max_token_id = -1;
         std::vector<int> results;
         std::vector<int> tokens(1);
-
-        auto encoder_outputs_info0 = param->encoder_model->outputs_info()[0];
-        auto encoder_outputs_info1 = param->encoder_model->outputs_info()[1];
-        auto encoder_ouptut_size0 = encoder_outputs_info0.shape_int() * tensor::dtype_size[encoder_outputs_info0.dtype];
-        auto encoder_ouptut_size1 = encoder_outputs_info0.shape_int() * tensor::dtype_size[encoder_outputs_info1.dtype];
-
-        auto decoder_main_outputs_info1 = param->decoder_main_model->outputs_info()[1];
-        auto decoder_main_outputs_info2 = param->decoder_main_model->outputs_info()[2];
-        auto decoder_main_ouptut_size1 = decoder_main_outputs_info1.shape_int() * tensor::dtype_size[decoder_main_outputs_info1.dtype];
-        auto decoder_main_ouptut_size2 = decoder_main_outputs_info2.shape_int() * tensor::dtype_size[decoder_main_outputs_info2.dtype];
-
-        std::vector<float> n_layer_cross_k(encoder_ouptut_size0 / sizeof(float));
-        std::vector<float> n_layer_cross_v(encoder_ouptut_size1 / sizeof(float));
-
         std::vector<float> decoder_main_logits(4 * WHISPER_VOCAB_SIZE);
-        std::vector<float> n_layer_self_k_cache(decoder_main_ouptut_size1 / sizeof(float));
-        std::vector<float> n_layer_self_v_cache(decoder_main_ouptut_size2 / sizeof(float));
 
-        // encoder
-        std::vector<float> continous_mel(WHISPER_N_MELS * n_len);
-        for (int i = 0; i < n_mel; i++) {
-            memcpy(continous_mel.data() + i * n_len, mel[i].data(), sizeof(float) * n_len);
-        }
-
-        // print_test(">>>>>>>>>>>>>>>>> Encoder input 0", (float *)continous_mel.data(), continous_mel.size());
-        auto encoder_input_tensor = new tensor::Tensor({1, 80, 3000}, tensor::DType::FLOAT32, continous_mel.data(), false);
+        // print_test(">>>>>>>>>>>>>>>>> Encoder input 0", mel_input, param->n_mels * 3000);
+        auto encoder_input_tensor = new tensor::Tensor({1, 80, 3000}, tensor::DType::FLOAT32, mel_input, false);
         tensor::Tensors encoder_input_tensors, encoder_output_tensors;
         encoder_input_tensors.add_tensor("mel", encoder_input_tensor, true, true);
         if ( err::ERR_NONE != (err = param->encoder_model->forward(encoder_input_tensors, encoder_output_tensors, false, true))) {
@@ -777,7 +736,7 @@ namespace maix::nn
         decoder_loop_input_tensors.add_tensor("n_layer_cross_v", decoder_loop_input_tensor4, false, true);
 
         auto check_duplicate = CheckDuplicate();
-        for (size_t i = 0; i < WHISPER_N_TEXT_CTX - SOT_SEQUENCE.size(); i++) {
+        for (size_t i = 0; i < WHISPER_N_TEXT_CTX - SOT_SEQUENCE.size() && (int)i < max_tokens; i++) {
             if (app::need_exit()) {
                 break;
             }
@@ -850,4 +809,270 @@ namespace maix::nn
         }
         return s;
     }
+
+    /**
+     * Transcribe pcm data to text
+     * @param pcm RAW data
+     * @return The output result after automatic speech recognition.
+     * @maixpy maix.nn.Whisper.transcribe_raw
+    */
+    std::string Whisper::transcribe_raw(Bytes *pcm, int sample_rate, int channels, int bits_per_frame) {
+        if (!pcm || pcm->data_len == 0) {
+            log::info("pcm data is empty");
+            return "";
+        }
+
+        WhisperParam *param = (WhisperParam *) _extra_param;
+        if (sample_rate != _input_pcm_samplerate) {
+            log::error("wav sample rate not match, must be %d!", _input_pcm_samplerate);
+            return "";
+        }
+
+        std::vector<float> pcm_data;
+        if (err::ERR_NONE != _pcm_to_float(pcm, channels, bits_per_frame, pcm_data)) {
+            return "";
+        }
+        // print_test("pcm_data_F", (float *)pcm_data.data(), pcm_data.size(), 100);
+        // print_test("pcm_data", (uint8_t *)pcm->data, pcm->data_len, 100);
+        param->mel->reset();
+        param->mel->push(pcm_data.data(), pcm_data.size());
+        param->mel->finish();
+
+        // audio longer than 30s is decoded by 30s windows, tail shorter than 100ms is ignored
+        std::vector<float> continous_mel(param->n_mels * 3000);
+        std::string s;
+        for (int start = 0; start == 0 || param->mel->frames() - start > 10; start += 3000) {
+            if (app::need_exit()) {
+                break;
+            }
+            // clamping and normalization, [n_mels, 3000], pad with 0
+            param->mel->whisper_input(continous_mel.data(), start, 3000);
+            s += _whisper_decode(param, continous_mel.data());
+        }
+        return s;
+    }
+
+    namespace {
+        class WhisperStreamChunk {
+        public:
+            std::vector<float> pcm;
+            bool end;   // utterance end
+        };
+
+        class WhisperStream {
+        public:
+            std::function<void(std::string, bool)> callback;
+            int vad_frame;          // samples of one VAD frame, 10ms
+            float vad_threshold;
+            int silence_samples;
+            int partial_frames;     // mel frames between partial results
+            int max_samples;
+            int preroll_samples;    // samples kept before speech start, avoid cutting the first phoneme
+
+            // capture thread only
+            bool in_speech = false;
+            int silence = 0;
+            int seg_len = 0;
+            std::vector<float> frame;   // uncompleted VAD frame
+            std::deque<float> preroll;
+            std::vector<float> pending; // speech samples not sent to worker
+
+            // shared with worker thread, protected by lock
+            std::mutex lock;
+            std::condition_variable cond;
+            std::deque<WhisperStreamChunk> chunks;
+            std::deque<std::pair<std::string, bool>> results;
+            std::string text;
+            bool exit = false;
+
+            std::thread *thread = nullptr;
+        };
+    }
+
+    static void _stream_send(WhisperStream *st, bool end) {
+        if (st->pending.empty() && !end) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> guard(st->lock);
+            st->chunks.push_back(WhisperStreamChunk{std::move(st->pending), end});
+        }
+        st->pending.clear();
+        st->cond.notify_one();
+    }
+
+    // energy VAD on 10ms frames, speech samples are sent to worker by chunk
+    static void _stream_vad(WhisperStream *st, const float *pcm, int num) {
+        for (int i = 0; i < num; ++i) {
+            st->frame.push_back(pcm[i]);
+            if ((int)st->frame.size() < st->vad_frame) {
+                continue;
+            }
+            float energy = 0;
+            for (float v : st->frame) {
+                energy += v * v;
+            }
+            bool voiced = sqrtf(energy / st->vad_frame) >= st->vad_threshold;
+            if (!st->in_speech) {
+                if (voiced) {
+                    st->in_speech = true;
+                    st->silence = 0;
+                    st->seg_len = st->preroll.size();
+                    st->pending.insert(st->pending.end(), st->preroll.begin(), st->preroll.end());
+                    st->preroll.clear();
+                } else {
+                    st->preroll.insert(st->preroll.end(), st->frame.begin(), st->frame.end());
+                    while ((int)st->preroll.size() > st->preroll_samples) {
+                        st->preroll.pop_front();
+                    }
+                }
+            }
+            if (st->in_speech) {
+                st->pending.insert(st->pending.end(), st->frame.begin(), st->frame.end());
+                st->seg_len += st->vad_frame;
+                st->silence = voiced ? 0 : st->silence + st->vad_frame;
+                if (st->silence >= st->silence_samples || st->seg_len >= st->max_samples) {
+                    st->in_speech = false;
+                    _stream_send(st, true);
+                }
+            }
+            st->frame.clear();
+        }
+        if (st->in_speech) {
+            _stream_send(st, false);
+        }
+    }
+
+    // worker thread, mel features are calculated incrementally, encoder and decoder run while capture continues
+    static void _stream_worker(WhisperParam *param, WhisperStream *st, int sample_rate) {
+        nn::MelSpectrogram mel(sample_rate, param->n_fft, param->n_hop, param->n_mels);
+        std::vector<float> mel_input(param->n_mels * 3000);
+        int last_partial = 0;
+        while (true) {
+            WhisperStreamChunk chunk;
+            bool more;
+            {
+                std::unique_lock<std::mutex> guard(st->lock);
+                st->cond.wait(guard, [st] { return st->exit || !st->chunks.empty(); });
+                if (st->chunks.empty()) {
+                    break;
+                }
+                chunk = std::move(st->chunks.front());
+                st->chunks.pop_front();
+                more = !st->chunks.empty();
+            }
+            mel.push(chunk.pcm.data(), chunk.pcm.size());
+            if (chunk.end) {
+                mel.finish();
+                mel.whisper_input(mel_input.data(), 0, 3000);
+                std::string s = mel.frames() > 0 ? _whisper_decode(param, mel_input.data()) : "";
+                mel.reset();
+                last_partial = 0;
+                std::lock_guard<std::mutex> guard(st->lock);
+                st->results.push_back({s, true});
+                st->text += s;
+            } else if (!more && st->partial_frames > 0 && mel.frames() - last_partial >= st->partial_frames) {
+                // only when caught up with capture, partial results never delay final results
+                last_partial = mel.frames();
+                mel.whisper_input(mel_input.data(), 0, 3000);
+                std::string s = _whisper_decode(param, mel_input.data(), WHISPER_N_TEXT_CTX / 4);
+                std::lock_guard<std::mutex> guard(st->lock);
+                st->results.push_back({s, false});
+            }
+        }
+    }
+
+    void Whisper::_stream_deliver() {
+        WhisperStream *st = (WhisperStream *)_stream;
+        std::deque<std::pair<std::string, bool>> results;
+        {
+            std::lock_guard<std::mutex> guard(st->lock);
+            results.swap(st->results);
+        }
+        if (!st->callback) {
+            return;
+        }
+        for (auto &r : results) {
+            st->callback(r.first, r.second);
+        }
+    }
+
+    /**
+     * Start a streaming transcription session.
+     * @maixpy maix.nn.Whisper.stream_start
+     */
+    err::Err Whisper::stream_start(std::function<void(std::string, bool)> callback, int silence_ms, float vad_threshold, int partial_ms, int max_segment_ms) {
+        WhisperParam *param = (WhisperParam *) _extra_param;
+        if (_stream) {
+            return err::ERR_BUSY;
+        }
+        if (!param->encoder_model || !param->mel) {
+            log::error("model not loaded");
+            return err::ERR_NOT_READY;
+        }
+        if (silence_ms <= 0 || max_segment_ms <= 0) {
+            log::error("silence_ms and max_segment_ms must > 0");
+            return err::ERR_ARGS;
+        }
+        WhisperStream *st = new WhisperStream();
+        int sample_rate = _input_pcm_samplerate;
+        st->callback = callback;
+        st->vad_frame = sample_rate / 100;
+        st->vad_threshold = vad_threshold;
+        st->silence_samples = (int64_t)silence_ms * sample_rate / 1000;
+        st->partial_frames = (int64_t)partial_ms * sample_rate / 1000 / param->n_hop;
+        st->max_samples = (int64_t)std::min(max_segment_ms, WHISPER_CHUNK_SIZE * 1000) * sample_rate / 1000;
+        st->preroll_samples = sample_rate * 3 / 10;
+        st->thread = new std::thread(_stream_worker, param, st, sample_rate);
+        _stream = st;
+        return err::ERR_NONE;
+    }
+
+    /**
+     * Push PCM to streaming session
+     * @maixpy maix.nn.Whisper.stream_push
+     */
+    err::Err Whisper::stream_push(Bytes *pcm, int channels, int bits_per_frame) {
+        WhisperStream *st = (WhisperStream *)_stream;
+        if (!st) {
+            return err::ERR_NOT_READY;
+        }
+        if (pcm && pcm->data_len > 0) {
+            std::vector<float> pcm_data;
+            err::Err e = _pcm_to_float(pcm, channels, bits_per_frame, pcm_data);
+            if (e != err::ERR_NONE) {
+                return e;
+            }
+            _stream_vad(st, pcm_data.data(), pcm_data.size());
+        }
+        _stream_deliver();
+        return err::ERR_NONE;
+    }
+
+    /**
+     * Stop streaming session
+     * @maixpy maix.nn.Whisper.stream_stop
+     */
+    std::string Whisper::stream_stop() {
+        WhisperStream *st = (WhisperStream *)_stream;
+        if (!st) {
+            return "";
+        }
+        if (st->in_speech) {
+            st->in_speech = false;
+            _stream_send(st, true);
+        }
+        {
+            std::lock_guard<std::mutex> guard(st->lock);
+            st->exit = true;
+        }
+        st->cond.notify_one();
+        st->thread->join();
+        delete st->thread;
+        _stream_deliver();
+        std::string text = st->text;
+        _stream = nullptr;
+        delete st;
+        return text;
+    }
 } // namespace maix::nn
\ No newline at end of file
@@ -199,6 +199,8 @@ namespace maix::nn
         _impl = nullptr;
 #if PLATFORM_MAIXCAM || PLATFORM_MAIXCAM2
         _impl = new NN_MaixCam(dual_buff);
+#elif ONNXRUNTIME_FOUND
+        _impl = new NN_Linux(dual_buff);
 #endif
         if(!_impl)
         {
@@ -268,9 +270,55 @@ namespace maix::nn
         return _impl->inputs_info();
     }
 
+    static std::vector<std::string> _split_values(const std::string &s)
+    {
+        std::vector<std::string> items;
+        size_t start = 0;
+        while (start <= s.size())
+        {
+            size_t end = s.find(',', start);
+            if (end == std::string::npos)
+                end = s.size();
+            std::string item = s.substr(start, end - start);
+            item.erase(0, item.find_first_not_of(" \t\r\n"));
+            item.erase(item.find_last_not_of(" \t\r\n") + 1);
+            items.push_back(item);
+            start = end + 1;
+        }
+        return items;
+    }
+
     std::vector<nn::LayerInfo> NN::outputs_info()
     {
-        return _impl->outputs_info();
+        std::vector<nn::LayerInfo> infos = _impl->outputs_info();
+        std::map<std::string, std::string> &extra = _mud.items["extra"];
+        auto scale_it = extra.find("output_scale");
+        if (scale_it == extra.end())
+            return infos;
+        std::vector<std::string> scales = _split_values(scale_it->second);
+        std::vector<std::string> zero_points;
+        auto zp_it = extra.find("output_zero_point");
+        if (zp_it != extra.end())
+            zero_points = _split_values(zp_it->second);
+        if (scales.size() != infos.size() || (!zero_points.empty() && zero_points.size() != infos.size()))
+        {
+            log::warn("output_scale or output_zero_point number not match outputs number %d, ignore", (int)infos.size());
+            return infos;
+        }
+        for (size_t i = 0; i < infos.size(); ++i)
+        {
+            if (infos[i].dtype != tensor::DType::INT8 && infos[i].dtype != tensor::DType::UINT8)
+                continue;
+            float scale = atof(scales[i].c_str());
+            if (scale <= 0)
+            {
+                log::warn("output %s scale %s invalid, ignore", infos[i].name.c_str(), scales[i].c_str());
+                continue;
+            }
+            infos[i].scale = scale;
+            infos[i].zero_point = zero_points.empty() ? 0 : atoi(zero_points[i].c_str());
+        }
+        return infos;
     }
 
     std::map<std::string, std::string> NN::extra_info()
@@ -305,6 +353,11 @@ namespace maix::nn
 
     tensor::Tensors *NN::forward_image(image::Image &img, std::vector<float> mean, std::vector<float> scale, image::Fit fit, bool copy_result, bool dual_buff_wait, bool chw)
     {
+#if !(PLATFORM_MAIXCAM || PLATFORM_MAIXCAM2)
+        // linux backend resize, convert color and normalize in one pass by nn::ImagePreprocess,
+        // no need to resize image here.
+        return _impl->forward_image(img, mean, scale, fit, copy_result, dual_buff_wait, chw);
+#endif
         int input_w = 0;
         int input_h = 0;
         int input_c = 0;
@@ -340,7 +393,7 @@ namespace maix::nn
         return res;
     }
 
-    int SelfLearnClassifier::learn()
+    int SelfLearnClassifier::_learn()
     {
         #if PLATFORM_MAIXCAM || PLATFORM_MAIXCAM2
             return maix_nn_self_learn_classifier_learn(_features, _features_sample, _feature_num);
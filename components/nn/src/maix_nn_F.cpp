@@ -3,10 +3,12 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Add dequantize and quantized sigmoid threshold.
  */
 
 
 #include "maix_nn_F.hpp"
+#include <math.h>
 
 namespace maix::nn::F
 {
@@ -53,4 +55,37 @@ namespace maix::nn::F
         return t;
     }
 
+    template <typename T>
+    static void _dequantize(const T *src, float *dst, int n, float scale, int zero_point)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            dst[i] = (float)((int)src[i] - zero_point) * scale;
+        }
+    }
+
+    tensor::Tensor *dequantize(tensor::Tensor *tensor, float scale, int zero_point)
+    {
+        maix::tensor::Tensor *t = new maix::tensor::Tensor(tensor->shape(), maix::tensor::DType::FLOAT32);
+        if (tensor->dtype() == maix::tensor::DType::INT8)
+            _dequantize((const int8_t *)tensor->data(), (float *)t->data(), tensor->size_int(), scale, zero_point);
+        else if (tensor->dtype() == maix::tensor::DType::UINT8)
+            _dequantize((const uint8_t *)tensor->data(), (float *)t->data(), tensor->size_int(), scale, zero_point);
+        else
+        {
+            delete t;
+            throw err::Exception(err::ERR_ARGS, "only support int8 and uint8 dtype");
+        }
+        return t;
+    }
+
+    int quant_sigmoid_threshold(float th, float scale, int zero_point)
+    {
+        th = fminf(fmaxf(th, 1e-6f), 1.f - 1e-6f);
+        // sigmoid(x) > th  <=>  x > logit(th)  <=>  q > logit(th) / scale + zero_point
+        float q = floorf(logf(th / (1.f - th)) / scale + zero_point);
+        q = fminf(fmaxf(q, -1024.f), 1024.f);
+        return (int)q + 1;
+    }
+
 } // namespace maix::nn::F
@@ -0,0 +1,403 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Create this file, add real FFT and streaming mel spectrogram.
+ */
+
+#include "maix_nn_audio_feature.hpp"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+namespace maix::nn
+{
+    typedef std::complex<float> _cpx;
+
+    RFFT::RFFT(int n)
+    {
+        if (n < 2 || n % 2 != 0)
+            throw err::Exception(err::ERR_ARGS, "RFFT size must be even");
+        _n = n;
+        _m = n / 2;
+
+        // factors, prefer radix 4, then 2, 3, 5 ..., the same as kissfft
+        int m = _m;
+        int p = 4;
+        int floor_sqrt = (int)floor(sqrt((double)m));
+        do
+        {
+            while (m % p)
+            {
+                switch (p)
+                {
+                case 4:
+                    p = 2;
+                    break;
+                case 2:
+                    p = 3;
+                    break;
+                default:
+                    p += 2;
+                    break;
+                }
+                if (p > floor_sqrt)
+                    p = m;
+            }
+            m /= p;
+            _factors.push_back(p);
+            _factors.push_back(m);
+        } while (m > 1);
+
+        _twiddles.resize(_m);
+        for (int i = 0; i < _m; ++i)
+        {
+            double phase = -2 * M_PI * i / _m;
+            _twiddles[i] = _cpx(cos(phase), sin(phase));
+        }
+        _super_twiddles.resize(_m / 2);
+        for (int i = 0; i < _m / 2; ++i)
+        {
+            double phase = -M_PI * ((double)(i + 1) / _m + 0.5);
+            _super_twiddles[i] = _cpx(cos(phase), sin(phase));
+        }
+        int max_p = 0;
+        for (size_t i = 0; i < _factors.size(); i += 2)
+            max_p = std::max(max_p, _factors[i]);
+        _scratch.resize(max_p);
+        _in.resize(_m);
+        _out.resize(_m);
+        _bins.resize(_m + 1);
+    }
+
+    void RFFT::_work(_cpx *out, const _cpx *in, int fstride, const int *factors)
+    {
+        int p = factors[0];
+        int m = factors[1];
+        if (m == 1)
+        {
+            for (int k = 0; k < p; ++k)
+                out[k] = in[k * fstride];
+        }
+        else
+        {
+            for (int k = 0; k < p; ++k)
+                _work(out + k * m, in + k * fstride, fstride * p, factors + 2);
+        }
+
+        const _cpx *tw = _twiddles.data();
+        if (p == 2)
+        {
+            for (int k = 0; k < m; ++k)
+            {
+                _cpx t = out[k + m] * tw[k * fstride];
+                out[k + m] = out[k] - t;
+                out[k] += t;
+            }
+        }
+        else if (p == 4)
+        {
+            for (int k = 0; k < m; ++k)
+            {
+                _cpx s0 = out[k + m] * tw[k * fstride];
+                _cpx s1 = out[k + 2 * m] * tw[k * fstride * 2];
+                _cpx s2 = out[k + 3 * m] * tw[k * fstride * 3];
+                _cpx s5 = out[k] - s1;
+                out[k] += s1;
+                _cpx s3 = s0 + s2;
+                _cpx s4 = s0 - s2;
+                out[k + 2 * m] = out[k] - s3;
+                out[k] += s3;
+                out[k + m] = _cpx(s5.real() + s4.imag(), s5.imag() - s4.real());
+                out[k + 3 * m] = _cpx(s5.real() - s4.imag(), s5.imag() + s4.real());
+            }
+        }
+        else
+        {
+            // generic radix
+            _cpx *scratch = _scratch.data();
+            for (int u = 0; u < m; ++u)
+            {
+                for (int q = 0, k = u; q < p; ++q, k += m)
+                    scratch[q] = out[k];
+                for (int q1 = 0, k = u; q1 < p; ++q1, k += m)
+                {
+                    int twidx = 0;
+                    _cpx sum = scratch[0];
+                    for (int q = 1; q < p; ++q)
+                    {
+                        twidx += fstride * k;
+                        if (twidx >= _m)
+                            twidx -= _m;
+                        sum += scratch[q] * tw[twidx];
+                    }
+                    out[k] = sum;
+                }
+            }
+        }
+    }
+
+    void RFFT::forward(const float *in, _cpx *out)
+    {
+        // pack even and odd samples to one complex sequence of n / 2
+        memcpy((void *)_in.data(), in, sizeof(float) * _n);
+        _work(_out.data(), _in.data(), 1, _factors.data());
+        const _cpx *z = _out.data();
+        out[0] = _cpx(z[0].real() + z[0].imag(), 0);
+        out[_m] = _cpx(z[0].real() - z[0].imag(), 0);
+        for (int k = 1; k <= _m / 2; ++k)
+        {
+            _cpx fpk = z[k];
+            _cpx fpnk = std::conj(z[_m - k]);
+            _cpx f1k = fpk + fpnk;
+            _cpx f2k = fpk - fpnk;
+            _cpx tw = f2k * _super_twiddles[k - 1];
+            out[k] = (f1k + tw) * 0.5f;
+            out[_m - k] = std::conj(f1k - tw) * 0.5f;
+        }
+    }
+
+    void RFFT::power(const float *in, float *out, float power)
+    {
+        _cpx *spec = _bins.data();
+        forward(in, spec);
+        for (int k = 0; k <= _m; ++k)
+        {
+            float p = spec[k].real() * spec[k].real() + spec[k].imag() * spec[k].imag();
+            if (power == 2.0f)
+                out[k] = p;
+            else if (power == 1.0f)
+                out[k] = sqrtf(p);
+            else
+                out[k] = powf(p, power * 0.5f);
+        }
+    }
+
+    MelSpectrogram::MelSpectrogram(int sample_rate, int n_fft, int hop, int n_mels, float fmin, float fmax, float power)
+        : _sample_rate(sample_rate), _n_fft(n_fft), _hop(hop), _n_mels(n_mels), _power(power), _fft(n_fft)
+    {
+        if (sample_rate <= 0 || hop <= 0 || n_mels <= 0)
+            throw err::Exception(err::ERR_ARGS, "mel spectrogram args error");
+        if (fmax <= 0)
+            fmax = sample_rate / 2;
+        // periodic hann window
+        _window.resize(n_fft);
+        for (int i = 0; i < n_fft; ++i)
+            _window[i] = 0.5f * (1.0f - cosf(2.0f * (float)M_PI * i / n_fft));
+        _mel_filters(fmin, fmax);
+        _frame.resize(n_fft);
+        _spec.resize(n_fft / 2 + 1);
+        reset();
+    }
+
+    static float _hz_to_mel(float hz)
+    {
+        // slaney mel scale
+        const float f_sp = 200.0f / 3;
+        const float min_log_hz = 1000.0f;
+        const float min_log_mel = min_log_hz / f_sp;
+        const float logstep = logf(6.4f) / 27.0f;
+        if (hz >= min_log_hz)
+            return min_log_mel + logf(hz / min_log_hz) / logstep;
+        return hz / f_sp;
+    }
+
+    static float _mel_to_hz(float mel)
+    {
+        const float f_sp = 200.0f / 3;
+        const float min_log_hz = 1000.0f;
+        const float min_log_mel = min_log_hz / f_sp;
+        const float logstep = logf(6.4f) / 27.0f;
+        if (mel > min_log_mel)
+            return min_log_hz * expf(logstep * (mel - min_log_mel));
+        return f_sp * mel;
+    }
+
+    void MelSpectrogram::_mel_filters(float fmin, float fmax)
+    {
+        int n_f = _n_fft / 2 + 1;
+        float min_mel = _hz_to_mel(fmin);
+        float max_mel = _hz_to_mel(fmax);
+        std::vector<float> mel_f(_n_mels + 2);
+        for (int i = 0; i < _n_mels + 2; ++i)
+            mel_f[i] = _mel_to_hz(min_mel + (max_mel - min_mel) * i / (_n_mels + 1));
+
+        // only keep non-zero weights, most bins of one band are zero
+        _filters.clear();
+        _filter_start.resize(_n_mels);
+        _filter_offset.resize(_n_mels + 1);
+        for (int m = 0; m < _n_mels; ++m)
+        {
+            float enorm = 2.0f / (mel_f[m + 2] - mel_f[m]);
+            float fdiff0 = mel_f[m + 1] - mel_f[m];
+            float fdiff1 = mel_f[m + 2] - mel_f[m + 1];
+            int start = -1;
+            _filter_offset[m] = (int)_filters.size();
+            for (int k = 0; k < n_f; ++k)
+            {
+                float freq = (float)k * _sample_rate / _n_fft;
+                float lower = (freq - mel_f[m]) / fdiff0;
+                float upper = (mel_f[m + 2] - freq) / fdiff1;
+                float w = std::max(0.0f, std::min(lower, upper)) * enorm;
+                if (w <= 0)
+                {
+                    if (start >= 0)
+                        break;
+                    continue;
+                }
+                if (start < 0)
+                    start = k;
+                _filters.push_back(w);
+            }
+            _filter_start[m] = start < 0 ? 0 : start;
+        }
+        _filter_offset[_n_mels] = (int)_filters.size();
+    }
+
+    void MelSpectrogram::reset()
+    {
+        _buf.clear();
+        _buf_start = 0;
+        _raw_num = 0;
+        _started = false;
+        _finished = false;
+        _frames = 0;
+        _max = -1e20f;
+        _log_mel.clear();
+    }
+
+    void MelSpectrogram::_start()
+    {
+        // center mode, reflect pad n_fft / 2 samples at left, x[pad], x[pad - 1] ... x[1]
+        int pad = _n_fft / 2;
+        std::vector<float> left(pad);
+        for (int i = 0; i < pad; ++i)
+        {
+            int64_t idx = pad - i;
+            if (idx >= _raw_num)
+                idx = _raw_num - 1;
+            left[i] = _buf[idx];
+        }
+        _buf.insert(_buf.begin(), left.begin(), left.end());
+        _buf_start = 0;
+        _started = true;
+    }
+
+    int MelSpectrogram::_compute()
+    {
+        int count = 0;
+        int n_f = _n_fft / 2 + 1;
+        while ((int64_t)_frames * _hop + _n_fft <= _buf_start + (int64_t)_buf.size())
+        {
+            const float *x = _buf.data() + ((int64_t)_frames * _hop - _buf_start);
+            for (int i = 0; i < _n_fft; ++i)
+                _frame[i] = x[i] * _window[i];
+            _fft.power(_frame.data(), _spec.data(), _power);
+            _log_mel.resize((size_t)(_frames + 1) * _n_mels);
+            float *out = _log_mel.data() + (size_t)_frames * _n_mels;
+            for (int m = 0; m < _n_mels; ++m)
+            {
+                const float *w = _filters.data() + _filter_offset[m];
+                const float *s = _spec.data() + _filter_start[m];
+                int len = std::min(_filter_offset[m + 1] - _filter_offset[m], n_f - _filter_start[m]);
+                float sum = 0;
+                for (int k = 0; k < len; ++k)
+                    sum += w[k] * s[k];
+                float v = log10f(std::max(sum, 1e-10f));
+                out[m] = v;
+                if (v > _max)
+                    _max = v;
+            }
+            ++_frames;
+            ++count;
+        }
+        // drop consumed samples, keep n_fft / 2 + 1 samples for right reflect pad
+        int64_t drop = (int64_t)_frames * _hop - _buf_start;
+        drop = std::min(drop, (int64_t)_buf.size() - (_n_fft / 2 + 1));
+        if (drop > 0)
+        {
+            _buf.erase(_buf.begin(), _buf.begin() + drop);
+            _buf_start += drop;
+        }
+        return count;
+    }
+
+    int MelSpectrogram::push(const float *pcm, int num)
+    {
+        if (_finished)
+            reset();
+        if (num <= 0)
+            return 0;
+        _buf.insert(_buf.end(), pcm, pcm + num);
+        _raw_num += num;
+        if (!_started)
+        {
+            if (_raw_num <= _n_fft / 2)
+                return 0;
+            _start();
+        }
+        return _compute();
+    }
+
+    int MelSpectrogram::push(const int16_t *pcm, int num)
+    {
+        if (_finished)
+            reset();
+        if (num <= 0)
+            return 0;
+        size_t old = _buf.size();
+        _buf.resize(old + num);
+        float *p = _buf.data() + old;
+        for (int i = 0; i < num; ++i)
+            p[i] = pcm[i] / 32768.0f;
+        _raw_num += num;
+        if (!_started)
+        {
+            if (_raw_num <= _n_fft / 2)
+                return 0;
+            _start();
+        }
+        return _compute();
+    }
+
+    int MelSpectrogram::finish()
+    {
+        if (_finished || _raw_num == 0)
+            return 0;
+        if (!_started)
+            _start();
+        // reflect pad n_fft / 2 samples at right, x[N - 2], x[N - 3] ...
+        int pad = _n_fft / 2;
+        int64_t raw_start = _buf_start - pad; // raw index of _buf[0]
+        std::vector<float> right(pad);
+        for (int j = 0; j < pad; ++j)
+        {
+            int64_t idx = std::max(_raw_num - 2 - j, (int64_t)0);
+            right[j] = _buf[std::max(idx - raw_start, (int64_t)0)];
+        }
+        _buf.insert(_buf.end(), right.begin(), right.end());
+        int count = _compute();
+        _finished = true;
+        return count;
+    }
+
+    void MelSpectrogram::whisper_input(float *out, int start, int n_frames)
+    {
+        memset(out, 0, sizeof(float) * _n_mels * n_frames);
+        int num = std::min(_frames - start, n_frames);
+        if (num <= 0)
+            return;
+        // max of used frames
+        float mmax = -1e20f;
+        const float *src = _log_mel.data() + (size_t)start * _n_mels;
+        for (int i = 0; i < num * _n_mels; ++i)
+            mmax = std::max(mmax, src[i]);
+        float min_v = mmax - 8.0f;
+        for (int t = 0; t < num; ++t)
+        {
+            const float *f = src + (size_t)t * _n_mels;
+            for (int m = 0; m < _n_mels; ++m)
+                out[(size_t)m * n_frames + t] = (std::max(f[m], min_v) + 4.0f) / 4.0f;
+        }
+    }
+} // namespace maix::nn
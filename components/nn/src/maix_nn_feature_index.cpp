@@ -0,0 +1,651 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Create this file, add feature vector index for face and self learn galleries.
+ */
+
+#include "maix_nn_feature_index.hpp"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define INDEX_USE_NEON 1
+    #define INDEX_USE_SSE 0
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+    #define INDEX_USE_NEON 0
+    #define INDEX_USE_SSE 1
+#else
+    #define INDEX_USE_NEON 0
+    #define INDEX_USE_SSE 0
+#endif
+
+// float16 convert instructions only always available in aarch64
+#if INDEX_USE_NEON && defined(__aarch64__)
+    #define INDEX_USE_NEON_FP16 1
+#else
+    #define INDEX_USE_NEON_FP16 0
+#endif
+
+namespace maix::nn
+{
+    #define INDEX_MAGIC   "MAIXIDX"
+    #define INDEX_VERSION 1
+
+    // file layout, all little endian:
+    // header | rows(num * row_bytes, padding to 4 bytes) | squared norms(num floats) | scales(num floats, only INT8) | labels(every label ends with \0)
+    typedef struct
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t dim;
+        uint32_t metric;
+        uint32_t dtype;
+        uint32_t num;
+        uint32_t labels_bytes;
+    } _index_header_t;
+
+    static inline size_t _align4(size_t n)
+    {
+        return (n + 3) & ~(size_t)3;
+    }
+
+    static inline size_t _dtype_size(IndexDType dtype)
+    {
+        return dtype == IndexDType::FLOAT32 ? 4 : (dtype == IndexDType::FLOAT16 ? 2 : 1);
+    }
+
+    static inline uint16_t _f32_to_f16(float value)
+    {
+        uint32_t x;
+        memcpy(&x, &value, 4);
+        uint32_t sign = (x >> 16) & 0x8000;
+        uint32_t mant = x & 0x7fffff;
+        int exp = ((x >> 23) & 0xff) - 127 + 15;
+        if (((x >> 23) & 0xff) == 0xff) // inf or nan
+            return sign | 0x7c00 | (mant ? 0x200 : 0);
+        if (exp >= 31)
+            return sign | 0x7c00;
+        if (exp <= 0)
+        {
+            if (exp < -10)
+                return sign;
+            mant |= 0x800000;
+            int shift = 14 - exp;
+            uint32_t half = mant >> shift;
+            uint32_t rem = mant & ((1u << shift) - 1);
+            uint32_t mid = 1u << (shift - 1);
+            if (rem > mid || (rem == mid && (half & 1)))
+                ++half;
+            return sign | half;
+        }
+        uint32_t half = sign | (exp << 10) | (mant >> 13);
+        uint32_t rem = mant & 0x1fff;
+        if (rem > 0x1000 || (rem == 0x1000 && (half & 1)))
+            ++half; // carry to exponent is also right
+        return half;
+    }
+
+    static inline float _f16_to_f32(uint16_t h)
+    {
+        uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+        uint32_t exp = (h >> 10) & 0x1f;
+        uint32_t mant = h & 0x3ff;
+        uint32_t x;
+        if (exp == 0x1f)
+            x = sign | 0x7f800000 | (mant << 13);
+        else if (exp != 0)
+            x = sign | ((exp + 127 - 15) << 23) | (mant << 13);
+        else if (mant == 0)
+            x = sign;
+        else
+        {
+            // subnormal, normalize it
+            exp = 127 - 15 + 1;
+            while (!(mant & 0x400))
+            {
+                mant <<= 1;
+                --exp;
+            }
+            x = sign | (exp << 23) | ((mant & 0x3ff) << 13);
+        }
+        float value;
+        memcpy(&value, &x, 4);
+        return value;
+    }
+
+    static float _dot_f32(const float *a, const float *b, int n)
+    {
+        int i = 0;
+        float sum = 0;
+#if INDEX_USE_NEON
+        float32x4_t acc0 = vdupq_n_f32(0), acc1 = vdupq_n_f32(0);
+        for (; i + 8 <= n; i += 8)
+        {
+            acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+            acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+        }
+        float32x4_t acc = vaddq_f32(acc0, acc1);
+        float32x2_t s = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+        sum = vget_lane_f32(vpadd_f32(s, s), 0);
+#elif INDEX_USE_SSE
+        __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+        for (; i + 8 <= n; i += 8)
+        {
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+        }
+        float s[4];
+        _mm_storeu_ps(s, _mm_add_ps(acc0, acc1));
+        sum = s[0] + s[1] + s[2] + s[3];
+#endif
+        for (; i < n; ++i)
+            sum += a[i] * b[i];
+        return sum;
+    }
+
+    static float _dot_f16(const uint16_t *a, const float *b, int n)
+    {
+        int i = 0;
+        float sum = 0;
+#if INDEX_USE_NEON_FP16
+        float32x4_t acc0 = vdupq_n_f32(0), acc1 = vdupq_n_f32(0);
+        for (; i + 8 <= n; i += 8)
+        {
+            float16x8_t h = vreinterpretq_f16_u16(vld1q_u16(a + i));
+            acc0 = vfmaq_f32(acc0, vcvt_f32_f16(vget_low_f16(h)), vld1q_f32(b + i));
+            acc1 = vfmaq_f32(acc1, vcvt_f32_f16(vget_high_f16(h)), vld1q_f32(b + i + 4));
+        }
+        sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+#endif
+        for (; i < n; ++i)
+            sum += _f16_to_f32(a[i]) * b[i];
+        return sum;
+    }
+
+    static int32_t _dot_i8(const int8_t *a, const int8_t *b, int n)
+    {
+        int i = 0;
+        int32_t sum = 0;
+#if INDEX_USE_NEON
+        int32x4_t acc = vdupq_n_s32(0);
+        for (; i + 16 <= n; i += 16)
+        {
+            int8x16_t va = vld1q_s8(a + i);
+            int8x16_t vb = vld1q_s8(b + i);
+            // values are in [-127, 127], product of two fits int16
+            acc = vpadalq_s16(acc, vmull_s8(vget_low_s8(va), vget_low_s8(vb)));
+            acc = vpadalq_s16(acc, vmull_s8(vget_high_s8(va), vget_high_s8(vb)));
+        }
+        int32x2_t s = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+        sum = vget_lane_s32(vpadd_s32(s, s), 0);
+#elif INDEX_USE_SSE
+        __m128i acc = _mm_setzero_si128();
+        for (; i + 16 <= n; i += 16)
+        {
+            __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+            __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+            // sign extend to int16 and multiply add pairs to int32
+            __m128i a_lo = _mm_srai_epi16(_mm_unpacklo_epi8(va, va), 8);
+            __m128i a_hi = _mm_srai_epi16(_mm_unpackhi_epi8(va, va), 8);
+            __m128i b_lo = _mm_srai_epi16(_mm_unpacklo_epi8(vb, vb), 8);
+            __m128i b_hi = _mm_srai_epi16(_mm_unpackhi_epi8(vb, vb), 8);
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(a_lo, b_lo));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(a_hi, b_hi));
+        }
+        int32_t s[4];
+        _mm_storeu_si128((__m128i *)s, acc);
+        sum = s[0] + s[1] + s[2] + s[3];
+#endif
+        for (; i < n; ++i)
+            sum += (int32_t)a[i] * b[i];
+        return sum;
+    }
+
+    // quantize to int8 with symmetric scale, return scale
+    static float _quantize_i8(const float *x, int8_t *q, int n)
+    {
+        float amax = 0;
+        for (int i = 0; i < n; ++i)
+            amax = std::max(amax, fabsf(x[i]));
+        float scale = amax > 0 ? amax / 127.f : 1.f;
+        float inv = 1.f / scale;
+        for (int i = 0; i < n; ++i)
+        {
+            int v = (int)roundf(x[i] * inv);
+            q[i] = (int8_t)std::min(127, std::max(-127, v));
+        }
+        return scale;
+    }
+
+    FeatureIndex::FeatureIndex(int dim, IndexMetric metric, IndexDType dtype)
+        : _rows(nullptr), _scales(nullptr), _norms(nullptr), _map(nullptr), _map_size(0)
+    {
+        reset(dim, metric, dtype);
+    }
+
+    FeatureIndex::~FeatureIndex()
+    {
+        _unmap();
+    }
+
+    void FeatureIndex::reset(int dim, IndexMetric metric, IndexDType dtype)
+    {
+        clear();
+        _dim = dim;
+        _metric = metric;
+        _dtype = dtype;
+        _row_bytes = _dim * _dtype_size(dtype);
+    }
+
+    void FeatureIndex::clear()
+    {
+        _unmap();
+        std::vector<uint8_t>().swap(_rows_buf);
+        std::vector<float>().swap(_scales_buf);
+        std::vector<float>().swap(_norms_buf);
+        _rows = nullptr;
+        _scales = nullptr;
+        _norms = nullptr;
+        _num = 0;
+    }
+
+    void FeatureIndex::_unmap()
+    {
+        if (_map)
+        {
+            munmap(_map, _map_size);
+            _map = nullptr;
+            _map_size = 0;
+        }
+    }
+
+    void FeatureIndex::_own()
+    {
+        if (_map)
+        {
+            _rows_buf.assign(_rows, _rows + _row_bytes * _num);
+            _norms_buf.assign(_norms, _norms + _num);
+            if (_dtype == IndexDType::INT8)
+                _scales_buf.assign(_scales, _scales + _num);
+            _unmap();
+        }
+        _rows = _rows_buf.data();
+        _norms = _norms_buf.data();
+        _scales = _scales_buf.empty() ? nullptr : _scales_buf.data();
+    }
+
+    void FeatureIndex::_encode(const float *feature, uint8_t *row, float &scale, float &norm)
+    {
+        _tmp.assign(feature, feature + _dim);
+        if (_metric == IndexMetric::COSINE)
+        {
+            float n = sqrtf(_dot_f32(_tmp.data(), _tmp.data(), _dim));
+            if (n > 0)
+            {
+                for (auto &v : _tmp)
+                    v /= n;
+            }
+        }
+        scale = 1;
+        norm = 0;
+        switch (_dtype)
+        {
+        case IndexDType::FLOAT32:
+            memcpy(row, _tmp.data(), _row_bytes);
+            norm = _dot_f32(_tmp.data(), _tmp.data(), _dim);
+            break;
+        case IndexDType::FLOAT16:
+        {
+            uint16_t *p = (uint16_t *)row;
+            for (int i = 0; i < _dim; ++i)
+            {
+                uint16_t h;
+                h = _f32_to_f16(_tmp[i]);
+                memcpy(p + i, &h, 2);
+                float v = _f16_to_f32(h);
+                norm += v * v;
+            }
+            break;
+        }
+        case IndexDType::INT8:
+        {
+            int8_t *p = (int8_t *)row;
+            scale = _quantize_i8(_tmp.data(), p, _dim);
+            norm = (float)_dot_i8(p, p, _dim) * scale * scale;
+            break;
+        }
+        }
+    }
+
+    int FeatureIndex::add(const float *feature, int len)
+    {
+        if (_dim == 0 && len > 0)
+            reset(len, _metric, _dtype);
+        if (len != _dim)
+        {
+            log::error("feature length %d not match index dim %d", len, _dim);
+            return -1;
+        }
+        _own();
+        _rows_buf.resize(_row_bytes * (_num + 1));
+        _norms_buf.resize(_num + 1);
+        if (_dtype == IndexDType::INT8)
+            _scales_buf.resize(_num + 1);
+        float scale, norm;
+        _encode(feature, _rows_buf.data() + _row_bytes * _num, scale, norm);
+        _norms_buf[_num] = norm;
+        if (_dtype == IndexDType::INT8)
+            _scales_buf[_num] = scale;
+        ++_num;
+        _own();
+        return _num - 1;
+    }
+
+    err::Err FeatureIndex::set(int idx, const float *feature)
+    {
+        if (idx < 0 || idx >= _num)
+            return err::ERR_ARGS;
+        _own();
+        float scale, norm;
+        _encode(feature, _rows_buf.data() + _row_bytes * idx, scale, norm);
+        _norms_buf[idx] = norm;
+        if (_dtype == IndexDType::INT8)
+            _scales_buf[idx] = scale;
+        return err::ERR_NONE;
+    }
+
+    err::Err FeatureIndex::remove(int idx)
+    {
+        if (idx < 0 || idx >= _num)
+            return err::ERR_ARGS;
+        _own();
+        _rows_buf.erase(_rows_buf.begin() + _row_bytes * idx, _rows_buf.begin() + _row_bytes * (idx + 1));
+        _norms_buf.erase(_norms_buf.begin() + idx);
+        if (_dtype == IndexDType::INT8)
+            _scales_buf.erase(_scales_buf.begin() + idx);
+        --_num;
+        _own();
+        return err::ERR_NONE;
+    }
+
+    std::vector<float> FeatureIndex::get(int idx)
+    {
+        std::vector<float> res;
+        if (idx < 0 || idx >= _num)
+            return res;
+        res.resize(_dim);
+        const uint8_t *row = _rows + _row_bytes * idx;
+        switch (_dtype)
+        {
+        case IndexDType::FLOAT32:
+            memcpy(res.data(), row, _row_bytes);
+            break;
+        case IndexDType::FLOAT16:
+            for (int i = 0; i < _dim; ++i)
+            {
+                uint16_t h;
+                memcpy(&h, row + i * 2, 2);
+                res[i] = _f16_to_f32(h);
+            }
+            break;
+        case IndexDType::INT8:
+            for (int i = 0; i < _dim; ++i)
+                res[i] = ((const int8_t *)row)[i] * _scales[idx];
+            break;
+        }
+        return res;
+    }
+
+    float FeatureIndex::_prepare_query(const float *query, float &scale)
+    {
+        _tmp.assign(query, query + _dim);
+        float norm = _dot_f32(_tmp.data(), _tmp.data(), _dim);
+        if (_metric == IndexMetric::COSINE)
+        {
+            float n = sqrtf(norm);
+            if (n > 0)
+            {
+                for (auto &v : _tmp)
+                    v /= n;
+            }
+            norm = n > 0 ? 1 : 0;
+        }
+        scale = 1;
+        if (_dtype == IndexDType::INT8)
+        {
+            _tmp_i8.resize(_dim);
+            scale = _quantize_i8(_tmp.data(), _tmp_i8.data(), _dim);
+        }
+        return norm;
+    }
+
+    inline float FeatureIndex::_dot(int idx, float query_scale)
+    {
+        const uint8_t *row = _rows + _row_bytes * idx;
+        switch (_dtype)
+        {
+        case IndexDType::FLOAT32:
+            return _dot_f32((const float *)row, _tmp.data(), _dim);
+        case IndexDType::FLOAT16:
+            return _dot_f16((const uint16_t *)row, _tmp.data(), _dim);
+        case IndexDType::INT8:
+            return (float)_dot_i8((const int8_t *)row, _tmp_i8.data(), _dim) * _scales[idx] * query_scale;
+        }
+        return 0;
+    }
+
+    std::vector<std::pair<int, float>> FeatureIndex::search(const float *query, int k)
+    {
+        std::vector<std::pair<int, float>> res;
+        if (_num == 0)
+            return res;
+        if (k <= 0 || k > _num)
+            k = _num;
+        float query_scale;
+        float query_norm = _prepare_query(query, query_scale);
+        bool cosine = _metric == IndexMetric::COSINE;
+
+        // min heap of (key, idx) keeps k best, bigger key is more similar
+        std::vector<std::pair<float, int>> heap;
+        heap.reserve(k);
+        auto cmp = [](const std::pair<float, int> &a, const std::pair<float, int> &b) { return a.first > b.first; };
+        for (int i = 0; i < _num; ++i)
+        {
+            float dot = _dot(i, query_scale);
+            float key = cosine ? dot : -(_norms[i] + query_norm - 2 * dot); // compare squared distance, sqrt only for results
+            if ((int)heap.size() < k)
+            {
+                heap.emplace_back(key, i);
+                std::push_heap(heap.begin(), heap.end(), cmp);
+            }
+            else if (key > heap.front().first)
+            {
+                std::pop_heap(heap.begin(), heap.end(), cmp);
+                heap.back() = std::make_pair(key, i);
+                std::push_heap(heap.begin(), heap.end(), cmp);
+            }
+        }
+        std::sort_heap(heap.begin(), heap.end(), cmp);
+        res.reserve(heap.size());
+        for (auto &h : heap)
+        {
+            float score = cosine ? 0.5f + 0.5f * h.first : sqrtf(std::max(-h.first, 0.f));
+            res.emplace_back(h.second, score);
+        }
+        return res;
+    }
+
+    err::Err FeatureIndex::save(const std::string &path, const std::vector<std::string> &labels)
+    {
+        if (!labels.empty() && (int)labels.size() != _num)
+        {
+            log::error("labels number %d not equal to features number %d", (int)labels.size(), _num);
+            return err::ERR_ARGS;
+        }
+        _index_header_t header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+        header.version = INDEX_VERSION;
+        header.dim = _dim;
+        header.metric = (uint32_t)_metric;
+        header.dtype = (uint32_t)_dtype;
+        header.num = _num;
+        std::string labels_data;
+        for (auto &label : labels)
+        {
+            labels_data += label;
+            labels_data.push_back('\0');
+        }
+        header.labels_bytes = labels_data.size();
+
+        // write to temp file and rename, the old file may be mapped by this or other index
+        std::string tmp = path + ".tmp";
+        FILE *fp = fopen(tmp.c_str(), "wb");
+        if (!fp)
+        {
+            log::error("open %s failed", tmp.c_str());
+            return err::ERR_IO;
+        }
+        size_t rows_bytes = _row_bytes * _num;
+        static const uint8_t padding[4] = {0};
+        bool ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+        ok = ok && (rows_bytes == 0 || fwrite(_rows, rows_bytes, 1, fp) == 1);
+        ok = ok && (_align4(rows_bytes) == rows_bytes || fwrite(padding, _align4(rows_bytes) - rows_bytes, 1, fp) == 1);
+        ok = ok && (_num == 0 || fwrite(_norms, sizeof(float) * _num, 1, fp) == 1);
+        if (_dtype == IndexDType::INT8)
+            ok = ok && (_num == 0 || fwrite(_scales, sizeof(float) * _num, 1, fp) == 1);
+        ok = ok && (labels_data.empty() || fwrite(labels_data.data(), labels_data.size(), 1, fp) == 1);
+        ok = fclose(fp) == 0 && ok;
+        if (!ok || rename(tmp.c_str(), path.c_str()) != 0)
+        {
+            log::error("write %s failed", path.c_str());
+            ::remove(tmp.c_str());
+            return err::ERR_IO;
+        }
+        return err::ERR_NONE;
+    }
+
+    bool FeatureIndex::is_index_file(const std::string &path)
+    {
+        char magic[8] = {0};
+        FILE *fp = fopen(path.c_str(), "rb");
+        if (!fp)
+            return false;
+        size_t n = fread(magic, 1, sizeof(magic), fp);
+        fclose(fp);
+        return n == sizeof(magic) && memcmp(magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0;
+    }
+
+    err::Err FeatureIndex::load(const std::string &path, std::vector<std::string> *labels, bool mmap)
+    {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            log::error("open %s failed", path.c_str());
+            return err::ERR_IO;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(_index_header_t))
+        {
+            close(fd);
+            return err::ERR_ARGS;
+        }
+        size_t size = st.st_size;
+        uint8_t *data = nullptr;
+        std::vector<uint8_t> buf;
+        void *map = nullptr;
+        if (mmap)
+        {
+            map = ::mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+            if (map == MAP_FAILED)
+            {
+                close(fd);
+                log::error("mmap %s failed", path.c_str());
+                return err::ERR_IO;
+            }
+            data = (uint8_t *)map;
+        }
+        else
+        {
+            buf.resize(size);
+            if (read(fd, buf.data(), size) != (ssize_t)size)
+            {
+                close(fd);
+                log::error("read %s failed", path.c_str());
+                return err::ERR_IO;
+            }
+            data = buf.data();
+        }
+        close(fd);
+
+        _index_header_t header;
+        memcpy(&header, data, sizeof(header));
+        size_t rows_bytes = 0, need = 0;
+        bool valid = memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0 && header.version == INDEX_VERSION &&
+                     header.metric <= (uint32_t)IndexMetric::L2 && header.dtype <= (uint32_t)IndexDType::INT8;
+        if (valid)
+        {
+            rows_bytes = (size_t)header.dim * _dtype_size((IndexDType)header.dtype) * header.num;
+            need = sizeof(header) + _align4(rows_bytes) + sizeof(float) * header.num * (header.dtype == (uint32_t)IndexDType::INT8 ? 2 : 1) + header.labels_bytes;
+            valid = size >= need;
+        }
+        if (!valid)
+        {
+            if (map)
+                munmap(map, size);
+            log::error("%s is not index file or broken", path.c_str());
+            return err::ERR_ARGS;
+        }
+
+        reset(header.dim, (IndexMetric)header.metric, (IndexDType)header.dtype);
+        _num = header.num;
+        const uint8_t *p = data + sizeof(header);
+        const uint8_t *rows = p;
+        p += _align4(rows_bytes);
+        const float *norms = (const float *)p;
+        p += sizeof(float) * _num;
+        const float *scales = nullptr;
+        if (_dtype == IndexDType::INT8)
+        {
+            scales = (const float *)p;
+            p += sizeof(float) * _num;
+        }
+        if (labels)
+        {
+            labels->clear();
+            const char *s = (const char *)p;
+            const char *end = s + header.labels_bytes;
+            while (s < end)
+            {
+                size_t len = strnlen(s, end - s);
+                labels->emplace_back(s, len);
+                s += len + 1;
+            }
+        }
+        if (map)
+        {
+            _map = map;
+            _map_size = size;
+            _rows = rows;
+            _norms = norms;
+            _scales = scales;
+        }
+        else
+        {
+            _rows_buf.assign(rows, rows + rows_bytes);
+            _norms_buf.assign(norms, norms + _num);
+            if (scales)
+                _scales_buf.assign(scales, scales + _num);
+            _own();
+        }
+        return err::ERR_NONE;
+    }
+} // namespace maix::nn
@@ -0,0 +1,362 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Create this file, add compiled lexicon for TTS G2P.
+ */
+
+#include "maix_nn_lexicon.hpp"
+#include "darts.h"
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace maix::nn
+{
+    #define LEXICON_MAGIC   "MAIXLEX"
+    #define LEXICON_VERSION 1
+
+    // binary layout, all little endian and 4 bytes aligned:
+    // header | words double array units | tokens double array units | data
+    // data is entries of [num, phones[num], tones[num]], value of words double array is entry offset in data
+    typedef struct
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t words_num;
+        uint32_t words_units;
+        uint32_t tokens_num;
+        uint32_t tokens_units;
+        uint32_t data_num;
+    } _lexicon_header_t;
+
+    class _LexiconData
+    {
+    public:
+        Darts::DoubleArray words;
+        Darts::DoubleArray tokens;
+        const int32_t *data = nullptr;
+        int words_num = 0;
+        void *map = nullptr;        // mmap address
+        size_t map_size = 0;
+        std::vector<uint8_t> mem;   // used when compiled lexicon can't be saved
+    };
+
+    static std::vector<std::string> _split(const std::string &s)
+    {
+        std::vector<std::string> result;
+        std::stringstream ss(s);
+        std::string item;
+        while (std::getline(ss, item, ' '))
+        {
+            if (!item.empty())
+                result.push_back(item);
+        }
+        return result;
+    }
+
+    static void _append_units(std::vector<uint8_t> &out, const Darts::DoubleArray &da)
+    {
+        size_t bytes = da.size() * da.unit_size();
+        size_t offset = out.size();
+        out.resize(offset + bytes);
+        memcpy(out.data() + offset, da.array(), bytes);
+    }
+
+    static err::Err _compile(const std::string &lexicon_file, const std::string &tokens_file, std::vector<uint8_t> &out)
+    {
+        // std::map keeps keys sorted as darts required, the first one wins for duplicated keys
+        std::map<std::string, int> tokens;
+        std::ifstream ifs(tokens_file);
+        if (!ifs.is_open())
+        {
+            log::error("open %s failed", tokens_file.c_str());
+            return err::ERR_ARGS;
+        }
+        std::string line;
+        while (std::getline(ifs, line))
+        {
+            auto items = _split(line);
+            if (items.size() < 2)
+                continue;
+            tokens.emplace(items[0], atoi(items[1].c_str()));
+        }
+        ifs.close();
+
+        ifs.open(lexicon_file);
+        if (!ifs.is_open())
+        {
+            log::error("open %s failed", lexicon_file.c_str());
+            return err::ERR_ARGS;
+        }
+        std::map<std::string, int> words;
+        std::vector<int32_t> data;
+        while (std::getline(ifs, line))
+        {
+            auto items = _split(line);
+            if (items.size() < 1)
+                continue;
+            if (words.find(items[0]) != words.end())
+                continue;
+            int num = (items.size() - 1) / 2;
+            words.emplace(items[0], (int)data.size());
+            data.push_back(num);
+            for (int i = 0; i < num; ++i)
+            {
+                auto it = tokens.find(items[i + 1]);
+                data.push_back(it == tokens.end() ? 0 : it->second);
+            }
+            for (int i = 0; i < num; ++i)
+                data.push_back(atoi(items[i + 1 + num].c_str()));
+        }
+        ifs.close();
+
+        Darts::DoubleArray words_da, tokens_da;
+        try
+        {
+            std::vector<const char *> keys;
+            std::vector<int> values;
+            keys.reserve(words.size());
+            values.reserve(words.size());
+            for (auto &w : words)
+            {
+                keys.push_back(w.first.c_str());
+                values.push_back(w.second);
+            }
+            if (words_da.build(keys.size(), keys.data(), NULL, values.data()) != 0)
+                return err::ERR_RUNTIME;
+            keys.clear();
+            values.clear();
+            for (auto &t : tokens)
+            {
+                if (t.second < 0)
+                    continue;
+                keys.push_back(t.first.c_str());
+                values.push_back(t.second);
+            }
+            if (tokens_da.build(keys.size(), keys.data(), NULL, values.data()) != 0)
+                return err::ERR_RUNTIME;
+        }
+        catch (const std::exception &e)
+        {
+            log::error("build lexicon failed: %s", e.what());
+            return err::ERR_RUNTIME;
+        }
+
+        _lexicon_header_t header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, LEXICON_MAGIC, sizeof(LEXICON_MAGIC));
+        header.version = LEXICON_VERSION;
+        header.words_num = words.size();
+        header.words_units = words_da.size();
+        header.tokens_num = tokens.size();
+        header.tokens_units = tokens_da.size();
+        header.data_num = data.size();
+        out.resize(sizeof(header));
+        memcpy(out.data(), &header, sizeof(header));
+        _append_units(out, words_da);
+        _append_units(out, tokens_da);
+        size_t offset = out.size();
+        out.resize(offset + data.size() * sizeof(int32_t));
+        memcpy(out.data() + offset, data.data(), data.size() * sizeof(int32_t));
+        return err::ERR_NONE;
+    }
+
+    // set tries and data to binary lexicon in memory, memory is not copied
+    static err::Err _attach(_LexiconData *lex, const uint8_t *buf, size_t size)
+    {
+        _lexicon_header_t header;
+        if (size < sizeof(header))
+            return err::ERR_ARGS;
+        memcpy(&header, buf, sizeof(header));
+        if (memcmp(header.magic, LEXICON_MAGIC, sizeof(LEXICON_MAGIC)) != 0 || header.version != LEXICON_VERSION)
+        {
+            log::error("lexicon format not match");
+            return err::ERR_ARGS;
+        }
+        size_t unit_size = lex->words.unit_size();
+        size_t need = sizeof(header) + ((size_t)header.words_units + header.tokens_units) * unit_size + (size_t)header.data_num * sizeof(int32_t);
+        if (size < need)
+        {
+            log::error("lexicon file broken, size %ld < %ld", (long)size, (long)need);
+            return err::ERR_ARGS;
+        }
+        const uint8_t *p = buf + sizeof(header);
+        lex->words.set_array(p, header.words_units);
+        p += header.words_units * unit_size;
+        lex->tokens.set_array(p, header.tokens_units);
+        p += header.tokens_units * unit_size;
+        lex->data = (const int32_t *)p;
+        lex->words_num = header.words_num;
+        return err::ERR_NONE;
+    }
+
+    static bool _newer(const std::string &a, const std::string &b)
+    {
+        struct stat sa, sb;
+        if (stat(a.c_str(), &sa) != 0 || stat(b.c_str(), &sb) != 0)
+            return false;
+        return sa.st_mtime >= sb.st_mtime;
+    }
+
+    Lexicon::Lexicon()
+    {
+        _data = new _LexiconData();
+    }
+
+    Lexicon::~Lexicon()
+    {
+        unload();
+        delete (_LexiconData *)_data;
+    }
+
+    err::Err Lexicon::compile(const std::string &lexicon_file, const std::string &tokens_file, const std::string &out_file)
+    {
+        std::vector<uint8_t> buf;
+        err::Err e = _compile(lexicon_file, tokens_file, buf);
+        if (e != err::ERR_NONE)
+            return e;
+        // write to temp file and rename, readers never see half written file
+        std::string tmp = out_file + ".tmp";
+        FILE *fp = fopen(tmp.c_str(), "wb");
+        if (!fp)
+        {
+            log::error("open %s failed", tmp.c_str());
+            return err::ERR_IO;
+        }
+        size_t n = fwrite(buf.data(), 1, buf.size(), fp);
+        fclose(fp);
+        if (n != buf.size() || rename(tmp.c_str(), out_file.c_str()) != 0)
+        {
+            log::error("write %s failed", out_file.c_str());
+            remove(tmp.c_str());
+            return err::ERR_IO;
+        }
+        return err::ERR_NONE;
+    }
+
+    err::Err Lexicon::load(const std::string &file)
+    {
+        _LexiconData *lex = (_LexiconData *)_data;
+        unload();
+        int fd = open(file.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            log::error("open %s failed", file.c_str());
+            return err::ERR_ARGS;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0)
+        {
+            close(fd);
+            return err::ERR_ARGS;
+        }
+        void *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED)
+        {
+            log::error("mmap %s failed", file.c_str());
+            return err::ERR_IO;
+        }
+        lex->map = map;
+        lex->map_size = st.st_size;
+        err::Err e = _attach(lex, (const uint8_t *)map, st.st_size);
+        if (e != err::ERR_NONE)
+            unload();
+        return e;
+    }
+
+    err::Err Lexicon::load(const std::string &lexicon_file, const std::string &tokens_file, const std::string &cache_file)
+    {
+        _LexiconData *lex = (_LexiconData *)_data;
+        std::string bin = cache_file.empty() ? lexicon_file + ".bin" : cache_file;
+        if (_newer(bin, lexicon_file) && _newer(bin, tokens_file) && load(bin) == err::ERR_NONE)
+            return err::ERR_NONE;
+        if (compile(lexicon_file, tokens_file, bin) == err::ERR_NONE && load(bin) == err::ERR_NONE)
+            return err::ERR_NONE;
+
+        // cache file not writable, keep compiled lexicon in memory
+        log::warn("lexicon cache %s not available, compile in memory", bin.c_str());
+        unload();
+        err::Err e = _compile(lexicon_file, tokens_file, lex->mem);
+        if (e != err::ERR_NONE)
+            return e;
+        e = _attach(lex, lex->mem.data(), lex->mem.size());
+        if (e != err::ERR_NONE)
+            unload();
+        return e;
+    }
+
+    void Lexicon::unload()
+    {
+        _LexiconData *lex = (_LexiconData *)_data;
+        lex->words.clear();
+        lex->tokens.clear();
+        lex->data = nullptr;
+        lex->words_num = 0;
+        if (lex->map)
+        {
+            munmap(lex->map, lex->map_size);
+            lex->map = nullptr;
+            lex->map_size = 0;
+        }
+        std::vector<uint8_t>().swap(lex->mem);
+    }
+
+    int Lexicon::size()
+    {
+        return ((_LexiconData *)_data)->words_num;
+    }
+
+    static inline void _entry(const int32_t *data, int offset, Lexicon::Entry &entry)
+    {
+        entry.num = data[offset];
+        entry.phones = data + offset + 1;
+        entry.tones = entry.phones + entry.num;
+    }
+
+    bool Lexicon::find(const char *word, int len, Lexicon::Entry &entry)
+    {
+        _LexiconData *lex = (_LexiconData *)_data;
+        if (!lex->data)
+            return false;
+        if (len < 0)
+            len = strlen(word);
+        if (len == 0)
+            return false;
+        int value;
+        lex->words.exactMatchSearch(word, value, len);
+        if (value < 0)
+            return false;
+        _entry(lex->data, value, entry);
+        return true;
+    }
+
+    int Lexicon::match(const char *text, int len, Lexicon::Entry &entry)
+    {
+        _LexiconData *lex = (_LexiconData *)_data;
+        if (!lex->data || len <= 0)
+            return 0;
+        Darts::DoubleArray::result_pair_type result;
+        lex->words.commonLongestPrefixSearch(text, result, len);
+        if (result.value < 0 || result.length == 0)
+            return 0;
+        _entry(lex->data, result.value, entry);
+        return result.length;
+    }
+
+    int Lexicon::token(const std::string &token)
+    {
+        _LexiconData *lex = (_LexiconData *)_data;
+        if (!lex->data || token.empty())
+            return -1;
+        int value;
+        lex->tokens.exactMatchSearch(token.c_str(), value, token.size());
+        return value;
+    }
+} // namespace maix::nn
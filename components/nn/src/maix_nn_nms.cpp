@@ -0,0 +1,377 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Create this file, add NMS engine shared by detectors.
+ */
+
+#include "maix_nn_nms.hpp"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define NMS_USE_NEON 1
+    #define NMS_USE_SSE 0
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+    #define NMS_USE_NEON 0
+    #define NMS_USE_SSE 1
+#else
+    #define NMS_USE_NEON 0
+    #define NMS_USE_SSE 0
+#endif
+
+namespace maix::nn
+{
+    NMS::NMS(float iou_th, bool class_agnostic, int max_det, NMSMethod method)
+        : _iou_th(iou_th), _class_agnostic(class_agnostic), _max_det(max_det), _method(method),
+          _sigma(0.5), _soft_score_th(0.001), _rotated(false)
+    {
+    }
+
+    void NMS::set_method(NMSMethod method, float sigma, float score_th)
+    {
+        if (method == NMSMethod::SOFT_GAUSSIAN && sigma <= 0)
+            throw err::Exception(err::ERR_ARGS, "sigma must > 0");
+        _method = method;
+        _sigma = sigma;
+        _soft_score_th = score_th;
+    }
+
+    void NMS::clear()
+    {
+        _x1.clear();
+        _y1.clear();
+        _x2.clear();
+        _y2.clear();
+        _area.clear();
+        _score.clear();
+        _angle.clear();
+        _class.clear();
+        _keep.clear();
+    }
+
+    void NMS::reserve(int num)
+    {
+        _x1.reserve(num);
+        _y1.reserve(num);
+        _x2.reserve(num);
+        _y2.reserve(num);
+        _area.reserve(num);
+        _score.reserve(num);
+        _angle.reserve(num);
+        _class.reserve(num);
+    }
+
+    int NMS::add(float x, float y, float w, float h, float score, int class_id, float angle)
+    {
+        _x1.push_back(x);
+        _y1.push_back(y);
+        _x2.push_back(x + w);
+        _y2.push_back(y + h);
+        _area.push_back(w * h);
+        _score.push_back(score);
+        _angle.push_back(angle == -9999 ? 0 : angle); // -9999 means no angle in nn::Object
+        _class.push_back(class_id);
+        return (int)_score.size() - 1;
+    }
+
+    void NMS::add(nn::Objects &objs)
+    {
+        reserve(size() + objs.size());
+        for (nn::Object *obj : objs)
+            add(*obj);
+    }
+
+    static void _box_corners(float x1, float y1, float x2, float y2, float angle, float *pts)
+    {
+        // same as nn::Object::get_obb_points, rotate around center
+        float cx = (x1 + x2) * 0.5f;
+        float cy = (y1 + y2) * 0.5f;
+        float c = cosf(angle * M_PI);
+        float s = sinf(angle * M_PI);
+        float xs[4] = {x1, x2, x2, x1};
+        float ys[4] = {y1, y1, y2, y2};
+        for (int i = 0; i < 4; ++i)
+        {
+            pts[i * 2] = c * (xs[i] - cx) - s * (ys[i] - cy) + cx;
+            pts[i * 2 + 1] = s * (xs[i] - cx) + c * (ys[i] - cy) + cy;
+        }
+    }
+
+    static float _poly_area(const float *pts, int n)
+    {
+        float a = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            int j = (i + 1) % n;
+            a += pts[i * 2] * pts[j * 2 + 1] - pts[j * 2] * pts[i * 2 + 1];
+        }
+        return a * 0.5f;
+    }
+
+    // intersection area of two convex quadrilaterals by Sutherland-Hodgman clipping
+    static float _quad_inter_area(const float *a, const float *b)
+    {
+        float buf0[32], buf1[32];
+        float *in = buf0, *out = buf1;
+        int n = 4;
+        memcpy(in, a, sizeof(float) * 8);
+        float dir = _poly_area(b, 4) >= 0 ? 1 : -1;
+        for (int e = 0; e < 4 && n > 0; ++e)
+        {
+            float ex1 = b[e * 2], ey1 = b[e * 2 + 1];
+            float ex2 = b[((e + 1) % 4) * 2], ey2 = b[((e + 1) % 4) * 2 + 1];
+            int m = 0;
+            for (int i = 0; i < n; ++i)
+            {
+                float px = in[i * 2], py = in[i * 2 + 1];
+                float qx = in[((i + 1) % n) * 2], qy = in[((i + 1) % n) * 2 + 1];
+                float dp = dir * ((ex2 - ex1) * (py - ey1) - (ey2 - ey1) * (px - ex1));
+                float dq = dir * ((ex2 - ex1) * (qy - ey1) - (ey2 - ey1) * (qx - ex1));
+                if (dp >= 0)
+                {
+                    out[m * 2] = px;
+                    out[m * 2 + 1] = py;
+                    ++m;
+                }
+                if ((dp >= 0) != (dq >= 0))
+                {
+                    float t = dp / (dp - dq);
+                    out[m * 2] = px + t * (qx - px);
+                    out[m * 2 + 1] = py + t * (qy - py);
+                    ++m;
+                }
+            }
+            n = m;
+            std::swap(in, out);
+        }
+        return n >= 3 ? fabsf(_poly_area(in, n)) : 0;
+    }
+
+    float NMS::rotated_iou(const float a[5], const float b[5])
+    {
+        float pa[8], pb[8];
+        _box_corners(a[0], a[1], a[0] + a[2], a[1] + a[3], a[4], pa);
+        _box_corners(b[0], b[1], b[0] + b[2], b[1] + b[3], b[4], pb);
+        float inter = _quad_inter_area(pa, pb);
+        float uni = a[2] * a[3] + b[2] * b[3] - inter;
+        return uni > 0 ? inter / uni : 0;
+    }
+
+    float NMS::_iou(int i, int j)
+    {
+        float inter;
+        if (_rotated)
+        {
+            // reject by circumscribed circles first
+            float dx = (_x1[i] + _x2[i] - _x1[j] - _x2[j]) * 0.5f;
+            float dy = (_y1[i] + _y2[i] - _y1[j] - _y2[j]) * 0.5f;
+            float wi = _x2[i] - _x1[i], hi = _y2[i] - _y1[i];
+            float wj = _x2[j] - _x1[j], hj = _y2[j] - _y1[j];
+            float r = (sqrtf(wi * wi + hi * hi) + sqrtf(wj * wj + hj * hj)) * 0.5f;
+            if (dx * dx + dy * dy >= r * r)
+                return 0;
+            inter = _quad_inter_area(&_corners[i * 8], &_corners[j * 8]);
+        }
+        else
+        {
+            float w = std::min(_x2[i], _x2[j]) - std::max(_x1[i], _x1[j]);
+            float h = std::min(_y2[i], _y2[j]) - std::max(_y1[i], _y1[j]);
+            inter = std::max(w, 0.0f) * std::max(h, 0.0f);
+        }
+        float uni = _area[i] + _area[j] - inter;
+        return uni > 0 ? inter / uni : 0;
+    }
+
+    // IoU > th  <=>  inter > th * (area_a + area_b - inter), no division
+    bool NMS::_overlap_kept(int i)
+    {
+        int n = (int)_kidx.size();
+        if (_rotated)
+        {
+            for (int j = 0; j < n; ++j)
+            {
+                if (_iou(i, _kidx[j]) > _iou_th)
+                    return true;
+            }
+            return false;
+        }
+        float x1 = _x1[i], y1 = _y1[i], x2 = _x2[i], y2 = _y2[i], area = _area[i];
+        int j = 0;
+#if NMS_USE_NEON
+        float32x4_t vx1 = vdupq_n_f32(x1), vy1 = vdupq_n_f32(y1);
+        float32x4_t vx2 = vdupq_n_f32(x2), vy2 = vdupq_n_f32(y2);
+        float32x4_t varea = vdupq_n_f32(area), vth = vdupq_n_f32(_iou_th), vzero = vdupq_n_f32(0);
+        for (; j + 4 <= n; j += 4)
+        {
+            float32x4_t w = vmaxq_f32(vsubq_f32(vminq_f32(vx2, vld1q_f32(&_kx2[j])), vmaxq_f32(vx1, vld1q_f32(&_kx1[j]))), vzero);
+            float32x4_t h = vmaxq_f32(vsubq_f32(vminq_f32(vy2, vld1q_f32(&_ky2[j])), vmaxq_f32(vy1, vld1q_f32(&_ky1[j]))), vzero);
+            float32x4_t inter = vmulq_f32(w, h);
+            float32x4_t uni = vsubq_f32(vaddq_f32(varea, vld1q_f32(&_karea[j])), inter);
+            uint32x4_t gt = vcgtq_f32(inter, vmulq_f32(vth, uni));
+            uint32x2_t t = vorr_u32(vget_low_u32(gt), vget_high_u32(gt));
+            if (vget_lane_u32(vpmax_u32(t, t), 0))
+                return true;
+        }
+#elif NMS_USE_SSE
+        __m128 vx1 = _mm_set1_ps(x1), vy1 = _mm_set1_ps(y1);
+        __m128 vx2 = _mm_set1_ps(x2), vy2 = _mm_set1_ps(y2);
+        __m128 varea = _mm_set1_ps(area), vth = _mm_set1_ps(_iou_th), vzero = _mm_setzero_ps();
+        for (; j + 4 <= n; j += 4)
+        {
+            __m128 w = _mm_max_ps(_mm_sub_ps(_mm_min_ps(vx2, _mm_loadu_ps(&_kx2[j])), _mm_max_ps(vx1, _mm_loadu_ps(&_kx1[j]))), vzero);
+            __m128 h = _mm_max_ps(_mm_sub_ps(_mm_min_ps(vy2, _mm_loadu_ps(&_ky2[j])), _mm_max_ps(vy1, _mm_loadu_ps(&_ky1[j]))), vzero);
+            __m128 inter = _mm_mul_ps(w, h);
+            __m128 uni = _mm_sub_ps(_mm_add_ps(varea, _mm_loadu_ps(&_karea[j])), inter);
+            if (_mm_movemask_ps(_mm_cmpgt_ps(inter, _mm_mul_ps(vth, uni))))
+                return true;
+        }
+#endif
+        for (; j < n; ++j)
+        {
+            float w = std::min(x2, _kx2[j]) - std::max(x1, _kx1[j]);
+            float h = std::min(y2, _ky2[j]) - std::max(y1, _ky1[j]);
+            float inter = std::max(w, 0.0f) * std::max(h, 0.0f);
+            if (inter > _iou_th * (area + _karea[j] - inter))
+                return true;
+        }
+        return false;
+    }
+
+    // idx sorted by score from high to low
+    void NMS::_hard(const int *idx, int num)
+    {
+        _kx1.clear();
+        _ky1.clear();
+        _kx2.clear();
+        _ky2.clear();
+        _karea.clear();
+        _kidx.clear();
+        for (int k = 0; k < num; ++k)
+        {
+            if (_max_det > 0 && (int)_kidx.size() >= _max_det)
+                break;
+            int i = idx[k];
+            if (_overlap_kept(i))
+                continue;
+            _kx1.push_back(_x1[i]);
+            _ky1.push_back(_y1[i]);
+            _kx2.push_back(_x2[i]);
+            _ky2.push_back(_y2[i]);
+            _karea.push_back(_area[i]);
+            _kidx.push_back(i);
+            _keep.push_back(i);
+        }
+    }
+
+    void NMS::_soft(const int *idx, int num)
+    {
+        _cand.assign(idx, idx + num);
+        int kept = 0;
+        while (!_cand.empty())
+        {
+            if (_max_det > 0 && kept >= _max_det)
+                break;
+            // pick the highest score, score changed after decay so can't use sorted order
+            size_t m = 0;
+            for (size_t k = 1; k < _cand.size(); ++k)
+            {
+                if (_cur_score[_cand[k]] > _cur_score[_cand[m]])
+                    m = k;
+            }
+            int i = _cand[m];
+            if (_cur_score[i] < _soft_score_th)
+                break;
+            _cand[m] = _cand.back();
+            _cand.pop_back();
+            _keep.push_back(i);
+            ++kept;
+            size_t n = 0;
+            for (size_t k = 0; k < _cand.size(); ++k)
+            {
+                int j = _cand[k];
+                float iou = _iou(i, j);
+                if (_method == NMSMethod::SOFT_LINEAR)
+                {
+                    if (iou > _iou_th)
+                        _cur_score[j] *= 1 - iou;
+                }
+                else
+                {
+                    _cur_score[j] *= expf(-iou * iou / _sigma);
+                }
+                if (_cur_score[j] >= _soft_score_th)
+                    _cand[n++] = j;
+            }
+            _cand.resize(n);
+        }
+    }
+
+    const std::vector<int> &NMS::run()
+    {
+        int n = size();
+        _keep.clear();
+        _cur_score = _score;
+        if (n == 0)
+            return _keep;
+        if (_rotated)
+        {
+            _corners.resize(n * 8);
+            for (int i = 0; i < n; ++i)
+                _box_corners(_x1[i], _y1[i], _x2[i], _y2[i], _angle[i], &_corners[i * 8]);
+        }
+        _order.resize(n);
+        for (int i = 0; i < n; ++i)
+            _order[i] = i;
+        // group by class, then score from high to low in each class
+        std::sort(_order.begin(), _order.end(), [this](int a, int b) {
+            if (!_class_agnostic && _class[a] != _class[b])
+                return _class[a] < _class[b];
+            if (_score[a] != _score[b])
+                return _score[a] > _score[b];
+            return a < b;
+        });
+        for (int start = 0; start < n;)
+        {
+            int end = start + 1;
+            if (_class_agnostic)
+                end = n;
+            else
+            {
+                while (end < n && _class[_order[end]] == _class[_order[start]])
+                    ++end;
+            }
+            if (_method == NMSMethod::HARD)
+                _hard(&_order[start], end - start);
+            else
+                _soft(&_order[start], end - start);
+            start = end;
+        }
+        std::sort(_keep.begin(), _keep.end(), [this](int a, int b) {
+            if (_cur_score[a] != _cur_score[b])
+                return _cur_score[a] > _cur_score[b];
+            return a < b;
+        });
+        if (_max_det > 0 && (int)_keep.size() > _max_det)
+            _keep.resize(_max_det);
+        return _keep;
+    }
+
+    int NMS::run(nn::Objects &objs)
+    {
+        clear();
+        add(objs);
+        const std::vector<int> &keep = run();
+        if (_method != NMSMethod::HARD)
+        {
+            for (int i : keep)
+                objs.at(i).score = _cur_score[i];
+        }
+        objs.keep(keep);
+        return (int)keep.size();
+    }
+
+} // namespace maix::nn
@@ -88,44 +88,125 @@ namespace maix::nn
             if(objects->size() > 0)
                 _correct_bbox(*objects, img_w, img_h, fit);
             // recognize charactors
+            std::vector<nn::OCR_Object *> objs;
             for(size_t i = 0; i < boxes.size(); ++i)
-            {
-                // int x, y, w, h;
-                // _get_external_box(boxes[i], x, y, w, h, shape[3], shape[2]);
-                std::vector<std::string> char_list;
-                nn::OCR_Object &obj = objects->at(i);
-                _recognize(img, obj.box, obj.idx_list, char_list, obj.char_pos, true);
-                obj.update_chars(char_list);
-            }
+                objs.push_back(&objects->at(i));
+            _recognize(img, objs, true);
             break;
         }
 
         return objects;
     }
 
-    static void _recognize_stdimg(nn::NN *_rec_model, image::Image &std_img, std::vector<float> &mean, std::vector<float> &scale, std::vector<int> &max_idxes, const int &_max_ch_num, const int &_prob_num)
+    // one model input of recognize, long text line is sliced to multiple model inputs
+    typedef struct
+    {
+        int obj;
+        int slice;
+    } _rec_job_t;
+
+    // size of text line after crop and keep ratio resize to model input height
+    static int _rec_resized_width(const nn::OCR_Box &box, bool crop, int img_w, int img_h, int input_h)
     {
-        // foward image
-        tensor::Tensors *outputs;
-        outputs = _rec_model->forward_image(std_img, mean, scale, image::Fit::FIT_FILL, true);
-        if (!outputs) // not happen here
+        float w = img_w, h = img_h;
+        if(crop)
         {
-            throw err::Exception(err::ERR_RUNTIME);
+            w = int(sqrt(pow(box.x1 - box.x2, 2) + pow(box.y1 - box.y2, 2)));
+            h = int(sqrt(pow(box.x1 - box.x4, 2) + pow(box.y1 - box.y4, 2)));
+            if (h >= w * 1.5)
+                std::swap(w, h);
         }
+        return static_cast<int>(input_h * (w / h));
+    }
+
+    void PP_OCR::_recognize(image::Image &img, std::vector<nn::OCR_Object *> &objs, bool crop)
+    {
+        // every text line is resized to model input height keep ratio,
+        // if new width > model input width, slice to multiple model inputs, padding black color at right of the last one,
+        // else padding black color at right.
+        // all slices of all text lines are forwarded by ROIPipeline, resize next text line is overlapped with forwarding.
+        int input_w = _rec_input_size.width();
+        int input_h = _rec_input_size.height();
+        std::vector<_rec_job_t> jobs;
+        for(size_t i = 0; i < objs.size(); ++i)
+        {
+            objs[i]->idx_list.clear();
+            objs[i]->char_pos.clear();
+            int resized_w = _rec_resized_width(objs[i]->box, crop, img.width(), img.height(), input_h);
+            int slices = resized_w > input_w ? (resized_w + input_w - 1) / input_w : 1;
+            for(int j = 0; j < slices; ++j)
+                jobs.push_back({(int)i, j});
+        }
+        std::vector<std::vector<std::string>> char_lists(objs.size());
+
+        cv::Mat img_src(img.height(), img.width(), CV_8UC3, img.data());
+        int resized_obj = -1;
+        cv::Mat resized_img;  // prepare is called in order, keep resized image for slices of the same text line
+        auto prepare = [&](int idx, image::Image &dst) -> err::Err {
+            _rec_job_t &job = jobs[idx];
+            if(job.obj != resized_obj)
+            {
+                const nn::OCR_Box &box = objs[job.obj]->box;
+                cv::Mat *std_img = &img_src;
+                cv::Mat img_dst;
+                cv::Mat srcCopy;
+                if(crop)
+                {
+                    // crop and get std
+                    cv::Point2f pts_std[4];
+                    int img_crop_width = int(sqrt(pow(box.x1 - box.x2, 2) +
+                                            pow(box.y1 - box.y2, 2)));
+                    int img_crop_height = int(sqrt(pow(box.x1 - box.x4, 2) +
+                                                    pow(box.y1 - box.y4, 2)));
+                    pts_std[0] = cv::Point2f(0., 0.);
+                    pts_std[1] = cv::Point2f(img_crop_width, 0.);
+                    pts_std[2] = cv::Point2f(img_crop_width, img_crop_height);
+                    pts_std[3] = cv::Point2f(0.f, img_crop_height);
+                    cv::Point2f pointsf[4];
+                    pointsf[0] = cv::Point2f(box.x1, box.y1);
+                    pointsf[1] = cv::Point2f(box.x2, box.y2);
+                    pointsf[2] = cv::Point2f(box.x3, box.y3);
+                    pointsf[3] = cv::Point2f(box.x4, box.y4);
+                    cv::Mat M = cv::getPerspectiveTransform(pointsf, pts_std);
+                    cv::warpPerspective(img_src, img_dst, M,
+                                cv::Size(img_crop_width, img_crop_height),
+                                cv::BORDER_REPLICATE);
+                    std_img = &img_dst;
+                    if (float(img_dst.rows) >= float(img_dst.cols) * 1.5) {
+                        srcCopy = cv::Mat(img_dst.rows, img_dst.cols, img_dst.depth());
+                        cv::transpose(img_dst, srcCopy);
+                        cv::flip(srcCopy, srcCopy, 0);
+                        std_img = &srcCopy;
+                    }
+                }
+                float aspect_ratio = float(std_img->cols) / float(std_img->rows);
+                cv::resize(*std_img, resized_img, cv::Size(static_cast<int>(input_h * aspect_ratio), input_h));
+                resized_obj = job.obj;
+            }
+            int x = job.slice * input_w;
+            if(x >= resized_img.cols) // rounding of resized width, no content left
+                return err::ERR_ARGS;
+            cv::Mat final_img(input_h, input_w, CV_8UC3, dst.data());
+            final_img.setTo(cv::Scalar(0, 0, 0));
+            cv::Mat crop_img = resized_img(cv::Rect(x, 0, std::min(input_w, resized_img.cols - x), resized_img.rows));
+            crop_img.copyTo(final_img(cv::Rect(0, 0, crop_img.cols, crop_img.rows)));
+            // show image on left-top
+            // img.draw_image(0, 0, dst);
+            return err::ERR_NONE;
+        };
 
         // rec postprocess, outputs shape: _max_ch_num x (_prob_num)
         // get all max prob, totally _max_ch_num sections,
-        // then remove dumplicate and empty section, get charactors store in chars var.
-        for (auto it = outputs->begin(); it != outputs->end(); it++)
-        {
-            tensor::Tensor *out = it->second;
-            float *data = (float*)out->data();
-            float max_score;
+        // then remove dumplicate and empty section, get charactors.
+        std::vector<int> max_idxes(_max_ch_num);
+        auto collect = [&](int idx, tensor::Tensors &outputs) {
+            _rec_job_t &job = jobs[idx];
+            float *data = (float *)outputs.begin()->second->data();
             #pragma omp parallel for
             for(int i = 0; i < _max_ch_num; ++i)
             {
                 float *p_data = data + i * _prob_num;
-                max_score = p_data[0];
+                float max_score = p_data[0];
                 max_idxes[i] = 0;
                 for(int j = 1; j < _prob_num; ++j)
                 {
@@ -136,121 +217,26 @@ namespace maix::nn
                     }
                 }
             }
-            break;
-        }
-        delete outputs;
-    }
-
-    void PP_OCR::_recognize(image::Image &img, const nn::OCR_Box &box, std::vector<int> &idx_list, std::vector<std::string> &char_list, std::vector<int> &char_pos, bool crop)
-    {
-        idx_list.clear();
-        char_list.clear();
-        cv::Mat img_src(img.height(), img.width(), CV_8UC3, img.data());
-        cv::Mat *std_img = &img_src;
-        cv::Mat img_dst;
-        cv::Mat srcCopy;
-        if(crop)
-        {
-            // crop and get std
-            cv::Point2f pts_std[4];
-            int img_crop_width = int(sqrt(pow(box.x1 - box.x2, 2) +
-                                    pow(box.y1 - box.y2, 2)));
-            int img_crop_height = int(sqrt(pow(box.x1 - box.x4, 2) +
-                                            pow(box.y1 - box.y4, 2)));
-            pts_std[0] = cv::Point2f(0., 0.);
-            pts_std[1] = cv::Point2f(img_crop_width, 0.);
-            pts_std[2] = cv::Point2f(img_crop_width, img_crop_height);
-            pts_std[3] = cv::Point2f(0.f, img_crop_height);
-            cv::Point2f pointsf[4];
-            pointsf[0] = cv::Point2f(box.x1, box.y1);
-            pointsf[1] = cv::Point2f(box.x2, box.y2);
-            pointsf[2] = cv::Point2f(box.x3, box.y3);
-            pointsf[3] = cv::Point2f(box.x4, box.y4);
-            cv::Mat M = cv::getPerspectiveTransform(pointsf, pts_std);
-            cv::warpPerspective(img_src, img_dst, M,
-                        cv::Size(img_crop_width, img_crop_height),
-                        cv::BORDER_REPLICATE);
-            std_img = &img_dst;
-            if (float(img_dst.rows) >= float(img_dst.cols) * 1.5) {
-                srcCopy = cv::Mat(img_dst.rows, img_dst.cols, img_dst.depth());
-                cv::transpose(img_dst, srcCopy);
-                cv::flip(srcCopy, srcCopy, 0);
-                std_img = &srcCopy;
-            }
-        }
-
-        // resize pad image to model input size(_rec_input_size) like 320x48
-        // keep ratio resize image's height to _rec_input_size.height(),
-        // if new image width > _rec_input_size.width()， resize new image width to _rec_input_size.width(), padding black color at bottom,
-        // else if new image width < _rec_input_size.width(), keep new image content at left, right padding black color.
-        // finally we got _rec_input_size image
-        float aspect_ratio = float(std_img->cols) / float(std_img->rows);
-        cv::Mat resized_img;
-        // Height is the limiting factor
-        cv::resize(*std_img, resized_img, cv::Size(static_cast<int>(_rec_input_size.height() * aspect_ratio),
-                    _rec_input_size.height()));
-        if (aspect_ratio > float(_rec_input_size.width()) / float(_rec_input_size.height())) {
-            // Width > input width
-            // slice and recognize
-            for(int i = 0; i < std::ceil((float)resized_img.cols / _rec_input_size.width()); ++i)
-            {
-                // crop
-                cv::Mat crop_img = resized_img(cv::Rect(i * _rec_input_size.width(), 0, std::min(_rec_input_size.width(), resized_img.cols - i * _rec_input_size.width()), resized_img.rows));
-                cv::Mat final_img;
-                if(crop_img.cols < _rec_input_size.width())
-                {
-                    cv::Mat padded_img(_rec_input_size.height(), _rec_input_size.width(), CV_8UC3, cv::Scalar(0, 0, 0));
-                    crop_img.copyTo(padded_img(cv::Rect(0, 0, crop_img.cols, crop_img.rows)));
-                    padded_img.copyTo(final_img);
-                }
-                else
-                {
-                    crop_img.copyTo(final_img);
-                }
-                // show image on left-top
-                image::Image std_img(final_img.cols, final_img.rows, image::Format::FMT_BGR888, final_img.data, -1, false);
-                // if(i == 0)
-                //     img.draw_image(0, 0, std_img);
-
-                std::vector<int> max_idxes(_max_ch_num);
-                _recognize_stdimg(_rec_model, std_img, this->rec_mean, this->rec_scale, max_idxes, _max_ch_num, _prob_num);
-
-                int last_idx = 0;
-                for(int j = 0; j < _max_ch_num; ++j)
-                {
-                    if((max_idxes[j] != last_idx) && (max_idxes[j] != 0))
-                    {
-                        idx_list.push_back(max_idxes[j] - 1);
-                        char_list.push_back(labels[max_idxes[j] - 1]);
-                        char_pos.push_back(j + i * _max_ch_num);
-                    }
-                    last_idx = max_idxes[j];
-                }
-            }
-        } else {
-            // pad
-            cv::Mat padded_img(_rec_input_size.height(), _rec_input_size.width(), CV_8UC3, cv::Scalar(0, 0, 0));
-            resized_img.copyTo(padded_img(cv::Rect(0, 0, resized_img.cols, resized_img.rows)));
-            image::Image pad_img(padded_img.cols, padded_img.rows, image::Format::FMT_BGR888, padded_img.data, -1, false);
-
-            // show image on left-top
-            // img.draw_image(0, 0, pad_img);
-
-            std::vector<int> max_idxes(_max_ch_num);
-            _recognize_stdimg(_rec_model, pad_img, this->rec_mean, this->rec_scale, max_idxes, _max_ch_num, _prob_num);
-
+            nn::OCR_Object *obj = objs[job.obj];
             int last_idx = 0;
             for(int i = 0; i < _max_ch_num; ++i)
             {
                 if((max_idxes[i] != last_idx) && (max_idxes[i] != 0))
                 {
-                    idx_list.push_back(max_idxes[i] - 1);
-                    char_list.push_back(labels[max_idxes[i] - 1]);
-                    char_pos.push_back(i);
+                    obj->idx_list.push_back(max_idxes[i] - 1);
+                    char_lists[job.obj].push_back(labels[max_idxes[i] - 1]);
+                    obj->char_pos.push_back(i + job.slice * _max_ch_num);
                 }
                 last_idx = max_idxes[i];
             }
+        };
+        err::Err e = _rec_pipeline->run(jobs.size(), prepare, collect);
+        if (e != err::ERR_NONE) // not happen here
+        {
+            throw err::Exception(e, "recognize forward failed");
         }
+        for(size_t i = 0; i < objs.size(); ++i)
+            objs[i]->update_chars(char_lists[i]);
     }
 
     void PP_OCR::_correct_bbox(nn::OCR_Objects &objs, int img_w, int img_h, maix::image::Fit fit)
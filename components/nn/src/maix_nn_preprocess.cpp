@@ -0,0 +1,546 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Create this file, add fused image preprocess for model input.
+ */
+
+#include "maix_nn_preprocess.hpp"
+#include <math.h>
+#include <omp.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define PREPROCESS_USE_NEON 1
+    #define PREPROCESS_USE_SSE 0
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+    #define PREPROCESS_USE_NEON 0
+    #define PREPROCESS_USE_SSE 1
+#else
+    #define PREPROCESS_USE_NEON 0
+    #define PREPROCESS_USE_SSE 0
+#endif
+
+namespace maix::nn
+{
+    enum
+    {
+        _DST_RGB = 0,
+        _DST_BGR,
+        _DST_GRAY
+    };
+
+    static inline uint8_t _clamp_u8(int v)
+    {
+        return v < 0 ? 0 : (v > 255 ? 255 : v);
+    }
+
+    /**
+     * Blend two source rows vertically, out = r0 * (256 - wy) + r1 * wy, exact in uint16.
+     * Source rows are contiguous bytes, so this is where most of resample work is vectorized.
+     */
+    static void _blend_rows(const uint8_t *r0, const uint8_t *r1, int wy, uint16_t *out, int n)
+    {
+        int i = 0;
+#if PREPROCESS_USE_NEON
+        uint16x8_t w0 = vdupq_n_u16(256 - wy);
+        uint16x8_t w1 = vdupq_n_u16(wy);
+        for (; i + 8 <= n; i += 8)
+        {
+            uint16x8_t a = vmovl_u8(vld1_u8(r0 + i));
+            uint16x8_t b = vmovl_u8(vld1_u8(r1 + i));
+            vst1q_u16(out + i, vmlaq_u16(vmulq_u16(a, w0), b, w1));
+        }
+#elif PREPROCESS_USE_SSE
+        __m128i w0 = _mm_set1_epi16((short)(256 - wy));
+        __m128i w1 = _mm_set1_epi16((short)wy);
+        __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= n; i += 16)
+        {
+            __m128i a = _mm_loadu_si128((const __m128i *)(r0 + i));
+            __m128i b = _mm_loadu_si128((const __m128i *)(r1 + i));
+            __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), w0), _mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), w1));
+            __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), w0), _mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), w1));
+            _mm_storeu_si128((__m128i *)(out + i), lo);
+            _mm_storeu_si128((__m128i *)(out + i + 8), hi);
+        }
+#endif
+        for (; i < n; ++i)
+        {
+            out[i] = (uint16_t)(r0[i] * (256 - wy) + r1[i] * wy);
+        }
+    }
+
+    static inline uint8_t _lerp_h(const uint16_t *v, int i0, int i1, int wx)
+    {
+        return (uint8_t)((v[i0] * (256 - wx) + v[i1] * wx + 32768) >> 16);
+    }
+
+    /**
+     * Sample one dst row horizontally from vertically blended packed row(gray, rgb, bgr, rgba, bgra),
+     * write to planar r, g, b(or gray) row, gather by index map, no SIMD gather on NEON and SSE2.
+     */
+    template <int SRC_C, bool SRC_BGR>
+    static void _sample_row_packed(const uint16_t *v, const int *i0, const int *i1, const uint16_t *w, int len, uint8_t **planes, int start)
+    {
+        for (int i = 0; i < len; ++i)
+        {
+            const int a = i0[i] * SRC_C;
+            const int b = i1[i] * SRC_C;
+            if (SRC_C == 1)
+            {
+                planes[0][start + i] = _lerp_h(v, a, b, w[i]);
+            }
+            else
+            {
+                planes[SRC_BGR ? 2 : 0][start + i] = _lerp_h(v, a, b, w[i]);
+                planes[1][start + i] = _lerp_h(v, a + 1, b + 1, w[i]);
+                planes[SRC_BGR ? 0 : 2][start + i] = _lerp_h(v, a + 2, b + 2, w[i]);
+            }
+        }
+    }
+
+    /**
+     * YUV to RGB use BT.601 same as OpenCV COLOR_YUV2RGB_NV21.
+     */
+    static void _yuv_to_rgb_row(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *r, uint8_t *g, uint8_t *b, int n)
+    {
+        int i = 0;
+#if PREPROCESS_USE_NEON
+        int16x8_t k16 = vdupq_n_s16(16), k128 = vdupq_n_s16(128), zero = vdupq_n_s16(0);
+        int32x4_t round = vdupq_n_s32(128);
+        for (; i + 8 <= n; i += 8)
+        {
+            int16x8_t yy = vmaxq_s16(vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(y + i))), k16), zero);
+            int16x8_t d = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(u + i))), k128);
+            int16x8_t e = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(v + i))), k128);
+            int32x4_t c_lo = vaddq_s32(vmull_n_s16(vget_low_s16(yy), 298), round);
+            int32x4_t c_hi = vaddq_s32(vmull_n_s16(vget_high_s16(yy), 298), round);
+            int32x4_t r_lo = vmlal_n_s16(c_lo, vget_low_s16(e), 409);
+            int32x4_t r_hi = vmlal_n_s16(c_hi, vget_high_s16(e), 409);
+            int32x4_t g_lo = vmlal_n_s16(vmlal_n_s16(c_lo, vget_low_s16(d), -100), vget_low_s16(e), -208);
+            int32x4_t g_hi = vmlal_n_s16(vmlal_n_s16(c_hi, vget_high_s16(d), -100), vget_high_s16(e), -208);
+            int32x4_t b_lo = vmlal_n_s16(c_lo, vget_low_s16(d), 516);
+            int32x4_t b_hi = vmlal_n_s16(c_hi, vget_high_s16(d), 516);
+            vst1_u8(r + i, vqmovn_u16(vcombine_u16(vqmovun_s32(vshrq_n_s32(r_lo, 8)), vqmovun_s32(vshrq_n_s32(r_hi, 8)))));
+            vst1_u8(g + i, vqmovn_u16(vcombine_u16(vqmovun_s32(vshrq_n_s32(g_lo, 8)), vqmovun_s32(vshrq_n_s32(g_hi, 8)))));
+            vst1_u8(b + i, vqmovn_u16(vcombine_u16(vqmovun_s32(vshrq_n_s32(b_lo, 8)), vqmovun_s32(vshrq_n_s32(b_hi, 8)))));
+        }
+#elif PREPROCESS_USE_SSE
+        __m128i zero = _mm_setzero_si128();
+        __m128i k16 = _mm_set1_epi16(16), k128 = _mm_set1_epi16(128);
+        __m128i round = _mm_set1_epi32(128);
+        // _mm_madd_epi16 pairs, low 16 bits is coefficient of first item, high 16 bits of second item
+        __m128i kc = _mm_set1_epi32(298), kr = _mm_set1_epi32(409), kb = _mm_set1_epi32(516);
+        __m128i kg = _mm_set1_epi32((int)(((uint32_t)(uint16_t)-208 << 16) | (uint16_t)-100));
+        for (; i + 8 <= n; i += 8)
+        {
+            __m128i yy = _mm_max_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(y + i)), zero), k16), zero);
+            __m128i d = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(u + i)), zero), k128);
+            __m128i e = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(v + i)), zero), k128);
+            __m128i c_lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(yy, zero), kc), round);
+            __m128i c_hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(yy, zero), kc), round);
+            __m128i r_lo = _mm_add_epi32(c_lo, _mm_madd_epi16(_mm_unpacklo_epi16(e, zero), kr));
+            __m128i r_hi = _mm_add_epi32(c_hi, _mm_madd_epi16(_mm_unpackhi_epi16(e, zero), kr));
+            __m128i g_lo = _mm_add_epi32(c_lo, _mm_madd_epi16(_mm_unpacklo_epi16(d, e), kg));
+            __m128i g_hi = _mm_add_epi32(c_hi, _mm_madd_epi16(_mm_unpackhi_epi16(d, e), kg));
+            __m128i b_lo = _mm_add_epi32(c_lo, _mm_madd_epi16(_mm_unpacklo_epi16(d, zero), kb));
+            __m128i b_hi = _mm_add_epi32(c_hi, _mm_madd_epi16(_mm_unpackhi_epi16(d, zero), kb));
+            __m128i rr = _mm_packs_epi32(_mm_srai_epi32(r_lo, 8), _mm_srai_epi32(r_hi, 8));
+            __m128i gg = _mm_packs_epi32(_mm_srai_epi32(g_lo, 8), _mm_srai_epi32(g_hi, 8));
+            __m128i bb = _mm_packs_epi32(_mm_srai_epi32(b_lo, 8), _mm_srai_epi32(b_hi, 8));
+            _mm_storel_epi64((__m128i *)(r + i), _mm_packus_epi16(rr, zero));
+            _mm_storel_epi64((__m128i *)(g + i), _mm_packus_epi16(gg, zero));
+            _mm_storel_epi64((__m128i *)(b + i), _mm_packus_epi16(bb, zero));
+        }
+#endif
+        for (; i < n; ++i)
+        {
+            int c = (y[i] - 16) < 0 ? 0 : (y[i] - 16) * 298;
+            int d = u[i] - 128;
+            int e = v[i] - 128;
+            r[i] = _clamp_u8((c + 409 * e + 128) >> 8);
+            g[i] = _clamp_u8((c - 100 * d - 208 * e + 128) >> 8);
+            b[i] = _clamp_u8((c + 516 * d + 128) >> 8);
+        }
+    }
+
+    static void _rgb_to_gray_row(const uint8_t *r, const uint8_t *g, const uint8_t *b, uint8_t *gray, int n)
+    {
+        int i = 0;
+#if PREPROCESS_USE_NEON
+        uint16x8_t round = vdupq_n_u16(128);
+        for (; i + 8 <= n; i += 8)
+        {
+            uint16x8_t acc = vmlal_u8(round, vld1_u8(r + i), vdup_n_u8(77));
+            acc = vmlal_u8(acc, vld1_u8(g + i), vdup_n_u8(150));
+            acc = vmlal_u8(acc, vld1_u8(b + i), vdup_n_u8(29));
+            vst1_u8(gray + i, vshrn_n_u16(acc, 8));
+        }
+#elif PREPROCESS_USE_SSE
+        __m128i zero = _mm_setzero_si128();
+        __m128i kr = _mm_set1_epi16(77), kg = _mm_set1_epi16(150), kb = _mm_set1_epi16(29), round = _mm_set1_epi16(128);
+        for (; i + 8 <= n; i += 8)
+        {
+            __m128i acc = _mm_mullo_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(r + i)), zero), kr);
+            acc = _mm_add_epi16(acc, _mm_mullo_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(g + i)), zero), kg));
+            acc = _mm_add_epi16(acc, _mm_mullo_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(b + i)), zero), kb));
+            acc = _mm_srli_epi16(_mm_add_epi16(acc, round), 8);
+            _mm_storel_epi64((__m128i *)(gray + i), _mm_packus_epi16(acc, zero));
+        }
+#endif
+        for (; i < n; ++i)
+        {
+            gray[i] = (uint8_t)((77 * r[i] + 150 * g[i] + 29 * b[i] + 128) >> 8);
+        }
+    }
+
+    static void _norm_row_f32(const uint8_t *src, float *dst, int n, float a, float b)
+    {
+        int i = 0;
+#if PREPROCESS_USE_NEON
+        float32x4_t va = vdupq_n_f32(a);
+        float32x4_t vb = vdupq_n_f32(b);
+        for (; i + 8 <= n; i += 8)
+        {
+            uint16x8_t u16 = vmovl_u8(vld1_u8(src + i));
+            float32x4_t f0 = vcvtq_f32_u32(vmovl_u16(vget_low_u16(u16)));
+            float32x4_t f1 = vcvtq_f32_u32(vmovl_u16(vget_high_u16(u16)));
+            vst1q_f32(dst + i, vmlaq_f32(vb, f0, va));
+            vst1q_f32(dst + i + 4, vmlaq_f32(vb, f1, va));
+        }
+#elif PREPROCESS_USE_SSE
+        __m128 va = _mm_set1_ps(a);
+        __m128 vb = _mm_set1_ps(b);
+        __m128i zero = _mm_setzero_si128();
+        for (; i + 8 <= n; i += 8)
+        {
+            __m128i u16 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(src + i)), zero);
+            __m128 f0 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(u16, zero));
+            __m128 f1 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(u16, zero));
+            _mm_storeu_ps(dst + i, _mm_add_ps(_mm_mul_ps(f0, va), vb));
+            _mm_storeu_ps(dst + i + 4, _mm_add_ps(_mm_mul_ps(f1, va), vb));
+        }
+#endif
+        for (; i < n; ++i)
+        {
+            dst[i] = src[i] * a + b;
+        }
+    }
+
+    static void _norm_row_f32_hwc(uint8_t **planes, float *dst, int n, int c, const float *a, const float *b)
+    {
+        int i = 0;
+#if PREPROCESS_USE_NEON
+        if (c == 3)
+        {
+            float32x4_t va0 = vdupq_n_f32(a[0]), va1 = vdupq_n_f32(a[1]), va2 = vdupq_n_f32(a[2]);
+            float32x4_t vb0 = vdupq_n_f32(b[0]), vb1 = vdupq_n_f32(b[1]), vb2 = vdupq_n_f32(b[2]);
+            for (; i + 4 <= n; i += 4)
+            {
+                float32x4x3_t v;
+                v.val[0] = vmlaq_f32(vb0, vcvtq_f32_u32(vmovl_u16(vget_low_u16(vmovl_u8(vld1_u8(planes[0] + i))))), va0);
+                v.val[1] = vmlaq_f32(vb1, vcvtq_f32_u32(vmovl_u16(vget_low_u16(vmovl_u8(vld1_u8(planes[1] + i))))), va1);
+                v.val[2] = vmlaq_f32(vb2, vcvtq_f32_u32(vmovl_u16(vget_low_u16(vmovl_u8(vld1_u8(planes[2] + i))))), va2);
+                vst3q_f32(dst + i * 3, v);
+            }
+        }
+#endif
+        for (; i < n; ++i)
+        {
+            for (int k = 0; k < c; ++k)
+            {
+                dst[i * c + k] = planes[k][i] * a[k] + b[k];
+            }
+        }
+    }
+
+    ImagePreprocess::ImagePreprocess(int width, int height, image::Format format, tensor::DType dtype, bool chw,
+                                     const std::vector<float> &mean, const std::vector<float> &scale, image::ResizeMethod method)
+    {
+        if (width <= 0 || height <= 0)
+            throw err::Exception(err::ERR_ARGS, "preprocess width and height should > 0");
+        if (format != image::FMT_RGB888 && format != image::FMT_BGR888 && format != image::FMT_GRAYSCALE)
+            throw err::Exception(err::ERR_ARGS, "preprocess only support RGB888, BGR888, GRAYSCALE model input");
+        if (dtype != tensor::DType::FLOAT32 && dtype != tensor::DType::UINT8 && dtype != tensor::DType::INT8)
+            throw err::Exception(err::ERR_ARGS, "preprocess only support float32, uint8, int8 model input");
+        _width = width;
+        _height = height;
+        _format = format;
+        _channels = format == image::FMT_GRAYSCALE ? 1 : 3;
+        _dtype = dtype;
+        _chw = chw;
+        _bilinear = method != image::ResizeMethod::NEAREST;
+        _src_w = 0;
+        _src_h = 0;
+        _fit = image::Fit::FIT_NONE;
+        set_norm(mean, scale);
+    }
+
+    void ImagePreprocess::set_norm(const std::vector<float> &mean, const std::vector<float> &scale)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            float m = (int)mean.size() > k ? mean[k] : 0;
+            float s = (int)scale.size() > k ? scale[k] : 1;
+            _a[k] = s;
+            _b[k] = -m * s;
+        }
+    }
+
+    void ImagePreprocess::_map_axis(AxisMap &m, int start, int len, float src_start, float src_len, int src_size)
+    {
+        m.start = start;
+        m.len = len;
+        m.i0.resize(len);
+        m.i1.resize(len);
+        m.w.resize(len);
+        float s = src_len / len;
+        for (int i = 0; i < len; ++i)
+        {
+            if (!_bilinear)
+            {
+                int idx = (int)(src_start + (i + 0.5f) * s);
+                idx = idx < 0 ? 0 : (idx >= src_size ? src_size - 1 : idx);
+                m.i0[i] = idx;
+                m.i1[i] = idx;
+                m.w[i] = 0;
+                continue;
+            }
+            float f = src_start + (i + 0.5f) * s - 0.5f;
+            if (f < 0)
+                f = 0;
+            int idx = (int)f;
+            if (idx >= src_size - 1)
+            {
+                m.i0[i] = src_size - 1;
+                m.i1[i] = src_size - 1;
+                m.w[i] = 0;
+            }
+            else
+            {
+                m.i0[i] = idx;
+                m.i1[i] = idx + 1;
+                m.w[i] = (uint16_t)((f - idx) * 256 + 0.5f);
+            }
+        }
+        // indexes are monotonic, keep them relative to the first used source pixel,
+        // so only the used source span is blended
+        m.first = len > 0 ? m.i0[0] : 0;
+        m.count = len > 0 ? m.i1[len - 1] - m.first + 1 : 0;
+        for (int i = 0; i < len; ++i)
+        {
+            m.i0[i] -= m.first;
+            m.i1[i] -= m.first;
+        }
+    }
+
+    void ImagePreprocess::_update_map(int src_w, int src_h, image::Fit fit)
+    {
+        if (src_w == _src_w && src_h == _src_h && fit == _fit)
+            return;
+        // content rect in dst, and source region mapped to it
+        int x = 0, y = 0, w = _width, h = _height;
+        float src_x = 0, src_y = 0, src_rw = src_w, src_rh = src_h;
+        if (fit == image::Fit::FIT_CONTAIN)
+        {
+            float s = std::min((float)_width / src_w, (float)_height / src_h);
+            w = std::max(std::min((int)(src_w * s + 0.5f), _width), 1);
+            h = std::max(std::min((int)(src_h * s + 0.5f), _height), 1);
+            x = (_width - w) / 2;
+            y = (_height - h) / 2;
+        }
+        else if (fit == image::Fit::FIT_COVER)
+        {
+            float s = std::max((float)_width / src_w, (float)_height / src_h);
+            src_rw = _width / s;
+            src_rh = _height / s;
+            src_x = (src_w - src_rw) / 2;
+            src_y = (src_h - src_rh) / 2;
+        }
+        else if (fit != image::Fit::FIT_FILL)
+        {
+            throw err::Exception(err::ERR_ARGS, "not support object fit");
+        }
+        _map_axis(_xmap, x, w, src_x, src_rw, src_w);
+        _map_axis(_ymap, y, h, src_y, src_rh, src_h);
+        _src_w = src_w;
+        _src_h = src_h;
+        _fit = fit;
+    }
+
+    void ImagePreprocess::_write_row(uint8_t **planes, void *dst, int y)
+    {
+        int hw = _width * _height;
+        int c = _channels;
+        if (_dtype == tensor::DType::FLOAT32)
+        {
+            float *out = (float *)dst;
+            if (_chw)
+            {
+                for (int k = 0; k < c; ++k)
+                    _norm_row_f32(planes[k], out + k * hw + y * _width, _width, _a[k], _b[k]);
+            }
+            else
+            {
+                _norm_row_f32_hwc(planes, out + y * _width * c, _width, c, _a, _b);
+            }
+        }
+        else if (_dtype == tensor::DType::UINT8)
+        {
+            uint8_t *out = (uint8_t *)dst;
+            if (_chw)
+            {
+                for (int k = 0; k < c; ++k)
+                    memcpy(out + k * hw + y * _width, planes[k], _width);
+            }
+            else
+            {
+                out += y * _width * c;
+                for (int i = 0; i < _width; ++i)
+                    for (int k = 0; k < c; ++k)
+                        out[i * c + k] = planes[k][i];
+            }
+        }
+        else // INT8
+        {
+            int8_t *out = (int8_t *)dst;
+            for (int k = 0; k < c; ++k)
+            {
+                for (int i = 0; i < _width; ++i)
+                {
+                    int v = (int)lroundf(planes[k][i] * _a[k] + _b[k]);
+                    v = v < -128 ? -128 : (v > 127 ? 127 : v);
+                    if (_chw)
+                        out[k * hw + y * _width + i] = (int8_t)v;
+                    else
+                        out[(y * _width + i) * c + k] = (int8_t)v;
+                }
+            }
+        }
+    }
+
+    err::Err ImagePreprocess::run(image::Image &img, void *dst, image::Fit fit)
+    {
+        image::Format src_fmt = img.format();
+        int src_w = img.width();
+        int src_h = img.height();
+        switch (src_fmt)
+        {
+        case image::FMT_YVU420SP:
+        case image::FMT_RGB888:
+        case image::FMT_BGR888:
+        case image::FMT_RGBA8888:
+        case image::FMT_BGRA8888:
+        case image::FMT_GRAYSCALE:
+            break;
+        default:
+            log::error("preprocess not support image format %s", image::fmt_names[src_fmt].c_str());
+            return err::ERR_ARGS;
+        }
+        _update_map(src_w, src_h, fit);
+        int dst_mode = _format == image::FMT_GRAYSCALE ? _DST_GRAY : (_format == image::FMT_BGR888 ? _DST_BGR : _DST_RGB);
+
+        // select row sampler once, not per pixel
+        typedef void (*packed_sampler_t)(const uint16_t *, const int *, const int *, const uint16_t *, int, uint8_t **, int);
+        packed_sampler_t packed = nullptr;
+        bool nv21 = src_fmt == image::FMT_YVU420SP;
+        int src_c = 1;
+        switch (src_fmt)
+        {
+        case image::FMT_RGB888:
+            src_c = 3;
+            packed = _sample_row_packed<3, false>;
+            break;
+        case image::FMT_BGR888:
+            src_c = 3;
+            packed = _sample_row_packed<3, true>;
+            break;
+        case image::FMT_RGBA8888:
+            src_c = 4;
+            packed = _sample_row_packed<4, false>;
+            break;
+        case image::FMT_BGRA8888:
+            src_c = 4;
+            packed = _sample_row_packed<4, true>;
+            break;
+        default: // gray and Y plane of NV21
+            packed = _sample_row_packed<1, false>;
+            break;
+        }
+        bool src_gray = src_fmt == image::FMT_GRAYSCALE || (nv21 && dst_mode == _DST_GRAY);
+
+        // row planes: 0~2 are r, g, b(or gray/Y in plane 0), 3 is gray of colorful source or Y of NV21,
+        // output planes point to them, so gray to RGB and RGB to BGR need no copy.
+        int out_idx[3] = {0, 1, 2};
+        if (dst_mode == _DST_GRAY)
+            out_idx[0] = src_gray ? 0 : 3;
+        else if (src_gray)
+            out_idx[0] = out_idx[1] = out_idx[2] = 0;
+        else if (dst_mode == _DST_BGR)
+            std::swap(out_idx[0], out_idx[2]);
+
+        const uint8_t *src = (const uint8_t *)img.data();
+        const uint8_t *src_vu = src + src_w * src_h;
+        int src_stride = src_w * src_c;
+        const AxisMap &xm = _xmap;
+        const AxisMap &ym = _ymap;
+        int c = _channels;
+
+        #pragma omp parallel
+        {
+            // per thread row buffers, border pixels keep 0(black)
+            std::vector<uint8_t> row_buf(4 * _width, 0);
+            std::vector<uint16_t> blend_buf(xm.count * src_c);
+            std::vector<uint8_t> uv_buf(nv21 ? 2 * xm.len : 0);
+            uint8_t *planes[4];
+            for (int k = 0; k < 4; ++k)
+                planes[k] = row_buf.data() + k * _width;
+            uint8_t *out_planes[3] = {planes[out_idx[0]], planes[out_idx[1]], planes[out_idx[2]]};
+
+            #pragma omp for schedule(static)
+            for (int y = 0; y < _height; ++y)
+            {
+                int iy = y - ym.start;
+                if (iy < 0 || iy >= ym.len)
+                {
+                    for (int k = 0; k < c; ++k)
+                        memset(out_planes[k] + xm.start, 0, xm.len);
+                    _write_row(out_planes, dst, y);
+                    continue;
+                }
+                int sy0 = ym.first + ym.i0[iy];
+                int sy1 = ym.first + ym.i1[iy];
+                _blend_rows(src + sy0 * src_stride + xm.first * src_c, src + sy1 * src_stride + xm.first * src_c, ym.w[iy],
+                            blend_buf.data(), xm.count * src_c);
+                if (nv21 && !src_gray)
+                {
+                    // Y is bilinear(or nearest), VU is nearest
+                    packed(blend_buf.data(), xm.i0.data(), xm.i1.data(), xm.w.data(), xm.len, planes + 3, xm.start);
+                    const uint8_t *vu = src_vu + (sy0 >> 1) * src_w;
+                    uint8_t *u = uv_buf.data();
+                    uint8_t *v = u + xm.len;
+                    for (int i = 0; i < xm.len; ++i)
+                    {
+                        const uint8_t *p = vu + ((xm.first + xm.i0[i]) & ~1);
+                        v[i] = p[0];
+                        u[i] = p[1];
+                    }
+                    _yuv_to_rgb_row(planes[3] + xm.start, u, v, planes[0] + xm.start, planes[1] + xm.start, planes[2] + xm.start, xm.len);
+                }
+                else
+                {
+                    packed(blend_buf.data(), xm.i0.data(), xm.i1.data(), xm.w.data(), xm.len, planes, xm.start);
+                }
+                if (out_idx[0] == 3 && !nv21)
+                {
+                    _rgb_to_gray_row(planes[0] + xm.start, planes[1] + xm.start, planes[2] + xm.start, planes[3] + xm.start, xm.len);
+                }
+                _write_row(out_planes, dst, y);
+            }
+        }
+        return err::ERR_NONE;
+    }
+
+} // namespace maix::nn
@@ -0,0 +1,283 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Create this file, add two stage ROI pipeline.
+ */
+
+#include "maix_nn_roi_pipeline.hpp"
+#include <opencv2/opencv.hpp>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+namespace maix::nn
+{
+    static int _cv_type(image::Format format)
+    {
+        switch (format)
+        {
+        case image::FMT_GRAYSCALE:
+            return CV_8UC1;
+        case image::FMT_RGB888:
+        case image::FMT_BGR888:
+            return CV_8UC3;
+        case image::FMT_RGBA8888:
+        case image::FMT_BGRA8888:
+            return CV_8UC4;
+        default:
+            return -1;
+        }
+    }
+
+    ROIPipeline::ROIPipeline(nn::NN *model, image::Format format, const std::vector<float> &mean, const std::vector<float> &scale)
+        : _model(model), _format(format), _mean(mean), _scale(scale), _scratch(nullptr), _preprocess(nullptr)
+    {
+        if (format != image::FMT_RGB888 && format != image::FMT_BGR888 && format != image::FMT_GRAYSCALE)
+        {
+            throw err::Exception(err::ERR_ARGS, "ROIPipeline format not support: " + image::fmt_names[format]);
+        }
+        std::vector<nn::LayerInfo> inputs = model->inputs_info();
+        if (inputs.empty() || inputs[0].shape.size() != 4)
+        {
+            throw err::Exception(err::ERR_ARGS, "ROIPipeline model input is not image");
+        }
+        nn::LayerInfo &info = inputs[0];
+        bool chw = info.layout != nn::Layout::NHWC;
+        _width = chw ? info.shape[3] : info.shape[2];
+        _height = chw ? info.shape[2] : info.shape[1];
+        _input_name = info.name;
+        _input_shape = info.shape;
+        _input_dtype = info.dtype;
+        _slot_bytes = (size_t)info.shape[1] * info.shape[2] * info.shape[3] * tensor::dtype_size[info.dtype];
+
+        // static batch of model, or max batch of dynamic batch model from MUD
+        _batch = info.shape[0];
+        _static_batch = _batch > 1;
+        if (!_static_batch)
+        {
+            std::map<std::string, std::string> extra = model->extra_info();
+            auto it = extra.find("batch");
+            _batch = it == extra.end() ? 1 : atoi(it->second.c_str());
+            if (_batch < 1)
+                _batch = 1;
+        }
+
+        if (_batch == 1)
+        {
+            for (auto &s : _stages)
+                s.img = new image::Image(_width, _height, _format);
+        }
+        else
+        {
+            for (auto &s : _stages)
+                s.buf.resize(_slot_bytes * _batch);
+            _scratch = new image::Image(_width, _height, _format);
+            _preprocess = new ImagePreprocess(_width, _height, _format, _input_dtype, chw, _mean, _scale);
+        }
+    }
+
+    ROIPipeline::~ROIPipeline()
+    {
+        for (auto &s : _stages)
+        {
+            delete s.img;
+            s.img = nullptr;
+        }
+        delete _scratch;
+        delete _preprocess;
+    }
+
+    void ROIPipeline::set_norm(const std::vector<float> &mean, const std::vector<float> &scale)
+    {
+        _mean = mean;
+        _scale = scale;
+        if (_preprocess)
+            _preprocess->set_norm(mean, scale);
+    }
+
+    void ROIPipeline::warp_affine(image::Image &src, image::Image &dst, const double M[6], image::ResizeMethod method)
+    {
+        int type = _cv_type(src.format());
+        if (type < 0 || src.format() != dst.format())
+        {
+            throw err::Exception(err::ERR_ARGS, "warp_affine format not support, src: " + image::fmt_names[src.format()] + ", dst: " + image::fmt_names[dst.format()]);
+        }
+        cv::Mat img_src(src.height(), src.width(), type, src.data());
+        cv::Mat img_dst(dst.height(), dst.width(), type, dst.data());
+        cv::Mat m(2, 3, CV_64F, (void *)M);
+        int flags = method == image::ResizeMethod::NEAREST ? cv::INTER_NEAREST : cv::INTER_LINEAR;
+        cv::warpAffine(img_src, img_dst, m, img_dst.size(), flags);
+    }
+
+    void ROIPipeline::warp_points(image::Image &src, image::Image &dst, const std::vector<int> &src_points, const std::vector<int> &dst_points, image::ResizeMethod method)
+    {
+        if (src_points.size() < 6 || dst_points.size() < 6)
+        {
+            throw err::Exception(err::ERR_ARGS, "warp_points need 3 points");
+        }
+        cv::Point2f src_tri[3];
+        cv::Point2f dst_tri[3];
+        for (int i = 0; i < 3; i++)
+        {
+            src_tri[i] = cv::Point2f(src_points[i * 2], src_points[i * 2 + 1]);
+            dst_tri[i] = cv::Point2f(dst_points[i * 2], dst_points[i * 2 + 1]);
+        }
+        cv::Mat m = cv::getAffineTransform(src_tri, dst_tri);
+        warp_affine(src, dst, (const double *)m.data, method);
+    }
+
+    void ROIPipeline::_fill(Stage &stage, int start, int num, const PrepareFunc &prepare)
+    {
+        stage.idx.clear();
+        for (int i = start; i < start + num; ++i)
+        {
+            image::Image &dst = _batch == 1 ? *stage.img : *_scratch;
+            if (prepare(i, dst) != err::ERR_NONE)
+                continue;
+            if (_batch > 1)
+            {
+                uint8_t *slot = stage.buf.data() + _slot_bytes * stage.idx.size();
+                err::Err e = _preprocess->run(dst, slot, image::Fit::FIT_FILL);
+                if (e != err::ERR_NONE)
+                    throw err::Exception(e, "ROIPipeline preprocess failed");
+            }
+            stage.idx.push_back(i);
+        }
+    }
+
+    err::Err ROIPipeline::_forward(Stage &stage, const CollectFunc &collect)
+    {
+        if (stage.idx.empty())
+            return err::ERR_NONE;
+        if (_batch == 1)
+        {
+            tensor::Tensors *outputs = _model->forward_image(*stage.img, _mean, _scale, image::Fit::FIT_FILL, false, true);
+            if (!outputs)
+                return err::ERR_NOT_READY;
+            collect(stage.idx[0], *outputs);
+            delete outputs;
+            return err::ERR_NONE;
+        }
+
+        // static batch model always forward all slots, unused slots keep last data
+        int slots = _static_batch ? _batch : (int)stage.idx.size();
+        std::vector<int> shape = _input_shape;
+        shape[0] = slots;
+        tensor::Tensor input(shape, _input_dtype, stage.buf.data(), false);
+        tensor::Tensors inputs;
+        inputs.add_tensor(_input_name, &input, false, false);
+        tensor::Tensors outputs;
+        err::Err e = _model->forward(inputs, outputs, false, true);
+        if (e != err::ERR_NONE)
+            return e;
+
+        std::vector<std::string> keys = outputs.keys();
+        for (size_t b = 0; b < stage.idx.size(); ++b)
+        {
+            // split outputs to every ROI without copy
+            tensor::Tensors one;
+            for (auto &key : keys)
+            {
+                tensor::Tensor &t = outputs[key];
+                std::vector<int> out_shape = t.shape();
+                if (out_shape.empty() || out_shape[0] != slots)
+                {
+                    log::error("ROIPipeline output %s batch %d not match input batch %d", key.c_str(), out_shape.empty() ? 0 : out_shape[0], slots);
+                    return err::ERR_RUNTIME;
+                }
+                size_t bytes = (size_t)t.size_int() / slots * tensor::dtype_size[t.dtype()];
+                out_shape[0] = 1;
+                one.add_tensor(key, new tensor::Tensor(out_shape, t.dtype(), (uint8_t *)t.data() + bytes * b, false), false, true);
+            }
+            collect(stage.idx[b], one);
+        }
+        return err::ERR_NONE;
+    }
+
+    err::Err ROIPipeline::run(int num, const PrepareFunc &prepare, const CollectFunc &collect)
+    {
+        if (num <= 0)
+            return err::ERR_NONE;
+        if (num <= _batch)
+        {
+            _fill(_stages[0], 0, num, prepare);
+            return _forward(_stages[0], collect);
+        }
+
+        // worker fills stage k while stage k - 1 is forwarding, stage k reuses buffers of stage k - 2
+        int stages_num = (num + _batch - 1) / _batch;
+        std::mutex mutex;
+        std::condition_variable cond;
+        int filled = 0;
+        int consumed = 0;
+        bool stop = false;
+        std::exception_ptr worker_err;
+        std::thread worker([&]() {
+            for (int k = 0; k < stages_num; ++k)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    cond.wait(lock, [&]() { return stop || k - consumed < 2; });
+                    if (stop)
+                        return;
+                }
+                try
+                {
+                    _fill(_stages[k % 2], k * _batch, std::min(_batch, num - k * _batch), prepare);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    worker_err = std::current_exception();
+                    cond.notify_all();
+                    return;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    filled = k + 1;
+                }
+                cond.notify_all();
+            }
+        });
+
+        err::Err e = err::ERR_NONE;
+        std::exception_ptr collect_err;
+        for (int k = 0; k < stages_num; ++k)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cond.wait(lock, [&]() { return filled > k || worker_err; });
+                if (filled <= k)
+                    break;
+            }
+            try
+            {
+                e = _forward(_stages[k % 2], collect);
+            }
+            catch (...)
+            {
+                collect_err = std::current_exception();
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                consumed = k + 1;
+            }
+            cond.notify_all();
+            if (e != err::ERR_NONE || collect_err)
+                break;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        cond.notify_all();
+        worker.join();
+        if (collect_err)
+            std::rethrow_exception(collect_err);
+        if (worker_err)
+            std::rethrow_exception(worker_err);
+        return e;
+    }
+} // namespace maix::nn
@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Add Transaction to submit many messages with one ioctl, add read to caller buffer APIs.
  */
 
 #pragma once
@@ -40,6 +41,100 @@ namespace maix::peripheral::i2c
      */
     std::vector<int> list_devices();
 
+    /**
+     * I2C transaction, a batch of read and write messages, can be across devices on the same bus.
+     * All messages are submitted by I2C.transfer with one I2C_RDWR ioctl, that is one syscall and one combined transfer on the bus,
+     * repeated start between messages and stop only at the end, so other users of the bus can't insert messages between them.
+     * Register address and write data are copied into transaction, read data is stored to caller provided buffers directly,
+     * so a transaction can be built once and transferred repeatedly in polling loop without any memory allocation.
+     * Note: some devices only commit a write after a stop condition(e.g. EEPROM write cycle), transfer this kind of write alone.
+     * @maixcdk maix.peripheral.i2c.Transaction
+     */
+    class Transaction
+    {
+    public:
+        /**
+         * @brief Transaction constructor
+         * @param[in] reserve messages number to reserve memory for.
+         * @maixcdk maix.peripheral.i2c.Transaction.Transaction
+         */
+        Transaction(int reserve = 8);
+
+        /**
+         * @brief remove all messages, memory is kept for reuse.
+         * @maixcdk maix.peripheral.i2c.Transaction.clear
+         */
+        void clear();
+
+        /**
+         * @brief messages number
+         * @maixcdk maix.peripheral.i2c.Transaction.size
+         */
+        int size() { return (int)_msgs.size(); }
+
+        /**
+         * @brief append write message
+         * @param[in] addr i2c slave address, int type
+         * @param[in] data data to write, copied.
+         * @param[in] len data length to write, int type
+         * @return err::ERR_NONE if success, else err::ERR_ARGS.
+         * @maixcdk maix.peripheral.i2c.Transaction.write
+         */
+        err::Err write(int addr, const uint8_t *data, int len);
+
+        /**
+         * @brief append write message of memory address followed by data
+         * @param[in] addr i2c slave address, int type
+         * @param[in] mem_addr memory address want to write, int type.
+         * @param[in] data data to write, copied.
+         * @param[in] len data length to write, int type
+         * @param[in] mem_addr_size memory address size, default is 8.
+         * @param[in] mem_addr_le memory address little endian, default is false, that is send high byte first.
+         * @return err::ERR_NONE if success, else err::ERR_ARGS.
+         * @maixcdk maix.peripheral.i2c.Transaction.write_mem
+         */
+        err::Err write_mem(int addr, int mem_addr, const uint8_t *data, int len, int mem_addr_size = 8, bool mem_addr_le = false);
+
+        /**
+         * @brief append read message
+         * @param[in] addr i2c slave address, int type
+         * @param[out] buf buffer to store read data, must be valid until transfer finished, at least len bytes.
+         * @param[in] len data length to read, int type, max 65535.
+         * @return err::ERR_NONE if success, else err::ERR_ARGS.
+         * @maixcdk maix.peripheral.i2c.Transaction.read
+         */
+        err::Err read(int addr, uint8_t *buf, int len);
+
+        /**
+         * @brief append write memory address and read messages
+         * @param[in] addr i2c slave address, int type
+         * @param[in] mem_addr memory address want to read, int type.
+         * @param[out] buf buffer to store read data, must be valid until transfer finished, at least len bytes.
+         * @param[in] len data length to read, int type, max 65535.
+         * @param[in] mem_addr_size memory address size, default is 8.
+         * @param[in] mem_addr_le memory address little endian, default is false, that is send high byte first.
+         * @return err::ERR_NONE if success, else err::ERR_ARGS.
+         * @maixcdk maix.peripheral.i2c.Transaction.read_mem
+         */
+        err::Err read_mem(int addr, int mem_addr, uint8_t *buf, int len, int mem_addr_size = 8, bool mem_addr_le = false);
+
+    private:
+        class Msg
+        {
+        public:
+            uint16_t addr;
+            bool read;
+            bool chained;   // must be in the same ioctl with previous message
+            int len;
+            uint8_t *buf;   // read buffer
+            size_t offset;  // write data offset in _wbuf
+        };
+        std::vector<Msg> _msgs;
+        std::vector<uint8_t> _wbuf;
+
+        friend class I2C;
+    };
+
     /**
      * Peripheral i2c class
      * @maixpy maix.peripheral.i2c.I2C
@@ -115,6 +210,16 @@ namespace maix::peripheral::i2c
          */
         Bytes* readfrom(int addr, int len);
 
+        /**
+         * @brief read data from i2c slave to buffer, no memory allocation
+         * @param[in] addr i2c slave address, int type
+         * @param[out] data buffer to store read data, at least len bytes.
+         * @param[in] len data length to read, int type
+         * @return if success, return the length of read data, error occurred will return -err::Err.
+         * @maixcdk maix.peripheral.i2c.I2C.readfrom
+         */
+        int readfrom(int addr, uint8_t *data, int len);
+
         /**
          * @brief write data to i2c slave's memory address
          * @param[in] addr i2c slave address, int type
@@ -165,6 +270,28 @@ namespace maix::peripheral::i2c
          */
         Bytes* readfrom_mem(int addr, int mem_addr, int len, int mem_addr_size = 8, bool mem_addr_le = false);
 
+        /**
+         * @brief read data from i2c slave's memory address to buffer, one I2C_RDWR ioctl and no memory allocation
+         * @param[in] addr i2c slave address, int type
+         * @param[in] mem_addr memory address want to read, int type.
+         * @param[out] data buffer to store read data, at least len bytes.
+         * @param[in] len data length to read, int type
+         * @param[in] mem_addr_size memory address size, default is 8.
+         * @param[in] mem_addr_le memory address little endian, default is false, that is send high byte first.
+         * @return if success, return the length of read data, error occurred will return -err::Err.
+         * @maixcdk maix.peripheral.i2c.I2C.readfrom_mem
+         */
+        int readfrom_mem(int addr, int mem_addr, uint8_t *data, int len, int mem_addr_size = 8, bool mem_addr_le = false);
+
+        /**
+         * @brief submit all messages of transaction with one I2C_RDWR ioctl,
+         * if messages number exceed kernel limit(42), they are split to several ioctls, write memory address and its read are never split.
+         * @param[in] t transaction, not changed, can be transferred again.
+         * @return err::ERR_NONE if all messages success, else error code.
+         * @maixcdk maix.peripheral.i2c.I2C.transfer
+         */
+        err::Err transfer(Transaction &t);
+
     private:
         int _fd;
         int _freq;
@@ -153,11 +153,20 @@ namespace maix::peripheral::uart
         err::Err close();
 
         /**
-         * Set received callback function
-         * @param callback function to call when received data
+         * Set received callback function.
+         * Data is read by a receive thread into a lock-free ring buffer as soon as it arrives,
+         * and callback is called in another thread with batched data, so slow callback will not block receiving.
+         * If ring buffer is full, new data will be dropped with a warning log.
+         * @param callback function to call when received data, data is only valid during callback,
+         *                 set to None(nullptr) to stop receiving.
+         * @param delimiter frame end byte, 0~255, callback will be called with data end with this byte(included), -1 means not use delimiter.
+         * @param idle_gap_us bus idle time between frames, unit us, callback will be called when no new data received in this time.
+         *                    0 means auto, about 30 bytes transfer time(max 50ms), -1 means not use idle gap,
+         *                    if both delimiter and idle_gap_us are -1, callback will be called with all received data as soon as possible.
+         * @param buff_size receive ring buffer size, will be rounded up to power of 2, default 64KiB.
          * @maixpy maix.peripheral.uart.UART.set_received_callback
          */
-        void set_received_callback(std::function<void(uart::UART&, Bytes&)> callback);
+        void set_received_callback(std::function<void(uart::UART&, Bytes&)> callback, int delimiter = -1, int idle_gap_us = 0, int buff_size = 65536);
 
         /**
          * Send data to device
@@ -257,6 +266,13 @@ namespace maix::peripheral::uart
         */
         Bytes *readline(int timeout = -1);
 
+        /**
+         * Get uart device file descriptor, used to wait data with poll/epoll.
+         * @return file descriptor, -1 if not open.
+         * @maixcdk maix.peripheral.uart.UART.fd
+         */
+        int fd() { return _fd; }
+
     private:
         int _fd;
         std::string      _uart_port;
@@ -267,9 +283,12 @@ namespace maix::peripheral::uart
         uart::FLOW_CTRL  _flow_ctrl;
         int         _one_byte_time_us;
         std::function<void(uart::UART&, Bytes&)> callback;
-        thread::Thread *_read_thread;
-        bool        _read_thread_need_exit;
-        bool        _read_thread_exit;
+        int         _rx_delimiter;
+        int         _rx_idle_gap_us;
+        int         _rx_buff_size;
+        void       *_rx;
+        err::Err    _rx_start();
+        void        _rx_stop();
     };
 
     err::Err register_comm_callback(uart::UART *obj, std::function<void(uart::UART*)> callback);
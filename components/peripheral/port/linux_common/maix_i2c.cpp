@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Add Transaction and I2C.transfer, read to caller buffer APIs.
  */
 
 
@@ -15,9 +16,14 @@
 #include <linux/i2c.h>
 #include <sys/ioctl.h>
 #include <algorithm>
+#include <string.h>
 
 #define DEV_PATH "/dev/i2c-%d"
 
+#ifndef I2C_RDWR_IOCTL_MAX_MSGS
+#define I2C_RDWR_IOCTL_MAX_MSGS 42
+#endif
+
 namespace maix::peripheral::i2c
 {
 
@@ -45,6 +51,85 @@ namespace maix::peripheral::i2c
         return data;
     }
 
+    // encode memory address to bytes, return bytes number, -1 if mem_addr_size invalid
+    static int _mem_addr_bytes(int mem_addr, int mem_addr_size, bool mem_addr_le, uint8_t *out)
+    {
+        if (mem_addr_size <= 0 || mem_addr_size > 32 || mem_addr_size % 8 != 0)
+            return -1;
+        int n = mem_addr_size / 8;
+        for (int i = 0; i < n; i++)
+        {
+            int shift = mem_addr_le ? 8 * i : 8 * (n - i - 1);
+            out[i] = (uint8_t)((unsigned int)mem_addr >> shift);
+        }
+        return n;
+    }
+
+    Transaction::Transaction(int reserve)
+    {
+        _msgs.reserve(reserve);
+        _wbuf.reserve(reserve * 4);
+    }
+
+    void Transaction::clear()
+    {
+        _msgs.clear();
+        _wbuf.clear();
+    }
+
+    err::Err Transaction::write(int addr, const uint8_t *data, int len)
+    {
+        if (len < 0 || len > 0xffff || (len > 0 && !data))
+        {
+            log::error("i2c transaction write len %d invalid", len);
+            return err::ERR_ARGS;
+        }
+        _msgs.push_back({(uint16_t)addr, false, false, len, nullptr, _wbuf.size()});
+        _wbuf.insert(_wbuf.end(), data, data + len);
+        return err::ERR_NONE;
+    }
+
+    err::Err Transaction::write_mem(int addr, int mem_addr, const uint8_t *data, int len, int mem_addr_size, bool mem_addr_le)
+    {
+        uint8_t mem[4];
+        int n = _mem_addr_bytes(mem_addr, mem_addr_size, mem_addr_le, mem);
+        if (n < 0 || len < 0 || n + len > 0xffff || (len > 0 && !data))
+        {
+            log::error("i2c transaction write_mem args invalid, mem_addr_size: %d, len: %d", mem_addr_size, len);
+            return err::ERR_ARGS;
+        }
+        _msgs.push_back({(uint16_t)addr, false, false, n + len, nullptr, _wbuf.size()});
+        _wbuf.insert(_wbuf.end(), mem, mem + n);
+        _wbuf.insert(_wbuf.end(), data, data + len);
+        return err::ERR_NONE;
+    }
+
+    err::Err Transaction::read(int addr, uint8_t *buf, int len)
+    {
+        if (len <= 0 || len > 0xffff || !buf)
+        {
+            log::error("i2c transaction read len %d invalid", len);
+            return err::ERR_ARGS;
+        }
+        _msgs.push_back({(uint16_t)addr, true, false, len, buf, 0});
+        return err::ERR_NONE;
+    }
+
+    err::Err Transaction::read_mem(int addr, int mem_addr, uint8_t *buf, int len, int mem_addr_size, bool mem_addr_le)
+    {
+        uint8_t mem[4];
+        int n = _mem_addr_bytes(mem_addr, mem_addr_size, mem_addr_le, mem);
+        if (n < 0 || len <= 0 || len > 0xffff || !buf)
+        {
+            log::error("i2c transaction read_mem args invalid, mem_addr_size: %d, len: %d", mem_addr_size, len);
+            return err::ERR_ARGS;
+        }
+        _msgs.push_back({(uint16_t)addr, false, false, n, nullptr, _wbuf.size()});
+        _wbuf.insert(_wbuf.end(), mem, mem + n);
+        _msgs.push_back({(uint16_t)addr, true, true, len, buf, 0});
+        return err::ERR_NONE;
+    }
+
     I2C::I2C(int id, i2c::Mode mode, int freq, i2c::AddrSize addr_size)
     {
         char buf[32];
@@ -178,60 +263,83 @@ namespace maix::peripheral::i2c
         return data;
     }
 
-    int I2C::writeto_mem(int addr, int mem_addr, const uint8_t *data, int len, int mem_addr_size, bool mem_addr_le)
+    int I2C::readfrom(int addr, uint8_t *data, int len)
     {
         if (_mode != i2c::Mode::MASTER)
         {
             log::error("Only for master mode");
             return (int)-err::Err::ERR_NOT_PERMIT;
         }
-        if(mem_addr_size % 8 != 0)
+        if (len <= 0 || len > 0xffff || !data)
         {
-            log::error("mem_addr_size must be multiple of 8");
-            return (int)-err::Err::ERR_IO;
+            log::error("read len %d invalid", len);
+            return (int)-err::Err::ERR_ARGS;
         }
 
-        if (0 != ioctl(_fd, I2C_SLAVE, addr))
+        struct i2c_msg msg;
+        msg.addr = addr;
+        msg.flags = I2C_M_RD;
+        msg.len = len;
+        msg.buf = data;
+
+        struct i2c_rdwr_ioctl_data msgset;
+        msgset.msgs = &msg;
+        msgset.nmsgs = 1;
+        if (ioctl(_fd, I2C_RDWR, &msgset) != 1)
         {
-            log::error("set slave address failed");
+            log::error("read failed");
             return (int)-err::Err::ERR_IO;
         }
+        return len;
+    }
 
-        std::vector<unsigned char> data_final;
-
-        if(mem_addr_size == 8)
+    int I2C::writeto_mem(int addr, int mem_addr, const uint8_t *data, int len, int mem_addr_size, bool mem_addr_le)
+    {
+        if (_mode != i2c::Mode::MASTER)
         {
-            data_final.push_back((unsigned char)mem_addr);
+            log::error("Only for master mode");
+            return (int)-err::Err::ERR_NOT_PERMIT;
         }
-        else
+        uint8_t mem[4];
+        int n = _mem_addr_bytes(mem_addr, mem_addr_size, mem_addr_le, mem);
+        if (n < 0)
         {
-            if(mem_addr_le)
-            {
-                for(int i = 0; i < mem_addr_size / 8; i++)
-                {
-                    data_final.push_back((unsigned char)(mem_addr & 0xff));
-                    mem_addr >>= 8;
-                }
-            }
-            else
-            {
-                for(int i = 0; i < mem_addr_size / 8; i++)
-                {
-                    data_final.push_back((unsigned char)(mem_addr >> (8 * (mem_addr_size / 8 - i - 1))));
-                }
-            }
+            log::error("mem_addr_size must be multiple of 8");
+            return (int)-err::Err::ERR_IO;
         }
-        for(int i = 0; i < len; i++)
+        if (len < 0 || n + len > 0xffff || (len > 0 && !data))
         {
-            data_final.push_back(data[i]);
+            log::error("write len %d invalid", len);
+            return (int)-err::Err::ERR_ARGS;
         }
-        int write_len = ::write(_fd, data_final.data(), data_final.size());
-        if (data_final.size() != (size_t)write_len)
+
+        // mem_addr and data in one message, small register writes use stack buffer
+        uint8_t stack_buf[64];
+        std::vector<uint8_t> heap_buf;
+        uint8_t *buf = stack_buf;
+        if (n + len > (int)sizeof(stack_buf))
         {
-            log::error("write failed, write_len: %d", write_len);
-            return (int)-err::Err::ERR_IO;
+            heap_buf.resize(n + len);
+            buf = heap_buf.data();
         }
+        memcpy(buf, mem, n);
+        if (len > 0)
+            memcpy(buf + n, data, len);
+
+        struct i2c_msg msg;
+        msg.addr = addr;
+        msg.flags = 0;
+        msg.len = n + len;
+        msg.buf = buf;
 
+        struct i2c_rdwr_ioctl_data msgset;
+        msgset.msgs = &msg;
+        msgset.nmsgs = 1;
+        if (ioctl(_fd, I2C_RDWR, &msgset) != 1)
+        {
+            log::error("write failed");
+            return (int)-err::Err::ERR_IO;
+        }
         return len;
     }
 
@@ -317,4 +425,86 @@ namespace maix::peripheral::i2c
 
         return data;
     }
+
+    int I2C::readfrom_mem(int addr, int mem_addr, uint8_t *data, int len, int mem_addr_size, bool mem_addr_le)
+    {
+        if (_mode != i2c::Mode::MASTER)
+        {
+            log::error("Only for master mode");
+            return (int)-err::Err::ERR_NOT_PERMIT;
+        }
+        uint8_t mem[4];
+        int n = _mem_addr_bytes(mem_addr, mem_addr_size, mem_addr_le, mem);
+        if (n < 0)
+        {
+            log::error("mem_addr_size must be multiple of 8");
+            return (int)-err::Err::ERR_ARGS;
+        }
+        if (len <= 0 || len > 0xffff || !data)
+        {
+            log::error("read len %d invalid", len);
+            return (int)-err::Err::ERR_ARGS;
+        }
+
+        struct i2c_msg msgs[2];
+        msgs[0].addr = addr;
+        msgs[0].flags = 0;
+        msgs[0].len = n;
+        msgs[0].buf = mem;
+        msgs[1].addr = addr;
+        msgs[1].flags = I2C_M_RD;
+        msgs[1].len = len;
+        msgs[1].buf = data;
+
+        struct i2c_rdwr_ioctl_data msgset;
+        msgset.msgs = msgs;
+        msgset.nmsgs = 2;
+        if (ioctl(_fd, I2C_RDWR, &msgset) != 2)
+        {
+            log::error("read failed");
+            return (int)-err::Err::ERR_IO;
+        }
+        return len;
+    }
+
+    err::Err I2C::transfer(Transaction &t)
+    {
+        if (_mode != i2c::Mode::MASTER)
+        {
+            log::error("Only for master mode");
+            return err::Err::ERR_NOT_PERMIT;
+        }
+
+        // write buffer pointers are resolved here, _wbuf may be reallocated when building transaction
+        struct i2c_msg msgs[I2C_RDWR_IOCTL_MAX_MSGS];
+        size_t total = t._msgs.size();
+        size_t i = 0;
+        while (i < total)
+        {
+            // fill one ioctl, chained messages are moved to next ioctl together with their previous message
+            size_t n = std::min(total - i, (size_t)I2C_RDWR_IOCTL_MAX_MSGS);
+            while (i + n < total && n > 1 && t._msgs[i + n].chained)
+                --n;
+            for (size_t k = 0; k < n; ++k)
+            {
+                Transaction::Msg &m = t._msgs[i + k];
+                msgs[k].addr = m.addr;
+                msgs[k].flags = m.read ? I2C_M_RD : 0;
+                msgs[k].len = (uint16_t)m.len;
+                msgs[k].buf = m.read ? m.buf : t._wbuf.data() + m.offset;
+            }
+
+            struct i2c_rdwr_ioctl_data msgset;
+            msgset.msgs = msgs;
+            msgset.nmsgs = n;
+            int ret = ioctl(_fd, I2C_RDWR, &msgset);
+            if (ret != (int)n)
+            {
+                log::error("transfer failed, message %d ~ %d, ret: %d", (int)i, (int)(i + n - 1), ret);
+                return err::Err::ERR_IO;
+            }
+            i += n;
+        }
+        return err::Err::ERR_NONE;
+    }
 }
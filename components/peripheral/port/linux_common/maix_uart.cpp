@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Wait data with ppoll instead of sleep polling, add ring buffer receive thread with framing for callback.
  */
 
 #include "maix_uart.hpp"
@@ -20,6 +21,10 @@
 #include <sys/ioctl.h>
 #include <sys/select.h>
 #include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <atomic>
+#include <thread>
 #include "maix_uart_port.hpp"
 
 namespace maix::peripheral::uart
@@ -225,6 +230,299 @@ namespace maix::peripheral::uart
 		return bytes_written;
 	}
 
+	/**
+	 * Wait fd readable
+	 * @param timeout_us -1 means wait forever
+	 * @return > 0 readable, 0 timeout, < 0 error(-errno)
+	 */
+	static int _uart_wait(int fd, int64_t timeout_us)
+	{
+		struct pollfd pfd = {fd, POLLIN, 0};
+		timespec ts;
+		timespec *p_ts = NULL;
+		if (timeout_us >= 0)
+		{
+			ts.tv_sec = timeout_us / 1000000;
+			ts.tv_nsec = (timeout_us % 1000000) * 1000;
+			p_ts = &ts;
+		}
+		int ret = ppoll(&pfd, 1, p_ts, NULL);
+		if (ret < 0)
+			return -errno;
+		return ret;
+	}
+
+	/**
+	 * Receive engine for callback mode.
+	 * rx thread read uart into SPSC ring buffer and record idle gap positions,
+	 * callback thread split frames from ring buffer and call user callback.
+	 */
+	class _UART_Rx
+	{
+	public:
+		uint8_t *ring = nullptr;
+		uint32_t size = 0;             // power of 2
+		std::atomic<uint64_t> head{0}; // write position, only rx thread update
+		std::atomic<uint64_t> tail{0}; // read position, only callback thread update
+
+		// idle gap positions, SPSC queue too
+		static const uint32_t GAP_NUM = 256;
+		uint64_t gaps[GAP_NUM];
+		std::atomic<uint32_t> gap_head{0};
+		std::atomic<uint32_t> gap_tail{0};
+
+		int exit_fd = -1; // notify rx thread exit
+		int data_fd = -1; // notify callback thread data ready or exit
+		std::atomic<bool> exit{false};
+		bool detached = false; // stopped in callback, callback thread free this object on exit
+		uint64_t dropped = 0;
+		std::thread rx_th;
+		std::thread cb_th;
+		std::vector<uint8_t> scratch; // for frame wrap around ring end
+
+		_UART_Rx(int buff_size)
+		{
+			size = 1024;
+			while ((int)size < buff_size)
+				size <<= 1;
+			ring = new uint8_t[size];
+			exit_fd = eventfd(0, EFD_CLOEXEC);
+			data_fd = eventfd(0, EFD_CLOEXEC);
+		}
+
+		~_UART_Rx()
+		{
+			if (exit_fd >= 0)
+				::close(exit_fd);
+			if (data_fd >= 0)
+				::close(data_fd);
+			delete[] ring;
+		}
+
+		static void notify(int fd)
+		{
+			uint64_t v = 1;
+			if (::write(fd, &v, sizeof(v)) < 0)
+				log::warn("uart notify failed: %d", errno);
+		}
+	};
+
+	static void _uart_rx_loop(int fd, _UART_Rx *rx, int64_t idle_gap_us)
+	{
+		struct pollfd pfds[2] = {{fd, POLLIN, 0}, {rx->exit_fd, POLLIN, 0}};
+		bool pending = false; // data received after last idle gap
+		uint64_t dropped_log = 0;
+		while (!rx->exit.load(std::memory_order_relaxed))
+		{
+			timespec ts;
+			timespec *p_ts = NULL;
+			if (pending && idle_gap_us >= 0)
+			{
+				ts.tv_sec = idle_gap_us / 1000000;
+				ts.tv_nsec = (idle_gap_us % 1000000) * 1000;
+				p_ts = &ts;
+			}
+			int ret = ppoll(pfds, 2, p_ts, NULL);
+			if (ret < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				log::error("uart poll failed: %d", errno);
+				break;
+			}
+			if (pfds[1].revents)
+				break;
+			if (ret == 0)
+			{
+				// bus idle, record frame end
+				uint32_t gh = rx->gap_head.load(std::memory_order_relaxed);
+				if (gh - rx->gap_tail.load(std::memory_order_acquire) < _UART_Rx::GAP_NUM)
+				{
+					rx->gaps[gh % _UART_Rx::GAP_NUM] = rx->head.load(std::memory_order_relaxed);
+					rx->gap_head.store(gh + 1, std::memory_order_release);
+				}
+				pending = false;
+				_UART_Rx::notify(rx->data_fd);
+				continue;
+			}
+			if (pfds[0].revents & (POLLERR | POLLHUP | POLLNVAL))
+			{
+				log::error("uart device error, stop receiving");
+				break;
+			}
+			// read all data in kernel buffer into ring
+			uint64_t head = rx->head.load(std::memory_order_relaxed);
+			while (1)
+			{
+				uint64_t free_len = rx->size - (head - rx->tail.load(std::memory_order_acquire));
+				uint32_t pos = head & (rx->size - 1);
+				uint32_t len = rx->size - pos;
+				if (len > free_len)
+					len = free_len;
+				int n;
+				if (len == 0)
+				{
+					uint8_t drop[256];
+					n = ::read(fd, drop, sizeof(drop));
+					if (n > 0)
+						rx->dropped += n;
+				}
+				else
+				{
+					n = ::read(fd, rx->ring + pos, len);
+					if (n > 0)
+						head += n;
+				}
+				if (n <= 0)
+					break;
+			}
+			if (head != rx->head.load(std::memory_order_relaxed))
+			{
+				rx->head.store(head, std::memory_order_release);
+				pending = true;
+				_UART_Rx::notify(rx->data_fd);
+			}
+			if (rx->dropped != dropped_log)
+			{
+				log::warn("uart receive buffer full, dropped %llu bytes", (unsigned long long)rx->dropped);
+				dropped_log = rx->dropped;
+			}
+		}
+		rx->exit.store(true);
+		_UART_Rx::notify(rx->data_fd);
+	}
+
+	static void _uart_cb_loop(UART *uart, _UART_Rx *rx, std::function<void(uart::UART&, Bytes&)> callback, int delimiter, bool use_gap)
+	{
+		uint64_t scan_pos = 0; // delimiter searched position
+		while (1)
+		{
+			uint64_t v;
+			if (::read(rx->data_fd, &v, sizeof(v)) < 0 && errno != EINTR)
+				break;
+			bool exit = rx->exit.load(std::memory_order_acquire);
+			while (1)
+			{
+				uint64_t tail = rx->tail.load(std::memory_order_relaxed);
+				uint64_t head = rx->head.load(std::memory_order_acquire);
+				if (head == tail)
+					break;
+				// find frame end, 0 means not found
+				uint64_t end = 0;
+				if (delimiter >= 0)
+				{
+					if (scan_pos < tail)
+						scan_pos = tail;
+					while (scan_pos < head)
+					{
+						uint32_t pos = scan_pos & (rx->size - 1);
+						uint32_t len = rx->size - pos;
+						if (len > head - scan_pos)
+							len = head - scan_pos;
+						uint8_t *p = (uint8_t *)memchr(rx->ring + pos, delimiter, len);
+						if (p)
+						{
+							end = scan_pos + (p - (rx->ring + pos)) + 1;
+							break;
+						}
+						scan_pos += len;
+					}
+				}
+				// drop consumed idle gaps
+				uint32_t gt = rx->gap_tail.load(std::memory_order_relaxed);
+				while (gt != rx->gap_head.load(std::memory_order_acquire) && rx->gaps[gt % _UART_Rx::GAP_NUM] <= tail)
+					++gt;
+				rx->gap_tail.store(gt, std::memory_order_release);
+				if (use_gap && gt != rx->gap_head.load(std::memory_order_acquire))
+				{
+					uint64_t gap = rx->gaps[gt % _UART_Rx::GAP_NUM];
+					if (end == 0 || gap < end)
+						end = gap;
+				}
+				if (end == 0)
+				{
+					// no framing, or buffer half full, or exiting, deliver all received data
+					if ((delimiter < 0 && !use_gap) || head - tail >= rx->size / 2 || exit)
+						end = head;
+					else
+						break;
+				}
+				uint32_t pos = tail & (rx->size - 1);
+				uint32_t len = end - tail;
+				uint8_t *data = rx->ring + pos;
+				if (pos + len > rx->size)
+				{
+					// wrap around, copy to continuous buffer
+					rx->scratch.resize(len);
+					uint32_t first = rx->size - pos;
+					memcpy(rx->scratch.data(), rx->ring + pos, first);
+					memcpy(rx->scratch.data() + first, rx->ring, len - first);
+					data = rx->scratch.data();
+				}
+				Bytes bytes(data, len, false, false);
+				try
+				{
+					callback(*uart, bytes);
+				}
+				catch (const std::exception &e)
+				{
+					log::error("uart received callback error: %s", e.what());
+				}
+				rx->tail.store(end, std::memory_order_release);
+			}
+			if (exit)
+				break;
+		}
+		// _rx_stop called in callback, no one join this thread, free rx here
+		if (rx->detached)
+			delete rx;
+	}
+
+	err::Err UART::_rx_start()
+	{
+		if (_rx || !callback || _fd <= 0)
+			return err::ERR_NONE;
+		_UART_Rx *rx = new _UART_Rx(_rx_buff_size);
+		if (rx->exit_fd < 0 || rx->data_fd < 0)
+		{
+			log::error("uart create eventfd failed: %d", errno);
+			delete rx;
+			return err::ERR_RUNTIME;
+		}
+		int64_t idle_gap_us = _rx_idle_gap_us;
+		if (idle_gap_us == 0)
+		{
+			idle_gap_us = _one_byte_time_us * 30; // system maybe use some time
+			if (idle_gap_us > 50000)
+				idle_gap_us = 50000;
+		}
+		rx->rx_th = std::thread(_uart_rx_loop, _fd, rx, idle_gap_us);
+		rx->cb_th = std::thread(_uart_cb_loop, this, rx, callback, _rx_delimiter, idle_gap_us >= 0);
+		_rx = rx;
+		return err::ERR_NONE;
+	}
+
+	void UART::_rx_stop()
+	{
+		_UART_Rx *rx = (_UART_Rx *)_rx;
+		if (!rx)
+			return;
+		_rx = nullptr;
+		rx->exit.store(true);
+		_UART_Rx::notify(rx->exit_fd);
+		rx->rx_th.join();
+		if (rx->cb_th.get_id() == std::this_thread::get_id())
+		{
+			// stopped in callback, callback thread exit by itself after callback return,
+			// and free rx object on its exit path.
+			rx->detached = true;
+			rx->cb_th.detach();
+			return;
+		}
+		rx->cb_th.join();
+		delete rx;
+	}
+
 	UART::UART(const std::string &port, int baudrate, uart::BITS databits,
 			   uart::PARITY parity, uart::STOP stopbits,
 			   uart::FLOW_CTRL flow_ctrl)
@@ -236,7 +534,10 @@ namespace maix::peripheral::uart
 		_parity = parity;
 		_stopbits = stopbits;
 		_flow_ctrl = flow_ctrl;
-		_read_thread = nullptr;
+		_rx_delimiter = -1;
+		_rx_idle_gap_us = 0;
+		_rx_buff_size = 65536;
+		_rx = nullptr;
 		if (!port.empty())
 		{
 			err::Err e = this->open();
@@ -321,9 +622,9 @@ namespace maix::peripheral::uart
 		}
 
 		// self.oneByteTime = 1 / (self.com.baudrate / (self.com.bytesize + 2 + self.com.stopbits)) # 1 byte use time
-		_one_byte_time_us = 1000000.0 / (_baudrate / (_databits + 2 + (_stopbits == STOP_1_5 ? 1.5 : _stopbits)));
+		_one_byte_time_us = 1000000.0 / (_baudrate / (_databits + 2 + (_stopbits == STOP_1_5 ? 1.5 : (double)_stopbits)));
 		log::debug("one byte time: %d", _one_byte_time_us);
-		return err::ERR_NONE;
+		return _rx_start();
 	}
 
 	bool UART::is_open()
@@ -335,24 +636,9 @@ namespace maix::peripheral::uart
 	{
 		if (_fd <= 0)
 			return err::ERR_NONE;
+		_rx_stop();
 		int ret = _uart_deinit(_fd);
 		_fd = -1;
-		if(_read_thread)
-		{
-			_read_thread_need_exit = true;
-			uint64_t t = time::ticks_ms();
-			while(!_read_thread_exit)
-			{
-				time::sleep_ms(10);
-				if(time::ticks_ms() - t > 5000)
-				{
-					log::error("waiting uart read thread exit");
-					t = time::ticks_ms();
-				}
-			}
-			delete _read_thread;
-			_read_thread = nullptr;
-		}
 		if (ret != 0)
 		{
 			log::error("uart close failed\r\n");
@@ -361,39 +647,18 @@ namespace maix::peripheral::uart
 		return err::ERR_NONE;
 	}
 
-	void UART::set_received_callback(std::function<void(uart::UART&, Bytes&)> callback)
+	void UART::set_received_callback(std::function<void(uart::UART&, Bytes&)> callback, int delimiter, int idle_gap_us, int buff_size)
 	{
-		if(!_read_thread)
-		{
-			_read_thread_need_exit = false;
-			_read_thread_exit = false;
-			_read_thread = new thread::Thread([callback](void *args){
-				UART *uart = (UART*)args;
-				while(!app::need_exit() && !uart->_read_thread_need_exit)
-				{
-					Bytes *data = NULL;
-					try
-					{
-						data = uart->read(-1, -1);
-					}
-					catch(const err::Exception& e)
-					{
-						log::error("read file failed");
-						break;
-					}
-					if(!data)
-					{
-						log::error("uart read data is null");
-						break;
-					}
-					callback(*uart, *data);
-					delete data;
-				}
-				uart->_read_thread_exit = true;
-			}, this);
-			_read_thread->detach();
-		}
+		if (delimiter > 255 || delimiter < -1)
+			throw err::Exception(err::ERR_ARGS, "delimiter should be -1 or 0~255");
+		_rx_stop();
 		this->callback = callback;
+		_rx_delimiter = delimiter;
+		_rx_idle_gap_us = idle_gap_us < 0 ? -1 : idle_gap_us;
+		_rx_buff_size = buff_size;
+		err::Err e = _rx_start();
+		if (e != err::ERR_NONE)
+			throw err::Exception(e, "start uart receive thread failed");
 	}
 
 	int UART::write(const uint8_t *buff, int len)
@@ -504,85 +769,52 @@ namespace maix::peripheral::uart
 	{
 		if (!is_open())
 			return -err::ERR_NOT_OPEN;
-		uint64_t t = time::ticks_ms();
+		if (recv_len != -1 && recv_len <= 0)
+			throw err::Exception(err::ERR_ARGS, "recv_len must be -1 or > 0");
+		uint64_t t = time::ticks_us();
+		int want_len = recv_len > 0 ? recv_len : buff_len;
+		if (want_len > buff_len)
+			want_len = buff_len;
+		// wait a short idle gap for the rest of data when no timeout set
+		int64_t gap_us = _one_byte_time_us * 30; // system maybe use some time
+		if (gap_us > 50000)
+			gap_us = 50000;
 		int read_len = 0;
-		if (recv_len == -1)
+		while (read_len < want_len)
 		{
-			while (1)
+			int len = _uart_read(_fd, buff + read_len, want_len - read_len);
+			if (len > 0)
 			{
-				int left_len = buff_len - read_len;
-				if(left_len <= 0)
-					break;
-				int len = _uart_read(_fd, buff + read_len, left_len);
-				if(len < 0)
-				{
-					if(errno != EAGAIN)
-					{
-						log::error("uart read failed: %d, %d\r\n", len, errno);
-						return -err::ERR_IO;
-					}
-				}
-				else
-				{
-					read_len += len;
-				}
-				if (timeout > 0 && (time::ticks_ms() - t) < (uint64_t)timeout)
-					time::sleep_ms(1);
-				else if (available(0) > 0)
-					continue;
-				else
-				{
-					int wait_time = _one_byte_time_us * 30; // system maybe use some time
-					time::sleep_us(wait_time > 50000 ? 50000: wait_time);
-					if (available(0) > 0)
-						continue;
-					if (timeout < 0 && read_len == 0) // block read
-					{
-						available(-1);
-						continue;
-					}
-					break;
-				}
+				read_len += len;
+				continue;
 			}
-			return read_len;
-		}
-		if (recv_len > 0)
-		{
-			int t_last = 0;
-			bool _available = false;
-			while(1)
+			if (len < 0 && errno != EAGAIN && errno != EINTR)
 			{
-				if(timeout > 0)
-				{
-					t_last = timeout - (time::ticks_ms() - t);
-					if(t_last < 0)
-						t_last = 0;
-					_available = available(t_last);
-				}
-				else
-					_available = available(timeout);
-				if (_available)
-				{
-					int len = _uart_read(_fd, buff + read_len, recv_len - read_len);
-					if (len < 0)
-					{
-						log::error("uart read failed\r\n");
-						return -err::ERR_IO;
-					}
-					read_len += len;
-				}
-				if(read_len >= recv_len || (timeout > 0 && (time::ticks_ms() - t) > (uint64_t)timeout))
-					break;
-				int wait_time = _one_byte_time_us * 30; // system maybe use some time
-				time::sleep_us(wait_time > 50000 ? 50000: wait_time);
-				if(available(0) > 0)
-					continue;
-				if(timeout == 0)
+				log::error("uart read failed: %d, %d\r\n", len, errno);
+				return -err::ERR_IO;
+			}
+			// no data now, wait data with ppoll instead of sleep polling
+			int64_t wait_us;
+			if (timeout > 0)
+			{
+				wait_us = (int64_t)timeout * 1000 - (int64_t)(time::ticks_us() - t);
+				if (wait_us <= 0)
 					break;
 			}
-			return read_len;
+			else if (timeout < 0 && (recv_len > 0 || read_len == 0)) // block read
+				wait_us = -1;
+			else
+				wait_us = gap_us;
+			int ret = _uart_wait(_fd, wait_us);
+			if (ret == 0)
+				break;
+			if (ret < 0 && ret != -EINTR)
+			{
+				log::error("uart poll failed: %d\r\n", -ret);
+				return -err::ERR_IO;
+			}
 		}
-		throw err::Exception(err::ERR_ARGS, "recv_len must be -1 or > 0");
+		return read_len;
 	}
 
 	Bytes *UART::read(int len, int timeout)
@@ -460,6 +460,8 @@ namespace maix::camera
          * @note You must use this interface very carefully. If it returns null, it means no image was captured.
          * If it returns a frame, you must explicitly release the frame after use; otherwise, it may block the next image capture.
          * For Python users, call `del frame` to release it; for C++ users, call `delete frame`.
+         * On linux(V4L2), frame is the driver buffer, only supported when camera output format is same as camera format(e.g. NV21 or GRAYSCALE),
+         * and frame.to_image() share the buffer with frame, buffer returned to driver after both released.
          * @param block_ms block read, if block_ms = -1, block indefinitely until an image is read; if block_ms = 0, do not block and return immediately
          * @return Return image frame
          * @maixcdk maix.camera.Camera.pop
@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: set_release_callback reject image owned data.
  */
 
 #pragma once
@@ -14,6 +15,7 @@
 #include "maix_image_def.hpp"
 #include "maix_image_color.hpp"
 #include "maix_image_obj.hpp"
+#include "maix_image_pool.hpp"
 #include "maix_type.hpp"
 #include <stdlib.h>
 
@@ -70,7 +72,7 @@ namespace maix::image
          * @param height image height, should > 0
          * @param format image format @see image::Format
          * @param bg background color, default is black, grayscale color will be faster,
-         *           if bg is image.COLOR_INVALID, will not fill background color, so background may be garbage(random content).
+         *           if bg is image.COLOR_INVALID, will not fill background color, so background may be garbage(random content, e.g. last image of the same size and format reused from buffer pool).
          *           So you can set to image.COLOR_INVALID to save time in some case.
          * @maixpy maix.image.Image.__init__
          * @maixcdk maix.image.Image.Image
@@ -89,7 +91,7 @@ namespace maix::image
          * @param data_size image data size, only for compressed format like jpeg png, data_size must be filled in, or should be -1, default is -1.
          * @param copy if true and data is not nullptr, will copy data to new buffer, else will use data directly. default is true to avoid memory leak.
          * @param bg background color, default is black, grayscale color will be faster,
-         *           if bg is image.COLOR_INVALID, will not fill background color, so background may be garbage(random content).
+         *           if bg is image.COLOR_INVALID, will not fill background color, so background may be garbage(random content, e.g. last image of the same size and format reused from buffer pool).
          *           So you can set to image.COLOR_INVALID to save time in some case.
          * @maixcdk maix.image.Image.Image
          */
@@ -102,9 +104,32 @@ namespace maix::image
             _data = nullptr;
             _data_size = 0;
             _is_malloc = false;
+            _release_cb = nullptr;
+            _release_arg = nullptr;
         }
         ~Image();
 
+        /**
+         * Set callback to release image data instead of free it, called once when image destroyed or data changed by update or assign.
+         * Used by the owner of external buffer(e.g. camera driver buffer) to recycle buffer after image released without copy.
+         * @param callback release callback, args are image data pointer and arg, set to nullptr to cancel.
+         * @param arg argument pass to callback.
+         * @return err::ERR_NOT_PERMIT if image data is owned by image(alloced or from buffer pool), callback not set.
+         * @maixcdk maix.image.Image.set_release_callback
+         */
+        err::Err set_release_callback(void (*callback)(void *data, void *arg), void *arg = nullptr)
+        {
+            if (_is_malloc)
+            {
+                // replace free or buffer pool release will leak image data
+                log::error("set_release_callback only for image with external data\r\n");
+                return err::ERR_NOT_PERMIT;
+            }
+            _release_cb = callback;
+            _release_arg = arg;
+            return err::ERR_NONE;
+        }
+
         /**
          * set image
          * @maixcdk maix.image.Image.update
@@ -435,8 +460,9 @@ namespace maix::image
          * Draw image on this image
          * @param x left top corner of image point's coordinate x
          * @param y left top corner of image point's coordinate y
-         * @param img image object to draw, the caller's channel must <= the args' channel,
-         *            e.g. caller is RGB888, args is RGBA8888, will throw exception, but caller is RGBA8888, args is RGB888 or RGBA8888 is ok
+         * @param img image object to draw, RGBA8888 and BGRA8888 image will be alpha blended,
+         *            caller image can be RGB888, BGR888, RGBA8888, BGRA8888, YVU420SP or YUV420SP, @see image::Compositor.
+         *            for GRAYSCALE, RGB888, BGR888 caller, args image's channel must <= the caller's channel.
          * @return this image object self
          * @maixpy maix.image.Image.draw_image
          */
@@ -1598,7 +1624,11 @@ namespace maix::image
         int _data_size;
         Format _format;
         bool _is_malloc;
+        void (*_release_cb)(void *data, void *arg);
+        void *_release_arg;
 
+        bool _alloc_data();
+        void _release_data();
         int _get_cv_pixel_num(image::Format &format);
         std::vector<int> _get_available_roi(std::vector<int> roi, std::vector<int> other_roi = std::vector<int>());
         void _create_image(int width, int height, image::Format format, uint8_t *data, int data_size, bool copy, const image::Color &bg = image::FMT_INVALID);
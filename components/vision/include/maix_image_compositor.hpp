@@ -0,0 +1,116 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2023-
+ * @license Apache 2.0
+ * @update 2026.10.18: Create this file, add alpha compositor.
+ */
+
+#pragma once
+
+#include "maix_image.hpp"
+
+namespace maix::image
+{
+    /**
+     * Alpha compositor, blend overlay layers(e.g. UI, logo) onto image.
+     * Layers are converted to premultiplied alpha once and blended by NEON or SSE2 if available,
+     * all layers are blended in one pass of target image rows.
+     * Layer image support RGBA8888, BGRA8888, and RGB888, BGR888, GRAYSCALE as opaque layer.
+     * Target image support RGB888, BGR888, RGBA8888, BGRA8888, YVU420SP(NV21), YUV420SP(NV12),
+     * for YUV420SP target, layer position will be aligned down to 2 pixels.
+     * @maixpy maix.image.Compositor
+     */
+    class Compositor
+    {
+    public:
+        /**
+         * Construct a compositor without layers
+         * @maixpy maix.image.Compositor.__init__
+         * @maixcdk maix.image.Compositor.Compositor
+         */
+        Compositor();
+        ~Compositor();
+
+        /**
+         * Add layer on top of other layers
+         * @param img layer image, RGBA8888, BGRA8888, RGB888, BGR888 or GRAYSCALE.
+         * @param x layer left top x on target image, can be negative.
+         * @param y layer left top y on target image, can be negative.
+         * @param cache true to convert img to premultiplied alpha now and cache it, img can be released after add, call update_layer if img content changed.
+         *              false to reference img and convert it every compose, img must be valid until layer removed, for layer changes every frame.
+         * @return layer id, used by other layer methods.
+         * @maixpy maix.image.Compositor.add_layer
+         */
+        int add_layer(image::Image &img, int x = 0, int y = 0, bool cache = true);
+
+        /**
+         * Update layer content
+         * @param id layer id
+         * @param img new layer image, size can be different from old one.
+         * @return err::ERR_NONE if success, else error code.
+         * @maixpy maix.image.Compositor.update_layer
+         */
+        err::Err update_layer(int id, image::Image &img);
+
+        /**
+         * Set layer position
+         * @param id layer id
+         * @param x layer left top x on target image
+         * @param y layer left top y on target image
+         * @return err::ERR_NONE if success, else error code.
+         * @maixpy maix.image.Compositor.set_layer_pos
+         */
+        err::Err set_layer_pos(int id, int x, int y);
+
+        /**
+         * Show or hide layer
+         * @param id layer id
+         * @param visible true to show, false to hide.
+         * @return err::ERR_NONE if success, else error code.
+         * @maixpy maix.image.Compositor.set_layer_visible
+         */
+        err::Err set_layer_visible(int id, bool visible);
+
+        /**
+         * Remove layer
+         * @param id layer id
+         * @return err::ERR_NONE if success, else error code.
+         * @maixpy maix.image.Compositor.remove_layer
+         */
+        err::Err remove_layer(int id);
+
+        /**
+         * Remove all layers
+         * @maixpy maix.image.Compositor.clear
+         */
+        void clear();
+
+        /**
+         * Get layer number
+         * @maixpy maix.image.Compositor.layer_num
+         */
+        int layer_num();
+
+        /**
+         * Blend all visible layers onto image by added order
+         * @param img target image, RGB888, BGR888, RGBA8888, BGRA8888, YVU420SP or YUV420SP.
+         * @return err::ERR_NONE if success, else error code.
+         * @maixpy maix.image.Compositor.compose
+         */
+        err::Err compose(image::Image &img);
+
+        /**
+         * Blend one image onto another image without cache, used by Image::draw_image
+         * @param dst target image, RGB888, BGR888, RGBA8888, BGRA8888, YVU420SP or YUV420SP.
+         * @param src source image, RGBA8888, BGRA8888, RGB888, BGR888 or GRAYSCALE.
+         * @param x source left top x on target image
+         * @param y source left top y on target image
+         * @return err::ERR_NONE if success, else error code.
+         * @maixcdk maix.image.Compositor.blend
+         */
+        static err::Err blend(image::Image &dst, image::Image &src, int x, int y);
+
+    private:
+        void *_data;
+    };
+} // namespace maix::image
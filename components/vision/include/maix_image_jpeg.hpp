@@ -0,0 +1,126 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Create this file, add software JPEG encoder.
+ */
+
+#pragma once
+
+#include "maix_basic.hpp"
+#include "maix_image.hpp"
+#include <vector>
+
+namespace maix::image
+{
+    /**
+     * Software baseline JPEG encoder for platforms without hardware JPEG encoder.
+     * YUV420SP(NV21/NV12), YUV420P, GRAYSCALE and RGB/BGR(A) images are encoded directly without convert to BGR first,
+     * YUV420 chroma planes are used as 4:2:0 components as is, RGB images are converted to YCbCr 4:2:0 MCU by MCU.
+     * Every MCU row is one restart interval slice, slices are encoded by multiple threads and joined with RST markers.
+     * Quantization divisors and Huffman codes are built once when quality changed, and slice buffers are reused by every frame,
+     * so keep one encoder to encode a stream of images.
+     * Not thread safe, use one encoder in one thread.
+     * @maixcdk maix.image.JpegEncoder
+     */
+    class JpegEncoder
+    {
+    public:
+        /**
+         * Construct JPEG encoder
+         * @param quality JPEG quality, [1, 100].
+         * @param threads max threads to encode slices, 0 means OpenMP default.
+         * @maixcdk maix.image.JpegEncoder.JpegEncoder
+         */
+        JpegEncoder(int quality = 95, int threads = 0);
+        ~JpegEncoder();
+        JpegEncoder(const JpegEncoder &) = delete;
+        JpegEncoder &operator=(const JpegEncoder &) = delete;
+
+        /**
+         * Set quality, quantization tables are only rebuilt when quality changed
+         * @param quality JPEG quality, [1, 100].
+         * @return err::ERR_ARGS if quality out of range.
+         * @maixcdk maix.image.JpegEncoder.set_quality
+         */
+        err::Err set_quality(int quality);
+
+        /**
+         * Get quality
+         * @maixcdk maix.image.JpegEncoder.quality
+         */
+        int quality() { return _quality; }
+
+        /**
+         * Set max threads to encode slices
+         * @param threads 0 means OpenMP default, 1 means encode in caller thread only.
+         * @maixcdk maix.image.JpegEncoder.set_threads
+         */
+        void set_threads(int threads) { _threads = threads < 0 ? 0 : threads; }
+
+        /**
+         * Is image format can be encoded directly
+         * @maixcdk maix.image.JpegEncoder.is_support
+         */
+        static bool is_support(image::Format format);
+
+        /**
+         * Encode image, result is kept in encoder until next encode, use write to get it.
+         * @param img image to encode, format must be supported, see is_support.
+         * @return JPEG size in bytes, < 0 means error, -err::ERR_ARGS if format not support.
+         * @maixcdk maix.image.JpegEncoder.encode
+         */
+        int encode(image::Image &img);
+
+        /**
+         * Write last encoded JPEG to buffer
+         * @param buff buffer, size must >= size().
+         * @return err::ERR_BUFF_FULL if buffer too small, err::ERR_NOT_READY if not encoded.
+         * @maixcdk maix.image.JpegEncoder.write
+         */
+        err::Err write(void *buff, size_t buff_size);
+
+        /**
+         * Last encoded JPEG size in bytes
+         * @maixcdk maix.image.JpegEncoder.size
+         */
+        int size() { return (int)_size; }
+
+        /**
+         * Encode image and write JPEG to buffer
+         * @return JPEG size in bytes, < 0 means error, -err::ERR_BUFF_FULL if buffer too small.
+         * @maixcdk maix.image.JpegEncoder.encode
+         */
+        int encode(image::Image &img, void *buff, size_t buff_size);
+
+        /**
+         * Encode image to FMT_JPEG image, the same as Image::to_jpeg
+         * @param buff if not nullptr, JPEG is written to it and returned image use it without copy.
+         * @return new FMT_JPEG image, delete it after use.
+         * @throw err::Exception if format not support or buff too small.
+         * @maixcdk maix.image.JpegEncoder.encode_image
+         */
+        image::Image *encode_image(image::Image &img, void *buff = nullptr, size_t buff_size = 0);
+
+    private:
+        class Slice
+        {
+        public:
+            std::vector<uint8_t> buf;
+            size_t len = 0;
+        };
+
+        int _quality;
+        int _threads;
+        float _divisors[2][64];     // 1 / (quant * AAN scale), natural order, luma and chroma
+        uint8_t _qtables[2][64];    // quant tables in zigzag order for DQT
+        uint16_t _codes[4][256];    // Huffman codes of DC luma, AC luma, DC chroma, AC chroma
+        uint8_t _code_sizes[4][256];
+        std::vector<uint8_t> _header;
+        std::vector<Slice> _slices;
+        int _slices_num;
+        size_t _size;
+
+        void _build_header(int width, int height, bool gray, int restart_interval);
+    };
+} // namespace maix::image
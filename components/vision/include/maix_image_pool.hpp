@@ -0,0 +1,71 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2023-
+ * @license Apache 2.0
+ * @update 2026.10.18: Create this file, add image buffer pool.
+ */
+
+#pragma once
+
+#include "maix_image_def.hpp"
+#include <map>
+#include <string>
+#include <stdint.h>
+
+namespace maix::image
+{
+    /**
+     * Config image buffer pool.
+     * Uncompressed image buffers are cached by (width, height, format) when image destroyed, and reused by next image with the same size and format,
+     * so camera read, resize, to_format etc. not need to malloc and page fault large buffer every frame.
+     * Reused buffer is not cleared, image created without bg color contains last image data.
+     * @param enable enable pool or not, disable will free all idle buffers of pool, default enabled.
+     * @param max_bytes max bytes of idle buffers kept by pool, oldest idle buffer will be freed if exceed, default 32MiB.
+     * @param thread_cache max idle buffers cached by each thread, reuse them without lock, 0 means not use thread cache, default 2.
+     *                     all thread caches use at most half of max_bytes.
+     * @param min_bytes only pool buffer size >= min_bytes, small buffer malloc is fast enough, default 64KiB.
+     * @maixpy maix.image.set_buffer_pool
+     */
+    void set_buffer_pool(bool enable, int max_bytes = 32 * 1024 * 1024, int thread_cache = 2, int min_bytes = 64 * 1024);
+
+    /**
+     * Get image buffer pool statistics
+     * @return dict type, keys:
+     *         hit: alloc reused pool buffer count, including thread_hit.
+     *         thread_hit: alloc reused thread cache buffer count.
+     *         miss: alloc new buffer count.
+     *         evict: idle buffer freed count because exceed max_bytes.
+     *         in_use, in_use_bytes: buffers used by images now.
+     *         idle, idle_bytes: buffers cached by pool now, including thread cache.
+     *         thread_cache_bytes: bytes cached by all thread caches now.
+     * @maixpy maix.image.buffer_pool_stats
+     */
+    std::map<std::string, uint64_t> buffer_pool_stats();
+
+    /**
+     * Free all idle buffers of pool and current thread cache, thread cache of other threads are freed when thread exit or next time they use pool.
+     * @maixpy maix.image.buffer_pool_clear
+     */
+    void buffer_pool_clear();
+
+    /**
+     * Alloc image buffer from pool, 4KiB aligned.
+     * @param width image width
+     * @param height image height
+     * @param format image format, compressed format not supported.
+     * @param size buffer size
+     * @param arg return argument of buffer_pool_release.
+     * @param reused if not nullptr, return true if buffer is reused from pool, content is left by last image, not cleared.
+     * @return buffer pointer, nullptr if pool disabled, or not support this buffer, or no memory, caller should malloc itself.
+     * @maixcdk maix.image.buffer_pool_alloc
+     */
+    void *buffer_pool_alloc(int width, int height, image::Format format, int size, void **arg, bool *reused = nullptr);
+
+    /**
+     * Release buffer alloced by buffer_pool_alloc, can be used as Image release callback.
+     * @param data buffer pointer
+     * @param arg argument returned by buffer_pool_alloc.
+     * @maixcdk maix.image.buffer_pool_release
+     */
+    void buffer_pool_release(void *data, void *arg);
+} // namespace maix::image
@@ -14,6 +14,7 @@
 #include "maix_video.hpp"
 #include "maix_image.hpp"
 #include "maix_basic.hpp"
+#include <map>
 
 namespace maix::http
 {
@@ -73,6 +74,18 @@ namespace maix::http
         */
         err::Err set_html(std::string data);
 
+        /**
+         * Get connected stream clients status, for benchmark how many clients can be served.
+         * Only supported on linux platform now, other platforms return empty.
+         * @return dict, key is client address "ip:port", value is dict with keys:
+         *         "fps": frames sent to this client per second,
+         *         "queue": frames written by write() but not sent to this client yet,
+         *         "sent": total sent frames,
+         *         "dropped": frames skipped because client is slower than write().
+         * @maixpy maix.http.JpegStreamer.clients_status
+        */
+        std::map<std::string, std::map<std::string, float>> clients_status();
+
         /**
          * Get host
          * @return host name
@@ -93,6 +106,7 @@ namespace maix::http
     private:
         std::string _host;
         int _port;
+        void *_data;
     };
 } // namespace maix::http
 
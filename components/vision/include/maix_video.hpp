@@ -1211,6 +1211,7 @@ namespace maix::video
         int _framerate;
         fs::File file;
         uint64_t _last_pts;
+        void *_param;
     };
 
     /**
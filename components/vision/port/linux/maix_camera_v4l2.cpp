@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Integer SIMD YUYV convert, lease driver buffer by pop, pace frames by driver.
  */
 
 
@@ -29,6 +30,20 @@
 #include "maix_err.hpp"
 #include "maix_log.hpp"
 #include "maix_image.hpp"
+#include "maix_camera_v4l2.hpp"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define CAMERA_USE_NEON 1
+    #define CAMERA_USE_SSE 0
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+    #define CAMERA_USE_NEON 0
+    #define CAMERA_USE_SSE 1
+#else
+    #define CAMERA_USE_NEON 0
+    #define CAMERA_USE_SSE 0
+#endif
 
 #ifndef V4L2_PIX_FMT_RGBA32
 #define V4L2_PIX_FMT_RGBA32 v4l2_fourcc('R', 'G', 'B', 'A') /* 32  RGBA-8-8-8-8    */
@@ -49,448 +64,308 @@ namespace maix::camera
         return r;
     }
 
-    static int choose_format(int target, const std::vector<uint32_t> &formats)
+    // V4L2 pixel format have same memory layout with image format, 0 if no one
+    static uint32_t _v4l2_format(image::Format format)
+    {
+        switch (format)
+        {
+        case image::FMT_RGB888:
+            return V4L2_PIX_FMT_RGB24;
+        case image::FMT_BGR888:
+            return V4L2_PIX_FMT_BGR24;
+        case image::FMT_RGBA8888:
+            return V4L2_PIX_FMT_RGBA32;
+        case image::FMT_BGRA8888:
+            return V4L2_PIX_FMT_BGR32;
+        case image::FMT_GRAYSCALE:
+            return V4L2_PIX_FMT_GREY;
+        case image::FMT_YVU420SP:
+            return V4L2_PIX_FMT_NV21;
+        case image::FMT_YUV420SP:
+            return V4L2_PIX_FMT_NV12;
+        default:
+            return 0;
+        }
+    }
+
+    static bool _is_support_format(image::Format format)
     {
-        int final = 0;
-        if (!(target == image::FMT_RGB888 || target == image::FMT_RGBA8888 ||
-              target == image::FMT_BGR888 || target == image::FMT_BGRA8888))
-            throw std::runtime_error("format not support");
+        return format == image::FMT_RGB888 || format == image::FMT_BGR888 ||
+               format == image::FMT_RGBA8888 || format == image::FMT_BGRA8888 ||
+               format == image::FMT_GRAYSCALE || format == image::FMT_YVU420SP;
+    }
 
-        for (size_t i = 1; i < formats.size(); i++)
+    /**
+     * Choose raw format, same layout with target first, or YUYV and convert in read.
+     * @return index of formats, -1 if not found
+     */
+    static int choose_format(image::Format target, const std::vector<uint32_t> &formats)
+    {
+        int final = -1;
+        uint32_t same = _v4l2_format(target);
+        for (size_t i = 0; i < formats.size(); i++)
         {
-            if (target == image::FMT_RGB888 && formats[i] == V4L2_PIX_FMT_RGB24)
-            {
-                log::debug("raw choose RGB888 mode\n");
-                final = i;
-                break;
-            }
-            if (target == image::FMT_BGR888 && formats[i] == V4L2_PIX_FMT_BGR24)
-            {
-                log::debug("raw choose BGR888 mode\n");
-                final = i;
-                break;
-            }
-            if (target == image::FMT_BGRA8888 && formats[i] == V4L2_PIX_FMT_BGR32)
+            if (same && formats[i] == same)
             {
-                log::debug("raw choose BGRA8888 mode\n");
-                final = i;
-                break;
+                log::debug("raw choose %s mode\n", image::fmt_names[target].c_str());
+                return i;
             }
             if (formats[i] == V4L2_PIX_FMT_YUYV)
             {
                 log::debug("raw choose YUYV 422 mode\n");
                 final = i;
-                //     if(target == image::FMT_YUV422)
-                //         break;
             }
         }
         return final;
     }
 
-    static bool need_convert_format(uint32_t raw_format, int target_format)
+    static bool need_convert_format(uint32_t raw_format, image::Format target_format)
     {
-        if (!(target_format == image::FMT_RGB888 || target_format == image::FMT_RGBA8888 ||
-              target_format == image::FMT_BGR888 || target_format == image::FMT_BGRA8888))
-            throw std::runtime_error("format not support");
-        return !((target_format == image::FMT_RGB888 && raw_format == V4L2_PIX_FMT_RGB24) ||
-                 (target_format == image::FMT_RGBA8888 && raw_format == V4L2_PIX_FMT_RGBA32) ||
-                 (target_format == image::FMT_BGR888 && raw_format == V4L2_PIX_FMT_BGR24) ||
-                 (target_format == image::FMT_BGRA8888 && raw_format == V4L2_PIX_FMT_BGRA32));
+        return raw_format != _v4l2_format(target_format);
     }
 
-    static void *alloc_buffer(int width, int height, int format)
+    /*
+     * YUYV(YUV422 packed) convert.
+     * BT709 limited range to RGB[0, 255], integer Q6 coefficients,
+     * NEON, SSE2 and scalar path use same formula so results are identical.
+     */
+#define YUV_KY  75  // 1.164384 * 64
+#define YUV_KRV 115 // 1.79271 * 64
+#define YUV_KGU 14  // 0.213249 * 64
+#define YUV_KGV 34  // 0.532909 * 64
+#define YUV_KBU 135 // 2.112402 * 64
+
+    static inline uint8_t _clamp_q6(int v)
     {
-        if (!(format == image::FMT_RGB888 || format == image::FMT_RGBA8888 ||
-              format == image::FMT_BGR888 || format == image::FMT_BGRA8888))
-            throw std::runtime_error("format not support");
-        if (format == image::FMT_RGBA8888 || format == image::FMT_BGRA8888)
-            return malloc(width * height * 4);
-        // if (format == image::FMT_YUV422)
-        //     return malloc(width * height * 2);
-        return malloc(width * height * 3);
+        v = (v + 32) >> 6;
+        return v < 0 ? 0 : (v > 255 ? 255 : v);
     }
 
-    static void yuyv422_to_rgb888(void *src, void *dst, int width, int height)
+    // RI, GI, BI: channel offset in one output pixel, AI: alpha offset or -1, BPP: bytes per output pixel
+    template <int RI, int GI, int BI, int AI, int BPP>
+    static void _yuyv_row_to_rgb(const uint8_t *yuyv, uint8_t *dst, int width)
     {
-        uint8_t *rgb = (uint8_t *)dst;
-        uint8_t *yuyv = (uint8_t *)src;
-        uint8_t y0, u, y1, v;
-        float r, g, b;
-        for (int y = 0; y < height; ++y)
+        int x = 0;
+#if CAMERA_USE_NEON
+        const int16x8_t k16 = vdupq_n_s16(16);
+        const uint8x8_t k128 = vdup_n_u8(128);
+        for (; x + 16 <= width; x += 16, yuyv += 32, dst += 16 * BPP)
         {
-            for (int x = 0; x < width;)
+            // val[0]: even pixels Y, val[1]: U, val[2]: odd pixels Y, val[3]: V
+            uint8x8x4_t p = vld4_u8(yuyv);
+            int16x8_t u = vreinterpretq_s16_u16(vsubl_u8(p.val[1], k128));
+            int16x8_t v = vreinterpretq_s16_u16(vsubl_u8(p.val[3], k128));
+            int16x8_t rv = vmulq_n_s16(v, YUV_KRV);
+            int16x8_t guv = vmlaq_n_s16(vmulq_n_s16(u, YUV_KGU), v, YUV_KGV);
+            int16x8_t bu = vmulq_n_s16(u, YUV_KBU);
+            uint8x8_t r[2], g[2], b[2];
+            for (int i = 0; i < 2; ++i)
+            {
+                int16x8_t y = vmulq_n_s16(vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(p.val[i * 2])), k16), YUV_KY);
+                r[i] = vqrshrun_n_s16(vqaddq_s16(y, rv), 6);
+                g[i] = vqrshrun_n_s16(vqsubq_s16(y, guv), 6);
+                b[i] = vqrshrun_n_s16(vqaddq_s16(y, bu), 6);
+            }
+            // even and odd pixels to continuous pixels
+            uint8x8x2_t r2 = vzip_u8(r[0], r[1]);
+            uint8x8x2_t g2 = vzip_u8(g[0], g[1]);
+            uint8x8x2_t b2 = vzip_u8(b[0], b[1]);
+            if constexpr (BPP == 4)
             {
-                y0 = yuyv[0];
-                u = yuyv[1];
-                y1 = yuyv[2];
-                v = yuyv[3];
-
-                // BT601 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y0 - 16) + 1.596 * (v - 128);
-                // g = 1.164384 * (y0 - 16) - 0.813 * (v - 128) - 0.391 * (u - 128);
-                // b = 1.164384 * (y0 - 16) + 2.018 * (u - 128);
-                // BT601 YUV data is full range, to RGB[0, 255]
-                // r = y0 + 1.402 * (v - 128);
-                // g = y0 - 0.344 * (u - 128) - 0.714 * (v - 128);
-                // b = y0 + 1.772 * (u - 128);
-                // BT709 YUV data is limited range, to RGB[0, 255]
-                r = 1.164384 * (y0 - 16) + 1.79271 * (v - 128);
-                g = 1.164384 * (y0 - 16) - 0.532909 * (v - 128) - 0.213249 * (u - 128);
-                b = 1.164384 * (y0 - 16) + 2.112402 * (u - 128);
-                // BT709 YUV data is full range, to RGB[0, 255]
-                // r = y0 + 1.5748 * (v - 128);
-                // g = y0 - 0.1873 * (u - 128) - 0.4681 * (v - 128);
-                // b = y0 + 1.8556 * (u - 128);
-                // BT2020 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y0 - 16) + 1.67867 * (v - 128);
-                // g = 1.164384 * (y0 - 16) - 0.65042 * (v - 128) - 0.187326 * (u - 128);
-                // b = 1.164384 * (y0 - 16) + 2.14177 * (u - 128);
-                // BT2020 YUV data is full range, to RGB[0, 255]
-                // r = y0 + 1.4746 * (v - 128)
-                // g = y0 - 0.164553 * (u - 128) - 0.571353 * (u - 128)
-                // b = y0 + 1.8814 * (u - 128)
-
-                r = r > 255 ? 255 : (r < 0 ? 0 : r);
-                g = g > 255 ? 255 : (g < 0 ? 0 : g);
-                b = b > 255 ? 255 : (b < 0 ? 0 : b);
-                rgb[0] = (uint8_t)r;
-                rgb[1] = (uint8_t)g;
-                rgb[2] = (uint8_t)b;
-
-                // BT601 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y1 - 16) + 1.596 * (v - 128);
-                // g = 1.164384 * (y1 - 16) - 0.813 * (v - 128) - 0.391 * (u - 128);
-                // b = 1.164384 * (y1 - 16) + 2.018 * (u - 128);
-                // BT601 YUV data is full range, to RGB[0, 255]
-                // r = y1 + 1.402 * (v - 128);
-                // g = y1 - 0.344 * (u - 128) - 0.714 * (v - 128);
-                // b = y1 + 1.772 * (u - 128);
-                // BT709 YUV data is limited range, to RGB[0, 255]
-                r = 1.164384 * (y1 - 16) + 1.79271 * (v - 128);
-                g = 1.164384 * (y1 - 16) - 0.532909 * (v - 128) - 0.213249 * (u - 128);
-                b = 1.164384 * (y1 - 16) + 2.112402 * (u - 128);
-                // BT709 YUV data is full range, to RGB[0, 255]
-                // r = y1 + 1.5748 * (v - 128);
-                // g = y1 - 0.1873 * (u - 128) - 0.4681 * (v - 128);
-                // b = y1 + 1.8556 * (u - 128);
-                // BT2020 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y1 - 16) + 1.67867 * (v - 128);
-                // g = 1.164384 * (y1 - 16) - 0.65042 * (v - 128) - 0.187326 * (u - 128);
-                // b = 1.164384 * (y1 - 16) + 2.14177 * (u - 128);
-                // BT2020 YUV data is full range, to RGB[0, 255]
-                // r = y1 + 1.4746 * (v - 128)
-                // g = y1 - 0.164553 * (u - 128) - 0.571353 * (u - 128)
-                // b = y1 + 1.8814 * (u - 128)
-
-                r = r > 255 ? 255 : (r < 0 ? 0 : r);
-                g = g > 255 ? 255 : (g < 0 ? 0 : g);
-                b = b > 255 ? 255 : (b < 0 ? 0 : b);
-                rgb[3] = (uint8_t)r;
-                rgb[4] = (uint8_t)g;
-                rgb[5] = (uint8_t)b;
-                yuyv += 4;
-                rgb += 6;
-                x += 2;
+                uint8x16x4_t o;
+                o.val[RI] = vcombine_u8(r2.val[0], r2.val[1]);
+                o.val[GI] = vcombine_u8(g2.val[0], g2.val[1]);
+                o.val[BI] = vcombine_u8(b2.val[0], b2.val[1]);
+                o.val[AI] = vdupq_n_u8(255);
+                vst4q_u8(dst, o);
+            }
+            else
+            {
+                uint8x16x3_t o;
+                o.val[RI] = vcombine_u8(r2.val[0], r2.val[1]);
+                o.val[GI] = vcombine_u8(g2.val[0], g2.val[1]);
+                o.val[BI] = vcombine_u8(b2.val[0], b2.val[1]);
+                vst3q_u8(dst, o);
             }
         }
-    }
-
-    static void yuyv422_to_bgr888(void *src, void *dst, int width, int height)
-    {
-        uint8_t *rgb = (uint8_t *)dst;
-        uint8_t *yuyv = (uint8_t *)src;
-        uint8_t y0, u, y1, v;
-        float r, g, b;
-        for (int y = 0; y < height; ++y)
+#elif CAMERA_USE_SSE
+        const __m128i mask_y = _mm_set1_epi16(0x00FF);
+        const __m128i k16 = _mm_set1_epi16(16);
+        const __m128i k128 = _mm_set1_epi16(128);
+        const __m128i k32 = _mm_set1_epi16(32);
+        const __m128i ky = _mm_set1_epi16(YUV_KY);
+        const __m128i krv = _mm_set1_epi16(YUV_KRV);
+        const __m128i kgu = _mm_set1_epi16(YUV_KGU);
+        const __m128i kgv = _mm_set1_epi16(YUV_KGV);
+        const __m128i kbu = _mm_set1_epi16(YUV_KBU);
+        alignas(16) uint8_t r[16], g[16], b[16];
+        for (; x + 16 <= width; x += 16, yuyv += 32, dst += 16 * BPP)
         {
-            for (int x = 0; x < width;)
+            __m128i rgb[3][2];
+            for (int i = 0; i < 2; ++i)
             {
-                y0 = yuyv[0];
-                u = yuyv[1];
-                y1 = yuyv[2];
-                v = yuyv[3];
-
-                // BT601 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y0 - 16) + 1.596 * (v - 128);
-                // g = 1.164384 * (y0 - 16) - 0.813 * (v - 128) - 0.391 * (u - 128);
-                // b = 1.164384 * (y0 - 16) + 2.018 * (u - 128);
-                // BT601 YUV data is full range, to RGB[0, 255]
-                r = y0 + 1.402 * (v - 128);
-                g = y0 - 0.344 * (u - 128) - 0.714 * (v - 128);
-                b = y0 + 1.772 * (u - 128);
-                // BT709 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y0 - 16) + 1.79271 * (v - 128);
-                // g = 1.164384 * (y0 - 16) - 0.532909 * (v - 128) - 0.213249 * (u - 128);
-                // b = 1.164384 * (y0 - 16) + 2.112402 * (u - 128);
-                // BT709 YUV data is full range, to RGB[0, 255]
-                // r = y0 + 1.5748 * (v - 128);
-                // g = y0 - 0.1873 * (u - 128) - 0.4681 * (v - 128);
-                // b = y0 + 1.8556 * (u - 128);
-                // BT2020 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y0 - 16) + 1.67867 * (v - 128);
-                // g = 1.164384 * (y0 - 16) - 0.65042 * (v - 128) - 0.187326 * (u - 128);
-                // b = 1.164384 * (y0 - 16) + 2.14177 * (u - 128);
-                // BT2020 YUV data is full range, to RGB[0, 255]
-                // r = y0 + 1.4746 * (v - 128)
-                // g = y0 - 0.164553 * (u - 128) - 0.571353 * (u - 128)
-                // b = y0 + 1.8814 * (u - 128)
-
-                r = r > 255 ? 255 : (r < 0 ? 0 : r);
-                g = g > 255 ? 255 : (g < 0 ? 0 : g);
-                b = b > 255 ? 255 : (b < 0 ? 0 : b);
-                rgb[0] = (uint8_t)b;
-                rgb[1] = (uint8_t)g;
-                rgb[2] = (uint8_t)r;
-
-                // BT601 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y1 - 16) + 1.596 * (v - 128);
-                // g = 1.164384 * (y1 - 16) - 0.813 * (v - 128) - 0.391 * (u - 128);
-                // b = 1.164384 * (y1 - 16) + 2.018 * (u - 128);
-                // BT601 YUV data is full range, to RGB[0, 255]
-                r = y1 + 1.402 * (v - 128);
-                g = y1 - 0.344 * (u - 128) - 0.714 * (v - 128);
-                b = y1 + 1.772 * (u - 128);
-                // BT709 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y1 - 16) + 1.79271 * (v - 128);
-                // g = 1.164384 * (y1 - 16) - 0.532909 * (v - 128) - 0.213249 * (u - 128);
-                // b = 1.164384 * (y1 - 16) + 2.112402 * (u - 128);
-                // BT709 YUV data is full range, to RGB[0, 255]
-                // r = y1 + 1.5748 * (v - 128);
-                // g = y1 - 0.1873 * (u - 128) - 0.4681 * (v - 128);
-                // b = y1 + 1.8556 * (u - 128);
-                // BT2020 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y1 - 16) + 1.67867 * (v - 128);
-                // g = 1.164384 * (y1 - 16) - 0.65042 * (v - 128) - 0.187326 * (u - 128);
-                // b = 1.164384 * (y1 - 16) + 2.14177 * (u - 128);
-                // BT2020 YUV data is full range, to RGB[0, 255]
-                // r = y1 + 1.4746 * (v - 128)
-                // g = y1 - 0.164553 * (u - 128) - 0.571353 * (u - 128)
-                // b = y1 + 1.8814 * (u - 128)
-
-                r = r > 255 ? 255 : (r < 0 ? 0 : r);
-                g = g > 255 ? 255 : (g < 0 ? 0 : g);
-                b = b > 255 ? 255 : (b < 0 ? 0 : b);
-                rgb[3] = (uint8_t)b;
-                rgb[4] = (uint8_t)g;
-                rgb[5] = (uint8_t)r;
-                yuyv += 4;
-                rgb += 6;
-                x += 2;
+                __m128i p = _mm_loadu_si128((const __m128i *)(yuyv + i * 16));
+                __m128i y = _mm_mullo_epi16(_mm_sub_epi16(_mm_and_si128(p, mask_y), k16), ky);
+                __m128i uv = _mm_sub_epi16(_mm_srli_epi16(p, 8), k128); // U V U V ...
+                // duplicate U and V for two pixels share them
+                __m128i u = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, _MM_SHUFFLE(2, 2, 0, 0)), _MM_SHUFFLE(2, 2, 0, 0));
+                __m128i v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, _MM_SHUFFLE(3, 3, 1, 1)), _MM_SHUFFLE(3, 3, 1, 1));
+                __m128i guv = _mm_add_epi16(_mm_mullo_epi16(u, kgu), _mm_mullo_epi16(v, kgv));
+                rgb[0][i] = _mm_srai_epi16(_mm_adds_epi16(_mm_adds_epi16(y, _mm_mullo_epi16(v, krv)), k32), 6);
+                rgb[1][i] = _mm_srai_epi16(_mm_adds_epi16(_mm_subs_epi16(y, guv), k32), 6);
+                rgb[2][i] = _mm_srai_epi16(_mm_adds_epi16(_mm_adds_epi16(y, _mm_mullo_epi16(u, kbu)), k32), 6);
+            }
+            _mm_store_si128((__m128i *)r, _mm_packus_epi16(rgb[0][0], rgb[0][1]));
+            _mm_store_si128((__m128i *)g, _mm_packus_epi16(rgb[1][0], rgb[1][1]));
+            _mm_store_si128((__m128i *)b, _mm_packus_epi16(rgb[2][0], rgb[2][1]));
+            for (int i = 0; i < 16; ++i)
+            {
+                uint8_t *o = dst + i * BPP;
+                o[RI] = r[i];
+                o[GI] = g[i];
+                o[BI] = b[i];
+                if constexpr (AI >= 0)
+                    o[AI] = 255;
             }
         }
-    }
-
-    // V4L2_PIX_FMT_YUYV to RGBA8888
-    static void yuyv422_to_rgba8888(void *src, void *dst, int width, int height)
-    {
-        uint8_t *rgba = (uint8_t *)dst;
-        uint8_t *yuyv = (uint8_t *)src;
-        uint8_t y0, u, y1, v;
-        float r, g, b;
-        for (int y = 0; y < height; ++y)
+#endif
+        for (; x + 2 <= width; x += 2, yuyv += 4, dst += 2 * BPP)
         {
-            for (int x = 0; x < width;)
+            int u = yuyv[1] - 128;
+            int v = yuyv[3] - 128;
+            int rv = YUV_KRV * v;
+            int guv = YUV_KGU * u + YUV_KGV * v;
+            int bu = YUV_KBU * u;
+            for (int i = 0; i < 2; ++i)
             {
-                y0 = yuyv[0];
-                u = yuyv[1];
-                y1 = yuyv[2];
-                v = yuyv[3];
-                // BT601 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y0 - 16) + 1.596 * (v - 128);
-                // g = 1.164384 * (y0 - 16) - 0.813 * (v - 128) - 0.391 * (u - 128);
-                // b = 1.164384 * (y0 - 16) + 2.018 * (u - 128);
-                // BT601 YUV data is full range, to RGB[0, 255]
-                // r = y0 + 1.402 * (v - 128);
-                // g = y0 - 0.344 * (u - 128) - 0.714 * (v - 128);
-                // b = y0 + 1.772 * (u - 128);
-                // BT709 YUV data is limited range, to RGB[0, 255]
-                r = 1.164384 * (y0 - 16) + 1.793 * (v - 128);
-                g = 1.164384 * (y0 - 16) - 0.534 * (v - 128) - 0.213 * (u - 128);
-                b = 1.164384 * (y0 - 16) + 2.115 * (u - 128);
-                // BT709 YUV data is full range, to RGB[0, 255]
-                // r = y0 + 1.5748 * (v - 128);
-                // g = y0 - 0.1873 * (u - 128) - 0.4681 * (v - 128);
-                // b = y0 + 1.8556 * (u - 128);
-                // BT2020 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y0 - 16) + 1.67867 * (v - 128);
-                // g = 1.164384 * (y0 - 16) - 0.65042 * (v - 128) - 0.187326 * (u - 128);
-                // b = 1.164384 * (y0 - 16) + 2.14177 * (u - 128);
-                // BT2020 YUV data is full range, to RGB[0, 255]
-                // r = y0 + 1.4746 * (v - 128)
-                // g = y0 - 0.164553 * (u - 128) - 0.571353 * (u - 128)
-                // b = y0 + 1.8814 * (u - 128)
-
-                r = r > 255 ? 255 : (r < 0 ? 0 : r);
-                g = g > 255 ? 255 : (g < 0 ? 0 : g);
-                b = b > 255 ? 255 : (b < 0 ? 0 : b);
-                rgba[0] = (uint8_t)r;
-                rgba[1] = (uint8_t)g;
-                rgba[2] = (uint8_t)b;
-                rgba[3] = 255;
-
-                // BT601 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y1 - 16) + 1.596 * (v - 128);
-                // g = 1.164384 * (y1 - 16) - 0.813 * (v - 128) - 0.391 * (u - 128);
-                // b = 1.164384 * (y1 - 16) + 2.018 * (u - 128);
-                // BT601 YUV data is full range, to RGB[0, 255]
-                // r = y1 + 1.402 * (v - 128);
-                // g = y1 - 0.344 * (u - 128) - 0.714 * (v - 128);
-                // b = y1 + 1.772 * (u - 128);
-                // BT709 YUV data is limited range, to RGB[0, 255]
-                r = 1.164384 * (y1 - 16) + 1.793 * (v - 128);
-                g = 1.164384 * (y1 - 16) - 0.534 * (v - 128) - 0.213 * (u - 128);
-                b = 1.164384 * (y1 - 16) + 2.115 * (u - 128);
-                // BT709 YUV data is full range, to RGB[0, 255]
-                // r = y1 + 1.5748 * (v - 128);
-                // g = y1 - 0.1873 * (u - 128) - 0.4681 * (v - 128);
-                // b = y1 + 1.8556 * (u - 128);
-                // BT2020 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y1 - 16) + 1.67867 * (v - 128);
-                // g = 1.164384 * (y1 - 16) - 0.65042 * (v - 128) - 0.187326 * (u - 128);
-                // b = 1.164384 * (y1 - 16) + 2.14177 * (u - 128);
-                // BT2020 YUV data is full range, to RGB[0, 255]
-                // r = y1 + 1.4746 * (v - 128)
-                // g = y1 - 0.164553 * (u - 128) - 0.571353 * (u - 128)
-                // b = y1 + 1.8814 * (u - 128)
-
-                r = r > 255 ? 255 : (r < 0 ? 0 : r);
-                g = g > 255 ? 255 : (g < 0 ? 0 : g);
-                b = b > 255 ? 255 : (b < 0 ? 0 : b);
-                rgba[4] = (uint8_t)r;
-                rgba[5] = (uint8_t)g;
-                rgba[6] = (uint8_t)b;
-                rgba[7] = 255;
-                yuyv += 4;
-                rgba += 8;
-                x += 2;
+                int y = (yuyv[i * 2] - 16) * YUV_KY;
+                uint8_t *o = dst + i * BPP;
+                o[RI] = _clamp_q6(y + rv);
+                o[GI] = _clamp_q6(y - guv);
+                o[BI] = _clamp_q6(y + bu);
+                if constexpr (AI >= 0)
+                    o[AI] = 255;
             }
         }
     }
 
-    // V4L2_PIX_FMT_YUYV to RGBA8888
-    static void yuyv422_to_bgra8888(void *src, void *dst, int width, int height)
+    template <int RI, int GI, int BI, int AI, int BPP>
+    static void _yuyv_to_rgb(const uint8_t *src, int src_stride, uint8_t *dst, int width, int height)
     {
-        uint8_t *rgba = (uint8_t *)dst;
-        uint8_t *yuyv = (uint8_t *)src;
-        uint8_t y0, u, y1, v;
-        float r, g, b;
+        #pragma omp parallel for
+        for (int y = 0; y < height; ++y)
+            _yuyv_row_to_rgb<RI, GI, BI, AI, BPP>(src + y * src_stride, dst + y * width * BPP, width);
+    }
 
+    static void _yuyv_to_gray(const uint8_t *src, int src_stride, uint8_t *dst, int width, int height)
+    {
         for (int y = 0; y < height; ++y)
         {
-            for (int x = 0; x < width;)
+            const uint8_t *row = src + y * src_stride;
+            uint8_t *out = dst + y * width;
+            int x = 0;
+#if CAMERA_USE_NEON
+            for (; x + 16 <= width; x += 16)
+                vst1q_u8(out + x, vld2q_u8(row + x * 2).val[0]);
+#elif CAMERA_USE_SSE
+            const __m128i mask_y = _mm_set1_epi16(0x00FF);
+            for (; x + 16 <= width; x += 16)
             {
-                y0 = yuyv[0];
-                u = yuyv[1];
-                y1 = yuyv[2];
-                v = yuyv[3];
-
-                // BT601 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y0 - 16) + 1.596 * (v - 128);
-                // g = 1.164384 * (y0 - 16) - 0.813 * (v - 128) - 0.391 * (u - 128);
-                // b = 1.164384 * (y0 - 16) + 2.018 * (u - 128);
-                // BT601 YUV data is full range, to RGB[0, 255]
-                // r = y0 + 1.402 * (v - 128);
-                // g = y0 - 0.344 * (u - 128) - 0.714 * (v - 128);
-                // b = y0 + 1.772 * (u - 128);
-                // BT709 YUV data is limited range, to RGB[0, 255]
-                r = 1.164384 * (y0 - 16) + 1.793 * (v - 128);
-                g = 1.164384 * (y0 - 16) - 0.534 * (v - 128) - 0.213 * (u - 128);
-                b = 1.164384 * (y0 - 16) + 2.115 * (u - 128);
-                // BT709 YUV data is full range, to RGB[0, 255]
-                // r = y0 + 1.5748 * (v - 128);
-                // g = y0 - 0.1873 * (u - 128) - 0.4681 * (v - 128);
-                // b = y0 + 1.8556 * (u - 128);
-                // BT2020 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y0 - 16) + 1.67867 * (v - 128);
-                // g = 1.164384 * (y0 - 16) - 0.65042 * (v - 128) - 0.187326 * (u - 128);
-                // b = 1.164384 * (y0 - 16) + 2.14177 * (u - 128);
-                // BT2020 YUV data is full range, to RGB[0, 255]
-                // r = y0 + 1.4746 * (v - 128)
-                // g = y0 - 0.164553 * (u - 128) - 0.571353 * (u - 128)
-                // b = y0 + 1.8814 * (u - 128)
-
-                r = r > 255 ? 255 : (r < 0 ? 0 : r);
-                g = g > 255 ? 255 : (g < 0 ? 0 : g);
-                b = b > 255 ? 255 : (b < 0 ? 0 : b);
-
-                rgba[0] = (uint8_t)b;
-                rgba[1] = (uint8_t)g;
-                rgba[2] = (uint8_t)r;
-                rgba[3] = 255;
-
-                // BT601 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y1 - 16) + 1.596 * (v - 128);
-                // g = 1.164384 * (y1 - 16) - 0.813 * (v - 128) - 0.391 * (u - 128);
-                // b = 1.164384 * (y1 - 16) + 2.018 * (u - 128);
-                // BT601 YUV data is full range, to RGB[0, 255]
-                // r = y1 + 1.402 * (v - 128);
-                // g = y1 - 0.344 * (u - 128) - 0.714 * (v - 128);
-                // b = y1 + 1.772 * (u - 128);
-                // BT709 YUV data is limited range, to RGB[0, 255]
-                r = 1.164384 * (y1 - 16) + 1.793 * (v - 128);
-                g = 1.164384 * (y1 - 16) - 0.534 * (v - 128) - 0.213 * (u - 128);
-                b = 1.164384 * (y1 - 16) + 2.115 * (u - 128);
-                // BT709 YUV data is full range, to RGB[0, 255]
-                // r = y1 + 1.5748 * (v - 128);
-                // g = y1 - 0.1873 * (u - 128) - 0.4681 * (v - 128);
-                // b = y1 + 1.8556 * (u - 128);
-                // BT2020 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y1 - 16) + 1.67867 * (v - 128);
-                // g = 1.164384 * (y1 - 16) - 0.65042 * (v - 128) - 0.187326 * (u - 128);
-                // b = 1.164384 * (y1 - 16) + 2.14177 * (u - 128);
-                // BT2020 YUV data is full range, to RGB[0, 255]
-                // r = y1 + 1.4746 * (v - 128)
-                // g = y1 - 0.164553 * (u - 128) - 0.571353 * (u - 128)
-                // b = y1 + 1.8814 * (u - 128)
-
-                r = r > 255 ? 255 : (r < 0 ? 0 : r);
-                g = g > 255 ? 255 : (g < 0 ? 0 : g);
-                b = b > 255 ? 255 : (b < 0 ? 0 : b);
-
-                rgba[4] = (uint8_t)b;
-                rgba[5] = (uint8_t)g;
-                rgba[6] = (uint8_t)r;
-                rgba[7] = 255;
-                yuyv += 4;
-                rgba += 8;
-                x += 2;
+                __m128i y0 = _mm_and_si128(_mm_loadu_si128((const __m128i *)(row + x * 2)), mask_y);
+                __m128i y1 = _mm_and_si128(_mm_loadu_si128((const __m128i *)(row + x * 2 + 16)), mask_y);
+                _mm_storeu_si128((__m128i *)(out + x), _mm_packus_epi16(y0, y1));
             }
+#endif
+            for (; x < width; ++x)
+                out[x] = row[x * 2];
         }
     }
 
-    static int convert_format(void *raw_buff, void *buff, uint32_t raw_format, int format, int width, int height)
+    // NV21 chroma is average of two YUYV rows
+    static void _yuyv_to_nv21(const uint8_t *src, int src_stride, uint8_t *dst, int width, int height)
     {
-        int ret = 0;
-
-        if (!(format == image::FMT_RGB888 || format == image::FMT_BGR888 ||
-              format == image::FMT_RGBA8888 || format == image::FMT_BGRA8888))
-            throw std::runtime_error("format not support");
-        if (raw_format != V4L2_PIX_FMT_YUYV)
-            throw std::runtime_error("raw format not support");
-
-        if (raw_format == V4L2_PIX_FMT_YUYV)
+        uint8_t *dst_vu = dst + width * height;
+        #pragma omp parallel for
+        for (int y = 0; y < height; y += 2)
         {
-            switch (format)
+            const uint8_t *row0 = src + y * src_stride;
+            const uint8_t *row1 = y + 1 < height ? row0 + src_stride : row0;
+            uint8_t *y0 = dst + y * width;
+            uint8_t *y1 = y + 1 < height ? y0 + width : y0;
+            uint8_t *vu = dst_vu + (y / 2) * width;
+            int x = 0;
+#if CAMERA_USE_NEON
+            for (; x + 16 <= width; x += 16)
+            {
+                // val[0]: Y, val[1]: U V U V ...
+                uint8x16x2_t p0 = vld2q_u8(row0 + x * 2);
+                uint8x16x2_t p1 = vld2q_u8(row1 + x * 2);
+                vst1q_u8(y0 + x, p0.val[0]);
+                vst1q_u8(y1 + x, p1.val[0]);
+                vst1q_u8(vu + x, vrev16q_u8(vrhaddq_u8(p0.val[1], p1.val[1])));
+            }
+#elif CAMERA_USE_SSE
+            const __m128i mask_y = _mm_set1_epi16(0x00FF);
+            for (; x + 16 <= width; x += 16)
+            {
+                __m128i a0 = _mm_loadu_si128((const __m128i *)(row0 + x * 2));
+                __m128i a1 = _mm_loadu_si128((const __m128i *)(row0 + x * 2 + 16));
+                __m128i b0 = _mm_loadu_si128((const __m128i *)(row1 + x * 2));
+                __m128i b1 = _mm_loadu_si128((const __m128i *)(row1 + x * 2 + 16));
+                _mm_storeu_si128((__m128i *)(y0 + x), _mm_packus_epi16(_mm_and_si128(a0, mask_y), _mm_and_si128(a1, mask_y)));
+                _mm_storeu_si128((__m128i *)(y1 + x), _mm_packus_epi16(_mm_and_si128(b0, mask_y), _mm_and_si128(b1, mask_y)));
+                // U V U V ... of 16 pixels, average two rows, then swap to V U
+                __m128i uv = _mm_avg_epu8(_mm_packus_epi16(_mm_srli_epi16(a0, 8), _mm_srli_epi16(a1, 8)),
+                                          _mm_packus_epi16(_mm_srli_epi16(b0, 8), _mm_srli_epi16(b1, 8)));
+                _mm_storeu_si128((__m128i *)(vu + x), _mm_or_si128(_mm_slli_epi16(uv, 8), _mm_srli_epi16(uv, 8)));
+            }
+#endif
+            for (; x + 2 <= width; x += 2)
             {
-            case image::FMT_RGB888:
-                yuyv422_to_rgb888(raw_buff, buff, width, height);
-                break;
-            case image::FMT_BGR888:
-                yuyv422_to_bgr888(raw_buff, buff, width, height);
-                break;
-            case image::FMT_RGBA8888:
-                yuyv422_to_rgba8888(raw_buff, buff, width, height);
-                break;
-            case image::FMT_BGRA8888:
-                yuyv422_to_bgra8888(raw_buff, buff, width, height);
-                break;
-            default:
-                ret = EINVAL;
-                break;
+                const uint8_t *a = row0 + x * 2;
+                const uint8_t *b = row1 + x * 2;
+                y0[x] = a[0];
+                y0[x + 1] = a[2];
+                y1[x] = b[0];
+                y1[x + 1] = b[2];
+                vu[x] = (a[3] + b[3] + 1) >> 1;
+                vu[x + 1] = (a[1] + b[1] + 1) >> 1;
             }
         }
+    }
 
-        return ret;
+    static int convert_format(const uint8_t *raw_buff, int raw_stride, uint8_t *buff, uint32_t raw_format, image::Format format, int width, int height)
+    {
+        if (raw_format != V4L2_PIX_FMT_YUYV)
+        {
+            log::error("raw format 0x%x convert not support\n", raw_format);
+            return EINVAL;
+        }
+        switch (format)
+        {
+        case image::FMT_RGB888:
+            _yuyv_to_rgb<0, 1, 2, -1, 3>(raw_buff, raw_stride, buff, width, height);
+            break;
+        case image::FMT_BGR888:
+            _yuyv_to_rgb<2, 1, 0, -1, 3>(raw_buff, raw_stride, buff, width, height);
+            break;
+        case image::FMT_RGBA8888:
+            _yuyv_to_rgb<0, 1, 2, 3, 4>(raw_buff, raw_stride, buff, width, height);
+            break;
+        case image::FMT_BGRA8888:
+            _yuyv_to_rgb<2, 1, 0, 3, 4>(raw_buff, raw_stride, buff, width, height);
+            break;
+        case image::FMT_GRAYSCALE:
+            _yuyv_to_gray(raw_buff, raw_stride, buff, width, height);
+            break;
+        case image::FMT_YVU420SP:
+            _yuyv_to_nv21(raw_buff, raw_stride, buff, width, height);
+            break;
+        default:
+            log::error("convert YUYV to %s not support\n", image::fmt_names[format].c_str());
+            return EINVAL;
+        }
+        return 0;
     }
 
     static bool set_regs_flag = false;
@@ -505,15 +380,10 @@ namespace maix::camera
             this->width = width;
             this->height = height;
             this->buffer_num = buff_num;
-            for (int i = 0; i < buff_num; i++)
-            {
-                buffers.push_back(NULL);
-                buffers_len.push_back(0);
-            }
             fd = -1;
-            queue_id = -1;
-            buff = NULL;
-            buff_alloc = false;
+            raw_format = 0;
+            stride = 0;
+            fps_by_driver = false;
         }
 
         CameraV4L2(const std::string device, int ch, int width, int height, image::Format format, int buff_num)
@@ -528,15 +398,12 @@ namespace maix::camera
 
         bool is_support_format(image::Format format)
         {
-            // auto convert in read, so always support formats
-            return true;
+            // auto convert in read
+            return _is_support_format(format);
         }
 
-        err::Err open(int width, int height, image::Format format, int buff_num)
+        err::Err open(int width, int height, image::Format format, double fps, int buff_num)
         {
-            struct v4l2_capability cap;
-            struct v4l2_format fmt;
-
             if (fd >= 0)
             {
                 log::error("Already open\n");
@@ -549,12 +416,290 @@ namespace maix::camera
             this->height = height > 0 ? height : this->height;
             this->buffer_num = buff_num;
 
-            fd = ::open(device.c_str(), O_RDWR | O_NONBLOCK, 0);
+            fd = ::open(device.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC, 0);
             if (fd == -1)
             {
                 log::error("open device %s failed\n", device.c_str());
                 return err::ERR_ARGS;
             }
+            err::Err e = _open(fps);
+            if (e != err::ERR_NONE)
+                close();
+            return e;
+        }
+
+        // read one frame, convert or copy to buff or new alloc image, driver buffer queue back immediately
+        image::Image *read(void *buff = NULL, size_t buff_size = 0, int timeout_ms = -1)
+        {
+            if (fd < 0)
+            {
+                log::error("Camera not open\n");
+                return NULL;
+            }
+            int need_size = image::fmt_size[format] * width * height;
+            if (buff && buff_size > 0 && buff_size < (size_t)need_size)
+            {
+                log::error("buff size %zu too small, need %d\n", buff_size, need_size);
+                return NULL;
+            }
+            // alloc output first, so driver buffer always queue back after dequeued
+            image::Image *img;
+            if (buff)
+                img = new image::Image(width, height, format, (uint8_t *)buff, -1, false);
+            else
+                img = new image::Image(width, height, format);
+
+            uint64_t pts_us;
+            int index = _dequeue(timeout_ms, &pts_us);
+            if (index < 0)
+            {
+                delete img;
+                return NULL;
+            }
+            const uint8_t *raw = (const uint8_t *)bufs->addrs[index];
+            int ret = 0;
+            if (need_convert_format(raw_format, format))
+            {
+                ret = convert_format(raw, stride, (uint8_t *)img->data(), raw_format, format, width, height);
+            }
+            else
+            {
+                bool semi_planar = format == image::FMT_YVU420SP || format == image::FMT_YUV420SP;
+                int line_size = semi_planar ? width : width * (int)image::fmt_size[format];
+                int rows = semi_planar ? height * 3 / 2 : height;
+                if (line_size == stride)
+                {
+                    memcpy(img->data(), raw, line_size * rows);
+                }
+                else
+                {
+                    for (int i = 0; i < rows; ++i)
+                        memcpy((uint8_t *)img->data() + i * line_size, raw + i * stride, line_size);
+                }
+            }
+            if (bufs->queue(index) < 0)
+                log::error("ERR(%s):VIDIOC_QBUF failed\n", __func__);
+            if (ret != 0)
+            {
+                delete img;
+                return NULL;
+            }
+            return img;
+        } // read
+
+        /**
+         * Lease driver buffer without copy, buffer queue back to driver after frame released.
+         * Only valid when camera output raw format same as image format.
+         */
+        pipeline::Frame *pop(int timeout_ms)
+        {
+            if (fd < 0)
+            {
+                log::error("Camera not open\n");
+                return NULL;
+            }
+            if (need_convert_format(raw_format, format))
+            {
+                log::error("camera raw format 0x%x is not %s, can not pop without convert, use read instead\n", raw_format, image::fmt_names[format].c_str());
+                return NULL;
+            }
+            uint64_t pts_us;
+            int index = _dequeue(timeout_ms, &pts_us);
+            if (index < 0)
+                return NULL;
+            _V4L2_Frame *frame = new _V4L2_Frame(std::make_shared<_V4L2_Lease>(bufs, index, width, height, stride, format, pts_us));
+            return new pipeline::Frame(frame, true, "v4l2");
+        }
+
+        void close()
+        {
+            if (fd >= 0)
+            {
+                enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+                if (bufs)
+                {
+                    std::lock_guard<std::mutex> guard(bufs->lock);
+                    bufs->streaming = false;
+                }
+                if (ioctl(fd, VIDIOC_STREAMOFF, &type) < 0)
+                    log::error("ERR(%s):VIDIOC_STREAMOFF failed\n", __func__);
+                // buffers unmap after all leased frames released
+                bufs.reset();
+                ::close(fd);
+                fd = -1;
+            }
+            fps_by_driver = false;
+        }
+
+        camera::CameraV4L2 *add_channel(int width, int height, image::Format forma, int buff_num)
+        {
+            return NULL;
+        }
+
+        void clear_buff()
+        {
+            if (fd < 0)
+                return;
+            // VIDIOC_DQBUF all ready buffers and queue them back
+            std::vector<int> indexes;
+            struct v4l2_buffer buffer;
+            while (1)
+            {
+                memset(&buffer, 0, sizeof(struct v4l2_buffer));
+                buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+                buffer.memory = V4L2_MEMORY_MMAP;
+                if (ioctl(fd, VIDIOC_DQBUF, &buffer) < 0)
+                    break;
+                indexes.push_back(buffer.index);
+            }
+            for (int index : indexes)
+            {
+                if (bufs->queue(index) < 0)
+                {
+                    log::error("ERR(%s):VIDIOC_QBUF failed\n", __func__);
+                    return;
+                }
+            }
+        }
+
+        bool is_opened()
+        {
+            return fd >= 0;
+        }
+
+        // driver accepted frame rate setting, poll will block until next frame, no need to pace by software
+        bool is_fps_by_driver()
+        {
+            return fps_by_driver;
+        }
+
+        int get_ch_nums()
+        {
+            return 1;
+        }
+
+        int get_channel() {
+            return 0;
+        }
+
+        int hmirror(int en)
+        {
+            return -1;
+        }
+
+        int vflip(int en)
+        {
+            return -1;
+        }
+
+        int luma(int value)
+        {
+            return -1;
+        }
+
+        int constrast(int value)
+        {
+            return -1;
+        }
+
+        int saturation(int value)
+        {
+            return -1;
+        }
+
+        int exposure(int value)
+        {
+            return -1;
+        }
+
+        int gain(int value)
+        {
+            return -1;
+        }
+
+        AwbMode awb_mode(AwbMode value)
+        {
+            return AwbMode::Invalid;
+        }
+
+        int set_awb(int value)
+        {
+            return -1;
+        }
+
+        std::vector<float> set_wb_gain(std::vector<float> gains) {
+            return std::vector<float>();
+        }
+
+        AeMode exp_mode(AeMode value)
+        {
+            return AeMode::Invalid;
+        }
+
+        int set_windowing(std::vector<int> roi)
+        {
+            return -1;
+        }
+    private:
+        std::string device;
+        image::Format format;
+        int fd;
+        uint32_t raw_format;
+        std::shared_ptr<_V4L2_Buffers> bufs;
+        int buffer_num;
+        int width;
+        int height;
+        int stride;         // bytes per line of raw frame
+        bool fps_by_driver;
+
+        /**
+         * Wait and dequeue one filled buffer
+         * @param timeout_ms -1 means block until frame ready, 0 means not block
+         * @return buffer index, < 0 if no frame
+         */
+        int _dequeue(int timeout_ms, uint64_t *pts_us)
+        {
+            struct pollfd poll_fds[1];
+            poll_fds[0].fd = fd;
+            poll_fds[0].events = POLLIN; // 等待可读
+            int ret;
+            do
+            {
+                ret = poll(poll_fds, 1, timeout_ms);
+            } while (ret < 0 && errno == EINTR);
+            if (ret == 0)
+            {
+                if (timeout_ms != 0)
+                    log::error("ERR(%s):wait frame timeout\n", __func__);
+                return -ETIMEDOUT;
+            }
+            if (ret < 0)
+            {
+                log::error("ERR(%s):poll failed: %d\n", __func__, errno);
+                return -errno;
+            }
+
+            struct v4l2_buffer buffer;
+            memset(&buffer, 0, sizeof(buffer));
+            buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buffer.memory = V4L2_MEMORY_MMAP;
+            if (ioctl(fd, VIDIOC_DQBUF, &buffer) < 0)
+            {
+                if (errno == EINVAL)
+                    log::error("ERR(%s):VIDIOC_DQBUF failed, no buffer in driver, release popped frames first\n", __func__);
+                else
+                    log::error("ERR(%s):VIDIOC_DQBUF failed, dropped frame\n", __func__);
+                return -errno;
+            }
+            *pts_us = (uint64_t)buffer.timestamp.tv_sec * 1000000 + buffer.timestamp.tv_usec;
+            return buffer.index;
+        }
+
+        err::Err _open(double fps)
+        {
+            struct v4l2_capability cap;
+            struct v4l2_format fmt;
+
             if (-1 == xioctl(fd, VIDIOC_QUERYCAP, &cap))
             {
                 if (EINVAL == errno)
@@ -575,22 +720,11 @@ namespace maix::camera
                 log::error("%s is no video capture device\n", device.c_str());
                 return err::ERR_ARGS;
             }
-
-            if (!(cap.capabilities & (V4L2_CAP_VIDEO_CAPTURE | V4L2_CAP_READWRITE | V4L2_CAP_STREAMING)))
+            if (!(cap.capabilities & V4L2_CAP_STREAMING))
             {
-                log::error("%s does not support read i/o\n", device.c_str());
+                log::error("%s does not support streaming i/o\n", device.c_str());
                 return err::ERR_NOT_PERMIT;
             }
-            if (cap.capabilities & V4L2_CAP_VIDEO_CAPTURE)
-                log::debug("v4l2 dev support capture\n");
-            if (cap.capabilities & V4L2_CAP_VIDEO_OUTPUT)
-                log::debug("v4l2 dev support output\n");
-            if (cap.capabilities & V4L2_CAP_VIDEO_OVERLAY)
-                log::debug("v4l2 dev support overlay\n");
-            if (cap.capabilities & V4L2_CAP_STREAMING)
-                log::debug("v4l2 dev support streaming\n");
-            if (cap.capabilities & V4L2_CAP_READWRITE)
-                log::debug("v4l2 dev support read write\n");
 
             struct v4l2_input input;
 
@@ -630,13 +764,12 @@ namespace maix::camera
                 // get resolution
                 memset(&frmsize, 0, sizeof(frmsize));
                 frmsize.pixel_format = fmtdesc.pixelformat;
-                frmsize.index = fmtdesc.index;
+                frmsize.index = 0;
                 if (-1 == xioctl(fd, VIDIOC_ENUM_FRAMESIZES, &frmsize))
                 {
                     log::error("VIDIOC_ENUM_FRAMESIZES error: %d\n", errno);
                     return err::ERR_RUNTIME;
                 }
-                // printf("frmsize.type: %d, frmsize.discrete: %d %d, frmsize.stepwise: %d %d\n", frmsize.type, frmsize.discrete.width, frmsize.discrete.height, frmsize.stepwise.max_width, frmsize.stepwise.max_height);
                 if (frmsize.type == V4L2_FRMSIZE_TYPE_DISCRETE)
                 {
                     log::debug("type DISCRETE: %dx%d\n",
@@ -645,17 +778,9 @@ namespace maix::camera
                     frame_size.w = frmsize.discrete.width;
                     frame_size.h = frmsize.discrete.height;
                 }
-                else if (frmsize.type == V4L2_FRMSIZE_TYPE_STEPWISE)
-                {
-                    log::debug("type STEPWISE: %dx%d\n",
-                               frmsize.stepwise.max_width,
-                               frmsize.stepwise.max_height);
-                    frame_size.w = frmsize.stepwise.max_width;
-                    frame_size.h = frmsize.stepwise.max_height;
-                }
                 else
                 {
-                    log::debug("type CONTINUOUS: %dx%d\n",
+                    log::debug("type %s: %dx%d\n", frmsize.type == V4L2_FRMSIZE_TYPE_STEPWISE ? "STEPWISE" : "CONTINUOUS",
                                frmsize.stepwise.max_width,
                                frmsize.stepwise.max_height);
                     frame_size.w = frmsize.stepwise.max_width;
@@ -667,6 +792,11 @@ namespace maix::camera
             }
             log::debug("supported fmts num: %ld\n", fmts.size());
             int format_idx = choose_format(format, fmts);
+            if (format_idx < 0)
+            {
+                log::error("camera not support output %s or YUYV format\n", image::fmt_names[format].c_str());
+                return err::ERR_ARGS;
+            }
             log::debug("choose format idx: %d\n", format_idx);
             raw_format = fmts[format_idx];
             max_frame_size = frame_sizes[format_idx];
@@ -675,64 +805,6 @@ namespace maix::camera
             if (height <= 0)
                 height = max_frame_size.h;
 
-            // crop VIDIOC_CROPCAP
-            // struct v4l2_cropcap cropcap;
-            // struct v4l2_crop crop;
-            // // TODO: resize crop by driver(if driver support)
-            // //  int w_resize = 0, h_resize = 0;
-            // //  w_resize = 1.0 *  height / max_frame_size.h * max_frame_size.w;
-            // //  printf("w_resize: %d, h_resize: %d\n", w_resize, h_resize);
-
-            // memset(&cropcap, 0, sizeof(cropcap));
-            // cropcap.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-
-            // if (0 == xioctl(fd, VIDIOC_CROPCAP, &cropcap))
-            // {
-            //     // cropcap's value will be the last time set by VIDIOC_S_CROP
-            //     log::debug("cropcap: %d %d %d %d, defrect: %d %d %d %d\n", cropcap.bounds.left, cropcap.bounds.top, cropcap.bounds.width, cropcap.bounds.height,
-            //         cropcap.defrect.left, cropcap.defrect.top, cropcap.defrect.width, cropcap.defrect.height);
-            //     memset(&crop, 0, sizeof(crop));
-            //     crop.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-            //     if (-1 == xioctl(fd, VIDIOC_G_CROP, &crop))
-            //     {
-            //         log::warn("VIDIOC_G_CROP error: %d\n", errno);
-            //         switch (errno)
-            //         {
-            //         case EINVAL:
-            //             log::warn("crop not supported on this camera driver\n");
-            //             /* Cropping not supported. */
-            //             break;
-            //         default:
-            //             /* Errors ignored. */
-            //             break;
-            //         }
-            //     }
-
-            //     // // crop.c = cropcap.defrect; /* reset to default */
-            //     // crop.c.left = (w_resize - width) / 2;
-            //     // crop.c.top = 0;
-            //     // crop.c.width = width;
-            //     // crop.c.height = height;
-
-            //     // if (-1 == xioctl(cam->fd, VIDIOC_S_CROP, &crop))
-            //     // {
-            //     //     printf("VIDIOC_S_CROP error: %d\n", errno);
-            //     //     switch (errno)
-            //     //     {
-            //     //     case EINVAL:
-            //     //         /* Cropping not supported. */
-            //     //         break;
-            //     //     default:
-            //     //         /* Errors ignored. */
-            //     //         break;
-            //     //     }
-            //     // }
-            // }
-            // else
-            // {
-            //     /* Errors ignored. */
-            // }
-
             memset(&fmt, 0, sizeof(fmt));
             fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
             fmt.fmt.pix.width = width;
@@ -749,7 +821,7 @@ namespace maix::camera
             fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
             if (-1 == xioctl(fd, VIDIOC_G_FMT, &fmt))
             {
-                log::error("VIDIOC_S_FMT error: %d\n", errno);
+                log::error("VIDIOC_G_FMT error: %d\n", errno);
                 return err::ERR_RUNTIME;
             }
             if ((int)fmt.fmt.pix.width != width || (int)fmt.fmt.pix.height != height || fmt.fmt.pix.pixelformat != raw_format)
@@ -758,10 +830,30 @@ namespace maix::camera
                            width, height, raw_format, fmt.fmt.pix.width, fmt.fmt.pix.height, fmt.fmt.pix.pixelformat);
                 return err::ERR_ARGS;
             }
+            stride = fmt.fmt.pix.bytesperline;
+            if (stride <= 0)
+                stride = raw_format == V4L2_PIX_FMT_YUYV ? width * 2 : width * (int)image::fmt_size[format];
+
+            // set frame rate to driver, so poll wait frame in driver's pace
+            struct v4l2_streamparm parm;
+            memset(&parm, 0, sizeof(parm));
+            parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            if (fps > 0 && xioctl(fd, VIDIOC_G_PARM, &parm) == 0 && (parm.parm.capture.capability & V4L2_CAP_TIMEPERFRAME))
+            {
+                parm.parm.capture.timeperframe.numerator = 1000;
+                parm.parm.capture.timeperframe.denominator = (uint32_t)(fps * 1000);
+                if (xioctl(fd, VIDIOC_S_PARM, &parm) == 0 && parm.parm.capture.timeperframe.numerator > 0)
+                {
+                    double real_fps = (double)parm.parm.capture.timeperframe.denominator / parm.parm.capture.timeperframe.numerator;
+                    log::debug("driver fps: %.2f\n", real_fps);
+                    // driver may choose a near fps it support, still pace by software if it's faster than we want
+                    fps_by_driver = real_fps <= fps + 0.5;
+                }
+            }
 
             // set buffer
-            struct v4l2_requestbuffers req = {0};
-
+            struct v4l2_requestbuffers req;
+            memset(&req, 0, sizeof(req));
             req.count = buffer_num;
             req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
             req.memory = V4L2_MEMORY_MMAP;
@@ -773,12 +865,13 @@ namespace maix::camera
             }
             if (req.count < (size_t)buffer_num)
             {
-                /* You may need to free the buffers here. */
-                log::error("Not enough buffer memory\\n");
+                log::error("Not enough buffer memory\n");
                 return err::ERR_NO_MEM;
             }
 
             // map address
+            bufs = std::make_shared<_V4L2_Buffers>();
+            bufs->fd = fd;
             struct v4l2_buffer v4l2_buffer;
             int i = 0;
             int ret = 0;
@@ -799,30 +892,22 @@ namespace maix::camera
                 }
 
                 /* 映射 */
-                buffers[i] = mmap(NULL /* start anywhere */,
+                void *addr = mmap(NULL /* start anywhere */,
                                   v4l2_buffer.length, PROT_READ | PROT_WRITE, MAP_SHARED,
                                   fd, v4l2_buffer.m.offset);
-                buffers_len[i] = v4l2_buffer.length;
-                if (buffers[i] == MAP_FAILED)
+                if (addr == MAP_FAILED)
                 {
-                    /* If you do not exit here you should unmap() and free()
-                    the buffers mapped so far. */
-                    for (int j = 0; j < i; j++)
-                        munmap(buffers[j], buffers_len[j]);
                     log::error("Unable to map buffer.\n");
                     return err::ERR_NO_MEM;
                 }
-                log::debug("buffer %d: %p, len: %d, offset: %u\n", i, buffers[i], buffers_len[i], v4l2_buffer.m.offset);
+                bufs->addrs.push_back(addr);
+                bufs->lens.push_back(v4l2_buffer.length);
+                log::debug("buffer %d: %p, len: %d, offset: %u\n", i, addr, v4l2_buffer.length, v4l2_buffer.m.offset);
             }
+            bufs->streaming = true;
             for (i = 0; i < buffer_num; i++)
             {
-                memset(&v4l2_buffer, 0, sizeof(struct v4l2_buffer));
-                v4l2_buffer.index = i; // 想要放入队列的缓存
-                v4l2_buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-                v4l2_buffer.memory = V4L2_MEMORY_MMAP;
-
-                ret = ioctl(fd, VIDIOC_QBUF, &v4l2_buffer);
-                if (ret < 0)
+                if (bufs->queue(i) < 0)
                 {
                     log::error("Unable to queue buffer.\n");
                     return err::ERR_RUNTIME;
@@ -838,236 +923,7 @@ namespace maix::camera
             }
 
             return err::ERR_NONE;
-        } // open
-
-        // read
-        image::Image *read(void *buff = NULL, size_t buff_size = 0)
-        {
-            struct v4l2_buffer v4l2_buf;
-            if (!buff)
-                buff = this->buff;
-            if (fd < 0)
-            {
-                log::error("Camera not open\n");
-                return NULL;
-            }
-            //
-            if (queue_id >= 0)
-            {
-                memset(&v4l2_buf, 0, sizeof(struct v4l2_buffer));
-                v4l2_buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-                v4l2_buf.memory = V4L2_MEMORY_MMAP;
-                v4l2_buf.index = queue_id;
-                if (ioctl(fd, VIDIOC_QBUF, &v4l2_buf) < 0)
-                {
-                    log::error("ERR(%s):VIDIOC_QBUF failed\n", __func__);
-                    queue_id = -1;
-                    return NULL;
-                }
-                queue_id = -1;
-            }
-
-            struct pollfd poll_fds[1];
-
-            poll_fds[0].fd = fd;
-            poll_fds[0].events = POLLIN; // 等待可读
-
-            poll(poll_fds, 1, 10000);
-
-            struct v4l2_buffer buffer = {0};
-
-            buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-            buffer.memory = V4L2_MEMORY_MMAP;
-
-            if (ioctl(fd, VIDIOC_DQBUF, &buffer) < 0)
-            {
-                log::error("ERR(%s):VIDIOC_DQBUF failed, dropped frame\n", __func__);
-                return NULL;
-            }
-
-            if (need_convert_format(raw_format, format))
-            {
-                if (!buff)
-                {
-                    buff = alloc_buffer(width, height, format);
-                    if (!buff)
-                    {
-                        log::error("alloc buffer failed\n");
-                        return NULL;
-                    }
-                    this->buff = buff;
-                    buff_alloc = true;
-                }
-                convert_format(buffers[buffer.index], buff, raw_format, format, width, height);
-
-                // release buffer
-                memset(&v4l2_buf, 0, sizeof(struct v4l2_buffer));
-                v4l2_buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-                v4l2_buf.memory = V4L2_MEMORY_MMAP;
-                v4l2_buf.index = buffer.index;
-
-                if (ioctl(fd, VIDIOC_QBUF, &v4l2_buf) < 0)
-                {
-                    log::error("ERR(%s):VIDIOC_QBUF 2 failed\n", __func__);
-                    return NULL;
-                }
-                return new image::Image(width, height, format, (uint8_t *)buff, -1, true);
-            }
-            else
-            {
-                queue_id = buffer.index;
-                return new image::Image(width, height, format, (uint8_t *)buffers[buffer.index], -1, true);
-            }
-        } // read
-
-        void close()
-        {
-            enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-            if (fd >= 0)
-            {
-                if (ioctl(fd, VIDIOC_STREAMOFF, &type) < 0)
-                {
-                    log::error("ERR(%s):VIDIOC_STREAMOFF failed\n", __func__);
-                    return;
-                }
-                for (int i = 0; i < buffer_num; ++i)
-                    munmap(buffers[i], buffers_len[i]);
-                ::close(fd);
-                fd = -1;
-            }
-            if (buff_alloc)
-            {
-                free(buff);
-                buff = NULL;
-            }
-            _is_opened = false;
-        }
-
-        camera::CameraV4L2 *add_channel(int width, int height, image::Format forma, int buff_num)
-        {
-            return NULL;
-        }
-
-        void clear_buff()
-        {
-            // VIDIOC_DQBUF all buffer
-            struct v4l2_buffer buffer;
-            buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-            buffer.memory = V4L2_MEMORY_MMAP;
-            while (ioctl(fd, VIDIOC_DQBUF, &buffer) >= 0)
-            {
-                memset(&buffer, 0, sizeof(struct v4l2_buffer));
-                buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-                buffer.memory = V4L2_MEMORY_MMAP;
-            }
-            // VIDIOC_QBUF all buffer
-            for (int i = 0; i < buffer_num; ++i)
-            {
-                memset(&buffer, 0, sizeof(struct v4l2_buffer));
-                buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-                buffer.memory = V4L2_MEMORY_MMAP;
-                buffer.index = i;
-                if (ioctl(fd, VIDIOC_QBUF, &buffer) < 0)
-                {
-                    log::error("ERR(%s):VIDIOC_QBUF failed\n", __func__);
-                    return;
-                }
-            }
-        }
-
-        bool is_opened()
-        {
-            if (fd >= 2)
-            {
-                return true;
-            }
-            else
-            {
-                return false;
-            }
-        }
-
-        int get_ch_nums()
-        {
-            return 1;
-        }
-
-        int get_channel() {
-            return 0;
-        }
-
-        int hmirror(int en)
-        {
-            return -1;
-        }
-
-        int vflip(int en)
-        {
-            return -1;
-        }
-
-        int luma(int value)
-        {
-            return -1;
-        }
-
-        int constrast(int value)
-        {
-            return -1;
-        }
-
-        int saturation(int value)
-        {
-            return -1;
-        }
-
-        int exposure(int value)
-        {
-            return -1;
-        }
-
-        int gain(int value)
-        {
-            return -1;
-        }
-
-        AwbMode awb_mode(AwbMode value)
-        {
-            return AwbMode::Invalid;
-        }
-
-        int set_awb(int value)
-        {
-            return -1;
-        }
-
-        std::vector<float> set_wb_gain(std::vector<float> gains) {
-            return std::vector<float>();
-        }
-
-        AeMode exp_mode(AeMode value)
-        {
-            return AeMode::Invalid;
-        }
-
-        int set_windowing(std::vector<int> roi)
-        {
-            return -1;
-        }
-    private:
-        std::string device;
-        image::Format format;
-        int fd;
-        uint32_t raw_format;
-        std::vector<void *> buffers;
-        std::vector<int> buffers_len;
-        int buffer_num;
-        int queue_id; // user directly used buffer id
-        int width;
-        int height;
-        void *buff;
-        bool buff_alloc;
-        bool _is_opened;
+        } // _open
     };
 
     std::vector<std::string> list_devices()
@@ -1168,7 +1024,6 @@ namespace maix::camera
         return device_name;
     }
 
-    static CameraV4L2 *_impl;
     Camera::Camera(int width, int height, image::Format format, const char *device, double fps, int buff_num, bool open, bool raw)
     {
         err::Err e;
@@ -1193,7 +1048,7 @@ namespace maix::camera
         } else {
             _device = _get_device(NULL);
         }
-        _impl = new CameraV4L2(_device, _width, _height, _format, _buff_num);
+        _param = new CameraV4L2(_device, _width, _height, _format, _buff_num);
 
 
         if (open) {
@@ -1207,7 +1062,8 @@ namespace maix::camera
         if (this->is_opened()) {
             this->close();
         }
-        delete (CameraV4L2*)_impl;
+        delete (CameraV4L2*)_param;
+        _param = NULL;
     }
 
     int Camera::get_ch_nums()
@@ -1217,6 +1073,7 @@ namespace maix::camera
 
     int Camera::get_channel()
     {
+        CameraV4L2 *_impl = (CameraV4L2 *)_param;
         if (_impl == NULL)
             return err::ERR_NOT_INIT;
 
@@ -1239,6 +1096,7 @@ namespace maix::camera
 
     err::Err Camera::open(int width, int height, image::Format format, double fps, int buff_num)
     {
+        CameraV4L2 *_impl = (CameraV4L2 *)_param;
         if (_impl == NULL)
             return err::Err::ERR_RUNTIME;
 
@@ -1283,7 +1141,8 @@ namespace maix::camera
                 return err::ERR_ARGS;
         }
 
-        auto ret =  _impl->open(_width, _height, _format_impl, _buff_num);;
+        auto ret =  _impl->open(_width, _height, _format_impl, _fps, _buff_num);
+        _last_read_us = 0;
         if(ret == err::ERR_NONE)
         {
             _is_opened = true;
@@ -1295,6 +1154,10 @@ namespace maix::camera
     {
         if (this->is_closed())
             return;
+        CameraV4L2 *_impl = (CameraV4L2 *)_param;
+        if (_impl)
+            _impl->close();
+        _is_opened = false;
     }
 
     camera::Camera *Camera::add_channel(int width, int height, image::Format format, double fps, int buff_num, bool open)
@@ -1309,58 +1172,64 @@ namespace maix::camera
 
     image::Image *Camera::read(void *buff, size_t buff_size, bool block, int block_ms)
     {
-        (void)block_ms;
         if (!this->is_opened()) {
-            err::Err e = open(_width, _height, _format, _buff_num);
+            err::Err e = open(_width, _height, _format, _fps, _buff_num);
             err::check_raise(e, "open camera failed");
         }
+        CameraV4L2 *_impl = (CameraV4L2 *)_param;
 
         if (_show_colorbar) {
             image::Image *img = new image::Image(_width, _height);
             generate_colorbar(*img);
             err::check_null_raise(img, "camera read failed");
             return img;
-        } else {
-            // it's better all done by impl to faster read, but if impl not support, we have to convert it
-            if(_format_impl == _format)
-            {
-                image::Image *img = _impl->read(buff, buff_size);
+        }
+        image::Image *img;
+        int timeout_ms = block ? block_ms : 0;
+        // it's better all done by impl to faster read, but if impl not support, we have to convert it
+        if(_format_impl == _format)
+        {
+            img = _impl->read(buff, buff_size, timeout_ms);
+        }
+        else
+        {
+            image::Image *img_impl = _impl->read(NULL, 0, timeout_ms);
+            img = img_impl ? img_impl->to_format(_format, buff, buff_size) : NULL;
+            delete img_impl;
+        }
+        if (!img)
+        {
+            if (block)
                 err::check_null_raise(img, "camera read failed");
+            return NULL;
+        }
 
-                // FIXME: delete me and fix driver bug
-                uint64_t wait_us = 1000000 / _fps;
-                while (time::ticks_us() - _last_read_us < wait_us) {
-                    time::sleep_us(50);
-                }
-                _last_read_us = time::ticks_us();
-                return img;
-            }
-            else
-            {
-                image::Image *img = _impl->read();
-                image::Image *img2 = img->to_format(_format, buff, buff_size);
-                delete img;
-                err::check_null_raise(img2, "camera read failed");
-
-                // FIXME: delete me and fix driver bug
-                uint64_t wait_us = 1000000 / _fps;
-                while (time::ticks_us() - _last_read_us < wait_us) {
-                    time::sleep_us(50);
-                }
-                _last_read_us = time::ticks_us();
-                return img2;
-            }
+        // poll already wait frame in driver's fps, only sleep to pace if driver not support set fps
+        if (!_impl->is_fps_by_driver() && _fps > 0)
+        {
+            uint64_t wait_us = 1000000 / _fps;
+            uint64_t t = time::ticks_us() - _last_read_us;
+            if (_last_read_us > 0 && t < wait_us)
+                time::sleep_us(wait_us - t);
         }
+        _last_read_us = time::ticks_us();
+        return img;
     }
 
     pipeline::Frame *Camera::pop(int block_ms) {
-        err::check_raise(err::ERR_NOT_IMPL, "This function is not implemented");
-        return nullptr;
+        if (!this->is_opened()) {
+            err::Err e = open(_width, _height, _format, _fps, _buff_num);
+            err::check_raise(e, "open camera failed");
+        }
+        CameraV4L2 *_impl = (CameraV4L2 *)_param;
+        return _impl->pop(block_ms);
     }
 
     void Camera::clear_buff()
     {
-
+        CameraV4L2 *_impl = (CameraV4L2 *)_param;
+        if (_impl && this->is_opened())
+            _impl->clear_buff();
     }
 
     void Camera::skip_frames(int num)
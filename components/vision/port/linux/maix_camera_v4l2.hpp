@@ -0,0 +1,100 @@
+/**
+ * V4L2 mmap buffers shared by camera and leased frames.
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2023-
+ * @license Apache 2.0
+ * @update 2026.10.18: Create this file.
+ */
+
+#pragma once
+
+#include "maix_image.hpp"
+#include <linux/videodev2.h>
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <errno.h>
+#include <string.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace maix::camera
+{
+    /**
+     * mmap buffers of one V4L2 stream.
+     * Camera and leased frames hold it by shared_ptr, so buffers keep mapped until the last frame released,
+     * even if camera closed before.
+     */
+    class _V4L2_Buffers
+    {
+    public:
+        int fd = -1;
+        bool streaming = false; // only queue back buffer to driver when streaming
+        std::vector<void *> addrs;
+        std::vector<size_t> lens;
+        std::mutex lock;
+
+        ~_V4L2_Buffers()
+        {
+            for (size_t i = 0; i < addrs.size(); ++i)
+            {
+                if (addrs[i] && addrs[i] != MAP_FAILED)
+                    munmap(addrs[i], lens[i]);
+            }
+        }
+
+        /**
+         * Queue buffer back to driver
+         * @return 0 if success, else -errno
+         */
+        int queue(int index)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (!streaming)
+                return 0;
+            struct v4l2_buffer buf;
+            memset(&buf, 0, sizeof(buf));
+            buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buf.memory = V4L2_MEMORY_MMAP;
+            buf.index = index;
+            int ret;
+            do
+            {
+                ret = ioctl(fd, VIDIOC_QBUF, &buf);
+            } while (ret < 0 && errno == EINTR);
+            return ret < 0 ? -errno : 0;
+        }
+    };
+
+    /**
+     * One dequeued buffer leased to user, queued back to driver when destroyed.
+     */
+    class _V4L2_Lease
+    {
+    public:
+        std::shared_ptr<_V4L2_Buffers> buffers;
+        int index;
+        int width;
+        int height;
+        int stride; // bytes per line of plane 0
+        image::Format format;
+        uint8_t *data;
+        uint64_t pts_us;
+
+        _V4L2_Lease(std::shared_ptr<_V4L2_Buffers> buffers, int index, int width, int height, int stride, image::Format format, uint64_t pts_us)
+            : buffers(buffers), index(index), width(width), height(height), stride(stride), format(format), pts_us(pts_us)
+        {
+            data = (uint8_t *)buffers->addrs[index];
+        }
+
+        ~_V4L2_Lease()
+        {
+            buffers->queue(index);
+        }
+    };
+
+    /**
+     * pipeline::Frame handle of linux, created from V4L2 lease, from string is "v4l2".
+     */
+    typedef std::shared_ptr<_V4L2_Lease> _V4L2_Frame;
+} // namespace maix::camera
@@ -3,33 +3,275 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2024.5.17: Add framework, create this file.
+ * @update 2026.10.18: Implement with cpp-httplib, frames shared by all clients.
+ * @update 2026.10.18: Encode frames by software JPEG encoder into frame part directly.
+ * @update 2026.10.18: Bound client frame wait and socket write time, release worker thread of dead client.
  */
 #include "maix_jpg_stream.hpp"
+#include "maix_image_jpeg.hpp"
+#include "httplib.h"
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <map>
+
+#define BOUNDARY "frame"
+
 namespace maix::http
 {
-        JpegStreamer::JpegStreamer(std::string host, int port, int client_number) {
-			(void)host;
-			(void)port;
-			(void)client_number;
+	static const char *default_index_str =
+		"<html>\n"
+		"<body>\n"
+		"<h1>JPG Stream</h1>\n"
+		"<img src='/stream'>\n"
+		"</body>\n"
+		"</html>";
+
+	class _JpegStreamer_Client
+	{
+	public:
+		std::string addr;
+		uint64_t last_seq = 0;   // last sent frame sequence
+		uint64_t sent = 0;       // sent frames
+		uint64_t dropped = 0;    // frames skipped because client is slower than write()
+		float fps = 0;
+		uint64_t fps_t = 0;
+		int fps_count = 0;
+	};
+
+	class _JpegStreamer_Data
+	{
+	public:
+		httplib::Server svr;
+		std::thread *th = nullptr;
+		std::mutex lock;
+		std::condition_variable cond;
+		bool running = false;
+		// latest frame, boundary header + jpeg data + "\r\n", shared by all clients
+		std::shared_ptr<const std::string> frame;
+		uint64_t seq = 0;
+		std::string html = default_index_str;
+		int client_max = 16;
+		int next_client_id = 0;
+		std::map<int, std::shared_ptr<_JpegStreamer_Client>> clients;
+		image::JpegEncoder encoder;
+	};
+
+	JpegStreamer::JpegStreamer(std::string host, int port, int client_number)
+	{
+		if (host.size() == 0)
+		{
+			host = "0.0.0.0";
 		}
+		_host = host;
+		_port = port;
+		_JpegStreamer_Data *data = new _JpegStreamer_Data();
+		data->client_max = client_number > 0 ? client_number : 1;
+		_data = data;
+
+		// every stream client hold one worker thread, keep some for index page
+		int threads = data->client_max + 2;
+		data->svr.new_task_queue = [threads] { return new httplib::ThreadPool(threads); };
+		// client not receive data in time will be closed, release worker thread
+		data->svr.set_write_timeout(3, 0);
 
-        JpegStreamer::~JpegStreamer() {
+		data->svr.Get("/", [data](const httplib::Request &req, httplib::Response &res) {
+			std::lock_guard<std::mutex> lock(data->lock);
+			res.set_content(data->html, "text/html");
+		});
 
+		data->svr.Get("/stream", [data](const httplib::Request &req, httplib::Response &res) {
+			int id;
+			std::shared_ptr<_JpegStreamer_Client> client = std::make_shared<_JpegStreamer_Client>();
+			client->addr = req.remote_addr + ":" + std::to_string(req.remote_port);
+			client->fps_t = time::ticks_ms();
+			{
+				std::lock_guard<std::mutex> lock(data->lock);
+				if ((int)data->clients.size() >= data->client_max)
+				{
+					log::warn("jpeg stream client %s rejected, max client number %d reached", client->addr.c_str(), data->client_max);
+					res.status = 503;
+					return;
+				}
+				id = data->next_client_id++;
+				data->clients[id] = client;
+			}
+			res.set_header("Cache-Control", "no-cache");
+			// provider without length and not chunked, httplib write sink data to socket directly,
+			// no chunk header and no extra copy, one frame part is sent by one write.
+			res.set_content_provider(
+				"multipart/x-mixed-replace; boundary=" BOUNDARY,
+				[data, client](size_t offset, httplib::DataSink &sink) {
+					std::shared_ptr<const std::string> frame;
+					uint64_t seq;
+					{
+						// only wait the latest frame, slow client skip frames it missed.
+						// wait with timeout, return to httplib to check client alive if no new frame,
+						// so disconnected client release worker thread even write() not called.
+						std::unique_lock<std::mutex> lock(data->lock);
+						if (!data->cond.wait_for(lock, std::chrono::milliseconds(1000), [data, client] { return !data->running || data->seq > client->last_seq; }))
+							return true;
+						if (!data->running)
+							return false;
+						frame = data->frame;
+						seq = data->seq;
+						if (client->last_seq > 0)
+							client->dropped += seq - client->last_seq - 1;
+						client->last_seq = seq;
+					}
+					if (!sink.write(frame->data(), frame->size()))
+						return false;
+					std::lock_guard<std::mutex> lock(data->lock);
+					++client->sent;
+					++client->fps_count;
+					uint64_t t = time::ticks_ms();
+					if (t - client->fps_t >= 1000)
+					{
+						client->fps = client->fps_count * 1000.0f / (t - client->fps_t);
+						client->fps_count = 0;
+						client->fps_t = t;
+					}
+					return true;
+				},
+				[data, id](bool success) {
+					std::lock_guard<std::mutex> lock(data->lock);
+					data->clients.erase(id);
+				});
+		});
+	}
+
+	JpegStreamer::~JpegStreamer()
+	{
+		stop();
+		delete (_JpegStreamer_Data *)_data;
+		_data = nullptr;
+	}
+
+	err::Err JpegStreamer::start()
+	{
+		_JpegStreamer_Data *data = (_JpegStreamer_Data *)_data;
+		if (data->th)
+			return err::ERR_NONE;
+		if (!data->svr.bind_to_port(_host, _port))
+		{
+			log::error("jpeg stream bind %s:%d failed", _host.c_str(), _port);
+			return err::ERR_IO;
+		}
+		{
+			std::lock_guard<std::mutex> lock(data->lock);
+			data->running = true;
 		}
+		data->th = new std::thread([data]() {
+			data->svr.listen_after_bind();
+		});
+		data->svr.wait_until_ready();
+		return err::ERR_NONE;
+	}
 
-        err::Err JpegStreamer::start() {
-			return err::ERR_NOT_IMPL;
+	err::Err JpegStreamer::stop()
+	{
+		_JpegStreamer_Data *data = (_JpegStreamer_Data *)_data;
+		if (!data->th)
+			return err::ERR_NONE;
+		{
+			std::lock_guard<std::mutex> lock(data->lock);
+			data->running = false;
 		}
+		data->cond.notify_all();
+		data->svr.stop();
+		data->th->join();
+		delete data->th;
+		data->th = nullptr;
+		return err::ERR_NONE;
+	}
 
-        err::Err JpegStreamer::stop() {
-			return err::ERR_NOT_IMPL;
+	err::Err JpegStreamer::write(image::Image *img)
+	{
+		_JpegStreamer_Data *data = (_JpegStreamer_Data *)_data;
+		image::Image *jpg = img;
+		int size = 0;
+		bool encoded = false;
+		if (img->format() == image::Format::FMT_JPEG)
+		{
+			size = jpg->data_size();
+		}
+		else if (image::JpegEncoder::is_support(img->format()))
+		{
+			// encoded to encoder slices, written to part after header later, no intermediate JPEG image
+			size = data->encoder.encode(*img);
+			if (size < 0)
+			{
+				log::error("encode jpeg failed!\r\n");
+				return err::ERR_RUNTIME;
+			}
+			encoded = true;
+		}
+		else
+		{
+			jpg = img->to_jpeg();
+			if (!jpg)
+			{
+				log::error("invert to jpeg failed!\r\n");
+				return err::ERR_RUNTIME;
+			}
+			size = jpg->data_size();
+		}
+		// build whole part once, clients send it by one write without copy
+		char header[128];
+		int header_len = snprintf(header, sizeof(header), "--" BOUNDARY "\r\nContent-Type: image/jpeg\r\nContent-Length: %d\r\n\r\n", size);
+		std::string *part = new std::string();
+		part->resize(header_len + size + 2);
+		char *p = &(*part)[0];
+		memcpy(p, header, header_len);
+		if (encoded)
+			data->encoder.write(p + header_len, size);
+		else
+			memcpy(p + header_len, jpg->data(), size);
+		memcpy(p + header_len + size, "\r\n", 2);
+		if (jpg != img)
+			delete jpg;
+		{
+			std::lock_guard<std::mutex> lock(data->lock);
+			data->frame = std::shared_ptr<const std::string>(part);
+			++data->seq;
 		}
+		data->cond.notify_all();
+		return err::ERR_NONE;
+	}
 
-        err::Err JpegStreamer::write(image::Image *img) {
-			return err::ERR_NOT_IMPL;
+	err::Err JpegStreamer::set_html(std::string html)
+	{
+		if (html.size() == 0)
+		{
+			log::error("html code is none!\r\n");
+			return err::ERR_RUNTIME;
 		}
+		_JpegStreamer_Data *data = (_JpegStreamer_Data *)_data;
+		std::lock_guard<std::mutex> lock(data->lock);
+		data->html = html;
+		return err::ERR_NONE;
+	}
 
-        err::Err JpegStreamer::set_html(std::string data) {
-			return err::ERR_NOT_IMPL;
+	std::map<std::string, std::map<std::string, float>> JpegStreamer::clients_status()
+	{
+		std::map<std::string, std::map<std::string, float>> status;
+		_JpegStreamer_Data *data = (_JpegStreamer_Data *)_data;
+		std::lock_guard<std::mutex> lock(data->lock);
+		uint64_t t = time::ticks_ms();
+		for (auto &it : data->clients)
+		{
+			_JpegStreamer_Client *c = it.second.get();
+			// fps decay to 0 if client not receive any frame in 2s
+			float fps = (t - c->fps_t > 2000) ? 0 : c->fps;
+			status[c->addr] = {
+				{"fps", fps},
+				{"queue", (float)(c->last_seq > 0 ? data->seq - c->last_seq : data->seq)},
+				{"sent", (float)c->sent},
+				{"dropped", (float)c->dropped},
+			};
 		}
-}
\ No newline at end of file
+		return status;
+	}
+}
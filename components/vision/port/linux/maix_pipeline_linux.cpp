@@ -1,4 +1,5 @@
 #include "maix_pipeline.hpp"
+#include "maix_camera_v4l2.hpp"
 
 namespace maix::pipeline {
     Stream::Stream(void *stream, bool auto_delete, std::string from) {
@@ -65,32 +66,78 @@ namespace maix::pipeline {
     }
 
     Frame::Frame(void *frame, bool auto_delete, std::string from) {
+        __frame = frame;
+        __auto_delete = auto_delete;
+        __from = from;
+        if (from != "v4l2") {
+            err::check_raise(err::ERR_NOT_IMPL, "Construct frame from " + from + " not supported");
+        }
     }
 
     Frame::~Frame() {
+        if (__frame && __auto_delete) {
+            delete (camera::_V4L2_Frame *)__frame;
+        }
+        __frame = nullptr;
+    }
+
+    static camera::_V4L2_Lease *__lease(void *frame) {
+        err::check_null_raise(frame, "frame already released");
+        return ((camera::_V4L2_Frame *)frame)->get();
     }
 
     int Frame::width() {
-        return 0;
+        return __lease(__frame)->width;
     }
 
     int Frame::height() {
-        return 0;
+        return __lease(__frame)->height;
     }
 
     image::Format Frame::format() {
-        return image::FMT_INVALID;
+        return __lease(__frame)->format;
+    }
+
+    static void __image_release(void *data, void *arg) {
+        delete (camera::_V4L2_Frame *)arg;
     }
 
     image::Image *Frame::to_image() {
-        return nullptr;
+        camera::_V4L2_Lease *lease = __lease(__frame);
+        bool semi_planar = lease->format == image::FMT_YVU420SP || lease->format == image::FMT_YUV420SP;
+        int line_size = semi_planar ? lease->width : lease->width * (int)image::fmt_size[lease->format];
+        if (lease->stride != line_size) {
+            // rows padded by driver, image need continuous data, copy
+            image::Image *img = new image::Image(lease->width, lease->height, lease->format);
+            int rows = semi_planar ? lease->height * 3 / 2 : lease->height;
+            uint8_t *dst = (uint8_t *)img->data();
+            for (int i = 0; i < rows; ++i)
+                memcpy(dst + i * line_size, lease->data + i * lease->stride, line_size);
+            return img;
+        }
+        // share driver buffer with image, buffer queue back after both frame and image released
+        image::Image *img = new image::Image(lease->width, lease->height, lease->format, lease->data, -1, false);
+        img->set_release_callback(__image_release, new camera::_V4L2_Frame(*(camera::_V4L2_Frame *)__frame));
+        return img;
     }
 
     int Frame::stride(int idx) {
+        camera::_V4L2_Lease *lease = __lease(__frame);
+        err::check_bool_raise(idx >= 0 && idx <= 2, "invalid plane index");
+        if (idx == 0)
+            return lease->stride;
+        if (idx == 1 && (lease->format == image::FMT_YVU420SP || lease->format == image::FMT_YUV420SP))
+            return lease->stride;
         return 0;
     }
 
     uint64_t Frame::virtual_address(int idx) {
+        camera::_V4L2_Lease *lease = __lease(__frame);
+        err::check_bool_raise(idx >= 0 && idx <= 2, "invalid plane index");
+        if (idx == 0)
+            return (uint64_t)lease->data;
+        if (idx == 1 && (lease->format == image::FMT_YVU420SP || lease->format == image::FMT_YUV420SP))
+            return (uint64_t)(lease->data + lease->stride * lease->height);
         return 0;
     }
 
@@ -3,14 +3,34 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Implement Encoder, Decoder, Video and VideoRecorder with FFmpeg software codecs.
  */
 
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#if __has_include(<libavcodec/bsf.h>)
+#include <libavcodec/bsf.h>
+#endif
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+#include <libswscale/swscale.h>
+#include <libswresample/swresample.h>
+}
+
 #include <stdint.h>
-#include "maix_err.hpp"
-#include "maix_log.hpp"
+#include "maix_basic.hpp"
 #include "maix_image.hpp"
 #include "maix_time.hpp"
 #include "maix_video.hpp"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+
+// FFmpeg 5.1 replaced channels and channel_layout with AVChannelLayout
+#define _FFMPEG_CH_LAYOUT (LIBSWRESAMPLE_VERSION_INT >= AV_VERSION_INT(4, 5, 100))
 
 namespace maix::video
 {
@@ -32,89 +52,1141 @@ namespace maix::video
         return value * 1000 / ((double)timebase[1] / timebase[0]);
     }
 
+    static std::string _av_err_str(int errnum) {
+        char buf[AV_ERROR_MAX_STRING_SIZE] = {0};
+        av_strerror(errnum, buf, sizeof(buf));
+        return buf;
+    }
+
+    static enum AVPixelFormat _image_format_to_ffmpeg(image::Format format) {
+        switch (format) {
+            case image::Format::FMT_GRAYSCALE: return AV_PIX_FMT_GRAY8;
+            case image::Format::FMT_YVU420SP: return AV_PIX_FMT_NV21;
+            case image::Format::FMT_YUV420SP: return AV_PIX_FMT_NV12;
+            case image::Format::FMT_YUV420P:    // fall through
+            case image::Format::FMT_YVU420P: return AV_PIX_FMT_YUV420P;  // U and V planes swapped by _fill_image_arrays
+            case image::Format::FMT_YUV422SP: return AV_PIX_FMT_NV16;
+            case image::Format::FMT_YUV422P: return AV_PIX_FMT_YUV422P;
+            case image::Format::FMT_RGB888: return AV_PIX_FMT_RGB24;
+            case image::Format::FMT_BGR888: return AV_PIX_FMT_BGR24;
+            case image::Format::FMT_RGBA8888: return AV_PIX_FMT_RGBA;
+            case image::Format::FMT_BGRA8888: return AV_PIX_FMT_BGRA;
+            default: return AV_PIX_FMT_NONE;
+        }
+    }
+
+    // point planes to image buffer without copy
+    static void _fill_image_arrays(uint8_t *data[4], int linesize[4], uint8_t *buff, image::Format format, int width, int height) {
+        av_image_fill_arrays(data, linesize, buff, _image_format_to_ffmpeg(format), width, height, 1);
+        if (format == image::Format::FMT_YVU420P) {
+            std::swap(data[1], data[2]);
+        }
+    }
+
+    static int64_t _frame_duration(AVFrame *frame) {
+#if LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(57, 30, 100)
+        return frame->duration;
+#else
+        return frame->pkt_duration;
+#endif
+    }
+
+    static enum AVCodecID _video_type_to_ffmpeg(VideoType video_type) {
+        switch (video_type) {
+            case VIDEO_H265:
+            case VIDEO_H265_CBR:
+            case VIDEO_H265_VBR:
+            case VIDEO_ENC_H265_CBR:
+            case VIDEO_H265_CBR_MP4:
+                return AV_CODEC_ID_HEVC;
+            default:
+                return AV_CODEC_ID_H264;
+        }
+    }
+
+    // first software encoder of codec, hardware encoders need hardware frames
+    static const AVCodec *_find_software_encoder(enum AVCodecID codec_id) {
+        void *it = NULL;
+        const AVCodec *codec = NULL;
+        while ((codec = av_codec_iterate(&it))) {
+            if (codec->id == codec_id && av_codec_is_encoder(codec)
+                && !(codec->capabilities & (AV_CODEC_CAP_HARDWARE | AV_CODEC_CAP_EXPERIMENTAL))) {
+                return codec;
+            }
+        }
+        return NULL;
+    }
+
+    // codec is decided by suffix for raw stream files and by video type for containers,
+    // containers fallback to MPEG-4 part 2 or MJPEG if FFmpeg is built without H.264/H.265 encoder.
+    static const AVCodec *_find_encoder(const std::string &path, video::VideoType type, const AVOutputFormat *oformat) {
+        std::string suffix;
+        size_t pos = path.rfind('.');
+        if (pos != std::string::npos) {
+            suffix = path.substr(pos);
+        }
+
+        enum AVCodecID codec_id = _video_type_to_ffmpeg(type);
+        if (suffix == ".mjpeg" || suffix == ".mjpg") {
+            codec_id = AV_CODEC_ID_MJPEG;
+        } else if (suffix == ".h264" || suffix == ".264") {
+            codec_id = AV_CODEC_ID_H264;
+        } else if (suffix == ".h265" || suffix == ".265" || suffix == ".hevc") {
+            codec_id = AV_CODEC_ID_HEVC;
+        }
+        const AVCodec *codec = _find_software_encoder(codec_id);
+        if (codec) {
+            return codec;
+        }
+
+        enum AVCodecID fallbacks[] = {AV_CODEC_ID_MPEG4, AV_CODEC_ID_MJPEG};
+        for (auto id : fallbacks) {
+            if (oformat && avformat_query_codec(oformat, id, FF_COMPLIANCE_NORMAL) != 1) {
+                continue;
+            }
+            codec = _find_software_encoder(id);
+            if (codec) {
+                log::warn("%s encoder not found, use %s instead", avcodec_get_name(codec_id), codec->name);
+                return codec;
+            }
+        }
+        log::error("%s encoder not found", avcodec_get_name(codec_id));
+        return NULL;
+    }
+
+    static enum AVPixelFormat _select_pix_fmt(const AVCodec *codec, enum AVPixelFormat input) {
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(61, 13, 100)
+        const enum AVPixelFormat *fmts = NULL;
+        avcodec_get_supported_config(NULL, codec, AV_CODEC_CONFIG_PIX_FORMAT, 0, (const void **)&fmts, NULL);
+#else
+        const enum AVPixelFormat *fmts = codec->pix_fmts;
+#endif
+        if (!fmts) {
+            return AV_PIX_FMT_YUV420P;
+        }
+        // encode input directly if encoder support it, else prefer 4:2:0, full range for MJPEG
+        enum AVPixelFormat prefer = codec->id == AV_CODEC_ID_MJPEG ? AV_PIX_FMT_YUVJ420P : AV_PIX_FMT_YUV420P;
+        for (const enum AVPixelFormat *p = fmts; *p != AV_PIX_FMT_NONE; p++) {
+            if (*p == input) {
+                return input;
+            }
+        }
+        for (const enum AVPixelFormat *p = fmts; *p != AV_PIX_FMT_NONE; p++) {
+            if (*p == prefer) {
+                return prefer;
+            }
+        }
+        return fmts[0];
+    }
+
+    typedef struct {
+        AVFormatContext *format_ctx;
+        AVStream *stream;
+        bool header_written;
+        AVCodecContext *codec_ctx;
+        AVPacket *packet;
+        SwsContext *sws_ctx;
+        int64_t frame_index;
+        AVRational out_timebase;        // timebase of pts of returned frames
+
+        // frames are converted in caller thread and encoded in encode thread if not block
+        std::thread *thread;
+        std::mutex lock;
+        std::condition_variable cond;
+        std::deque<AVFrame *> frames;   // frames wait to encode, NULL means flush
+        std::vector<AVFrame *> free_frames;
+        std::vector<uint8_t> stream_data; // encoded data not returned yet
+        int64_t stream_pts;
+    } encoder_param_t;
+
+    static const size_t _ENCODE_QUEUE_MAX = 4;
+
+    // receive all packets from encoder, write them to file and append to out
+    static int _receive_packets(encoder_param_t *param, std::vector<uint8_t> &out, int64_t &pts) {
+        AVPacket *packet = param->packet;
+        int ret;
+        while ((ret = avcodec_receive_packet(param->codec_ctx, packet)) >= 0) {
+            if (out.empty()) {
+                pts = av_rescale_q(packet->pts, param->codec_ctx->time_base, param->out_timebase);
+            }
+            out.insert(out.end(), packet->data, packet->data + packet->size);
+            if (param->format_ctx) {
+                av_packet_rescale_ts(packet, param->codec_ctx->time_base, param->stream->time_base);
+                packet->stream_index = param->stream->index;
+                int write_ret = av_interleaved_write_frame(param->format_ctx, packet);
+                if (write_ret < 0) {
+                    log::error("write video frame failed: %s", _av_err_str(write_ret).c_str());
+                }
+            }
+            av_packet_unref(packet);
+        }
+        return (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) ? 0 : ret;
+    }
+
+    static void _encode_thread(encoder_param_t *param) {
+        std::vector<uint8_t> out;
+        while (true) {
+            AVFrame *frame;
+            {
+                std::unique_lock<std::mutex> lock(param->lock);
+                param->cond.wait(lock, [param]() { return !param->frames.empty(); });
+                frame = param->frames.front();
+            }
+
+            int64_t pts = 0;
+            out.clear();
+            int ret = avcodec_send_frame(param->codec_ctx, frame);
+            if (ret >= 0) {
+                ret = _receive_packets(param, out, pts);
+            }
+            if (ret < 0) {
+                log::error("encode frame failed: %s", _av_err_str(ret).c_str());
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(param->lock);
+                param->frames.pop_front();
+                if (frame) {
+                    param->free_frames.push_back(frame);
+                }
+                if (param->stream_data.empty()) {
+                    param->stream_pts = pts;
+                }
+                param->stream_data.insert(param->stream_data.end(), out.begin(), out.end());
+            }
+            param->cond.notify_all();
+            if (!frame) {
+                break;
+            }
+        }
+    }
+
+    // get a writable frame of encoder format, frames still referenced by encoder are not reused
+    static AVFrame *_get_free_frame(encoder_param_t *param) {
+        AVFrame *frame = NULL;
+        {
+            std::lock_guard<std::mutex> lock(param->lock);
+            if (!param->free_frames.empty()) {
+                frame = param->free_frames.back();
+                param->free_frames.pop_back();
+            }
+        }
+        if (!frame) {
+            frame = av_frame_alloc();
+            if (!frame) {
+                return NULL;
+            }
+        }
+        if (frame->buf[0] && av_frame_is_writable(frame)) {
+            return frame;
+        }
+        av_frame_unref(frame);
+        frame->format = param->codec_ctx->pix_fmt;
+        frame->width = param->codec_ctx->width;
+        frame->height = param->codec_ctx->height;
+        if (av_frame_get_buffer(frame, 0) < 0) {
+            av_frame_free(&frame);
+            return NULL;
+        }
+        return frame;
+    }
+
+    // copy or convert image planes to encoder frame in one pass
+    static err::Err _fill_frame(encoder_param_t *param, AVFrame *frame, image::Image &img) {
+        uint8_t *data[4];
+        int linesize[4];
+        _fill_image_arrays(data, linesize, (uint8_t *)img.data(), img.format(), img.width(), img.height());
+        enum AVPixelFormat format = _image_format_to_ffmpeg(img.format());
+        if (format == frame->format && img.width() == frame->width && img.height() == frame->height) {
+            av_image_copy(frame->data, frame->linesize, (const uint8_t **)data, linesize, format, img.width(), img.height());
+            return err::ERR_NONE;
+        }
+        param->sws_ctx = sws_getCachedContext(param->sws_ctx, img.width(), img.height(), format,
+                                            frame->width, frame->height, (enum AVPixelFormat)frame->format,
+                                            SWS_BILINEAR, NULL, NULL, NULL);
+        if (!param->sws_ctx) {
+            log::error("convert %s to %s not support", image::fmt_names[img.format()].c_str(), av_get_pix_fmt_name((enum AVPixelFormat)frame->format));
+            return err::ERR_NOT_IMPL;
+        }
+        sws_scale(param->sws_ctx, (const uint8_t *const *)data, linesize, 0, img.height(), frame->data, frame->linesize);
+        return err::ERR_NONE;
+    }
+
+    static err::Err _open_encoder(encoder_param_t *param, const std::string &path, int width, int height, image::Format format,
+                                    video::VideoType type, int framerate, int gop, int bitrate, int time_base, bool block) {
+        const AVOutputFormat *oformat = NULL;
+        if (path.size() != 0) {
+            avformat_alloc_output_context2(&param->format_ctx, NULL, NULL, path.c_str());
+            if (!param->format_ctx) {
+                log::error("Could not deduce output format from file name: %s", path.c_str());
+                return err::ERR_ARGS;
+            }
+            oformat = param->format_ctx->oformat;
+        }
+
+        const AVCodec *codec = _find_encoder(path, type, oformat);
+        if (!codec) {
+            return err::ERR_NOT_IMPL;
+        }
+        AVCodecContext *ctx = avcodec_alloc_context3(codec);
+        if (!ctx) {
+            return err::ERR_NO_MEM;
+        }
+        param->codec_ctx = ctx;
+        ctx->width = width;
+        ctx->height = height;
+        ctx->pix_fmt = _select_pix_fmt(codec, _image_format_to_ffmpeg(format));
+        ctx->time_base = AVRational{1, framerate};
+        ctx->framerate = AVRational{framerate, 1};
+        ctx->gop_size = gop;
+        ctx->max_b_frames = 0;  // no B-frame, so pts and dts are always the same
+        ctx->bit_rate = bitrate;
+        ctx->thread_count = 0;
+        if (codec->id == AV_CODEC_ID_MJPEG) {
+            ctx->color_range = AVCOL_RANGE_JPEG;
+        }
+        if (oformat && (oformat->flags & AVFMT_GLOBALHEADER)) {
+            ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+        }
+        AVDictionary *opts = NULL;
+        if (!strcmp(codec->name, "libx264") || !strcmp(codec->name, "libx265")) {
+            av_dict_set(&opts, "preset", "veryfast", 0);
+            if (block) {
+                av_dict_set(&opts, "tune", "zerolatency", 0);   // no lookahead, every encode returns its own frame
+            }
+        }
+        int ret = avcodec_open2(ctx, codec, &opts);
+        av_dict_free(&opts);
+        if (ret < 0) {
+            log::error("open encoder %s failed: %s", codec->name, _av_err_str(ret).c_str());
+            return err::ERR_RUNTIME;
+        }
+
+        if (param->format_ctx) {
+            param->stream = avformat_new_stream(param->format_ctx, NULL);
+            if (!param->stream) {
+                return err::ERR_NO_MEM;
+            }
+            param->stream->time_base = ctx->time_base;
+            avcodec_parameters_from_context(param->stream->codecpar, ctx);
+            if (!(oformat->flags & AVFMT_NOFILE)) {
+                ret = avio_open(&param->format_ctx->pb, path.c_str(), AVIO_FLAG_WRITE);
+                if (ret < 0) {
+                    log::error("Could not open file %s: %s", path.c_str(), _av_err_str(ret).c_str());
+                    return err::ERR_IO;
+                }
+            }
+            ret = avformat_write_header(param->format_ctx, NULL);
+            if (ret < 0) {
+                log::error("write header to %s failed: %s", path.c_str(), _av_err_str(ret).c_str());
+                return err::ERR_IO;
+            }
+            param->header_written = true;
+        }
+
+        param->packet = av_packet_alloc();
+        if (!param->packet) {
+            return err::ERR_NO_MEM;
+        }
+        param->out_timebase = AVRational{1, time_base};
+        if (!block) {
+            param->thread = new std::thread(_encode_thread, param);
+        }
+        log::info("video encoder: %s %dx%d %s", codec->name, width, height, av_get_pix_fmt_name(ctx->pix_fmt));
+        return err::ERR_NONE;
+    }
+
+    // flush encoder, write file tail and release all resources
+    static void _release_encoder(encoder_param_t *param) {
+        if (param->thread) {
+            {
+                std::lock_guard<std::mutex> lock(param->lock);
+                param->frames.push_back(NULL);
+            }
+            param->cond.notify_all();
+            param->thread->join();
+            delete param->thread;
+            param->thread = NULL;
+        } else if (param->codec_ctx && param->packet && avcodec_is_open(param->codec_ctx)) {
+            std::vector<uint8_t> out;
+            int64_t pts;
+            if (avcodec_send_frame(param->codec_ctx, NULL) >= 0) {
+                _receive_packets(param, out, pts);
+            }
+        }
+
+        if (param->format_ctx) {
+            if (param->header_written) {
+                av_write_trailer(param->format_ctx);
+            }
+            if (!(param->format_ctx->oformat->flags & AVFMT_NOFILE)) {
+                avio_closep(&param->format_ctx->pb);
+            }
+            avformat_free_context(param->format_ctx);
+            param->format_ctx = NULL;
+        }
+        avcodec_free_context(&param->codec_ctx);
+        av_packet_free(&param->packet);
+        sws_freeContext(param->sws_ctx);
+        param->sws_ctx = NULL;
+        for (auto frame : param->free_frames) {
+            av_frame_free(&frame);
+        }
+        param->free_frames.clear();
+        delete param;
+    }
+
     Encoder::Encoder(std::string path, int width, int height, image::Format format, VideoType type, int framerate, int gop, int bitrate, int time_base, bool capture, bool block) {
-        throw err::Exception(err::ERR_NOT_IMPL);
+        _path = path;
+        _width = width;
+        _height = height;
+        _format = format;
+        _type = type;
+        _framerate = framerate;
+        _gop = gop;
+        _bitrate = bitrate;
+        _time_base = time_base;
+        _need_capture = capture;
+        _capture_image = NULL;
+        _camera = NULL;
+        _bind_camera = false;
+        _pts = 0;
+        _dts = 0;
+        _start_encode_ms = 0;
+        _encode_started = false;
+        _block = block;
+        _param = NULL;
+
+        err::check_bool_raise(_image_format_to_ffmpeg(format) != AV_PIX_FMT_NONE, "Encoder not support format " + image::fmt_names[format]);
+        err::check_bool_raise(width > 0 && height > 0 && framerate > 0 && time_base > 0, "Encoder args error");
+
+        av_log_set_level(AV_LOG_ERROR);
+        encoder_param_t *param = new encoder_param_t();
+        err::Err e = _open_encoder(param, path, width, height, format, type, framerate, gop, bitrate, time_base, block);
+        if (e != err::ERR_NONE) {
+            _release_encoder(param);
+            throw err::Exception(e, "Encoder open failed");
+        }
+        _param = param;
     }
 
     Encoder::~Encoder() {
-        throw err::Exception(err::ERR_NOT_IMPL);
+        encoder_param_t *param = (encoder_param_t *)_param;
+        if (param) {
+            _release_encoder(param);
+            _param = NULL;
+        }
+        if (_capture_image) {
+            delete _capture_image;
+            _capture_image = nullptr;
+        }
     }
 
     err::Err Encoder::bind_camera(camera::Camera *camera) {
-        (void)camera;
-        throw err::Exception(err::ERR_NOT_IMPL);
-        return err::ERR_NOT_IMPL;
+        if (_image_format_to_ffmpeg(camera->format()) == AV_PIX_FMT_NONE) {
+            log::error("bind camera failed! format %s not support", image::fmt_names[camera->format()].c_str());
+            return err::ERR_ARGS;
+        }
+
+        this->_camera = camera;
+        this->_bind_camera = true;
+        return err::ERR_NONE;
     }
 
     video::Frame *Encoder::encode(image::Image *img, Bytes *pcm) {
-        (void)img;
-        (void)pcm;
-        throw err::Exception(err::ERR_NOT_IMPL);
-        return nullptr;
+        (void)pcm;      // audio encode is not supported yet
+        encoder_param_t *param = (encoder_param_t *)_param;
+        image::Image *camera_img = NULL;
+
+        if (!img || !img->data()) {
+            if (!_bind_camera) {
+                log::error("encode img is null");
+                return new video::Frame();
+            }
+            camera_img = _camera->read();
+            if (!camera_img) {
+                log::error("read camera failed");
+                return new video::Frame();
+            }
+            img = camera_img;
+        }
+        if (_image_format_to_ffmpeg(img->format()) == AV_PIX_FMT_NONE) {
+            log::error("encode image format %s not support", image::fmt_names[img->format()].c_str());
+            delete camera_img;
+            return new video::Frame();
+        }
+
+        AVFrame *frame = _get_free_frame(param);
+        if (!frame) {
+            log::error("alloc frame failed");
+            delete camera_img;
+            return new video::Frame();
+        }
+        err::Err e = _fill_frame(param, frame, *img);
+        frame->pts = param->frame_index++;  // pts from frame index, not wall clock, so encode can be faster than real time
+
+        if (_need_capture) {
+            delete _capture_image;
+            _capture_image = camera_img ? camera_img : img->copy();
+            camera_img = NULL;
+        }
+        delete camera_img;
+
+        if (e != err::ERR_NONE) {
+            std::lock_guard<std::mutex> lock(param->lock);
+            param->free_frames.push_back(frame);
+            return new video::Frame();
+        }
+
+        std::vector<uint8_t> out;
+        int64_t pts = 0;
+        if (_block) {
+            int ret = avcodec_send_frame(param->codec_ctx, frame);
+            if (ret >= 0) {
+                ret = _receive_packets(param, out, pts);
+            }
+            param->free_frames.push_back(frame);
+            if (ret < 0) {
+                log::error("encode frame failed: %s", _av_err_str(ret).c_str());
+                return new video::Frame();
+            }
+        } else {
+            // return frames encoded before, wait if encode thread is too slow
+            std::unique_lock<std::mutex> lock(param->lock);
+            param->cond.wait(lock, [param]() { return param->frames.size() < _ENCODE_QUEUE_MAX; });
+            param->frames.push_back(frame);
+            out.swap(param->stream_data);
+            pts = param->stream_pts;
+            lock.unlock();
+            param->cond.notify_all();
+        }
+
+        if (out.empty()) {
+            return new video::Frame();
+        }
+        return new video::Frame(out.data(), out.size(), pts, pts, 0, true, true);
     }
 
     err::Err Encoder::push(pipeline::Frame *frame) {
         (void)frame;
-        throw err::Exception(err::ERR_NOT_IMPL);
-        return err::ERR_NONE;
+        log::error("pipeline is not supported by software encoder, use encode instead");
+        return err::ERR_NOT_IMPL;
     }
 
     pipeline::Stream *Encoder::pop(int block_ms) {
         (void)block_ms;
-        throw err::Exception(err::ERR_NOT_IMPL);
+        log::error("pipeline is not supported by software encoder, use encode instead");
         return nullptr;
     }
 
+    void *Encoder::get_driver() {
+        encoder_param_t *param = (encoder_param_t *)_param;
+        return param->codec_ctx;
+    }
+
+    typedef struct {
+        AVFormatContext *format_ctx;
+        AVPacket *packet;
+        bool eof;                       // all packets are read, decoders are draining
+
+        // video
+        int video_stream_index;
+        AVCodecContext *video_ctx;
+        AVFrame *video_frame;
+        AVBSFContext *bsf_ctx;          // convert H.264/H.265 in mp4 to annex-b for unpack
+        SwsContext *sws_ctx;
+        bool video_eof;
+        int64_t start_pts;
+        int64_t next_pts;
+        int64_t frame_duration;
+        int64_t video_skip_pts;         // drop frames before seek target
+
+        // audio
+        int audio_stream_index;
+        AVCodecContext *audio_ctx;
+        AVFrame *audio_frame;
+        SwrContext *swr_ctx;
+        bool audio_eof;
+        int64_t audio_skip_pts;
+        std::vector<uint8_t> pcm;
+    } decoder_param_t;
+
+    static AVCodecContext *_open_decoder(AVStream *stream) {
+        const AVCodec *codec = avcodec_find_decoder(stream->codecpar->codec_id);
+        if (!codec) {
+            log::error("%s decoder not found", avcodec_get_name(stream->codecpar->codec_id));
+            return NULL;
+        }
+        AVCodecContext *ctx = avcodec_alloc_context3(codec);
+        if (!ctx) {
+            return NULL;
+        }
+        if (avcodec_parameters_to_context(ctx, stream->codecpar) < 0) {
+            avcodec_free_context(&ctx);
+            return NULL;
+        }
+        ctx->pkt_timebase = stream->time_base;
+        // decode frames in parallel, frames are returned in order with a few frames delay
+        ctx->thread_count = 0;
+        ctx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+        int ret = avcodec_open2(ctx, codec, NULL);
+        if (ret < 0) {
+            log::error("open decoder %s failed: %s", codec->name, _av_err_str(ret).c_str());
+            avcodec_free_context(&ctx);
+            return NULL;
+        }
+        return ctx;
+    }
+
+    static int _get_audio_channels(AVCodecContext *ctx) {
+#if _FFMPEG_CH_LAYOUT
+        return ctx->ch_layout.nb_channels;
+#else
+        return ctx->channels;
+#endif
+    }
+
+    // convert sample format to S16, keep sample rate and channels
+    static SwrContext *_create_swr(AVCodecContext *ctx) {
+        SwrContext *swr = NULL;
+#if _FFMPEG_CH_LAYOUT
+        AVChannelLayout layout;
+        if (ctx->ch_layout.order == AV_CHANNEL_ORDER_UNSPEC) {
+            av_channel_layout_default(&layout, ctx->ch_layout.nb_channels);
+        } else {
+            av_channel_layout_copy(&layout, &ctx->ch_layout);
+        }
+        int ret = swr_alloc_set_opts2(&swr, &layout, AV_SAMPLE_FMT_S16, ctx->sample_rate,
+                                        &layout, ctx->sample_fmt, ctx->sample_rate, 0, NULL);
+        av_channel_layout_uninit(&layout);
+        if (ret < 0) {
+            return NULL;
+        }
+#else
+        int64_t layout = ctx->channel_layout ? ctx->channel_layout : av_get_default_channel_layout(ctx->channels);
+        swr = swr_alloc_set_opts(NULL, layout, AV_SAMPLE_FMT_S16, ctx->sample_rate,
+                                    layout, ctx->sample_fmt, ctx->sample_rate, 0, NULL);
+        if (!swr) {
+            return NULL;
+        }
+#endif
+        if (swr_init(swr) < 0) {
+            swr_free(&swr);
+            return NULL;
+        }
+        return swr;
+    }
+
+    static void _release_decoder(decoder_param_t *param) {
+        avcodec_free_context(&param->video_ctx);
+        avcodec_free_context(&param->audio_ctx);
+        av_frame_free(&param->video_frame);
+        av_frame_free(&param->audio_frame);
+        av_bsf_free(&param->bsf_ctx);
+        sws_freeContext(param->sws_ctx);
+        swr_free(&param->swr_ctx);
+        av_packet_free(&param->packet);
+        avformat_close_input(&param->format_ctx);
+        delete param;
+    }
+
+    static void _release_av_frame(void *data, void *arg) {
+        (void)data;
+        AVFrame *frame = (AVFrame *)arg;
+        av_frame_free(&frame);
+    }
+
+    // image shares decoded frame buffer if layout is the same, else frame is converted to image buffer in one pass
+    static image::Image *_frame_to_image(decoder_param_t *param, AVFrame *frame, image::Format format) {
+        int w = frame->width;
+        int h = frame->height;
+        enum AVPixelFormat src_format = (enum AVPixelFormat)frame->format;
+        enum AVPixelFormat dst_format = _image_format_to_ffmpeg(format);
+        uint8_t *data[4];
+        int linesize[4];
+
+        bool share = false;
+        bool y_plane = false;
+        if (format == image::FMT_GRAYSCALE) {
+            // Y plane of 8 bits YUV is grayscale image
+            const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(src_format);
+            y_plane = desc && !(desc->flags & AV_PIX_FMT_FLAG_RGB) && desc->comp[0].plane == 0
+                    && desc->comp[0].depth == 8 && desc->comp[0].step == 1;
+            share = y_plane && frame->linesize[0] == w;
+        } else if (src_format == dst_format) {
+            _fill_image_arrays(data, linesize, frame->data[0], format, w, h);
+            share = true;
+            for (int i = 0; i < 4 && data[i]; i++) {
+                if (data[i] != frame->data[i] || linesize[i] != frame->linesize[i]) {
+                    share = false;
+                }
+            }
+        }
+        if (share) {
+            AVFrame *ref = av_frame_clone(frame);
+            if (ref) {
+                image::Image *img = new image::Image(w, h, format, ref->data[0], -1, false);
+                img->set_release_callback(_release_av_frame, ref);
+                return img;
+            }
+        }
+
+        image::Image *img = new image::Image(w, h, format);
+        _fill_image_arrays(data, linesize, (uint8_t *)img->data(), format, w, h);
+        if (y_plane) {
+            av_image_copy_plane(data[0], linesize[0], frame->data[0], frame->linesize[0], w, h);
+        } else if (src_format == dst_format) {
+            av_image_copy(data, linesize, (const uint8_t **)frame->data, frame->linesize, src_format, w, h);
+        } else {
+            param->sws_ctx = sws_getCachedContext(param->sws_ctx, w, h, src_format, w, h, dst_format, SWS_BILINEAR, NULL, NULL, NULL);
+            if (!param->sws_ctx) {
+                log::error("convert %s to %s not support", av_get_pix_fmt_name(src_format), image::fmt_names[format].c_str());
+                delete img;
+                return NULL;
+            }
+            sws_scale(param->sws_ctx, (const uint8_t *const *)frame->data, frame->linesize, 0, h, data, linesize);
+        }
+        return img;
+    }
+
+    // get one decoded video frame, return NULL if decoder need more packets or all frames are returned
+    static video::Context *_receive_video(decoder_param_t *param, image::Format format, uint64_t &last_pts) {
+        AVStream *stream = param->format_ctx->streams[param->video_stream_index];
+        AVFrame *frame = param->video_frame;
+        while (!param->video_eof) {
+            int ret = avcodec_receive_frame(param->video_ctx, frame);
+            if (ret == AVERROR(EAGAIN)) {
+                return NULL;
+            }
+            if (ret < 0) {
+                if (ret != AVERROR_EOF) {
+                    log::error("decode video failed: %s", _av_err_str(ret).c_str());
+                }
+                param->video_eof = true;
+                return NULL;
+            }
+
+            int64_t pts = frame->best_effort_timestamp;
+            if (pts == AV_NOPTS_VALUE) {
+                pts = param->next_pts;
+            }
+            int64_t duration = _frame_duration(frame);
+            if (duration <= 0) {
+                duration = param->frame_duration;
+            }
+            param->next_pts = pts + duration;
+            if (param->video_skip_pts != AV_NOPTS_VALUE) {
+                if (pts + duration <= param->video_skip_pts) {
+                    av_frame_unref(frame);
+                    continue;
+                }
+                param->video_skip_pts = AV_NOPTS_VALUE;
+            }
+
+            image::Image *img = _frame_to_image(param, frame, format);
+            av_frame_unref(frame);
+            std::vector<int> timebase = {stream->time_base.num, stream->time_base.den};
+            video::Context *context = new video::Context(img ? MEDIA_TYPE_VIDEO : MEDIA_TYPE_UNKNOWN, timebase);
+            context->set_image(img, duration, pts, last_pts);
+            last_pts = pts;
+            return context;
+        }
+        return NULL;
+    }
+
+    // get one decoded audio frame as S16 pcm, return NULL if decoder need more packets or all frames are returned
+    static video::Context *_receive_audio(decoder_param_t *param) {
+        AVStream *stream = param->format_ctx->streams[param->audio_stream_index];
+        AVFrame *frame = param->audio_frame;
+        int channels = _get_audio_channels(param->audio_ctx);
+        while (!param->audio_eof) {
+            int ret = avcodec_receive_frame(param->audio_ctx, frame);
+            if (ret == AVERROR(EAGAIN)) {
+                return NULL;
+            }
+            if (ret < 0) {
+                if (ret != AVERROR_EOF) {
+                    log::error("decode audio failed: %s", _av_err_str(ret).c_str());
+                }
+                param->audio_eof = true;
+                return NULL;
+            }
+
+            int64_t pts = frame->best_effort_timestamp;
+            int64_t duration = _frame_duration(frame);
+            if (param->audio_skip_pts != AV_NOPTS_VALUE && pts != AV_NOPTS_VALUE) {
+                if (pts + duration <= param->audio_skip_pts) {
+                    av_frame_unref(frame);
+                    continue;
+                }
+                param->audio_skip_pts = AV_NOPTS_VALUE;
+            }
+
+            int max_samples = swr_get_out_samples(param->swr_ctx, frame->nb_samples);
+            param->pcm.resize((size_t)(max_samples > 0 ? max_samples : 0) * channels * 2);
+            uint8_t *out = param->pcm.data();
+            int samples = max_samples > 0 ? swr_convert(param->swr_ctx, &out, max_samples, (const uint8_t **)frame->extended_data, frame->nb_samples) : 0;
+            av_frame_unref(frame);
+            if (samples <= 0) {
+                continue;
+            }
+
+            std::vector<int> timebase = {stream->time_base.num, stream->time_base.den};
+            video::Context *context = new video::Context(MEDIA_TYPE_AUDIO, timebase, param->audio_ctx->sample_rate, audio::FMT_S16_LE, channels);
+            Bytes data(param->pcm.data(), samples * channels * 2, false, false);
+            context->set_pcm(&data, duration, pts == AV_NOPTS_VALUE ? 0 : pts);
+            return context;
+        }
+        return NULL;
+    }
+
+    // read next packet of wanted streams and send it to decoder,
+    // return MEDIA_TYPE_UNKNOWN at the end of file after decoders are set to draining.
+    static video::MediaType _send_packet(decoder_param_t *param, bool video, bool audio) {
+        AVPacket *packet = param->packet;
+        while (!param->eof) {
+            int ret = av_read_frame(param->format_ctx, packet);
+            if (ret < 0) {
+                param->eof = true;
+                if (param->video_ctx) {
+                    avcodec_send_packet(param->video_ctx, NULL);
+                }
+                if (param->audio_ctx) {
+                    avcodec_send_packet(param->audio_ctx, NULL);
+                }
+                break;
+            }
+
+            video::MediaType type = MEDIA_TYPE_UNKNOWN;
+            if (video && packet->stream_index == param->video_stream_index) {
+                ret = avcodec_send_packet(param->video_ctx, packet);
+                type = MEDIA_TYPE_VIDEO;
+            } else if (audio && packet->stream_index == param->audio_stream_index) {
+                ret = avcodec_send_packet(param->audio_ctx, packet);
+                type = MEDIA_TYPE_AUDIO;
+            }
+            av_packet_unref(packet);
+            if (type != MEDIA_TYPE_UNKNOWN) {
+                if (ret < 0) {
+                    log::warn("drop broken packet: %s", _av_err_str(ret).c_str());
+                }
+                return type;
+            }
+        }
+        return MEDIA_TYPE_UNKNOWN;
+    }
+
     Decoder::Decoder(std::string path, image::Format format) {
-        throw err::Exception(err::ERR_NOT_IMPL);
+        err::check_bool_raise(_image_format_to_ffmpeg(format) != AV_PIX_FMT_NONE, "Decoder not support format " + image::fmt_names[format]);
+        _path = path;
+        _format_out = format;
+        _width = 0;
+        _height = 0;
+        _bitrate = 0;
+        _fps = 0;
+        _has_video = false;
+        _has_audio = false;
+        _last_pts = 0;
+        _audio_sample_rate = 0;
+        _audio_format = audio::FMT_NONE;
+        _audio_channels = 0;
+        _param = NULL;
+
+        av_log_set_level(AV_LOG_ERROR);
+        decoder_param_t *param = new decoder_param_t();
+        param->video_stream_index = -1;
+        param->audio_stream_index = -1;
+        param->video_skip_pts = AV_NOPTS_VALUE;
+        param->audio_skip_pts = AV_NOPTS_VALUE;
+        auto open_failed = [param](err::Err e, const std::string &msg) {
+            _release_decoder(param);
+            throw err::Exception(e, msg);
+        };
+
+        int ret = avformat_open_input(&param->format_ctx, _path.c_str(), NULL, NULL);
+        if (ret < 0) {
+            open_failed(err::ERR_IO, "Could not open file " + _path + ": " + _av_err_str(ret));
+        }
+        if (avformat_find_stream_info(param->format_ctx, NULL) < 0) {
+            open_failed(err::ERR_RUNTIME, "Could not find stream information");
+        }
+        _bitrate = param->format_ctx->bit_rate;
+        param->packet = av_packet_alloc();
+        if (!param->packet) {
+            open_failed(err::ERR_NO_MEM, "alloc packet failed");
+        }
+
+        int video_index = av_find_best_stream(param->format_ctx, AVMEDIA_TYPE_VIDEO, -1, -1, NULL, 0);
+        if (video_index >= 0) {
+            AVStream *stream = param->format_ctx->streams[video_index];
+            param->video_ctx = _open_decoder(stream);
+            param->video_frame = av_frame_alloc();
+            if (!param->video_ctx || !param->video_frame) {
+                open_failed(err::ERR_NOT_IMPL, "Could not open video decoder");
+            }
+            param->video_stream_index = video_index;
+            param->start_pts = stream->start_time == AV_NOPTS_VALUE ? 0 : stream->start_time;
+            param->next_pts = param->start_pts;
+            AVRational frame_rate = av_guess_frame_rate(param->format_ctx, stream, NULL);
+            param->frame_duration = frame_rate.num > 0 ? av_rescale_q(1, av_inv_q(frame_rate), stream->time_base) : 0;
+
+            // unpack returns annex-b stream as hardware decoders, convert if stream is in avcC/hvcC format
+            enum AVCodecID codec_id = stream->codecpar->codec_id;
+            if ((codec_id == AV_CODEC_ID_H264 || codec_id == AV_CODEC_ID_HEVC)
+                && stream->codecpar->extradata_size > 0 && stream->codecpar->extradata[0] == 1) {
+                const AVBitStreamFilter *filter = av_bsf_get_by_name(codec_id == AV_CODEC_ID_H264 ? "h264_mp4toannexb" : "hevc_mp4toannexb");
+                if (filter && av_bsf_alloc(filter, &param->bsf_ctx) >= 0) {
+                    avcodec_parameters_copy(param->bsf_ctx->par_in, stream->codecpar);
+                    param->bsf_ctx->time_base_in = stream->time_base;
+                    if (av_bsf_init(param->bsf_ctx) < 0) {
+                        av_bsf_free(&param->bsf_ctx);
+                    }
+                }
+            }
+
+            _has_video = true;
+            _width = param->video_ctx->width;
+            _height = param->video_ctx->height;
+            _fps = (int)(av_q2d(frame_rate) + 0.5);
+            _timebase = {stream->time_base.num, stream->time_base.den};
+        }
+
+        int audio_index = av_find_best_stream(param->format_ctx, AVMEDIA_TYPE_AUDIO, -1, video_index, NULL, 0);
+        if (audio_index >= 0) {
+            AVStream *stream = param->format_ctx->streams[audio_index];
+            param->audio_ctx = _open_decoder(stream);
+            param->audio_frame = av_frame_alloc();
+            if (param->audio_ctx && param->audio_frame) {
+                param->swr_ctx = _create_swr(param->audio_ctx);
+            }
+            if (param->swr_ctx) {
+                param->audio_stream_index = audio_index;
+                _has_audio = true;
+                _audio_sample_rate = param->audio_ctx->sample_rate;
+                _audio_channels = _get_audio_channels(param->audio_ctx);
+                _audio_format = audio::FMT_S16_LE;
+                if (!_has_video) {
+                    _timebase = {stream->time_base.num, stream->time_base.den};
+                }
+            } else {
+                log::warn("audio of %s can not be decoded, ignore it", _path.c_str());
+                avcodec_free_context(&param->audio_ctx);
+                av_frame_free(&param->audio_frame);
+            }
+        }
+
+        if (!_has_video && !_has_audio) {
+            open_failed(err::ERR_NOT_FOUND, "No video or audio stream found in " + _path);
+        }
+        _param = param;
     }
 
     Decoder::~Decoder() {
-        throw err::Exception(err::ERR_NOT_IMPL);
+        decoder_param_t *param = (decoder_param_t *)_param;
+        if (param) {
+            _release_decoder(param);
+            _param = NULL;
+        }
     }
 
     video::Context *Decoder::decode_video(bool block) {
-        return NULL;
+        decoder_param_t *param = (decoder_param_t *)_param;
+        if (!_has_video) {
+            return NULL;
+        }
+
+        while (true) {
+            video::Context *context = _receive_video(param, _format_out, _last_pts);
+            if (context || param->video_eof) {
+                return context;
+            }
+            video::MediaType type = _send_packet(param, true, false);
+            if (!block && type == MEDIA_TYPE_VIDEO) {
+                context = _receive_video(param, _format_out, _last_pts);
+                if (context || param->video_eof) {
+                    return context;
+                }
+                return new video::Context(MEDIA_TYPE_UNKNOWN, _timebase);
+            }
+        }
     }
 
     video::Context *Decoder::decode_audio() {
-        return NULL;
+        decoder_param_t *param = (decoder_param_t *)_param;
+        if (!_has_audio) {
+            return NULL;
+        }
+
+        while (true) {
+            video::Context *context = _receive_audio(param);
+            if (context || param->audio_eof) {
+                return context;
+            }
+            _send_packet(param, false, true);
+        }
     }
 
     video::Context *Decoder::decode(bool block) {
-        (void)block;
-        return NULL;
+        decoder_param_t *param = (decoder_param_t *)_param;
+
+        while (true) {
+            video::Context *context = NULL;
+            if (_has_audio && (context = _receive_audio(param))) {
+                return context;
+            }
+            if (_has_video && (context = _receive_video(param, _format_out, _last_pts))) {
+                return context;
+            }
+            bool video_end = !_has_video || param->video_eof;
+            bool audio_end = !_has_audio || param->audio_eof;
+            if (video_end && audio_end) {
+                return NULL;
+            }
+
+            video::MediaType type = _send_packet(param, _has_video, _has_audio);
+            if (!block && type == MEDIA_TYPE_VIDEO) {
+                context = _receive_video(param, _format_out, _last_pts);
+                if (context || param->video_eof) {
+                    return context;
+                }
+                return new video::Context(MEDIA_TYPE_UNKNOWN, _timebase);
+            }
+        }
     }
 
     err::Err Decoder::push(pipeline::Stream *stream) {
+        (void)stream;
+        log::error("pipeline is not supported by software decoder, use decode instead");
         return err::ERR_NOT_IMPL;
     }
 
     pipeline::Frame *Decoder::pop(int block_ms) {
+        (void)block_ms;
+        log::error("pipeline is not supported by software decoder, use decode instead");
         return nullptr;
     }
 
+    video::Context *Decoder::unpack() {
+        decoder_param_t *param = (decoder_param_t *)_param;
+        AVPacket *packet = param->packet;
+
+        while (av_read_frame(param->format_ctx, packet) >= 0) {
+            if (packet->stream_index == param->video_stream_index) {
+                int64_t pts = packet->pts;
+                int64_t duration = packet->duration;
+                if (param->bsf_ctx) {
+                    if (av_bsf_send_packet(param->bsf_ctx, packet) < 0 || av_bsf_receive_packet(param->bsf_ctx, packet) < 0) {
+                        av_packet_unref(packet);
+                        continue;
+                    }
+                }
+                video::Context *context = new video::Context(MEDIA_TYPE_VIDEO, _timebase);
+                context->set_raw_data(packet->data, packet->size, duration, pts, _last_pts, true);
+                _last_pts = pts;
+                param->next_pts = pts + duration;
+                av_packet_unref(packet);
+                return context;
+            } else if (packet->stream_index == param->audio_stream_index) {
+                avcodec_send_packet(param->audio_ctx, packet);
+                av_packet_unref(packet);
+                video::Context *context = _receive_audio(param);
+                if (context) {
+                    return context;
+                }
+                continue;
+            }
+            av_packet_unref(packet);
+        }
+        return NULL;
+    }
+
     double Decoder::seek(double time) {
-        throw err::Exception(err::ERR_NOT_IMPL);
-        return 0;
+        decoder_param_t *param = (decoder_param_t *)_param;
+        int index = _has_video ? param->video_stream_index : param->audio_stream_index;
+        AVStream *stream = param->format_ctx->streams[index];
+
+        if (time < 0) {
+            if (!_has_video) {
+                return 0;
+            }
+            return (param->next_pts - param->start_pts) * av_q2d(stream->time_base);
+        }
+
+        int64_t target_us = (int64_t)(time * AV_TIME_BASE);
+        int64_t start = stream->start_time == AV_NOPTS_VALUE ? 0 : stream->start_time;
+        int64_t target = av_rescale_q(target_us, AV_TIME_BASE_Q, stream->time_base) + start;
+        int ret = av_seek_frame(param->format_ctx, index, target, AVSEEK_FLAG_BACKWARD);
+        if (ret < 0) {
+            log::error("seek to %.3f s failed: %s", time, _av_err_str(ret).c_str());
+            return -1;
+        }
+
+        // decoding restarts from the key frame before target, frames before target are decoded and dropped
+        param->eof = false;
+        if (param->video_ctx) {
+            avcodec_flush_buffers(param->video_ctx);
+            param->video_eof = false;
+            param->video_skip_pts = target;
+            param->next_pts = target;
+        }
+        if (param->audio_ctx) {
+            AVStream *audio_stream = param->format_ctx->streams[param->audio_stream_index];
+            int64_t audio_start = audio_stream->start_time == AV_NOPTS_VALUE ? 0 : audio_stream->start_time;
+            avcodec_flush_buffers(param->audio_ctx);
+            param->audio_eof = false;
+            param->audio_skip_pts = av_rescale_q(target_us, AV_TIME_BASE_Q, audio_stream->time_base) + audio_start;
+        }
+        if (param->bsf_ctx) {
+            av_bsf_flush(param->bsf_ctx);
+        }
+        return time;
     }
 
     double Decoder::duration() {
-        throw err::Exception(err::ERR_NOT_IMPL);
+        decoder_param_t *param = (decoder_param_t *)_param;
+        AVFormatContext *format_ctx = param->format_ctx;
+        if (format_ctx->duration != AV_NOPTS_VALUE && format_ctx->duration > 0) {
+            return (double)format_ctx->duration / AV_TIME_BASE;
+        }
+        int index = _has_video ? param->video_stream_index : param->audio_stream_index;
+        AVStream *stream = format_ctx->streams[index];
+        if (stream->duration != AV_NOPTS_VALUE && stream->duration > 0) {
+            return stream->duration * av_q2d(stream->time_base);
+        }
         return 0;
     }
 
+    void *Decoder::get_driver() {
+        decoder_param_t *param = (decoder_param_t *)_param;
+        return param->video_ctx;
+    }
+
     Video::Video(std::string path, int width, int height, image::Format format, int time_base, int framerate, bool capture, bool open)
     {
-        (void)path;
-        (void)width;
-        (void)height;
-        (void)format;
-        (void)time_base;
-        (void)framerate;
-        (void)capture;
-        (void)open;
-        throw err::Exception(err::ERR_NOT_IMPL);
+        (void)format;   // decided by the first encoded image
+        this->_pre_path = path;
+        this->_pre_fps = framerate;
+        this->_video_type = VIDEO_NONE;
+        this->_bind_camera = false;
+        this->_is_recording = false;
+        this->_camera = NULL;
+        this->_fd = -1;
+        this->_time_base = time_base;
+        this->_framerate = framerate;
+        this->_need_auto_config = true;
+        this->_pre_width = width;
+        this->_pre_height = height;
+        this->_width = width;
+        this->_height = height;
+        this->_last_pts = 0;
+        this->_capture_image = nullptr;
+        this->_need_capture = capture;
+        this->_is_opened = false;
+        this->_param = nullptr;
+
+        if (open) {
+            err::check_bool_raise(err::ERR_NONE == this->open(), "Video open failed!\r\n");
+        }
     }
 
     Video::~Video() {
@@ -125,27 +1197,96 @@ namespace maix::video
 
     err::Err Video::open(std::string path, double fps)
     {
-        (void)path;
-        (void)fps;
-        throw err::Exception(err::ERR_NOT_IMPL);
+        if (this->_is_opened) {
+            return err::ERR_NONE;
+        }
+
+        if (path == std::string()) {
+            this->_path = this->_pre_path;
+        } else {
+            this->_path = path;
+        }
+
+        if (fps == 30.0) {
+            this->_fps = this->_pre_fps;
+        } else {
+            this->_fps = fps;
+        }
+
+        this->_is_opened = true;
         return err::ERR_NONE;
     }
 
     void Video::close()
     {
-        throw err::Exception(err::ERR_NOT_IMPL);
+        finish();
+        if (_capture_image && _capture_image->data()) {
+            delete _capture_image;
+            _capture_image = nullptr;
+        }
+        this->_is_opened = false;
     }
 
     err::Err Video::bind_camera(camera::Camera *camera) {
-        (void)camera;
-        err::Err err = err::ERR_NONE;
-        throw err::Exception(err::ERR_NOT_IMPL);
-        return err;
+        if (_image_format_to_ffmpeg(camera->format()) == AV_PIX_FMT_NONE) {
+            log::error("bind camera failed! format %s not support", image::fmt_names[camera->format()].c_str());
+            return err::ERR_ARGS;
+        }
+
+        this->_camera = camera;
+        this->_bind_camera = true;
+        return err::ERR_NONE;
     }
 
     video::Packet *Video::encode(image::Image *img) {
-        (void)img;
-        return nullptr;
+        image::Image *camera_img = NULL;
+        if (!img || !img->data()) {
+            if (!_bind_camera) {
+                log::error("encode img is null");
+                return new video::Packet();
+            }
+            camera_img = _camera->read();
+            if (!camera_img) {
+                log::error("read camera failed");
+                return new video::Packet();
+            }
+            img = camera_img;
+        }
+
+        // encoder is created by the first image, file is completed by finish
+        video::Encoder *encoder = (video::Encoder *)_param;
+        if (!encoder) {
+            try {
+                encoder = new video::Encoder(_path, img->width(), img->height(), img->format(), VIDEO_H264, (int)_fps, 50, 3000 * 1000, _time_base);
+            } catch (err::Exception &e) {
+                log::error("create encoder failed: %s", e.what());
+                delete camera_img;
+                return new video::Packet();
+            }
+            _param = encoder;
+            _width = img->width();
+            _height = img->height();
+            _is_recording = true;
+        }
+
+        if (_need_capture) {
+            delete _capture_image;
+            _capture_image = camera_img ? camera_img : img->copy();
+            camera_img = NULL;
+        }
+
+        video::Frame *frame = encoder->encode(img);
+        delete camera_img;
+        uint8_t *data = NULL;
+        int size = frame->size();
+        if (size > 0) {
+            data = (uint8_t *)malloc(size);
+            err::check_null_raise(data, "malloc failed!");
+            memcpy(data, frame->data(), size);
+        }
+        video::Packet *packet = new video::Packet(data, size, frame->get_pts(), frame->get_dts());
+        delete frame;
+        return packet;
     }
 
     image::Image *Video::decode(video::Frame *frame) {
@@ -154,163 +1295,536 @@ namespace maix::video
     }
 
     err::Err Video::finish() {
-        throw err::Exception(err::ERR_NOT_IMPL);
-        return err::ERR_NOT_IMPL;
+        video::Encoder *encoder = (video::Encoder *)_param;
+        if (encoder) {
+            delete encoder;     // flush encoder and write file tail
+            _param = nullptr;
+        }
+        _is_recording = false;
+        return err::ERR_NONE;
+    }
+
+    typedef enum {
+        VIDEO_RECORDER_IDLE = 0,
+        VIDEO_RECORDER_RECORD,           // record and display
+    } video_recoder_state_t;
+
+    class rect_info {
+    public:
+        int id;
+        int x;
+        int y;
+        int w;
+        int h;
+        image::Color color = image::Color(255);
+        int thickness;
+        bool show = false;
+    };
+
+    typedef struct {
+        std::timed_mutex lock;
+        video_recoder_state_t state;
+        std::string path;
+        bool snapshot_en;
+        std::vector<int> snapshot_res;
+        image::Format snapshot_fmt;
+        image::Image *snapshot_img;
+        uint64_t record_start_ms;
+        std::atomic<int64_t> seek_ms;
+
+        struct {
+            int fps;
+            int bitrate;
+            std::vector<int> resolution;
+            video::Encoder *obj;
+        } venc;
+
+        camera::Camera *camera;
+
+        struct {
+            display::Display *obj;
+            image::Fit fit;
+        } display;
+
+        audio::Recorder *audio;
+
+        std::thread *thread;
+        std::atomic<bool> thread_exit;
+        std::vector<rect_info> rect;
+    } video_recoder_param_t;
+
+    static void _video_recoder_config_default(video_recoder_param_t *param)
+    {
+        param->path = "";
+        param->snapshot_en = false;
+        param->snapshot_res.clear();
+        param->snapshot_fmt = image::FMT_YVU420SP;
+        if (param->snapshot_img) {
+            delete param->snapshot_img;
+            param->snapshot_img = NULL;
+        }
+        param->venc.fps = 30;
+        param->venc.bitrate = 3000 * 1000;
+        param->venc.resolution.clear();
+        param->rect.assign(16, rect_info());
+    }
+
+    static image::Image *_video_recoder_snapshot(image::Image *img, const std::vector<int> &res, image::Format format)
+    {
+        image::Image *snapshot = img->format() == format ? img->copy() : img->to_format(format);
+        if (snapshot && res.size() >= 2 && (snapshot->width() != res[0] || snapshot->height() != res[1])) {
+            image::Image *resized = snapshot->resize(res[0], res[1]);
+            delete snapshot;
+            snapshot = resized;
+        }
+        return snapshot;
+    }
+
+    // read camera, draw rects, keep snapshot, encode and display every frame
+    static void _video_recoder_thread(video_recoder_param_t *param)
+    {
+        while (!param->thread_exit && !app::need_exit()) {
+            param->lock.lock();
+            camera::Camera *camera = param->camera;
+            param->lock.unlock();
+            if (!camera) {
+                time::sleep_ms(10);
+                continue;
+            }
+            image::Image *img = camera->read();
+            if (!img) {
+                continue;
+            }
+
+            param->lock.lock();
+            for (auto &r : param->rect) {
+                if (r.show) {
+                    img->draw_rect(r.x, r.y, r.w, r.h, r.color, r.thickness);
+                }
+            }
+            if (param->snapshot_en) {
+                delete param->snapshot_img;
+                param->snapshot_img = _video_recoder_snapshot(img, param->snapshot_res, param->snapshot_fmt);
+            }
+            if (param->state == VIDEO_RECORDER_RECORD && param->venc.obj) {
+                delete param->venc.obj->encode(img);
+                param->seek_ms = time::ticks_ms() - param->record_start_ms;
+            }
+            display::Display *display = param->display.obj;
+            image::Fit fit = param->display.fit;
+            param->lock.unlock();
+
+            if (display) {
+                display->show(*img, fit);
+            }
+            delete img;
+        }
     }
 
     VideoRecorder::VideoRecorder(bool open)
     {
-        (void)open;
+        video_recoder_param_t *param = new video_recoder_param_t();
+        param->state = VIDEO_RECORDER_IDLE;
+        param->snapshot_img = NULL;
+        param->seek_ms = 0;
+        param->venc.obj = NULL;
+        param->camera = NULL;
+        param->display.obj = NULL;
+        param->display.fit = image::FIT_COVER;
+        param->audio = NULL;
+        param->thread = NULL;
+        param->thread_exit = false;
+        _video_recoder_config_default(param);
+
+        _is_opened = false;
+        _param = param;
+
+        if (open) {
+            this->open();
+        }
     }
 
     VideoRecorder::~VideoRecorder()
     {
+        close();
+
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        if (param) {
+            delete param->snapshot_img;
+            delete param;
+            _param = nullptr;
+        }
     }
 
     err::Err VideoRecorder::open()
     {
-        return err::ERR_NOT_IMPL;
+        if (_is_opened) {
+            return err::ERR_NONE;
+        }
+
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        param->thread_exit = false;
+        param->thread = new std::thread(_video_recoder_thread, param);
+        _is_opened = true;
+        return err::ERR_NONE;
     }
 
     err::Err VideoRecorder::close()
     {
-        return err::ERR_NOT_IMPL;
+        if (!_is_opened) {
+            return err::ERR_NONE;
+        }
+
+        record_finish();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        param->thread_exit = true;
+        param->thread->join();
+        delete param->thread;
+        param->thread = NULL;
+        _is_opened = false;
+        return err::ERR_NONE;
     }
 
     err::Err VideoRecorder::lock(int64_t timeout)
     {
-        (void)timeout;
-        return err::ERR_NOT_IMPL;
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        if (timeout < 0) {
+            param->lock.lock();
+            return err::ERR_NONE;
+        }
+        return param->lock.try_lock_for(std::chrono::milliseconds(timeout)) ? err::ERR_NONE : err::ERR_TIMEOUT;
     }
 
     err::Err VideoRecorder::unlock()
     {
-        return err::ERR_NOT_IMPL;
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        param->lock.unlock();
+        return err::ERR_NONE;
     }
 
     err::Err VideoRecorder::bind_display(display::Display *display, image::Fit fit)
     {
-        (void)display;
-        (void)fit;
-        return err::ERR_NOT_IMPL;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        param->display.obj = display;
+        param->display.fit = fit;
+        unlock();
+        return display ? err::ERR_NONE : err::ERR_ARGS;
     }
 
     err::Err VideoRecorder::bind_camera(camera::Camera *camera)
     {
-        (void)camera;
-        return err::ERR_NOT_IMPL;
+        if (camera && _image_format_to_ffmpeg(camera->format()) == AV_PIX_FMT_NONE) {
+            log::error("bind camera failed! format %s not support", image::fmt_names[camera->format()].c_str());
+            return err::ERR_ARGS;
+        }
+
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        param->camera = camera;
+        unlock();
+        return camera ? err::ERR_NONE : err::ERR_ARGS;
     }
 
     err::Err VideoRecorder::bind_audio(audio::Recorder *audio)
     {
-        (void)audio;
-        return err::ERR_NOT_IMPL;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        param->audio = audio;
+        unlock();
+        return audio ? err::ERR_NONE : err::ERR_ARGS;
     }
 
     err::Err VideoRecorder::bind_imu(void *imu)
     {
         (void)imu;
+        log::error("bind imu is not supported");
         return err::ERR_NOT_IMPL;
     }
 
     err::Err VideoRecorder::reset()
     {
-        return err::ERR_NOT_IMPL;
+        record_finish();
+
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        _video_recoder_config_default(param);
+        unlock();
+        return err::ERR_NONE;
     }
 
     err::Err VideoRecorder::config_path(std::string path)
     {
-        (void)path;
-        return err::ERR_NOT_IMPL;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        if (param->state != VIDEO_RECORDER_IDLE) {
+            unlock();
+            return err::ERR_BUSY;
+        }
+
+        param->path = path;
+        unlock();
+        return err::ERR_NONE;
     }
 
     std::string VideoRecorder::get_path()
     {
-        return "";
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        std::string path = param->path;
+        unlock();
+        return path;
     }
 
     err::Err VideoRecorder::config_snapshot(bool enable, std::vector<int> resolution, image::Format format)
     {
-        (void)enable;
-        (void)resolution;
-        (void)format;
-        return err::ERR_NOT_IMPL;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        if (param->state != VIDEO_RECORDER_IDLE) {
+            unlock();
+            return err::ERR_BUSY;
+        }
+
+        camera::Camera *cam = param->camera;
+        if (!cam) {
+            unlock();
+            log::error("You must use the bind_camera interface to bind a Camera object.");
+            return err::ERR_RUNTIME;
+        }
+
+        if (enable) {
+            if (resolution.size() < 2) {
+                param->snapshot_res = {cam->width(), cam->height()};
+            } else {
+                param->snapshot_res = resolution;
+            }
+            param->snapshot_fmt = format;
+            param->snapshot_en = true;
+        } else {
+            if (param->snapshot_img) {
+                delete param->snapshot_img;
+                param->snapshot_img = NULL;
+            }
+            param->snapshot_en = false;
+        }
+
+        unlock();
+        return err::ERR_NONE;
     }
 
     err::Err VideoRecorder::config_resolution(std::vector<int> resolution)
     {
-        (void)resolution;
-        return err::ERR_NOT_IMPL;
+        if (resolution.size() < 2) return err::ERR_ARGS;
+
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        if (param->state != VIDEO_RECORDER_IDLE) {
+            unlock();
+            return err::ERR_BUSY;
+        }
+
+        camera::Camera *cam = param->camera;
+        if (!cam) {
+            unlock();
+            log::error("You must use the bind_camera interface to bind a Camera object.");
+            return err::ERR_RUNTIME;
+        }
+
+        cam->set_resolution(resolution[0], resolution[1]);
+
+        param->venc.resolution = resolution;
+        unlock();
+        return err::ERR_NONE;
     }
 
     std::vector<int> VideoRecorder::get_resolution()
     {
-        return {};
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        std::vector<int> resolution = param->venc.resolution;
+        if (resolution.size() == 0 && param->camera) {
+            resolution = {param->camera->width(), param->camera->height()};
+        }
+        unlock();
+
+        err::check_bool_raise(resolution.size() == 2, "You need config resolution!");
+        return resolution;
     }
 
     err::Err VideoRecorder::config_fps(int fps)
     {
-        return err::ERR_NOT_IMPL;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        if (param->state != VIDEO_RECORDER_IDLE) {
+            unlock();
+            return err::ERR_BUSY;
+        }
+
+        camera::Camera *cam = param->camera;
+        if (!cam) {
+            unlock();
+            log::error("You must use the bind_camera interface to bind a Camera object.");
+            return err::ERR_RUNTIME;
+        }
+
+        cam->set_fps(fps);
+
+        param->venc.fps = fps;
+        unlock();
+        return err::ERR_NONE;
     }
 
     int VideoRecorder::get_fps()
     {
-        return 0;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        int fps = param->venc.fps;
+        unlock();
+        return fps;
     }
 
     err::Err VideoRecorder::config_bitrate(int bitrate)
     {
-        (void)bitrate;
-        return err::ERR_NOT_IMPL;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        if (param->state != VIDEO_RECORDER_IDLE) {
+            unlock();
+            return err::ERR_BUSY;
+        }
+
+        param->venc.bitrate = bitrate;
+        unlock();
+        return err::ERR_NONE;
     }
 
     int VideoRecorder::get_bitrate()
     {
-        return 0;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        int bitrate = param->venc.bitrate;
+        unlock();
+        return bitrate;
     }
 
     int VideoRecorder::mute(int data)
     {
-        (void)data;
-        return 0;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        int current_mute = 0;
+        if (param->audio) {
+            current_mute = param->audio->mute(data);
+        }
+        unlock();
+
+        return current_mute;
     }
 
     int VideoRecorder::volume(int data)
     {
-        (void)data;
-        return 0;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        int current_volume = 0;
+        if (param->audio) {
+            current_volume = param->audio->volume(data >= 100 ? 100 : data);
+        }
+        unlock();
+
+        return current_volume;
     }
 
     int64_t VideoRecorder::seek()
     {
-        return 0;
+        // Only read param, so don't lock
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        return param->seek_ms;
     }
 
     err::Err VideoRecorder::record_start()
     {
-        return err::ERR_NOT_IMPL;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        if (param->state != VIDEO_RECORDER_IDLE) {
+            unlock();
+            return err::ERR_BUSY;
+        }
+
+        camera::Camera *cam = param->camera;
+        if (!cam) {
+            unlock();
+            log::error("You must use the bind_camera interface to bind a Camera object.");
+            return err::ERR_RUNTIME;
+        }
+        if (param->path.size() == 0) {
+            unlock();
+            log::error("You must use the config_path interface to set the path of video file.");
+            return err::ERR_ARGS;
+        }
+
+        std::vector<int> resolution = param->venc.resolution;
+        if (resolution.size() < 2) {
+            resolution = {cam->width(), cam->height()};
+        }
+        try {
+            // encode in encoder thread, so camera and display are not blocked by encoding
+            param->venc.obj = new video::Encoder(param->path, resolution[0], resolution[1], cam->format(), VIDEO_H264,
+                                                param->venc.fps, 50, param->venc.bitrate, 1000, false, false);
+        } catch (err::Exception &e) {
+            unlock();
+            log::error("create encoder failed: %s", e.what());
+            return e.code();
+        }
+        param->record_start_ms = time::ticks_ms();
+        param->seek_ms = 0;
+        param->state = VIDEO_RECORDER_RECORD;
+        unlock();
+
+        return open();
     }
 
     image::Image *VideoRecorder::snapshot()
     {
-        return NULL;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        image::Image *new_image = param->snapshot_img;
+        param->snapshot_img = NULL;
+        unlock();
+        return new_image;
     }
 
     err::Err VideoRecorder::record_finish()
     {
-        return err::ERR_NOT_IMPL;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        video::Encoder *encoder = param->venc.obj;
+        param->venc.obj = NULL;
+        param->state = VIDEO_RECORDER_IDLE;
+        unlock();
+
+        // flush encoder and write file tail
+        delete encoder;
+        return err::ERR_NONE;
     }
 
     err::Err VideoRecorder::draw_rect(int id, int x, int y, int w, int h, image::Color color, int thickness, bool hidden)
     {
-        (void)id;
-        (void)x;
-        (void)y;
-        (void)w;
-        (void)h;
-        (void)color;
-        (void)thickness;
-        (void)hidden;
-        return err::ERR_NOT_IMPL;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        if (id < 0 || id >= (int)param->rect.size()) {
+            unlock();
+            log::error("draw_rect id %d out of range", id);
+            return err::ERR_ARGS;
+        }
+
+        param->rect[id].id = id;
+        param->rect[id].x = x;
+        param->rect[id].y = y;
+        param->rect[id].w = w;
+        param->rect[id].h = h;
+        param->rect[id].color = color;
+        param->rect[id].thickness = thickness;
+        param->rect[id].show = !hidden;
+
+        unlock();
+        return err::ERR_NONE;
     }
 } // namespace maix::video
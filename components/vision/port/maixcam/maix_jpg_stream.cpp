@@ -617,4 +617,8 @@ namespace maix::http
 
 			return err::ERR_NONE;
 		}
-}
\ No newline at end of file
+
+        std::map<std::string, std::map<std::string, float>> JpegStreamer::clients_status() {
+			return {};
+		}
+}
@@ -3,9 +3,13 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: to_jpeg and save use software JPEG encoder on platforms without hardware encoder.
+ * @update 2026.10.18: save fall back to opencv if software JPEG encode failed.
  */
 
 #include "maix_image.hpp"
+#include "maix_image_compositor.hpp"
+#include "maix_image_jpeg.hpp"
 #include "opencv2/opencv.hpp"
 #include "opencv2/freetype.hpp"
 #include <map>
@@ -15,6 +19,7 @@
 #include <array>
 #include <sched.h>
 #include <thread>
+#include <mutex>
 #include "omp.h"
 #ifdef PLATFORM_MAIXCAM
 #include "sophgo_middleware.hpp"
@@ -373,6 +378,8 @@ namespace maix::image
         _format = format;
         _width = width;
         _height = height;
+        _release_cb = nullptr;
+        _release_arg = nullptr;
         if (width <= 0 || height <= 0)
             throw err::Exception(err::ERR_ARGS, "image width and height should > 0");
 
@@ -396,14 +403,12 @@ namespace maix::image
 
         if (!data)
         {
-            _actual_data = malloc(_data_size + 0x1000);
-            if (!_actual_data)
+            if (!_alloc_data())
                 throw err::Exception(err::ERR_NO_MEM, "malloc image data failed");
-            _data = (void *)(((uint64_t)_actual_data + 0x1000) & ~0xFFF);
             // set background color
             if(bg.format == image::FMT_INVALID)
             {
-                // do nothing
+                // do nothing, buffer reused from pool keeps last image data
             }
             else if(bg.format == image::FMT_GRAYSCALE)
             {
@@ -451,13 +456,10 @@ namespace maix::image
             }
             else
             {
-                free(_actual_data);
-                _actual_data = NULL;
-                _data = NULL;
+                _release_data();
                 log::error("image bg format not support, format: %d\n", bg.format);
                 throw err::Exception(err::ERR_ARGS, "image bg format not support, use grayscale(recommend)/rgb/rgba");
             }
-            _is_malloc = true;
         }
         else
         {
@@ -469,13 +471,9 @@ namespace maix::image
             }
             else
             {
-                _actual_data = malloc(_data_size + 0x1000);
-                if (!_actual_data)
+                if (!_alloc_data())
                     throw std::bad_alloc();
-                _data = (void *)(((uint64_t)_actual_data + 0x1000) & ~0xFFF);
                 memcpy(_data, data, _data_size);
-                // log::debug("malloc image data\n");
-                _is_malloc = true;
             }
         }
     }
@@ -496,26 +494,60 @@ namespace maix::image
         // _create_image(width, height, format, data->data, data->size(), copy);
     }
 
-    Image::~Image()
+    bool Image::_alloc_data()
     {
-        if (_is_malloc)
+        // reuse buffer of image with the same size and format if possible
+        void *arg = nullptr;
+        _data = image::buffer_pool_alloc(_width, _height, _format, _data_size, &arg);
+        if (_data)
         {
-            // log::debug("free image data\n");
-            free(_actual_data);
-            _actual_data = NULL;
-            _data = NULL;
+            _actual_data = _data;
+            _release_cb = image::buffer_pool_release;
+            _release_arg = arg;
         }
+        else
+        {
+            _actual_data = malloc(_data_size + 0x1000);
+            if (!_actual_data)
+            {
+                _data = NULL;
+                return false;
+            }
+            _data = (void *)(((uint64_t)_actual_data + 0x1000) & ~0xFFF);
+        }
+        _is_malloc = true;
+        return true;
     }
 
-    err::Err Image::update(int width, int height, image::Format format, uint8_t *data, int data_size, bool copy)
+    void Image::_release_data()
     {
-        if (_actual_data && _is_malloc)
+        if (_release_cb)
+        {
+            void (*cb)(void *, void *) = _release_cb;
+            _release_cb = nullptr;
+            cb(_data, _release_arg);
+            _release_arg = nullptr;
+            _actual_data = NULL;
+            _data = NULL;
+            _is_malloc = false;
+        }
+        else if (_actual_data && _is_malloc)
         {
             // log::debug("free image data\n");
             free(_actual_data);
             _actual_data = NULL;
             _data = NULL;
         }
+    }
+
+    Image::~Image()
+    {
+        _release_data();
+    }
+
+    err::Err Image::update(int width, int height, image::Format format, uint8_t *data, int data_size, bool copy)
+    {
+        _release_data();
         _create_image(width, height, format, data, data_size, copy);
         return err::ERR_NONE;
     }
@@ -524,12 +556,9 @@ namespace maix::image
     {
         if (_data)
         {
-            if (_is_malloc)
+            if (_is_malloc || _release_cb)
             {
-                log::info("free _actual_data");
-                free(_actual_data);
-                _actual_data = NULL;
-                _data = NULL;
+                _release_data();
             }
             else
                 throw err::Exception(err::ERR_NOT_IMPL, "not support copy image to not alloc data image");
@@ -538,13 +567,9 @@ namespace maix::image
         _width = img._width;
         _height = img._height;
         _data_size = _width * _height * image::fmt_size[_format];
-        _actual_data = malloc(_data_size + 0x1000);
-        if (!_actual_data)
+        if (!_alloc_data())
             throw std::bad_alloc();
-        _data = (void *)(((uint64_t)_actual_data + 0x1000) & ~0xFFF);
         memcpy(_data, img._data, _data_size);
-        _is_malloc = true;
-        // log::debug("malloc image data\n");
     }
 
     std::string Image::__str__()
@@ -1146,11 +1171,17 @@ namespace maix::image
         return to_format(format, nullptr, 0);
     }
 
+#if !defined(PLATFORM_MAIXCAM) && !defined(PLATFORM_MAIXCAM2)
+    // software JPEG encoder shared by all to_jpeg calls, quant tables and slice buffers are reused between frames
+    static std::mutex _jpeg_encoder_lock;
+    static image::JpegEncoder *_jpeg_encoder = nullptr;
+#endif
+
     image::Image *Image::to_jpeg(int quality, void *buff, size_t buff_size)
     {
+#if defined(PLATFORM_MAIXCAM) || defined(PLATFORM_MAIXCAM2)
         image::Format format = image::Format::FMT_JPEG;
-
-        cv::Mat src(_height, _width, CV_8UC((int)image::fmt_size[_format]), _data);
+#endif
 #if defined(PLATFORM_MAIXCAM)
         quality = quality < 51 ? 51 : quality;
         quality = quality > 99 ? 99 : quality;
@@ -1232,44 +1263,33 @@ __EXIT:
         }
         return img;
 #else
-        // soft convert, slower
-        image::Image *p_img = nullptr;
-        cv::Mat *p_src = &src;
-        bool src_alloc = false;
-        if (_format != Format::FMT_BGR888 && _format != Format::FMT_BGRA8888)
+        // YUV420, gray and RGB are encoded directly, other formats convert to RGB888 first
+        quality = quality < 1 ? 1 : quality;
+        quality = quality > 100 ? 100 : quality;
+        image::Image *p_img = this;
+        if (!image::JpegEncoder::is_support(_format))
         {
-            p_img = to_format(image::FMT_BGR888);
-            p_src = new cv::Mat(p_img->_height, p_img->_width, CV_8UC((int)image::fmt_size[image::FMT_BGR888]), p_img->_data);
-            src_alloc = true;
+            p_img = to_format(image::FMT_RGB888);
+            if (!p_img)
+                throw err::Exception(err::ERR_RUNTIME, "convert format failed, see log");
         }
-        cv::InputArray input(*p_src);
-        std::vector<uchar> jpeg_buff;
-        std::vector<int> params;
-        params.push_back(cv::IMWRITE_JPEG_QUALITY);
-        params.push_back(quality);
-        cv::imencode(".jpg", input, jpeg_buff, params);
-        image::Image *img;
-        if (buff)
+        image::Image *img = nullptr;
+        try
         {
-            if (buff_size < jpeg_buff.size())
-            {
-                if (src_alloc)
-                {
-                    delete p_img;
-                    delete p_src;
-                }
-                throw err::Exception(err::ERR_ARGS, "convert format failed, buffer size not enough");
-            }
-            memcpy(buff, jpeg_buff.data(), jpeg_buff.size());
-            img = new image::Image(src.cols, src.rows, format, (uint8_t *)buff, jpeg_buff.size(), false);
+            std::lock_guard<std::mutex> lock(_jpeg_encoder_lock);
+            if (!_jpeg_encoder)
+                _jpeg_encoder = new image::JpegEncoder(quality);
+            _jpeg_encoder->set_quality(quality);
+            img = _jpeg_encoder->encode_image(*p_img, buff, buff_size);
         }
-        else
-            img = new image::Image(src.cols, src.rows, format, (uint8_t *)jpeg_buff.data(), jpeg_buff.size(), true);
-        if (src_alloc)
+        catch (...)
         {
-            delete p_img;
-            delete p_src;
+            if (p_img != this)
+                delete p_img;
+            throw;
         }
+        if (p_img != this)
+            delete p_img;
         return img;
 #endif
         return nullptr;
@@ -1290,13 +1310,8 @@ __EXIT:
         if (!(fmt == image::FMT_GRAYSCALE || fmt == image::FMT_RGB888 || fmt == image::FMT_BGR888 ||
               fmt == image::FMT_RGBA8888 || fmt == image::FMT_BGRA8888))
             throw std::runtime_error("image format not support");
-        // check format
-        if (image::fmt_size[img.format()] > image::fmt_size[_format])
-            throw std::runtime_error("image format not match");
-        cv::Mat src(img.height(), img.width(), CV_8UC((int)image::fmt_size[img.format()]), img.data());
-        cv::Mat dst(_height, _width, CV_8UC((int)image::fmt_size[_format]), _data);
         cv::Rect rect(x, y, img.width(), img.height());
-        cv::Rect adjustedRect = _adjustRectToFit(rect, dst.size());
+        cv::Rect adjustedRect = _adjustRectToFit(rect, cv::Size(_width, _height));
         int srcX = std::max(0, -x);
         int srcY = std::max(0, -y);
         cv::Rect srcRect(srcX, srcY, adjustedRect.width, adjustedRect.height);
@@ -1304,73 +1319,187 @@ __EXIT:
         {
             throw err::Exception(err::ERR_ARGS, "range error");
         }
-        if (_format == fmt && image::fmt_size[fmt] < 4)
+        // alpha blend, or draw on RGBA and YUV420SP image
+        if (fmt == image::FMT_RGBA8888 || fmt == image::FMT_BGRA8888 ||
+            _format == image::FMT_RGBA8888 || _format == image::FMT_BGRA8888 ||
+            _format == image::FMT_YVU420SP || _format == image::FMT_YUV420SP)
         {
+            err::Err e = image::Compositor::blend(*this, img, x, y);
+            if (e != err::ERR_NONE)
+                throw err::Exception(e, "draw image failed");
+            return this;
+        }
+        // check format
+        if (image::fmt_size[img.format()] > image::fmt_size[_format])
+            throw std::runtime_error("image format not match");
+        cv::Mat dst(_height, _width, CV_8UC((int)image::fmt_size[_format]), _data);
+        if (_format == fmt)
+        {
+            cv::Mat src(img.height(), img.width(), CV_8UC((int)image::fmt_size[fmt]), img.data());
             src(srcRect).copyTo(dst(adjustedRect));
         }
         else
         {
             // convert format
-            bool img_alloc = false;
-            image::Image *img_new = nullptr;
-            if (_format != fmt)
+            image::Image *img_new = img.to_format(_format);
+            if (!img_new)
             {
-                img_new = img.to_format(_format);
-                if (!img_new)
-                {
-                    return img_new;
-                }
-                img_alloc = true;
+                return img_new;
             }
-            else
-                img_new = &img;
             cv::Mat src_new(img_new->height(), img_new->width(), CV_8UC((int)image::fmt_size[_format]), img_new->data());
-            if (image::fmt_size[_format] < 4)
+            src_new(srcRect).copyTo(dst(adjustedRect));
+            delete img_new;
+        }
+        return this;
+    }
+
+    static inline bool _is_yuv420sp(image::Format format)
+    {
+        return format == image::FMT_YVU420SP || format == image::FMT_YUV420SP;
+    }
+
+    /**
+     * Draw target of YUV420SP image, shapes always use full resolution coordinates,
+     * UV plane is half resolution, so it's drawn with OpenCV shift 1(coordinates are fixed point with 1 fractional bit) and halved thickness.
+     */
+    class _YUV420SP_Target
+    {
+    public:
+        cv::Mat &img;
+        cv::Scalar color;
+        cv::Point offset;
+        int shift;
+
+        cv::Point pt(int x, int y) const { return cv::Point(x - offset.x, y - offset.y); }
+        int thickness(int t) const { return t > 0 ? std::max(t >> shift, 1) : t; }
+    };
+
+    /**
+     * Draw shapes on YUV420SP(NV21 and NV12) image directly, no RGB convert, cost only depends on shape area.
+     * Opaque color draw shape on Y plane and UV plane by OpenCV directly,
+     * transparent color and anti-aliased text draw shape to a mask of the shape bounding rect first, then blend mask to Y and UV planes.
+     */
+    class _YUV420SP_Canvas
+    {
+    public:
+        _YUV420SP_Canvas(uint8_t *data, int width, int height, image::Format format, const image::Color &color)
+            : _data(data), _width(width), _height(height)
+        {
+            image::Color c = color;
+            c.to_format(image::FMT_RGBA8888);
+            // BT.601 limited range, the same as OpenCV RGB2YUV_YV12 used by to_format
+            _y = ((66 * c.r + 129 * c.g + 25 * c.b + 128) >> 8) + 16;
+            int u = ((-38 * c.r - 74 * c.g + 112 * c.b + 128) >> 8) + 128;
+            int v = ((112 * c.r - 94 * c.g - 18 * c.b + 128) >> 8) + 128;
+            if (format == image::FMT_YVU420SP)
             {
-                src_new(srcRect).copyTo(dst(adjustedRect));
+                _c0 = v;
+                _c1 = u;
             }
-            else // merge two BGRA images
+            else
             {
-                uint8_t *data = (uint8_t *)_data;
-                #pragma omp parallel for
-                for (int y = 0; y < adjustedRect.height; y++)
+                _c0 = u;
+                _c1 = v;
+            }
+            _alpha = std::min(std::max((int)(c.alpha * 256 + 0.5f), 0), 256);
+        }
+
+        /**
+         * Draw shape
+         * @param x, y, w, h shape bounding rect, can be out of image.
+         * @param func draw function, draw shape on target with target color, coordinates and thickness.
+         * @param mask force draw on mask, for anti-aliased shape.
+         */
+        template <typename F>
+        void draw(int x, int y, int w, int h, F func, bool mask = false)
+        {
+            if (_alpha <= 0)
+                return;
+            if (_alpha >= 256 && !mask)
+            {
+                cv::Mat y_plane(_height, _width, CV_8UC1, _data);
+                cv::Mat uv_plane(_height / 2, _width / 2, CV_8UC2, _data + _width * _height);
+                _YUV420SP_Target y_target{y_plane, cv::Scalar(_y), cv::Point(0, 0), 0};
+                func(y_target);
+                _YUV420SP_Target uv_target{uv_plane, cv::Scalar(_c0, _c1), cv::Point(0, 0), 1};
+                func(uv_target);
+                return;
+            }
+            // 2 pixels aligned to match UV plane
+            int x0 = std::max(x, 0) & ~1;
+            int y0 = std::max(y, 0) & ~1;
+            int x1 = std::min((x + w + 1) & ~1, _width & ~1);
+            int y1 = std::min((y + h + 1) & ~1, _height & ~1);
+            if (x1 <= x0 || y1 <= y0)
+                return;
+            cv::Mat m = cv::Mat::zeros(y1 - y0, x1 - x0, CV_8UC1);
+            _YUV420SP_Target target{m, cv::Scalar(255), cv::Point(x0, y0), 0};
+            func(target);
+            _blend(m, x0, y0);
+        }
+
+    private:
+        uint8_t *_data;
+        int _width;
+        int _height;
+        int _y;
+        int _c0; // first byte of UV pair
+        int _c1;
+        int _alpha; // 0 ~ 256
+
+        static inline void _blend_px(uint8_t &p, int c, int k)
+        {
+            p = p + (((c - p) * k) >> 8);
+        }
+
+        // mask value 0 ~ 255 to blend weight 0 ~ 256
+        inline int _weight(int m) const
+        {
+            int k = (m * _alpha) >> 8;
+            return k + (k >> 7);
+        }
+
+        void _blend(const cv::Mat &mask, int x0, int y0)
+        {
+            int w = mask.cols;
+            int h = mask.rows;
+            uint8_t *uv_base = _data + _width * _height;
+            #pragma omp parallel for
+            for (int j = 0; j < h / 2; ++j)
+            {
+                const uint8_t *m0 = mask.ptr<uint8_t>(j * 2);
+                const uint8_t *m1 = mask.ptr<uint8_t>(j * 2 + 1);
+                uint8_t *py0 = _data + (y0 + j * 2) * _width + x0;
+                uint8_t *py1 = py0 + _width;
+                uint8_t *puv = uv_base + (y0 / 2 + j) * _width + x0;
+                for (int i = 0; i < w; i += 2)
                 {
-                    for (int x = 0; x < adjustedRect.width; x++)
-                    {
-                        cv::Vec4b &pixel = src_new.at<cv::Vec4b>(y + srcY, x + srcX);
-                        // ignore transparent pixel
-                        if (pixel[3] == 0)
-                            continue;
-                        // cv::Vec4b &pixel_dst = dst.at<cv::Vec4b>(y + adjustedRect.y, x + adjustedRect.x);
-                        // alpha is 255, just copy
-                        uint8_t *p = data + (_width * (y + adjustedRect.y) + (x + adjustedRect.x)) * 4;
-                        if (pixel[3] == 255)
-                        {
-                            p[0] = pixel[0];
-                            p[1] = pixel[1];
-                            p[2] = pixel[2];
-                            p[3] = pixel[3];
-                        }
-                        // alpha > 0 and < 255, blend
-                        else
-                        {
-                            // TODO: optimize blend algorithm
-                            p[0] = (uint32_t)((pixel[0] * pixel[3] + p[0] * (255 - pixel[3]))) >> 8;
-                            p[1] = (uint32_t)((pixel[1] * pixel[3] + p[1] * (255 - pixel[3]))) >> 8;
-                            p[2] = (uint32_t)((pixel[2] * pixel[3] + p[2] * (255 - pixel[3]))) >> 8;
-                            p[3] = 255 - (255 - pixel[3]) * (255 - p[3]);
-                        }
-                    }
+                    int s = m0[i] + m0[i + 1] + m1[i] + m1[i + 1];
+                    if (s == 0)
+                        continue;
+                    _blend_px(py0[i], _y, _weight(m0[i]));
+                    _blend_px(py0[i + 1], _y, _weight(m0[i + 1]));
+                    _blend_px(py1[i], _y, _weight(m1[i]));
+                    _blend_px(py1[i + 1], _y, _weight(m1[i + 1]));
+                    int k = _weight((s + 2) >> 2);
+                    _blend_px(puv[i], _c0, k);
+                    _blend_px(puv[i + 1], _c1, k);
                 }
             }
-            if (img_alloc)
-                delete img_new;
         }
-        return this;
-    }
+    };
 
     image::Image *Image::draw_rect(int x, int y, int w, int h, const image::Color &color, int thickness)
     {
+        if (_is_yuv420sp(_format))
+        {
+            _YUV420SP_Canvas canvas((uint8_t *)_data, _width, _height, _format, color);
+            int t = thickness > 0 ? thickness : 0;
+            canvas.draw(x - t, y - t, w + t * 2, h + t * 2, [&](_YUV420SP_Target &dst) {
+                cv::rectangle(dst.img, dst.pt(x, y), dst.pt(x + w - 1, y + h - 1), dst.color, dst.thickness(thickness), cv::LINE_8, dst.shift);
+            });
+            return this;
+        }
         int ch_format = 0;
         cv::Scalar cv_color;
         _get_cv_format_color(_format, color, &ch_format, cv_color);
@@ -1389,6 +1518,15 @@ __EXIT:
 
     image::Image *Image::draw_line(int x1, int y1, int x2, int y2, const image::Color &color, int thickness)
     {
+        if (_is_yuv420sp(_format))
+        {
+            _YUV420SP_Canvas canvas((uint8_t *)_data, _width, _height, _format, color);
+            int t = std::abs(thickness) + 1;
+            canvas.draw(std::min(x1, x2) - t, std::min(y1, y2) - t, std::abs(x2 - x1) + t * 2, std::abs(y2 - y1) + t * 2, [&](_YUV420SP_Target &dst) {
+                cv::line(dst.img, dst.pt(x1, y1), dst.pt(x2, y2), dst.color, dst.thickness(thickness), cv::LINE_8, dst.shift);
+            });
+            return this;
+        }
         int ch_format = 0;
         cv::Scalar cv_color;
         _get_cv_format_color(_format, color, &ch_format, cv_color);
@@ -1399,6 +1537,15 @@ __EXIT:
 
     image::Image *Image::draw_circle(int x, int y, int radius, const image::Color &color, int thickness)
     {
+        if (_is_yuv420sp(_format))
+        {
+            _YUV420SP_Canvas canvas((uint8_t *)_data, _width, _height, _format, color);
+            int r = radius + std::abs(thickness) + 1;
+            canvas.draw(x - r, y - r, r * 2 + 1, r * 2 + 1, [&](_YUV420SP_Target &dst) {
+                cv::circle(dst.img, dst.pt(x, y), radius, dst.color, dst.thickness(thickness), cv::LINE_8, dst.shift);
+            });
+            return this;
+        }
         int ch_format = 0;
         cv::Scalar cv_color;
         _get_cv_format_color(_format, color, &ch_format, cv_color);
@@ -1409,6 +1556,15 @@ __EXIT:
 
     image::Image *Image::draw_ellipse(int x, int y, int a, int b, float angle, float start_angle, float end_angle, const image::Color &color, int thickness)
     {
+        if (_is_yuv420sp(_format))
+        {
+            _YUV420SP_Canvas canvas((uint8_t *)_data, _width, _height, _format, color);
+            int r = std::max(a, b) + std::abs(thickness) + 1;
+            canvas.draw(x - r, y - r, r * 2 + 1, r * 2 + 1, [&](_YUV420SP_Target &dst) {
+                cv::ellipse(dst.img, dst.pt(x, y), cv::Size(a, b), angle, start_angle, end_angle, dst.color, dst.thickness(thickness), cv::LINE_8, dst.shift);
+            });
+            return this;
+        }
         int ch_format = 0;
         cv::Scalar cv_color;
         _get_cv_format_color(_format, color, &ch_format, cv_color);
@@ -1422,9 +1578,14 @@ __EXIT:
     {
         int ch_format = 0;
         cv::Scalar cv_color;
+        cv::Mat img;
         add_default_fonts(fonts_info);
-        _get_cv_format_color(_format, color, &ch_format, cv_color);
-        cv::Mat img(_height, _width, ch_format, _data);
+        bool yuv = _is_yuv420sp(_format);
+        if (!yuv)
+        {
+            _get_cv_format_color(_format, color, &ch_format, cv_color);
+            img = cv::Mat(_height, _width, ch_format, _data);
+        }
         cv::Point point(x, y);
         const std::string *final_font = &curr_font_name;
         int final_font_id = curr_font_id;
@@ -1440,10 +1601,18 @@ __EXIT:
             final_font = &font;
             final_font_id = get_default_fonts_id(font);
         }
+        // YUV420SP image collect lines first, then draw all lines by one mask
+        std::vector<std::pair<std::string, cv::Point>> yuv_lines;
+        auto put_text = [&](const std::string &line, const cv::Point &pos) {
+            if (yuv)
+                yuv_lines.emplace_back(line, pos);
+            else
+                _put_text(img, line, pos, cv_color, scale, thickness, *final_font, final_font_id);
+        };
         // auto wrap if text width > image width
         if (!wrap)
         {
-            _put_text(img, text, point, cv_color, scale, thickness, *final_font, final_font_id);
+            put_text(text, point);
         }
         else
         {
@@ -1492,7 +1661,7 @@ __EXIT:
                     }
                     if (wrap_now)
                     {
-                        _put_text(img, text_tmp, point, cv_color, scale, thickness, *final_font, final_font_id);
+                        put_text(text_tmp, point);
                         point.x = x;
                         point.y += text_height + wrap_space;
                         text_tmp.clear();
@@ -1511,7 +1680,7 @@ __EXIT:
                         {
                             text_tmp.erase(text_tmp.length() - char_size, char_size);
                         }
-                        _put_text(img, text_tmp, point, cv_color, scale, thickness, *final_font, final_font_id);
+                        put_text(text_tmp, point);
                         point.x = x;
                         point.y += text_height + wrap_space;
                         text_tmp.clear();
@@ -1525,19 +1694,49 @@ __EXIT:
                 // draw last line
                 if (!text_tmp.empty())
                 {
-                    _put_text(img, text_tmp, point, cv_color, scale, thickness, *final_font, final_font_id);
+                    put_text(text_tmp, point);
                 }
             }
             else
             {
-                _put_text(img, text, point, cv_color, scale, thickness, *final_font, final_font_id);
+                put_text(text, point);
+            }
+        }
+        if (yuv && !yuv_lines.empty())
+        {
+            int x0 = _width, y0 = _height, x1 = 0, y1 = 0;
+            int pad = std::abs(thickness) + 2;
+            for (auto &line : yuv_lines)
+            {
+                cv::Size size;
+                _get_text_size(size, line.first, *final_font, final_font_id, scale, thickness);
+                x0 = std::min(x0, line.second.x - pad);
+                y0 = std::min(y0, line.second.y - pad);
+                x1 = std::max(x1, line.second.x + size.width + pad);
+                y1 = std::max(y1, line.second.y + size.height * 3 / 2 + pad);
             }
+            // draw on mask to keep text anti-aliasing
+            _YUV420SP_Canvas canvas((uint8_t *)_data, _width, _height, _format, color);
+            canvas.draw(x0, y0, x1 - x0, y1 - y0, [&](_YUV420SP_Target &dst) {
+                for (auto &line : yuv_lines)
+                    _put_text(dst.img, line.first, dst.pt(line.second.x, line.second.y), dst.color, scale, thickness, *final_font, final_font_id);
+            }, true);
         }
         return this;
     }
 
     image::Image *Image::draw_cross(int x, int y, const image::Color &color, int size, int thickness)
     {
+        if (_is_yuv420sp(_format))
+        {
+            _YUV420SP_Canvas canvas((uint8_t *)_data, _width, _height, _format, color);
+            int r = size + std::abs(thickness) + 1;
+            canvas.draw(x - r, y - r, r * 2 + 1, r * 2 + 1, [&](_YUV420SP_Target &dst) {
+                cv::line(dst.img, dst.pt(x - size, y), dst.pt(x + size, y), dst.color, dst.thickness(thickness), cv::LINE_8, dst.shift);
+                cv::line(dst.img, dst.pt(x, y - size), dst.pt(x, y + size), dst.color, dst.thickness(thickness), cv::LINE_8, dst.shift);
+            });
+            return this;
+        }
         int ch_format = 0;
         cv::Scalar cv_color;
         _get_cv_format_color(_format, color, &ch_format, cv_color);
@@ -1549,6 +1748,16 @@ __EXIT:
 
     image::Image *Image::draw_arrow(int x0, int y0, int x1, int y1, const image::Color &color, int thickness)
     {
+        if (_is_yuv420sp(_format))
+        {
+            _YUV420SP_Canvas canvas((uint8_t *)_data, _width, _height, _format, color);
+            // arrow tip length is 0.1 of line length
+            int t = std::abs(thickness) + (std::abs(x1 - x0) + std::abs(y1 - y0)) / 10 + 1;
+            canvas.draw(std::min(x0, x1) - t, std::min(y0, y1) - t, std::abs(x1 - x0) + t * 2, std::abs(y1 - y0) + t * 2, [&](_YUV420SP_Target &dst) {
+                cv::arrowedLine(dst.img, dst.pt(x0, y0), dst.pt(x1, y1), dst.color, dst.thickness(thickness), cv::LINE_8, dst.shift);
+            });
+            return this;
+        }
         int ch_format = 0;
         cv::Scalar cv_color;
         _get_cv_format_color(_format, color, &ch_format, cv_color);
@@ -1561,11 +1770,6 @@ __EXIT:
 
     image::Image *Image::draw_edges(std::vector<std::vector<int>> corners, const image::Color &color, int size, int thickness, bool fill)
     {
-        int ch_format = 0;
-        cv::Scalar cv_color;
-        _get_cv_format_color(_format, color, &ch_format, cv_color);
-        cv::Mat img(_height, _width, ch_format, _data);
-
         if (corners.size() < 4)
         {
             throw std::runtime_error("corners size must >= 4");
@@ -1577,6 +1781,21 @@ __EXIT:
             thickness = -1;
         }
 
+        if (_is_yuv420sp(_format))
+        {
+            _YUV420SP_Canvas canvas((uint8_t *)_data, _width, _height, _format, color);
+            int x0 = corners[0][0], y0 = corners[0][1], x1 = corners[2][0], y1 = corners[2][1];
+            int t = std::abs(thickness) + 1;
+            canvas.draw(std::min(x0, x1) - t, std::min(y0, y1) - t, std::abs(x1 - x0) + t * 2, std::abs(y1 - y0) + t * 2, [&](_YUV420SP_Target &dst) {
+                cv::rectangle(dst.img, dst.pt(x0, y0), dst.pt(x1, y1), dst.color, dst.thickness(thickness), cv::LINE_8, dst.shift);
+            });
+            return this;
+        }
+
+        int ch_format = 0;
+        cv::Scalar cv_color;
+        _get_cv_format_color(_format, color, &ch_format, cv_color);
+        cv::Mat img(_height, _width, ch_format, _data);
         cv::Point topLeft(corners[0][0], corners[0][1]);
         cv::Point bottomRight(corners[2][0], corners[2][1]);
         cv::rectangle(img, topLeft, bottomRight, cv_color, thickness);
@@ -1585,16 +1804,55 @@ __EXIT:
 
     image::Image *Image::draw_keypoints(const std::vector<int> &keypoints, const image::Color &color, int size, int thickness, int line_thickness)
     {
-        int ch_format = 0;
-        cv::Scalar cv_color;
-        _get_cv_format_color(_format, color, &ch_format, cv_color);
-        cv::Mat img(_height, _width, ch_format, _data);
-
         if (keypoints.size() < 2 || keypoints.size() % 2 != 0)
         {
             throw std::runtime_error("keypoints size must >= 2 and multiple of 2");
             return nullptr;
         }
+        if (_is_yuv420sp(_format))
+        {
+            _YUV420SP_Canvas canvas((uint8_t *)_data, _width, _height, _format, color);
+            int x0 = _width, y0 = _height, x1 = 0, y1 = 0;
+            for (size_t i = 0; i < keypoints.size() / 2; ++i)
+            {
+                int x = keypoints[i * 2], y = keypoints[i * 2 + 1];
+                if (x < 0 || y < 0)
+                    continue;
+                x0 = std::min(x0, x);
+                y0 = std::min(y0, y);
+                x1 = std::max(x1, x);
+                y1 = std::max(y1, y);
+            }
+            if (x1 < x0)
+                return this;
+            int r = size + std::max(std::abs(thickness), line_thickness) + 1;
+            canvas.draw(x0 - r, y0 - r, x1 - x0 + r * 2 + 1, y1 - y0 + r * 2 + 1, [&](_YUV420SP_Target &dst) {
+                int n = keypoints.size() / 2;
+                for (int i = 0; i < n; ++i)
+                {
+                    int x = keypoints[i * 2], y = keypoints[i * 2 + 1];
+                    if (x < 0 || y < 0)
+                        continue;
+                    cv::circle(dst.img, dst.pt(x, y), size, dst.color, dst.thickness(thickness), cv::LINE_8, dst.shift);
+                }
+                if (line_thickness <= 0)
+                    return;
+                // lines between consecutive keypoints, and last to first to close the loop
+                for (int i = 0; i < n; ++i)
+                {
+                    int j = (i + n - 1) % n;
+                    if (keypoints[j * 2] < 0 || keypoints[j * 2 + 1] < 0 || keypoints[i * 2] < 0 || keypoints[i * 2 + 1] < 0)
+                        continue;
+                    cv::line(dst.img, dst.pt(keypoints[j * 2], keypoints[j * 2 + 1]), dst.pt(keypoints[i * 2], keypoints[i * 2 + 1]),
+                             dst.color, dst.thickness(line_thickness), cv::LINE_8, dst.shift);
+                }
+            });
+            return this;
+        }
+        int ch_format = 0;
+        cv::Scalar cv_color;
+        _get_cv_format_color(_format, color, &ch_format, cv_color);
+        cv::Mat img(_height, _width, ch_format, _data);
         for (size_t i = 0; i < keypoints.size() / 2; ++i)
         {
             cv::Point center(keypoints[i * 2], keypoints[i * 2 + 1]);
@@ -1627,6 +1885,71 @@ __EXIT:
         return this;
     }
 
+    static void _fill_nv21_rect(cv::Mat &y_plane, cv::Mat &vu_plane, const cv::Rect &rect)
+    {
+        if (rect.width <= 0 || rect.height <= 0)
+            return;
+        y_plane(rect).setTo(cv::Scalar(0));
+        vu_plane(cv::Rect(rect.x / 2, rect.y / 2, rect.width / 2, rect.height / 2)).setTo(cv::Scalar(128, 128));
+    }
+
+    /**
+     * Resize NV21(YVU420SP) image by scale Y plane and interleaved VU plane directly,
+     * no RGB convert, all rect are aligned to 2 pixels to keep VU plane aligned with Y plane.
+     */
+    static void _resize_nv21(uint8_t *src, int src_w, int src_h, uint8_t *dst, int dst_w, int dst_h, image::Fit fit, cv::InterpolationFlags method)
+    {
+        cv::Mat src_y(src_h, src_w, CV_8UC1, src);
+        cv::Mat src_vu(src_h / 2, src_w / 2, CV_8UC2, src + src_w * src_h);
+        cv::Mat dst_y(dst_h, dst_w, CV_8UC1, dst);
+        cv::Mat dst_vu(dst_h / 2, dst_w / 2, CV_8UC2, dst + dst_w * dst_h);
+
+        if (fit == image::Fit::FIT_FILL)
+        {
+            cv::resize(src_y, dst_y, dst_y.size(), 0, 0, method);
+            cv::resize(src_vu, dst_vu, dst_vu.size(), 0, 0, method);
+        }
+        else if (fit == image::Fit::FIT_CONTAIN)
+        {
+            float scale = std::min((float)dst_w / src_w, (float)dst_h / src_h);
+            int w = std::max(std::min((int)(src_w * scale + 0.5f), dst_w) & ~1, 2);
+            int h = std::max(std::min((int)(src_h * scale + 0.5f), dst_h) & ~1, 2);
+            int x = ((dst_w - w) / 2) & ~1;
+            int y = ((dst_h - h) / 2) & ~1;
+            cv::Mat roi_y = dst_y(cv::Rect(x, y, w, h));
+            cv::Mat roi_vu = dst_vu(cv::Rect(x / 2, y / 2, w / 2, h / 2));
+            cv::resize(src_y, roi_y, roi_y.size(), 0, 0, method);
+            cv::resize(src_vu, roi_vu, roi_vu.size(), 0, 0, method);
+            // fill black color, only border area
+            _fill_nv21_rect(dst_y, dst_vu, cv::Rect(0, 0, dst_w & ~1, y));
+            _fill_nv21_rect(dst_y, dst_vu, cv::Rect(0, y + h, dst_w & ~1, (dst_h - y - h) & ~1));
+            _fill_nv21_rect(dst_y, dst_vu, cv::Rect(0, y, x, h));
+            _fill_nv21_rect(dst_y, dst_vu, cv::Rect(x + w, y, (dst_w - x - w) & ~1, h));
+            // odd last column and row of Y plane are not covered by the 2 pixels aligned rects
+            if (dst_w & 1)
+                dst_y.col(dst_w - 1).setTo(cv::Scalar(0));
+            if (dst_h & 1)
+                dst_y.row(dst_h - 1).setTo(cv::Scalar(0));
+        }
+        else if (fit == image::Fit::FIT_COVER)
+        {
+            // only resize the center area of source image which will be shown
+            float scale = std::max((float)dst_w / src_w, (float)dst_h / src_h);
+            int w = std::max(std::min((int)(dst_w / scale + 0.5f), src_w) & ~1, 2);
+            int h = std::max(std::min((int)(dst_h / scale + 0.5f), src_h) & ~1, 2);
+            int x = ((src_w - w) / 2) & ~1;
+            int y = ((src_h - h) / 2) & ~1;
+            cv::Mat roi_y = src_y(cv::Rect(x, y, w, h));
+            cv::Mat roi_vu = src_vu(cv::Rect(x / 2, y / 2, w / 2, h / 2));
+            cv::resize(roi_y, dst_y, dst_y.size(), 0, 0, method);
+            cv::resize(roi_vu, dst_vu, dst_vu.size(), 0, 0, method);
+        }
+        else
+        {
+            throw std::runtime_error("not support object fit");
+        }
+    }
+
     image::Image *Image::resize(int width, int height, image::Fit object_fit, image::ResizeMethod method)
     {
         int pixel_num = 0;
@@ -1677,24 +2000,26 @@ __EXIT:
         }
         image::Image *ret = new image::Image(width, height, _format);
 
-        cv::Mat img(cv_h, _width, pixel_num, _data);
-        cv::Mat dst;
         cv::InterpolationFlags inter_method = (cv::InterpolationFlags)method;
-        if (object_fit == image::Fit::FIT_FILL)
+        if (_format == image::FMT_YVU420SP)
         {
-            if (_format == image::FMT_YVU420SP)
+            try
             {
-                cv::Mat rgb, resize_rgb;
-                cv::cvtColor(img, rgb, cv::COLOR_YUV2RGB_NV21);
-                cv::resize(rgb, resize_rgb, cv::Size(width, height), 0, 0, inter_method);
-                dst = cv::Mat(cv_dst_h, width, pixel_num, ret->data());
-                _cv_rgb_nv21(resize_rgb, dst, width, height);
+                _resize_nv21((uint8_t *)_data, _width, _height, (uint8_t *)ret->data(), width, height, object_fit, inter_method);
             }
-            else
+            catch (...)
             {
-                dst = cv::Mat(height, width, pixel_num, ret->data());
-                cv::resize(img, dst, cv::Size(width, height), 0, 0, inter_method);
+                delete ret;
+                throw;
             }
+            return ret;
+        }
+        cv::Mat img(cv_h, _width, pixel_num, _data);
+        cv::Mat dst;
+        if (object_fit == image::Fit::FIT_FILL)
+        {
+            dst = cv::Mat(height, width, pixel_num, ret->data());
+            cv::resize(img, dst, cv::Size(width, height), 0, 0, inter_method);
         }
         else if (object_fit == image::Fit::FIT_CONTAIN)
         {
@@ -1970,6 +2295,39 @@ __EXIT:
                 }
             }
         }
+#if !defined(PLATFORM_MAIXCAM) && !defined(PLATFORM_MAIXCAM2)
+        // JPEG file is encoded by software encoder of to_jpeg without convert to BGR,
+        // hardware encoders limit quality range, so they still use opencv.
+        image::Image *jpg = nullptr;
+        if (_format < FMT_COMPRESSED_MIN && quality >= 0 && quality <= 100 &&
+            (path_is_format(path, ".jpeg") || path_is_format(path, ".jpg")))
+        {
+            try
+            {
+                jpg = to_jpeg(quality < 1 ? 1 : quality);
+            }
+            catch (const std::exception &e)
+            {
+                log::warn("encode jpeg failed: %s, use opencv instead", e.what());
+                jpg = nullptr;
+            }
+        }
+        if (jpg)
+        {
+            fs::File *f = fs::open(path, "wb");
+            if (!f)
+            {
+                delete jpg;
+                return err::ERR_IO;
+            }
+            int size = jpg->data_size();
+            int ret = f->write(jpg->data(), size);
+            f->close();
+            delete f;
+            delete jpg;
+            return ret == size ? err::ERR_NONE : err::ERR_IO;
+        }
+#endif
         bool ok = false;
         switch (_format)
         {
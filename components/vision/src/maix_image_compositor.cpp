@@ -0,0 +1,612 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2023-
+ * @license Apache 2.0
+ * @update 2026.10.18: Create this file, add alpha compositor.
+ */
+
+#include "maix_image_compositor.hpp"
+#include <algorithm>
+#include <vector>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define COMPOSITOR_USE_NEON 1
+    #define COMPOSITOR_USE_SSE 0
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+    #define COMPOSITOR_USE_NEON 0
+    #define COMPOSITOR_USE_SSE 1
+#else
+    #define COMPOSITOR_USE_NEON 0
+    #define COMPOSITOR_USE_SSE 0
+#endif
+
+namespace maix::image
+{
+    class _CompositorLayer
+    {
+    public:
+        int id = -1;
+        int x = 0;
+        int y = 0;
+        int w = 0;
+        int h = 0;
+        bool visible = true;
+        bool cache = true;
+        image::Image *src = nullptr; // source of not cached layer
+        std::vector<uint8_t> rgba;   // premultiplied RGBA, w * h * 4
+        std::vector<uint8_t> ya;     // premultiplied Y and alpha, 2 pixels aligned size, for YUV420SP target
+        std::vector<uint8_t> uva;    // premultiplied U, V and average alpha of 2x2 pixels
+        bool yuv_valid = false;
+    };
+
+    class _CompositorData
+    {
+    public:
+        std::vector<_CompositorLayer *> layers;
+        int next_id = 0;
+
+        ~_CompositorData()
+        {
+            for (_CompositorLayer *layer : layers)
+                delete layer;
+        }
+
+        _CompositorLayer *find(int id)
+        {
+            for (_CompositorLayer *layer : layers)
+            {
+                if (layer->id == id)
+                    return layer;
+            }
+            return nullptr;
+        }
+    };
+
+    class _CompositorSpan
+    {
+    public:
+        const _CompositorLayer *layer;
+        int dx0, dy0, dx1, dy1; // area on target image
+        int sx, sy;             // start position on layer
+    };
+
+    // x / 255 rounded, x <= 255 * 255
+    static inline uint32_t _div255(uint32_t x)
+    {
+        x += 128;
+        return (x + (x >> 8)) >> 8;
+    }
+
+    static inline bool _layer_format_valid(image::Format fmt)
+    {
+        return fmt == image::FMT_RGBA8888 || fmt == image::FMT_BGRA8888 ||
+               fmt == image::FMT_RGB888 || fmt == image::FMT_BGR888 || fmt == image::FMT_GRAYSCALE;
+    }
+
+    static err::Err _layer_load(_CompositorLayer *layer, image::Image &img)
+    {
+        image::Format fmt = img.format();
+        if (!_layer_format_valid(fmt))
+        {
+            log::error("compositor layer format %s not support\n", image::format_name(fmt).c_str());
+            return err::ERR_ARGS;
+        }
+        int n = img.width() * img.height();
+        layer->w = img.width();
+        layer->h = img.height();
+        layer->yuv_valid = false;
+        layer->rgba.resize((size_t)n * 4);
+        const uint8_t *s = (const uint8_t *)img.data();
+        uint8_t *d = layer->rgba.data();
+        if (fmt == image::FMT_RGBA8888 || fmt == image::FMT_BGRA8888)
+        {
+            int ri = fmt == image::FMT_RGBA8888 ? 0 : 2;
+            int bi = 2 - ri;
+            #pragma omp parallel for
+            for (int i = 0; i < n; ++i)
+            {
+                const uint8_t *p = s + i * 4;
+                uint8_t *q = d + i * 4;
+                uint32_t a = p[3];
+                q[0] = _div255(p[ri] * a);
+                q[1] = _div255(p[1] * a);
+                q[2] = _div255(p[bi] * a);
+                q[3] = a;
+            }
+        }
+        else if (fmt == image::FMT_RGB888 || fmt == image::FMT_BGR888)
+        {
+            int ri = fmt == image::FMT_RGB888 ? 0 : 2;
+            int bi = 2 - ri;
+            #pragma omp parallel for
+            for (int i = 0; i < n; ++i)
+            {
+                const uint8_t *p = s + i * 3;
+                uint8_t *q = d + i * 4;
+                q[0] = p[ri];
+                q[1] = p[1];
+                q[2] = p[bi];
+                q[3] = 255;
+            }
+        }
+        else
+        {
+            #pragma omp parallel for
+            for (int i = 0; i < n; ++i)
+            {
+                uint8_t *q = d + i * 4;
+                q[0] = s[i];
+                q[1] = s[i];
+                q[2] = s[i];
+                q[3] = 255;
+            }
+        }
+        return err::ERR_NONE;
+    }
+
+    /**
+     * Premultiplied RGBA to premultiplied Y plane and UV plane,
+     * BT.601 limited range is linear, so premultiplied RGB can be converted directly.
+     */
+    static void _layer_load_yuv(_CompositorLayer *layer)
+    {
+        int pw = (layer->w + 1) & ~1;
+        int ph = (layer->h + 1) & ~1;
+        int bw = pw / 2;
+        layer->ya.assign((size_t)pw * ph * 2, 0);
+        layer->uva.resize((size_t)bw * (ph / 2) * 3);
+        const uint8_t *s = layer->rgba.data();
+        #pragma omp parallel for
+        for (int by = 0; by < ph / 2; ++by)
+        {
+            for (int bx = 0; bx < bw; ++bx)
+            {
+                int su = 0, sv = 0, sa = 0;
+                for (int k = 0; k < 4; ++k)
+                {
+                    int x = bx * 2 + (k & 1);
+                    int y = by * 2 + (k >> 1);
+                    if (x >= layer->w || y >= layer->h)
+                        continue;
+                    const uint8_t *p = s + ((size_t)y * layer->w + x) * 4;
+                    int r = p[0], g = p[1], b = p[2], a = p[3];
+                    int yp = (int)_div255(16 * a) + ((66 * r + 129 * g + 25 * b + 128) >> 8);
+                    int up = (int)_div255(128 * a) + ((-38 * r - 74 * g + 112 * b + 128) >> 8);
+                    int vp = (int)_div255(128 * a) + ((112 * r - 94 * g - 18 * b + 128) >> 8);
+                    uint8_t *q = layer->ya.data() + ((size_t)y * pw + x) * 2;
+                    q[0] = std::min(std::max(yp, 0), a);
+                    q[1] = a;
+                    su += std::min(std::max(up, 0), a);
+                    sv += std::min(std::max(vp, 0), a);
+                    sa += a;
+                }
+                uint8_t *q = layer->uva.data() + ((size_t)by * bw + bx) * 3;
+                q[0] = (su + 2) >> 2;
+                q[1] = (sv + 2) >> 2;
+                q[2] = (sa + 2) >> 2;
+            }
+        }
+        layer->yuv_valid = true;
+    }
+
+#if COMPOSITOR_USE_NEON
+    // d * ia / 255 rounded
+    static inline uint8x8_t _neon_mul_div255(uint8x8_t d, uint8x8_t ia)
+    {
+        uint16x8_t t = vmull_u8(d, ia);
+        return vraddhn_u16(t, vrshrq_n_u16(t, 8));
+    }
+#elif COMPOSITOR_USE_SSE
+    static inline __m128i _sse_div255(__m128i t)
+    {
+        t = _mm_add_epi16(t, _mm_set1_epi16(128));
+        return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+    }
+
+    // 2 pixels of premultiplied RGBA s over d, 16 bits per channel
+    template <bool BGR>
+    static inline __m128i _sse_blend_rgba(__m128i s, __m128i d)
+    {
+        if (BGR)
+            s = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 0, 1, 2)), _MM_SHUFFLE(3, 0, 1, 2));
+        __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        __m128i ia = _mm_sub_epi16(_mm_set1_epi16(255), a);
+        return _mm_add_epi16(s, _sse_div255(_mm_mullo_epi16(d, ia)));
+    }
+#endif
+
+    // premultiplied RGBA over RGBA(BGR false) or BGRA(BGR true)
+    template <bool BGR>
+    static void _blend_row_4(uint8_t *d, const uint8_t *s, int n)
+    {
+        int i = 0;
+#if COMPOSITOR_USE_NEON
+        for (; i + 8 <= n; i += 8)
+        {
+            uint8x8x4_t sv = vld4_u8(s + i * 4);
+            uint8x8x4_t dv = vld4_u8(d + i * 4);
+            uint8x8_t ia = vmvn_u8(sv.val[3]);
+            dv.val[0] = vqadd_u8(sv.val[BGR ? 2 : 0], _neon_mul_div255(dv.val[0], ia));
+            dv.val[1] = vqadd_u8(sv.val[1], _neon_mul_div255(dv.val[1], ia));
+            dv.val[2] = vqadd_u8(sv.val[BGR ? 0 : 2], _neon_mul_div255(dv.val[2], ia));
+            dv.val[3] = vqadd_u8(sv.val[3], _neon_mul_div255(dv.val[3], ia));
+            vst4_u8(d + i * 4, dv);
+        }
+#elif COMPOSITOR_USE_SSE
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128i sv = _mm_loadu_si128((const __m128i *)(s + i * 4));
+            __m128i dv = _mm_loadu_si128((const __m128i *)(d + i * 4));
+            __m128i lo = _sse_blend_rgba<BGR>(_mm_unpacklo_epi8(sv, zero), _mm_unpacklo_epi8(dv, zero));
+            __m128i hi = _sse_blend_rgba<BGR>(_mm_unpackhi_epi8(sv, zero), _mm_unpackhi_epi8(dv, zero));
+            _mm_storeu_si128((__m128i *)(d + i * 4), _mm_packus_epi16(lo, hi));
+        }
+#endif
+        for (; i < n; ++i)
+        {
+            const uint8_t *p = s + i * 4;
+            uint32_t a = p[3];
+            if (a == 0)
+                continue;
+            uint8_t *q = d + i * 4;
+            uint32_t ia = 255 - a;
+            q[0] = p[BGR ? 2 : 0] + _div255(q[0] * ia);
+            q[1] = p[1] + _div255(q[1] * ia);
+            q[2] = p[BGR ? 0 : 2] + _div255(q[2] * ia);
+            q[3] = a + _div255(q[3] * ia);
+        }
+    }
+
+    // premultiplied RGBA over RGB(BGR false) or BGR(BGR true)
+    template <bool BGR>
+    static void _blend_row_3(uint8_t *d, const uint8_t *s, int n)
+    {
+        int i = 0;
+#if COMPOSITOR_USE_NEON
+        for (; i + 8 <= n; i += 8)
+        {
+            uint8x8x4_t sv = vld4_u8(s + i * 4);
+            uint8x8x3_t dv = vld3_u8(d + i * 3);
+            uint8x8_t ia = vmvn_u8(sv.val[3]);
+            dv.val[0] = vqadd_u8(sv.val[BGR ? 2 : 0], _neon_mul_div255(dv.val[0], ia));
+            dv.val[1] = vqadd_u8(sv.val[1], _neon_mul_div255(dv.val[1], ia));
+            dv.val[2] = vqadd_u8(sv.val[BGR ? 0 : 2], _neon_mul_div255(dv.val[2], ia));
+            vst3_u8(d + i * 3, dv);
+        }
+#endif
+        // SSE2 has no byte shuffle for 3 bytes pixel, skip transparent and copy opaque pixels fast
+        for (; i < n; ++i)
+        {
+            const uint8_t *p = s + i * 4;
+            uint32_t a = p[3];
+            if (a == 0)
+                continue;
+            uint8_t *q = d + i * 3;
+            if (a == 255)
+            {
+                q[0] = p[BGR ? 2 : 0];
+                q[1] = p[1];
+                q[2] = p[BGR ? 0 : 2];
+                continue;
+            }
+            uint32_t ia = 255 - a;
+            q[0] = p[BGR ? 2 : 0] + _div255(q[0] * ia);
+            q[1] = p[1] + _div255(q[1] * ia);
+            q[2] = p[BGR ? 0 : 2] + _div255(q[2] * ia);
+        }
+    }
+
+    // premultiplied Y and alpha over Y plane
+    static void _blend_row_y(uint8_t *d, const uint8_t *s, int n)
+    {
+        int i = 0;
+#if COMPOSITOR_USE_NEON
+        for (; i + 8 <= n; i += 8)
+        {
+            uint8x8x2_t sv = vld2_u8(s + i * 2);
+            uint8x8_t dv = vld1_u8(d + i);
+            dv = vqadd_u8(sv.val[0], _neon_mul_div255(dv, vmvn_u8(sv.val[1])));
+            vst1_u8(d + i, dv);
+        }
+#elif COMPOSITOR_USE_SSE
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i mask = _mm_set1_epi16(0xFF);
+        for (; i + 8 <= n; i += 8)
+        {
+            __m128i sv = _mm_loadu_si128((const __m128i *)(s + i * 2));
+            __m128i yp = _mm_and_si128(sv, mask);
+            __m128i ia = _mm_sub_epi16(mask, _mm_srli_epi16(sv, 8));
+            __m128i dv = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(d + i)), zero);
+            dv = _mm_add_epi16(yp, _sse_div255(_mm_mullo_epi16(dv, ia)));
+            _mm_storel_epi64((__m128i *)(d + i), _mm_packus_epi16(dv, dv));
+        }
+#endif
+        for (; i < n; ++i)
+        {
+            uint32_t a = s[i * 2 + 1];
+            if (a == 0)
+                continue;
+            d[i] = s[i * 2] + _div255(d[i] * (255 - a));
+        }
+    }
+
+    // premultiplied U, V and alpha over UV plane, VU true for NV21
+    template <bool VU>
+    static void _blend_row_uv(uint8_t *d, const uint8_t *s, int n)
+    {
+        int i = 0;
+#if COMPOSITOR_USE_NEON
+        for (; i + 8 <= n; i += 8)
+        {
+            uint8x8x3_t sv = vld3_u8(s + i * 3);
+            uint8x8x2_t dv = vld2_u8(d + i * 2);
+            uint8x8_t ia = vmvn_u8(sv.val[2]);
+            dv.val[0] = vqadd_u8(sv.val[VU ? 1 : 0], _neon_mul_div255(dv.val[0], ia));
+            dv.val[1] = vqadd_u8(sv.val[VU ? 0 : 1], _neon_mul_div255(dv.val[1], ia));
+            vst2_u8(d + i * 2, dv);
+        }
+#endif
+        for (; i < n; ++i)
+        {
+            const uint8_t *p = s + i * 3;
+            uint32_t a = p[2];
+            if (a == 0)
+                continue;
+            uint8_t *q = d + i * 2;
+            uint32_t ia = 255 - a;
+            q[0] = p[VU ? 1 : 0] + _div255(q[0] * ia);
+            q[1] = p[VU ? 0 : 1] + _div255(q[1] * ia);
+        }
+    }
+
+    static err::Err _compose(const std::vector<_CompositorLayer *> &layers, image::Image &img)
+    {
+        image::Format fmt = img.format();
+        bool yuv = fmt == image::FMT_YVU420SP || fmt == image::FMT_YUV420SP;
+        if (!(yuv || fmt == image::FMT_RGB888 || fmt == image::FMT_BGR888 ||
+              fmt == image::FMT_RGBA8888 || fmt == image::FMT_BGRA8888))
+        {
+            log::error("compositor target format %s not support\n", image::format_name(fmt).c_str());
+            return err::ERR_ARGS;
+        }
+        int width = img.width();
+        int height = img.height();
+        uint8_t *data = (uint8_t *)img.data();
+
+        // clip layers to target image
+        std::vector<_CompositorSpan> spans;
+        int y_min = height, y_max = 0;
+        for (_CompositorLayer *layer : layers)
+        {
+            int lx = layer->x, ly = layer->y, lw = layer->w, lh = layer->h;
+            int max_w = width, max_h = height;
+            if (yuv)
+            {
+                if (!layer->yuv_valid)
+                    _layer_load_yuv(layer);
+                lx &= ~1;
+                ly &= ~1;
+                lw = (lw + 1) & ~1;
+                lh = (lh + 1) & ~1;
+                max_w &= ~1;
+                max_h &= ~1;
+            }
+            _CompositorSpan span;
+            span.layer = layer;
+            span.dx0 = std::max(lx, 0);
+            span.dy0 = std::max(ly, 0);
+            span.dx1 = std::min(lx + lw, max_w);
+            span.dy1 = std::min(ly + lh, max_h);
+            if (span.dx1 <= span.dx0 || span.dy1 <= span.dy0)
+                continue;
+            span.sx = span.dx0 - lx;
+            span.sy = span.dy0 - ly;
+            spans.push_back(span);
+            y_min = std::min(y_min, span.dy0);
+            y_max = std::max(y_max, span.dy1);
+        }
+        if (spans.empty())
+            return err::ERR_NONE;
+
+        // one pass of target rows, all layers of one row are blended together while row is in cache
+        if (!yuv)
+        {
+            int bpp = (int)image::fmt_size[fmt];
+            #pragma omp parallel for
+            for (int y = y_min; y < y_max; ++y)
+            {
+                uint8_t *row = data + (size_t)y * width * bpp;
+                for (const _CompositorSpan &span : spans)
+                {
+                    if (y < span.dy0 || y >= span.dy1)
+                        continue;
+                    const _CompositorLayer *layer = span.layer;
+                    const uint8_t *s = layer->rgba.data() + ((size_t)(y - span.dy0 + span.sy) * layer->w + span.sx) * 4;
+                    uint8_t *d = row + span.dx0 * bpp;
+                    int n = span.dx1 - span.dx0;
+                    switch (fmt)
+                    {
+                    case image::FMT_RGB888:
+                        _blend_row_3<false>(d, s, n);
+                        break;
+                    case image::FMT_BGR888:
+                        _blend_row_3<true>(d, s, n);
+                        break;
+                    case image::FMT_RGBA8888:
+                        _blend_row_4<false>(d, s, n);
+                        break;
+                    default:
+                        _blend_row_4<true>(d, s, n);
+                        break;
+                    }
+                }
+            }
+        }
+        else
+        {
+            uint8_t *uv_plane = data + width * height;
+            #pragma omp parallel for
+            for (int by = y_min / 2; by < y_max / 2; ++by)
+            {
+                for (const _CompositorSpan &span : spans)
+                {
+                    if (by * 2 < span.dy0 || by * 2 >= span.dy1)
+                        continue;
+                    const _CompositorLayer *layer = span.layer;
+                    int pw = (layer->w + 1) & ~1;
+                    int n = span.dx1 - span.dx0;
+                    int sy = by * 2 - span.dy0 + span.sy;
+                    for (int k = 0; k < 2; ++k)
+                    {
+                        const uint8_t *s = layer->ya.data() + ((size_t)(sy + k) * pw + span.sx) * 2;
+                        _blend_row_y(data + (size_t)(by * 2 + k) * width + span.dx0, s, n);
+                    }
+                    const uint8_t *s = layer->uva.data() + ((size_t)(sy / 2) * (pw / 2) + span.sx / 2) * 3;
+                    uint8_t *d = uv_plane + (size_t)by * width + span.dx0;
+                    if (fmt == image::FMT_YVU420SP)
+                        _blend_row_uv<true>(d, s, n / 2);
+                    else
+                        _blend_row_uv<false>(d, s, n / 2);
+                }
+            }
+        }
+        return err::ERR_NONE;
+    }
+
+    Compositor::Compositor()
+    {
+        _data = new _CompositorData();
+    }
+
+    Compositor::~Compositor()
+    {
+        delete (_CompositorData *)_data;
+        _data = nullptr;
+    }
+
+    int Compositor::add_layer(image::Image &img, int x, int y, bool cache)
+    {
+        _CompositorData *data = (_CompositorData *)_data;
+        _CompositorLayer *layer = new _CompositorLayer();
+        layer->x = x;
+        layer->y = y;
+        layer->cache = cache;
+        if (cache)
+        {
+            if (_layer_load(layer, img) != err::ERR_NONE)
+            {
+                delete layer;
+                throw err::Exception(err::ERR_ARGS, "compositor layer format not support");
+            }
+        }
+        else
+        {
+            if (!_layer_format_valid(img.format()))
+            {
+                delete layer;
+                throw err::Exception(err::ERR_ARGS, "compositor layer format not support");
+            }
+            layer->src = &img;
+        }
+        layer->id = data->next_id++;
+        data->layers.push_back(layer);
+        return layer->id;
+    }
+
+    err::Err Compositor::update_layer(int id, image::Image &img)
+    {
+        _CompositorData *data = (_CompositorData *)_data;
+        _CompositorLayer *layer = data->find(id);
+        if (!layer)
+            return err::ERR_ARGS;
+        if (layer->cache)
+            return _layer_load(layer, img);
+        if (!_layer_format_valid(img.format()))
+            return err::ERR_ARGS;
+        layer->src = &img;
+        return err::ERR_NONE;
+    }
+
+    err::Err Compositor::set_layer_pos(int id, int x, int y)
+    {
+        _CompositorLayer *layer = ((_CompositorData *)_data)->find(id);
+        if (!layer)
+            return err::ERR_ARGS;
+        layer->x = x;
+        layer->y = y;
+        return err::ERR_NONE;
+    }
+
+    err::Err Compositor::set_layer_visible(int id, bool visible)
+    {
+        _CompositorLayer *layer = ((_CompositorData *)_data)->find(id);
+        if (!layer)
+            return err::ERR_ARGS;
+        layer->visible = visible;
+        return err::ERR_NONE;
+    }
+
+    err::Err Compositor::remove_layer(int id)
+    {
+        _CompositorData *data = (_CompositorData *)_data;
+        for (auto it = data->layers.begin(); it != data->layers.end(); ++it)
+        {
+            if ((*it)->id == id)
+            {
+                delete *it;
+                data->layers.erase(it);
+                return err::ERR_NONE;
+            }
+        }
+        return err::ERR_ARGS;
+    }
+
+    void Compositor::clear()
+    {
+        _CompositorData *data = (_CompositorData *)_data;
+        for (_CompositorLayer *layer : data->layers)
+            delete layer;
+        data->layers.clear();
+    }
+
+    int Compositor::layer_num()
+    {
+        return (int)((_CompositorData *)_data)->layers.size();
+    }
+
+    err::Err Compositor::compose(image::Image &img)
+    {
+        _CompositorData *data = (_CompositorData *)_data;
+        std::vector<_CompositorLayer *> layers;
+        layers.reserve(data->layers.size());
+        for (_CompositorLayer *layer : data->layers)
+        {
+            if (!layer->visible)
+                continue;
+            if (!layer->cache)
+            {
+                err::Err e = _layer_load(layer, *layer->src);
+                if (e != err::ERR_NONE)
+                    return e;
+            }
+            layers.push_back(layer);
+        }
+        return _compose(layers, img);
+    }
+
+    err::Err Compositor::blend(image::Image &dst, image::Image &src, int x, int y)
+    {
+        // reuse premultiplied buffer of each thread
+        static thread_local _CompositorLayer layer;
+        err::Err e = _layer_load(&layer, src);
+        if (e != err::ERR_NONE)
+            return e;
+        layer.x = x;
+        layer.y = y;
+        std::vector<_CompositorLayer *> layers = {&layer};
+        return _compose(layers, dst);
+    }
+} // namespace maix::image
@@ -0,0 +1,638 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Create this file, add software JPEG encoder.
+ * @update 2026.10.18: Use neutral chroma for YUV image with one pixel width or height.
+ * @update 2026.10.18: Slice buffers grow on demand instead of worst case size.
+ */
+
+#include "maix_image_jpeg.hpp"
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+#include "omp.h"
+
+namespace maix::image
+{
+    // zigzag index to natural index
+    static const uint8_t _zigzag[64] = {
+        0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5,
+        12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28,
+        35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+        58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63};
+
+    // JPEG standard Annex K quantization tables, natural order
+    static const uint8_t _std_qtables[2][64] = {
+        {16, 11, 10, 16, 24, 40, 51, 61,
+         12, 12, 14, 19, 26, 58, 60, 55,
+         14, 13, 16, 24, 40, 57, 69, 56,
+         14, 17, 22, 29, 51, 87, 80, 62,
+         18, 22, 37, 56, 68, 109, 103, 77,
+         24, 35, 55, 64, 81, 104, 113, 92,
+         49, 64, 78, 87, 103, 121, 120, 101,
+         72, 92, 95, 98, 112, 100, 103, 99},
+        {17, 18, 24, 47, 99, 99, 99, 99,
+         18, 21, 26, 66, 99, 99, 99, 99,
+         24, 26, 56, 99, 99, 99, 99, 99,
+         47, 66, 99, 99, 99, 99, 99, 99,
+         99, 99, 99, 99, 99, 99, 99, 99,
+         99, 99, 99, 99, 99, 99, 99, 99,
+         99, 99, 99, 99, 99, 99, 99, 99,
+         99, 99, 99, 99, 99, 99, 99, 99}};
+
+    // JPEG standard Annex K Huffman tables, code numbers of length 1~16, and symbols
+    static const uint8_t _dc_luma_bits[16] = {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+    static const uint8_t _dc_chroma_bits[16] = {0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
+    static const uint8_t _dc_vals[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+    static const uint8_t _ac_luma_bits[16] = {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d};
+    static const uint8_t _ac_luma_vals[162] = {
+        0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+        0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+        0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+        0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+        0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+        0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+        0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+        0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+        0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+        0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+        0xf9, 0xfa};
+    static const uint8_t _ac_chroma_bits[16] = {0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77};
+    static const uint8_t _ac_chroma_vals[162] = {
+        0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+        0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+        0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+        0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+        0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+        0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+        0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+        0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+        0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+        0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+        0xf9, 0xfa};
+
+    static const uint8_t *_huff_bits[4] = {_dc_luma_bits, _ac_luma_bits, _dc_chroma_bits, _ac_chroma_bits};
+    static const uint8_t *_huff_vals[4] = {_dc_vals, _ac_luma_vals, _dc_vals, _ac_chroma_vals};
+
+    // worst case bytes of one 8x8 block, (16 + 11) + 63 * (16 + 10) bits, doubled for 0xFF stuffing
+    #define BLOCK_MAX_BYTES 420
+
+    // input image planes, chroma planes of YUV420 are used directly
+    class _Source
+    {
+    public:
+        int w;
+        int h;
+        const uint8_t *y;       // YUV420 and gray
+        const uint8_t *u;
+        const uint8_t *v;
+        int uv_w;               // chroma plane width and height
+        int uv_h;
+        int uv_stride;          // chroma row bytes
+        int uv_step;            // chroma pixel bytes, 2 for semi planar
+        const uint8_t *rgb;     // RGB/BGR(A)
+        int bpp;
+        int r, g, b;            // channel offsets of pixel
+        bool gray;
+        bool yuv;
+    };
+
+    static void _fdct(float *d)
+    {
+        // AAN float DCT, output is scaled by AAN factors, which are merged to quantization divisors
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            int step = pass == 0 ? 1 : 8;
+            int next = pass == 0 ? 8 : 1;
+            float *p = d;
+            for (int i = 0; i < 8; ++i, p += next)
+            {
+                float tmp0 = p[0] + p[7 * step];
+                float tmp7 = p[0] - p[7 * step];
+                float tmp1 = p[step] + p[6 * step];
+                float tmp6 = p[step] - p[6 * step];
+                float tmp2 = p[2 * step] + p[5 * step];
+                float tmp5 = p[2 * step] - p[5 * step];
+                float tmp3 = p[3 * step] + p[4 * step];
+                float tmp4 = p[3 * step] - p[4 * step];
+
+                float tmp10 = tmp0 + tmp3;
+                float tmp13 = tmp0 - tmp3;
+                float tmp11 = tmp1 + tmp2;
+                float tmp12 = tmp1 - tmp2;
+                p[0] = tmp10 + tmp11;
+                p[4 * step] = tmp10 - tmp11;
+                float z1 = (tmp12 + tmp13) * 0.707106781f;
+                p[2 * step] = tmp13 + z1;
+                p[6 * step] = tmp13 - z1;
+
+                tmp10 = tmp4 + tmp5;
+                tmp11 = tmp5 + tmp6;
+                tmp12 = tmp6 + tmp7;
+                float z5 = (tmp10 - tmp12) * 0.382683433f;
+                float z2 = 0.541196100f * tmp10 + z5;
+                float z4 = 1.306562965f * tmp12 + z5;
+                float z3 = tmp11 * 0.707106781f;
+                float z11 = tmp7 + z3;
+                float z13 = tmp7 - z3;
+                p[5 * step] = z13 + z2;
+                p[3 * step] = z13 - z2;
+                p[step] = z11 + z4;
+                p[7 * step] = z11 - z4;
+            }
+        }
+    }
+
+    class _BitWriter
+    {
+    public:
+        uint8_t *p;
+        uint64_t acc = 0;
+        int bits = 0;
+
+        inline void put(uint32_t code, int len)
+        {
+            acc = (acc << len) | code;
+            bits += len;
+            while (bits >= 8)
+            {
+                bits -= 8;
+                uint8_t c = (uint8_t)(acc >> bits);
+                *p++ = c;
+                if (c == 0xFF)
+                    *p++ = 0;
+            }
+        }
+
+        // pad with 1 bits to byte boundary
+        inline void flush()
+        {
+            if (bits > 0)
+                put((1u << (8 - bits)) - 1, 8 - bits);
+        }
+    };
+
+    static inline int _bit_count(int v)
+    {
+        return v == 0 ? 0 : 32 - __builtin_clz((unsigned)(v < 0 ? -v : v));
+    }
+
+    static inline void _encode_block(_BitWriter &w, float *block, const float *divisors, int &dc_pred,
+                                     const uint16_t *dc_codes, const uint8_t *dc_sizes,
+                                     const uint16_t *ac_codes, const uint8_t *ac_sizes)
+    {
+        _fdct(block);
+        int q[64];
+        for (int i = 0; i < 64; ++i)
+        {
+            float v = block[_zigzag[i]] * divisors[_zigzag[i]];
+            int t = (int)(v < 0 ? v - 0.5f : v + 0.5f);
+            q[i] = t > 1023 ? 1023 : (t < -1023 ? -1023 : t);
+        }
+
+        int diff = q[0] - dc_pred;
+        dc_pred = q[0];
+        int n = _bit_count(diff);
+        w.put(dc_codes[n], dc_sizes[n]);
+        if (n)
+            w.put((uint32_t)(diff < 0 ? diff - 1 : diff) & ((1u << n) - 1), n);
+
+        int run = 0;
+        for (int i = 1; i < 64; ++i)
+        {
+            int v = q[i];
+            if (v == 0)
+            {
+                ++run;
+                continue;
+            }
+            while (run > 15)
+            {
+                w.put(ac_codes[0xF0], ac_sizes[0xF0]);
+                run -= 16;
+            }
+            n = _bit_count(v);
+            int sym = (run << 4) | n;
+            w.put(ac_codes[sym], ac_sizes[sym]);
+            w.put((uint32_t)(v < 0 ? v - 1 : v) & ((1u << n) - 1), n);
+            run = 0;
+        }
+        if (run > 0)
+            w.put(ac_codes[0], ac_sizes[0]);
+    }
+
+    // load one MCU, 16x16 pixels to 4 Y blocks and Cb, Cr blocks for color, 8x8 pixels to 1 Y block for gray
+    static void _load_mcu(const _Source &src, int mx, int my, float *y, float *cb, float *cr)
+    {
+        if (src.gray)
+        {
+            int x0 = mx * 8;
+            int y0 = my * 8;
+            for (int j = 0; j < 8; ++j)
+            {
+                const uint8_t *row = src.y + (size_t)std::min(y0 + j, src.h - 1) * src.w;
+                for (int i = 0; i < 8; ++i)
+                    y[j * 8 + i] = (float)row[std::min(x0 + i, src.w - 1)] - 128.f;
+            }
+            return;
+        }
+        int x0 = mx * 16;
+        int y0 = my * 16;
+        int xs[16];
+        for (int i = 0; i < 16; ++i)
+            xs[i] = std::min(x0 + i, src.w - 1);
+        if (src.yuv)
+        {
+            for (int j = 0; j < 16; ++j)
+            {
+                const uint8_t *row = src.y + (size_t)std::min(y0 + j, src.h - 1) * src.w;
+                float *dst = y + ((j >> 3) * 2) * 64 + (j & 7) * 8;
+                for (int i = 0; i < 8; ++i)
+                    dst[i] = (float)row[xs[i]] - 128.f;
+                for (int i = 0; i < 8; ++i)
+                    dst[64 + i] = (float)row[xs[8 + i]] - 128.f;
+            }
+            for (int j = 0; j < 8; ++j)
+            {
+                size_t row = (size_t)std::min(my * 8 + j, src.uv_h - 1) * src.uv_stride;
+                for (int i = 0; i < 8; ++i)
+                {
+                    size_t off = row + (size_t)std::min(mx * 8 + i, src.uv_w - 1) * src.uv_step;
+                    cb[j * 8 + i] = (float)src.u[off] - 128.f;
+                    cr[j * 8 + i] = (float)src.v[off] - 128.f;
+                }
+            }
+            return;
+        }
+        // RGB to YCbCr, chroma is average of 2x2 pixels
+        memset(cb, 0, 64 * sizeof(float));
+        memset(cr, 0, 64 * sizeof(float));
+        for (int j = 0; j < 16; ++j)
+        {
+            const uint8_t *row = src.rgb + (size_t)std::min(y0 + j, src.h - 1) * src.w * src.bpp;
+            float *dst = y + ((j >> 3) * 2) * 64 + (j & 7) * 8;
+            float *dst_cb = cb + (j >> 1) * 8;
+            float *dst_cr = cr + (j >> 1) * 8;
+            for (int i = 0; i < 16; ++i)
+            {
+                const uint8_t *p = row + xs[i] * src.bpp;
+                float r = p[src.r];
+                float g = p[src.g];
+                float b = p[src.b];
+                dst[(i >> 3) * 64 + (i & 7)] = 0.299f * r + 0.587f * g + 0.114f * b - 128.f;
+                dst_cb[i >> 1] += -0.168736f * r - 0.331264f * g + 0.5f * b;
+                dst_cr[i >> 1] += 0.5f * r - 0.418688f * g - 0.081312f * b;
+            }
+        }
+        for (int i = 0; i < 64; ++i)
+        {
+            cb[i] *= 0.25f;
+            cr[i] *= 0.25f;
+        }
+    }
+
+    JpegEncoder::JpegEncoder(int quality, int threads)
+        : _quality(0), _threads(threads < 0 ? 0 : threads), _slices_num(0), _size(0)
+    {
+        for (int t = 0; t < 4; ++t)
+        {
+            memset(_codes[t], 0, sizeof(_codes[t]));
+            memset(_code_sizes[t], 0, sizeof(_code_sizes[t]));
+            uint32_t code = 0;
+            int k = 0;
+            for (int len = 1; len <= 16; ++len)
+            {
+                for (int i = 0; i < _huff_bits[t][len - 1]; ++i)
+                {
+                    uint8_t sym = _huff_vals[t][k++];
+                    _codes[t][sym] = (uint16_t)code++;
+                    _code_sizes[t][sym] = (uint8_t)len;
+                }
+                code <<= 1;
+            }
+        }
+        if (set_quality(quality) != err::ERR_NONE)
+            throw err::Exception(err::ERR_ARGS, "JPEG quality should be [1, 100]");
+    }
+
+    JpegEncoder::~JpegEncoder()
+    {
+    }
+
+    err::Err JpegEncoder::set_quality(int quality)
+    {
+        if (quality < 1 || quality > 100)
+            return err::ERR_ARGS;
+        if (quality == _quality)
+            return err::ERR_NONE;
+        _quality = quality;
+        int scale = quality < 50 ? 5000 / quality : 200 - quality * 2;
+        static const float aan[8] = {1.0f, 1.387039845f, 1.306562965f, 1.175875602f,
+                                     1.0f, 0.785694958f, 0.541196100f, 0.275899379f};
+        for (int t = 0; t < 2; ++t)
+        {
+            for (int i = 0; i < 64; ++i)
+            {
+                int q = (_std_qtables[t][i] * scale + 50) / 100;
+                q = q < 1 ? 1 : (q > 255 ? 255 : q);
+                _divisors[t][i] = 1.0f / ((float)q * aan[i >> 3] * aan[i & 7] * 8.0f);
+            }
+            for (int i = 0; i < 64; ++i)
+            {
+                int q = (_std_qtables[t][_zigzag[i]] * scale + 50) / 100;
+                _qtables[t][i] = (uint8_t)(q < 1 ? 1 : (q > 255 ? 255 : q));
+            }
+        }
+        return err::ERR_NONE;
+    }
+
+    bool JpegEncoder::is_support(image::Format format)
+    {
+        switch (format)
+        {
+        case image::FMT_GRAYSCALE:
+        case image::FMT_YVU420SP:
+        case image::FMT_YUV420SP:
+        case image::FMT_YVU420P:
+        case image::FMT_YUV420P:
+        case image::FMT_RGB888:
+        case image::FMT_BGR888:
+        case image::FMT_RGBA8888:
+        case image::FMT_BGRA8888:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    void JpegEncoder::_build_header(int width, int height, bool gray, int restart_interval)
+    {
+        std::vector<uint8_t> &h = _header;
+        h.clear();
+        auto put16 = [&h](int v) {
+            h.push_back((uint8_t)(v >> 8));
+            h.push_back((uint8_t)v);
+        };
+        int ncomp = gray ? 1 : 3;
+        int ntables = gray ? 1 : 2;
+        // SOI, APP0 JFIF
+        static const uint8_t app0[] = {0xFF, 0xD8, 0xFF, 0xE0, 0x00, 0x10, 'J', 'F', 'I', 'F', 0x00,
+                                       0x01, 0x01, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00};
+        h.insert(h.end(), app0, app0 + sizeof(app0));
+        // DQT
+        put16(0xFFDB);
+        put16(2 + ntables * 65);
+        for (int t = 0; t < ntables; ++t)
+        {
+            h.push_back((uint8_t)t);
+            h.insert(h.end(), _qtables[t], _qtables[t] + 64);
+        }
+        // SOF0
+        put16(0xFFC0);
+        put16(8 + 3 * ncomp);
+        h.push_back(8);
+        put16(height);
+        put16(width);
+        h.push_back((uint8_t)ncomp);
+        for (int c = 0; c < ncomp; ++c)
+        {
+            h.push_back((uint8_t)(c + 1));
+            h.push_back(gray ? 0x11 : (c == 0 ? 0x22 : 0x11));
+            h.push_back(c == 0 ? 0 : 1);
+        }
+        // DHT
+        int len = 2;
+        for (int t = 0; t < ntables * 2; ++t)
+        {
+            len += 17;
+            for (int i = 0; i < 16; ++i)
+                len += _huff_bits[t][i];
+        }
+        put16(0xFFC4);
+        put16(len);
+        for (int t = 0; t < ntables * 2; ++t)
+        {
+            h.push_back((uint8_t)(((t & 1) << 4) | (t >> 1)));
+            int n = 0;
+            for (int i = 0; i < 16; ++i)
+            {
+                h.push_back(_huff_bits[t][i]);
+                n += _huff_bits[t][i];
+            }
+            h.insert(h.end(), _huff_vals[t], _huff_vals[t] + n);
+        }
+        // DRI
+        put16(0xFFDD);
+        put16(4);
+        put16(restart_interval);
+        // SOS
+        put16(0xFFDA);
+        put16(6 + 2 * ncomp);
+        h.push_back((uint8_t)ncomp);
+        for (int c = 0; c < ncomp; ++c)
+        {
+            h.push_back((uint8_t)(c + 1));
+            h.push_back(c == 0 ? 0x00 : 0x11);
+        }
+        h.push_back(0);
+        h.push_back(63);
+        h.push_back(0);
+    }
+
+    int JpegEncoder::encode(image::Image &img)
+    {
+        _size = 0;
+        image::Format format = img.format();
+        if (!is_support(format))
+            return -err::ERR_ARGS;
+        int w = img.width();
+        int h = img.height();
+        if (w > 65535 || h > 65535)
+            return -err::ERR_ARGS;
+
+        _Source src;
+        memset(&src, 0, sizeof(src));
+        src.w = w;
+        src.h = h;
+        src.gray = format == image::FMT_GRAYSCALE;
+        src.yuv = format == image::FMT_YVU420SP || format == image::FMT_YUV420SP ||
+                  format == image::FMT_YVU420P || format == image::FMT_YUV420P;
+        const uint8_t *data = (const uint8_t *)img.data();
+        if (src.gray || src.yuv)
+        {
+            src.y = data;
+            src.uv_w = w / 2 > 0 ? w / 2 : 1;
+            src.uv_h = h / 2 > 0 ? h / 2 : 1;
+            const uint8_t *c = data + (size_t)w * h;
+            switch (format)
+            {
+            case image::FMT_YVU420SP:
+                src.v = c;
+                src.u = c + 1;
+                src.uv_stride = w;
+                src.uv_step = 2;
+                break;
+            case image::FMT_YUV420SP:
+                src.u = c;
+                src.v = c + 1;
+                src.uv_stride = w;
+                src.uv_step = 2;
+                break;
+            case image::FMT_YVU420P:
+                src.v = c;
+                src.u = c + (size_t)(w / 2) * (h / 2);
+                src.uv_stride = w / 2;
+                src.uv_step = 1;
+                break;
+            case image::FMT_YUV420P:
+                src.u = c;
+                src.v = c + (size_t)(w / 2) * (h / 2);
+                src.uv_stride = w / 2;
+                src.uv_step = 1;
+                break;
+            default:
+                break;
+            }
+            if (src.yuv && (w < 2 || h < 2))
+            {
+                // image with one pixel width or height has no chroma data, use neutral chroma
+                static const uint8_t neutral = 128;
+                src.u = &neutral;
+                src.v = &neutral;
+                src.uv_stride = 0;
+                src.uv_step = 0;
+            }
+        }
+        else
+        {
+            src.rgb = data;
+            src.bpp = (format == image::FMT_RGB888 || format == image::FMT_BGR888) ? 3 : 4;
+            bool bgr = format == image::FMT_BGR888 || format == image::FMT_BGRA8888;
+            src.r = bgr ? 2 : 0;
+            src.g = 1;
+            src.b = bgr ? 0 : 2;
+        }
+
+        int mcu_size = src.gray ? 8 : 16;
+        int mcus_x = (w + mcu_size - 1) / mcu_size;
+        int mcus_y = (h + mcu_size - 1) / mcu_size;
+        int blocks = src.gray ? 1 : 6;
+        _build_header(w, h, src.gray, mcus_x);
+
+        // one MCU row one slice, slice buffers are kept for next frame,
+        // they grow with encoded size instead of worst case size, which is several times larger
+        _slices.resize(mcus_y);
+        size_t mcu_max = (size_t)blocks * BLOCK_MAX_BYTES + 16;
+        const float *div_y = _divisors[0];
+        const float *div_c = _divisors[1];
+        const uint16_t *codes[4] = {_codes[0], _codes[1], _codes[2], _codes[3]};
+        const uint8_t *sizes[4] = {_code_sizes[0], _code_sizes[1], _code_sizes[2], _code_sizes[3]};
+        int threads = _threads > 0 ? _threads : omp_get_max_threads();
+
+        #pragma omp parallel for schedule(dynamic) num_threads(threads)
+        for (int my = 0; my < mcus_y; ++my)
+        {
+            Slice &slice = _slices[my];
+            if (slice.buf.size() < mcu_max)
+                slice.buf.resize(mcu_max * 4);
+            _BitWriter writer;
+            writer.p = slice.buf.data();
+            uint8_t *end = slice.buf.data() + slice.buf.size();
+            int pred[3] = {0, 0, 0};
+            float y[4 * 64];
+            float cb[64];
+            float cr[64];
+            for (int mx = 0; mx < mcus_x; ++mx)
+            {
+                if ((size_t)(end - writer.p) < mcu_max)
+                {
+                    size_t used = writer.p - slice.buf.data();
+                    slice.buf.resize(slice.buf.size() * 2);
+                    writer.p = slice.buf.data() + used;
+                    end = slice.buf.data() + slice.buf.size();
+                }
+                _load_mcu(src, mx, my, y, cb, cr);
+                if (src.gray)
+                {
+                    _encode_block(writer, y, div_y, pred[0], codes[0], sizes[0], codes[1], sizes[1]);
+                    continue;
+                }
+                for (int k = 0; k < 4; ++k)
+                    _encode_block(writer, y + k * 64, div_y, pred[0], codes[0], sizes[0], codes[1], sizes[1]);
+                _encode_block(writer, cb, div_c, pred[1], codes[2], sizes[2], codes[3], sizes[3]);
+                _encode_block(writer, cr, div_c, pred[2], codes[2], sizes[2], codes[3], sizes[3]);
+            }
+            writer.flush();
+            slice.len = writer.p - slice.buf.data();
+        }
+
+        // header + slices + RST markers between slices + EOI
+        _size = _header.size() + 2 + (size_t)(mcus_y - 1) * 2;
+        for (int i = 0; i < mcus_y; ++i)
+            _size += _slices[i].len;
+        _slices_num = mcus_y;
+        return (int)_size;
+    }
+
+    err::Err JpegEncoder::write(void *buff, size_t buff_size)
+    {
+        if (_size == 0)
+            return err::ERR_NOT_READY;
+        if (buff_size < _size)
+            return err::ERR_BUFF_FULL;
+        uint8_t *p = (uint8_t *)buff;
+        memcpy(p, _header.data(), _header.size());
+        p += _header.size();
+        for (int i = 0; i < _slices_num; ++i)
+        {
+            if (i > 0)
+            {
+                *p++ = 0xFF;
+                *p++ = (uint8_t)(0xD0 + ((i - 1) & 7));
+            }
+            memcpy(p, _slices[i].buf.data(), _slices[i].len);
+            p += _slices[i].len;
+        }
+        *p++ = 0xFF;
+        *p++ = 0xD9;
+        return err::ERR_NONE;
+    }
+
+    int JpegEncoder::encode(image::Image &img, void *buff, size_t buff_size)
+    {
+        int size = encode(img);
+        if (size < 0)
+            return size;
+        err::Err e = write(buff, buff_size);
+        if (e != err::ERR_NONE)
+            return -e;
+        return size;
+    }
+
+    static void _free_jpeg_data(void *data, void *arg)
+    {
+        free(data);
+    }
+
+    image::Image *JpegEncoder::encode_image(image::Image &img, void *buff, size_t buff_size)
+    {
+        int size = encode(img);
+        if (size < 0)
+            throw err::Exception((err::Err)(-size), "JPEG encode format not support: " + image::fmt_names[img.format()]);
+        if (buff)
+        {
+            if (write(buff, buff_size) != err::ERR_NONE)
+                throw err::Exception(err::ERR_ARGS, "convert format failed, buffer size not enough");
+            return new image::Image(img.width(), img.height(), image::FMT_JPEG, (uint8_t *)buff, size, false);
+        }
+        uint8_t *data = (uint8_t *)malloc(size);
+        if (!data)
+            throw err::Exception(err::ERR_NO_MEM, "malloc JPEG data failed");
+        write(data, size);
+        image::Image *res = new image::Image(img.width(), img.height(), image::FMT_JPEG, data, size, false);
+        res->set_release_callback(_free_jpeg_data, nullptr);
+        return res;
+    }
+} // namespace maix::image
@@ -0,0 +1,269 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2023-
+ * @license Apache 2.0
+ * @update 2026.10.18: Create this file, add image buffer pool.
+ * @update 2026.10.18: Limit thread caches by max_bytes, report reused buffer to caller.
+ */
+
+#include "maix_image_pool.hpp"
+#include "maix_log.hpp"
+#include <stdlib.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace maix::image
+{
+    class _PoolBlock
+    {
+    public:
+        void *actual; // malloc address
+        void *data;   // 4KiB aligned address
+        int size;
+        uint64_t key;
+    };
+
+    class _Pool
+    {
+    public:
+        std::mutex lock;
+        std::vector<_PoolBlock *> idle; // oldest first
+        std::atomic<bool> enable{true};
+        std::atomic<int> max_bytes{32 * 1024 * 1024};
+        std::atomic<int> thread_cache{2};
+        std::atomic<int> min_bytes{64 * 1024};
+        std::atomic<uint32_t> generation{0}; // increase when clear, thread caches flush when generation changed
+
+        // statistics
+        std::atomic<uint64_t> hit{0};
+        std::atomic<uint64_t> thread_hit{0};
+        std::atomic<uint64_t> miss{0};
+        std::atomic<uint64_t> evict{0};
+        std::atomic<uint64_t> in_use{0};
+        std::atomic<uint64_t> in_use_bytes{0};
+        std::atomic<uint64_t> idle_num{0};
+        std::atomic<uint64_t> idle_bytes{0};
+        std::atomic<uint64_t> cache_bytes{0}; // idle bytes in thread caches, part of idle_bytes
+    };
+
+    // never destroyed, static images may release buffer after static objects destructed
+    static _Pool *_pool()
+    {
+        static _Pool *pool = new _Pool();
+        return pool;
+    }
+
+    static inline uint64_t _pool_key(int width, int height, image::Format format)
+    {
+        return ((uint64_t)width << 40) | ((uint64_t)height << 16) | (uint64_t)format;
+    }
+
+    static void _block_free(_Pool *pool, _PoolBlock *block)
+    {
+        pool->idle_num--;
+        pool->idle_bytes -= block->size;
+        free(block->actual);
+        delete block;
+    }
+
+    class _PoolThreadCache
+    {
+    public:
+        std::vector<_PoolBlock *> blocks;
+        uint32_t generation = 0;
+
+        ~_PoolThreadCache()
+        {
+            flush();
+        }
+
+        void flush()
+        {
+            _Pool *pool = _pool();
+            for (_PoolBlock *block : blocks)
+            {
+                pool->cache_bytes -= block->size;
+                _block_free(pool, block);
+            }
+            blocks.clear();
+        }
+    };
+
+    static thread_local _PoolThreadCache _thread_cache;
+
+    // call with pool->lock locked
+    static void _evict(_Pool *pool, uint64_t max_bytes)
+    {
+        size_t n = 0;
+        while (n < pool->idle.size() && pool->idle_bytes > max_bytes)
+        {
+            _block_free(pool, pool->idle[n]);
+            ++n;
+            pool->evict++;
+        }
+        if (n > 0)
+            pool->idle.erase(pool->idle.begin(), pool->idle.begin() + n);
+    }
+
+    static void _clear(_Pool *pool)
+    {
+        {
+            std::lock_guard<std::mutex> guard(pool->lock);
+            for (_PoolBlock *block : pool->idle)
+                _block_free(pool, block);
+            pool->idle.clear();
+            pool->generation++;
+        }
+        _thread_cache.flush();
+        _thread_cache.generation = pool->generation;
+    }
+
+    void set_buffer_pool(bool enable, int max_bytes, int thread_cache, int min_bytes)
+    {
+        _Pool *pool = _pool();
+        pool->max_bytes = max_bytes < 0 ? 0 : max_bytes;
+        pool->thread_cache = thread_cache < 0 ? 0 : thread_cache;
+        pool->min_bytes = min_bytes < 0 ? 0 : min_bytes;
+        pool->enable = enable;
+        if (!enable)
+        {
+            _clear(pool);
+            return;
+        }
+        {
+            // thread caches may exceed new limits, let them flush
+            std::lock_guard<std::mutex> guard(pool->lock);
+            _evict(pool, pool->max_bytes);
+            pool->generation++;
+        }
+        _thread_cache.flush();
+        _thread_cache.generation = pool->generation;
+    }
+
+    std::map<std::string, uint64_t> buffer_pool_stats()
+    {
+        _Pool *pool = _pool();
+        return {
+            {"hit", pool->hit},
+            {"thread_hit", pool->thread_hit},
+            {"miss", pool->miss},
+            {"evict", pool->evict},
+            {"in_use", pool->in_use},
+            {"in_use_bytes", pool->in_use_bytes},
+            {"idle", pool->idle_num},
+            {"idle_bytes", pool->idle_bytes},
+            {"thread_cache_bytes", pool->cache_bytes},
+        };
+    }
+
+    void buffer_pool_clear()
+    {
+        _clear(_pool());
+    }
+
+    void *buffer_pool_alloc(int width, int height, image::Format format, int size, void **arg, bool *reused)
+    {
+        if (reused)
+            *reused = false;
+        _Pool *pool = _pool();
+        if (!pool->enable || format >= image::FMT_COMPRESSED_MIN || size <= 0 || size < pool->min_bytes)
+            return nullptr;
+        uint64_t key = _pool_key(width, height, format);
+        _PoolBlock *block = nullptr;
+
+        // thread cache first, no lock
+        _PoolThreadCache &cache = _thread_cache;
+        if (cache.generation != pool->generation)
+        {
+            cache.flush();
+            cache.generation = pool->generation;
+        }
+        for (int i = (int)cache.blocks.size() - 1; i >= 0; --i)
+        {
+            if (cache.blocks[i]->key == key)
+            {
+                block = cache.blocks[i];
+                cache.blocks.erase(cache.blocks.begin() + i);
+                pool->cache_bytes -= block->size;
+                pool->thread_hit++;
+                break;
+            }
+        }
+        if (!block)
+        {
+            std::lock_guard<std::mutex> guard(pool->lock);
+            // newest first, it's more likely still in cache
+            for (int i = (int)pool->idle.size() - 1; i >= 0; --i)
+            {
+                if (pool->idle[i]->key == key)
+                {
+                    block = pool->idle[i];
+                    pool->idle.erase(pool->idle.begin() + i);
+                    break;
+                }
+            }
+        }
+        if (block)
+        {
+            if (reused)
+                *reused = true;
+            pool->hit++;
+            pool->idle_num--;
+            pool->idle_bytes -= block->size;
+        }
+        else
+        {
+            void *actual = malloc(size + 0x1000);
+            if (!actual)
+            {
+                log::error("image buffer pool malloc %d bytes failed\n", size);
+                return nullptr;
+            }
+            block = new _PoolBlock();
+            block->actual = actual;
+            block->data = (void *)(((uint64_t)actual + 0x1000) & ~0xFFF);
+            block->size = size;
+            block->key = key;
+            pool->miss++;
+        }
+        pool->in_use++;
+        pool->in_use_bytes += size;
+        *arg = block;
+        return block->data;
+    }
+
+    void buffer_pool_release(void *data, void *arg)
+    {
+        _Pool *pool = _pool();
+        _PoolBlock *block = (_PoolBlock *)arg;
+        pool->in_use--;
+        pool->in_use_bytes -= block->size;
+        pool->idle_num++;
+        uint64_t idle_bytes = pool->idle_bytes.fetch_add(block->size) + block->size;
+        uint64_t max_bytes = pool->max_bytes;
+        if (!pool->enable || (uint64_t)block->size > max_bytes)
+        {
+            _block_free(pool, block);
+            return;
+        }
+        _PoolThreadCache &cache = _thread_cache;
+        if (cache.generation == pool->generation &&
+            (int)cache.blocks.size() < pool->thread_cache &&
+            idle_bytes <= max_bytes)
+        {
+            // thread caches can not be evicted by other threads, limit all of them to half of max_bytes,
+            // so many threads caching buffers will not grow idle memory beyond max_bytes.
+            uint64_t cache_bytes = pool->cache_bytes.fetch_add(block->size) + block->size;
+            if (cache_bytes <= max_bytes / 2)
+            {
+                cache.blocks.push_back(block);
+                return;
+            }
+            pool->cache_bytes -= block->size;
+        }
+        std::lock_guard<std::mutex> guard(pool->lock);
+        pool->idle.push_back(block);
+        _evict(pool, pool->max_bytes);
+    }
+} // namespace maix::image
@@ -3,11 +3,13 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Use own software JPEG encoder on platforms without hardware encoder.
  */
 
 
 #include <stdlib.h>
 #include "maix_image_trans.hpp"
+#include "maix_image_jpeg.hpp"
 
 #include <websocketpp/config/asio_no_tls_client.hpp>
 #include <websocketpp/client.hpp>
@@ -78,6 +80,9 @@ namespace maix
         FixedQueue<QueueItem, 4> img_queue;
         std::vector<uint8_t> frame_buffer;
         ImageTrans *img_trans;
+#if !defined(PLATFORM_MAIXCAM) && !defined(PLATFORM_MAIXCAM2)
+        image::JpegEncoder jpeg_encoder; // keep tables and buffers for every frame
+#endif
     };
 
     inline uint8_t get_img_encode_id(image::Format fmt)
@@ -499,7 +504,17 @@ namespace maix
         {
             if(_fmt == image::FMT_JPEG)
             {
+#if !defined(PLATFORM_MAIXCAM) && !defined(PLATFORM_MAIXCAM2)
+                if (image::JpegEncoder::is_support(img.format()))
+                {
+                    handle->jpeg_encoder.set_quality(this->_quality);
+                    compressed = handle->jpeg_encoder.encode_image(img);
+                }
+                else
+                    compressed = img.to_jpeg(this->_quality);
+#else
                 compressed = img.to_jpeg(this->_quality);
+#endif
             }
             else
             {